@@ -43,6 +43,7 @@
 #include <lists/dir_list.h>
 
 #ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
 #include "audio_thread_wrapper.h"
 #endif
 
@@ -63,6 +64,7 @@
 #include "../frontend/frontend_driver.h"
 #include "../retroarch.h"
 #include "../list_special.h"
+#include "../performance_trace.h"
 #include "../file_path_special.h"
 #include "../record/record_driver.h"
 #include "../tasks/task_content.h"
@@ -83,6 +85,45 @@
 
 #define MENU_SOUND_FORMATS "ogg|mod|xm|s3m|mp3|flac|wav"
 
+#ifdef HAVE_THREADS
+/* Chunks the main thread can queue ahead of the processing thread.
+ * Two lets the core run while the previous chunk is filtered;
+ * any more would only add latency. */
+#define AUDIO_PROCESSING_SLOTS         2
+/* Largest flush: a full rewind buffer */
+#define AUDIO_PROCESSING_SLOT_SAMPLES  (AUDIO_CHUNK_SIZE_NONBLOCKING * 2)
+
+typedef struct audio_processing_slot
+{
+   int16_t data[AUDIO_PROCESSING_SLOT_SAMPLES];
+   retro_time_t flush_time;
+   size_t samples;
+   float volume_gain;
+   float slowmotion_ratio;
+   bool is_slowmotion;
+   bool is_fastforward;
+} audio_processing_slot_t;
+
+/* Single-producer, single-consumer ring of chunks. The lock only
+ * covers the index handoff; slots are filled and drained outside it. */
+struct audio_processing_thread
+{
+   audio_processing_slot_t slots[AUDIO_PROCESSING_SLOTS];
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;      /* A chunk was queued, or quit was set */
+   scond_t *done_cond; /* A chunk reached the driver */
+   /* Scratch for the 16-bit output; output_samples_conv_buf
+    * is the main thread's staging buffer. */
+   int16_t *conv_buf;
+   unsigned write_idx; /* Advanced by the main thread only */
+   unsigned read_idx;  /* Advanced by the worker only */
+   bool quit;
+};
+
+static void audio_driver_processing_thread_free(audio_driver_state_t *audio_st);
+#endif
+
  /* Converts decibels to voltage gain. Returns voltage gain value. */
 #define DB_TO_GAIN(db) (powf(10.0f, (db) / 20.0f))
 
@@ -316,6 +357,7 @@ static void audio_driver_report_audio_buffer_statistics(void)
 static void audio_driver_deinit_resampler(void)
 {
    audio_driver_state_t *audio_st = &audio_driver_st;
+   audio_driver_processing_thread_drain();
    if (audio_st->resampler && audio_st->resampler_data)
       audio_st->resampler->free(audio_st->resampler_data);
    audio_st->resampler          = NULL;
@@ -327,6 +369,9 @@ static void audio_driver_deinit_resampler(void)
 static bool audio_driver_deinit_internal(bool audio_enable)
 {
    audio_driver_state_t *audio_st = &audio_driver_st;
+#ifdef HAVE_THREADS
+   audio_driver_processing_thread_free(audio_st);
+#endif
    if (     audio_st->current_audio
          && audio_st->current_audio->free)
    {
@@ -435,76 +480,51 @@ bool audio_driver_find_driver(const char *audio_drv,
 }
 
 /**
- * Writes audio samples to audio driver's output.
- * Will first perform DSP processing (if enabled) and resampling.
+ * Runs the DSP filter and the resampler over a chunk of core audio,
+ * then writes the result to the audio driver.
  *
  * @param audio_st The overall state of the audio driver.
- * @param slowmotion_ratio The factor by which slow motion extends the core's runtime
- * (e.g. a value of 2 means the core is running at half speed).
  * @param data Audio output data that was most recently provided by the core.
  * @param samples The size of \c data, in samples.
+ * @param volume_gain Linear gain applied to the core's samples.
+ * @param slowmotion_ratio The factor by which slow motion extends the core's runtime.
  * @param is_slowmotion True if the core is currently running in slow motion.
- * @param is_fastmotion True if the core is currently running in fast-forward.
+ * @param is_fastforward True if fast-forward should speed up the audio.
+ * @param flush_time When the chunk was flushed, for the fast-forward ratio.
+ * @param mix True if the mixer streams should be mixed into the chunk;
+ * decided when the chunk was flushed, as the mixer may have been
+ * switched on or off since.
+ * @param avail Free space in the driver's buffer if it was already
+ * measured for this chunk, or -1 to query the driver.
+ * @param conv_buf Scratch buffer for the 16-bit output.
  **/
-static void audio_driver_flush(audio_driver_state_t *audio_st,
-      float slowmotion_ratio,
-      const int16_t *data, size_t samples,
-      bool is_slowmotion, bool is_fastforward)
+static void audio_driver_process(audio_driver_state_t *audio_st,
+      const int16_t *data, size_t samples, float volume_gain,
+      float slowmotion_ratio, bool is_slowmotion, bool is_fastforward,
+      retro_time_t flush_time, bool mix, int avail, int16_t *conv_buf)
 {
    struct resampler_data src_data;
-   float audio_volume_gain           =
-         (audio_st->mute_enable || audio_st->flags & AUDIO_FLAG_MUTED)
-               ? 0.0f
-               : audio_st->volume_gain;
-
-   /* Fast path: if driver handles resampling and no DSP/mixer is active,
-    * bypass software resampling entirely. */
-   if (audio_st->current_audio->write_raw
+   /* With 16-bit output and nothing working on float frames
+    * in between, a resampler that takes 16-bit frames directly
+    * saves converting to float and back. */
+   bool s16_path                     =
+            audio_st->resampler->process_s16
+         && !(audio_st->flags & AUDIO_FLAG_USE_FLOAT)
 #ifdef HAVE_DSP_FILTER
          && !audio_st->dsp
 #endif
-#ifdef HAVE_AUDIOMIXER
-         && audio_st->mixer_streams_playing == 0
-#endif
-      )
-   {
-      size_t frames                  = samples >> 1;
-      double rate_adjust             = 1.0;
-      unsigned input_rate            = (unsigned)audio_st->input;
-
-      /* Rate control for A/V sync */
-      if (audio_st->flags & AUDIO_FLAG_CONTROL)
-      {
-         unsigned write_idx          =
-               audio_st->free_samples_count++ & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1);
-         int avail                   = (int)audio_st->current_audio->write_avail(
-               audio_st->context_audio_data);
-         int half_size               = (int)(audio_st->buffer_size / 2);
-         int delta_mid               = avail - half_size;
-         double direction            = (double)delta_mid / half_size;
-
-         audio_st->free_samples_buf[write_idx] = avail;
-         rate_adjust                 = 1.0 + audio_st->rate_control_delta * direction;
-      }
-
-      if (is_slowmotion)
-         rate_adjust                *= slowmotion_ratio;
-
-      /* Note: mute/volume is not applied here - driver must handle or ignore */
-      audio_st->current_audio->write_raw(audio_st->context_audio_data,
-            data, frames, input_rate, rate_adjust, audio_volume_gain);
-      return;
-   }
+         && !mix;
 
    src_data.data_out                 = NULL;
    src_data.output_frames            = 0;
    /* We'll assign a proper output to the resampler later in this function */
 
-   convert_s16_to_float(audio_st->input_data, data, samples,
-         audio_volume_gain);
-
    /* The resampler operates on floating-point frames,
     * so we have to convert the input first */
+   if (!s16_path)
+      convert_s16_to_float(audio_st->input_data, data, samples,
+            volume_gain);
+
    src_data.data_in                  = audio_st->input_data;
    src_data.input_frames             = samples >> 1;
 
@@ -513,7 +533,7 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
 
 #ifdef HAVE_DSP_FILTER
    /* If we want to process our audio for reasons besides resampling... */
-   if (audio_st->dsp)
+   if (audio_st->dsp && !s16_path)
    {
       struct retro_dsp_data dsp_data;
 
@@ -552,12 +572,18 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
       /* Readjust the audio input rate. */
       if (audio_st->flags & AUDIO_FLAG_CONTROL)
       {
-         int avail                   = (int)audio_st->current_audio->write_avail(
-               audio_st->context_audio_data);
-         int half_size               = (int)(audio_st->buffer_size / 2);
-         int delta_mid               = avail - half_size;
-         double direction            = (double)delta_mid / half_size;
-         double adjust               = 1.0 + audio_st->rate_control_delta * direction;
+         int half_size;
+         int delta_mid;
+         double direction;
+         double adjust;
+
+         if (avail < 0)
+            avail                    = (int)audio_st->current_audio->write_avail(
+                  audio_st->context_audio_data);
+         half_size                   = (int)(audio_st->buffer_size / 2);
+         delta_mid                   = avail - half_size;
+         direction                   = (double)delta_mid / half_size;
+         adjust                      = 1.0 + audio_st->rate_control_delta * direction;
 
          audio_st->free_samples_buf[write_idx] = avail;
          audio_st->src_ratio_curr = audio_st->src_ratio_orig * adjust;
@@ -581,10 +607,8 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
    if (is_slowmotion)
       src_data.ratio       *= slowmotion_ratio;
 
-   if (is_fastforward && config_get_ptr()->bools.audio_fastforward_speedup)
+   if (is_fastforward)
    {
-      const retro_time_t flush_time = cpu_features_get_time_usec();
-
       if (audio_st->last_flush_time > 0)
       {
          /* What we should see if the speed was 1.0x, converted to microsecs */
@@ -616,10 +640,43 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
       audio_st->last_flush_time = flush_time;
    }
 
+   if (s16_path)
+   {
+      struct resampler_data_s16 s16_data;
+
+      s16_data.data_in               = data;
+      s16_data.data_out              = conv_buf;
+      s16_data.input_frames          = src_data.input_frames;
+      s16_data.output_frames         = 0;
+      s16_data.ratio                 = src_data.ratio;
+
+      /* Nothing else touches input_data on this path,
+       * so it doubles as room for the attenuated input. */
+      if (volume_gain != 1.0f)
+      {
+         size_t i;
+         int16_t *scaled             = (int16_t*)audio_st->input_data;
+         for (i = 0; i < samples; i++)
+         {
+            float val                = data[i] * volume_gain;
+            scaled[i]                = (int16_t)(val >  32767.0f ?  32767.0f
+                                     :           val < -32768.0f ? -32768.0f
+                                     :           val);
+         }
+         s16_data.data_in            = scaled;
+      }
+
+      audio_st->resampler->process_s16(audio_st->resampler_data, &s16_data);
+
+      audio_st->current_audio->write(audio_st->context_audio_data,
+            conv_buf, s16_data.output_frames * 2 * sizeof(int16_t));
+      return;
+   }
+
    audio_st->resampler->process(audio_st->resampler_data, &src_data);
 
 #ifdef HAVE_AUDIOMIXER
-   if (audio_st->flags & AUDIO_FLAG_MIXER_ACTIVE)
+   if (mix)
    {
       bool override                       = true;
       float mixer_gain                    = 0.0f;
@@ -650,10 +707,10 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
          output_frames       *= sizeof(float); /* Unit: bytes */
       else
       {
-         convert_float_to_s16(audio_st->output_samples_conv_buf,
+         convert_float_to_s16(conv_buf,
                (const float*)output_data, output_frames * 2);
 
-         output_data          = audio_st->output_samples_conv_buf;
+         output_data          = conv_buf;
          output_frames       *= sizeof(int16_t);  /* Unit: bytes */
       }
 
@@ -662,6 +719,278 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
    }
 }
 
+#ifdef HAVE_THREADS
+static void audio_driver_processing_thread_loop(void *data)
+{
+   struct audio_processing_thread *proc = (struct audio_processing_thread*)data;
+
+   slock_lock(proc->lock);
+   for (;;)
+   {
+      audio_processing_slot_t *slot;
+
+      while (!proc->quit && proc->read_idx == proc->write_idx)
+         scond_wait(proc->cond, proc->lock);
+      if (proc->quit)
+         break;
+
+      /* The main thread doesn't touch a queued slot, so it can be
+       * processed without holding the lock. */
+      slot = &proc->slots[proc->read_idx % AUDIO_PROCESSING_SLOTS];
+      slock_unlock(proc->lock);
+
+      /* Chunks are only queued while the mixer is off,
+       * and its voices stay with the main thread either way */
+      audio_driver_process(&audio_driver_st, slot->data, slot->samples,
+            slot->volume_gain, slot->slowmotion_ratio, slot->is_slowmotion,
+            slot->is_fastforward, slot->flush_time, false, -1,
+            proc->conv_buf);
+
+      slock_lock(proc->lock);
+      proc->read_idx++;
+      scond_signal(proc->done_cond);
+   }
+   slock_unlock(proc->lock);
+}
+
+static void audio_driver_processing_thread_free(audio_driver_state_t *audio_st)
+{
+   struct audio_processing_thread *proc = audio_st->processing_thread;
+
+   if (!proc)
+      return;
+
+   if (proc->thread)
+   {
+      /* Whatever is still queued is dropped along with the driver */
+      slock_lock(proc->lock);
+      proc->quit = true;
+      scond_signal(proc->cond);
+      slock_unlock(proc->lock);
+      sthread_join(proc->thread);
+   }
+
+   if (proc->done_cond)
+      scond_free(proc->done_cond);
+   if (proc->cond)
+      scond_free(proc->cond);
+   if (proc->lock)
+      slock_free(proc->lock);
+   if (proc->conv_buf)
+      memalign_free(proc->conv_buf);
+   free(proc);
+
+   audio_st->processing_thread = NULL;
+}
+
+static bool audio_driver_processing_thread_init(audio_driver_state_t *audio_st)
+{
+   struct audio_processing_thread *proc = (struct audio_processing_thread*)
+      calloc(1, sizeof(*proc));
+
+   if (!proc)
+      return false;
+
+   audio_st->processing_thread = proc;
+
+   if (   !(proc->conv_buf  = (int16_t*)memalign_alloc(64,
+               audio_st->output_samples_conv_buf_length))
+       || !(proc->lock      = slock_new())
+       || !(proc->cond      = scond_new())
+       || !(proc->done_cond = scond_new())
+       || !(proc->thread    = sthread_create(
+               audio_driver_processing_thread_loop, proc)))
+   {
+      RARCH_ERR("[Audio] Failed to start audio processing thread.\n");
+      audio_driver_processing_thread_free(audio_st);
+      return false;
+   }
+
+   RARCH_LOG("[Audio] Started audio processing thread.\n");
+   return true;
+}
+
+/**
+ * Hands a chunk of core audio to the processing thread,
+ * blocking while every slot is still queued.
+ *
+ * @return \c true if the chunk was queued, \c false if it
+ * has to be processed on the calling thread instead.
+ **/
+static bool audio_driver_processing_thread_push(audio_driver_state_t *audio_st,
+      const int16_t *data, size_t samples, float volume_gain,
+      float slowmotion_ratio, bool is_slowmotion, bool is_fastforward,
+      retro_time_t flush_time)
+{
+   audio_processing_slot_t *slot;
+   struct audio_processing_thread *proc = audio_st->processing_thread;
+
+   if (samples > AUDIO_PROCESSING_SLOT_SAMPLES)
+      return false;
+   if (!proc)
+   {
+      if (!audio_driver_processing_thread_init(audio_st))
+         return false;
+      proc = audio_st->processing_thread;
+   }
+
+   slock_lock(proc->lock);
+   while (proc->write_idx - proc->read_idx >= AUDIO_PROCESSING_SLOTS)
+      scond_wait(proc->done_cond, proc->lock);
+   slock_unlock(proc->lock);
+
+   /* Only the main thread advances write_idx, so the slot
+    * stays ours until it's published below. */
+   slot                   = &proc->slots[proc->write_idx % AUDIO_PROCESSING_SLOTS];
+   memcpy(slot->data, data, samples * sizeof(int16_t));
+   slot->samples          = samples;
+   slot->volume_gain      = volume_gain;
+   slot->slowmotion_ratio = slowmotion_ratio;
+   slot->is_slowmotion    = is_slowmotion;
+   slot->is_fastforward   = is_fastforward;
+   slot->flush_time       = flush_time;
+
+   slock_lock(proc->lock);
+   proc->write_idx++;
+   scond_signal(proc->cond);
+   slock_unlock(proc->lock);
+   return true;
+}
+#endif
+
+void audio_driver_processing_thread_drain(void)
+{
+#ifdef HAVE_THREADS
+   struct audio_processing_thread *proc = audio_driver_st.processing_thread;
+
+   if (!proc)
+      return;
+
+   slock_lock(proc->lock);
+   while (proc->read_idx != proc->write_idx)
+      scond_wait(proc->done_cond, proc->lock);
+   slock_unlock(proc->lock);
+#endif
+}
+
+/**
+ * Writes audio samples to audio driver's output.
+ * Will first perform DSP processing (if enabled) and resampling.
+ *
+ * @param audio_st The overall state of the audio driver.
+ * @param slowmotion_ratio The factor by which slow motion extends the core's runtime
+ * (e.g. a value of 2 means the core is running at half speed).
+ * @param data Audio output data that was most recently provided by the core.
+ * @param samples The size of \c data, in samples.
+ * @param is_slowmotion True if the core is currently running in slow motion.
+ * @param is_fastmotion True if the core is currently running in fast-forward.
+ **/
+static void audio_driver_flush(audio_driver_state_t *audio_st,
+      float slowmotion_ratio,
+      const int16_t *data, size_t samples,
+      bool is_slowmotion, bool is_fastforward)
+{
+   retro_time_t flush_time           = 0;
+   /* Free space measured for the raw path, reused
+    * by the resampler if the driver declines */
+   int avail                         = -1;
+#ifdef HAVE_THREADS
+   bool processing_thread            = config_get_ptr()->bools.audio_processing_thread;
+#endif
+   float audio_volume_gain           =
+         (audio_st->mute_enable || audio_st->flags & AUDIO_FLAG_MUTED)
+               ? 0.0f
+               : audio_st->volume_gain;
+
+   performance_trace_begin(PERF_TRACE_AUDIO_FLUSH);
+
+   /* Fast path: if driver handles resampling and no DSP/mixer is active,
+    * bypass software resampling entirely. */
+   if (audio_st->current_audio->write_raw
+#ifdef HAVE_DSP_FILTER
+         && !audio_st->dsp
+#endif
+#ifdef HAVE_AUDIOMIXER
+         && audio_st->mixer_streams_playing == 0
+#endif
+      )
+   {
+      size_t frames                  = samples >> 1;
+      double rate_adjust             = 1.0;
+      unsigned input_rate            = (unsigned)audio_st->input;
+
+#ifdef HAVE_THREADS
+      audio_driver_processing_thread_drain();
+#endif
+
+      /* Rate control for A/V sync */
+      if (audio_st->flags & AUDIO_FLAG_CONTROL)
+      {
+         int half_size               = (int)(audio_st->buffer_size / 2);
+         int delta_mid;
+         double direction;
+
+         avail                       = (int)audio_st->current_audio->write_avail(
+               audio_st->context_audio_data);
+         delta_mid                   = avail - half_size;
+         direction                   = (double)delta_mid / half_size;
+         rate_adjust                 = 1.0 + audio_st->rate_control_delta * direction;
+      }
+
+      if (is_slowmotion)
+         rate_adjust                *= slowmotion_ratio;
+
+      /* The driver applies volume itself. It may also
+       * decline a rate it can't play, in which case the
+       * samples take the software resampler below, which
+       * records the buffer statistics instead. */
+      if (audio_st->current_audio->write_raw(audio_st->context_audio_data,
+            data, frames, input_rate, rate_adjust, audio_volume_gain) >= 0)
+      {
+         if (audio_st->flags & AUDIO_FLAG_CONTROL)
+            audio_st->free_samples_buf[audio_st->free_samples_count++
+               & (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1)] = avail;
+         performance_trace_end(PERF_TRACE_AUDIO_FLUSH);
+         return;
+      }
+   }
+
+   if (is_fastforward && config_get_ptr()->bools.audio_fastforward_speedup)
+      flush_time                     = cpu_features_get_time_usec();
+   else
+      is_fastforward                 = false;
+
+#ifdef HAVE_THREADS
+   /* The mixer's voices belong to the main thread,
+    * so mixing keeps everything on it. */
+   if (     processing_thread
+#ifdef HAVE_AUDIOMIXER
+         && !(audio_st->flags & AUDIO_FLAG_MIXER_ACTIVE)
+#endif
+         && audio_driver_processing_thread_push(audio_st, data, samples,
+            audio_volume_gain, slowmotion_ratio, is_slowmotion,
+            is_fastforward, flush_time))
+   {
+      performance_trace_end(PERF_TRACE_AUDIO_FLUSH);
+      return;
+   }
+
+   /* Anything still queued has to reach the driver first. */
+   audio_driver_processing_thread_drain();
+#endif
+
+   audio_driver_process(audio_st, data, samples, audio_volume_gain,
+         slowmotion_ratio, is_slowmotion, is_fastforward, flush_time,
+#ifdef HAVE_AUDIOMIXER
+         !!(audio_st->flags & AUDIO_FLAG_MIXER_ACTIVE),
+#else
+         false,
+#endif
+         avail, audio_st->output_samples_conv_buf);
+
+   performance_trace_end(PERF_TRACE_AUDIO_FLUSH);
+}
+
 #ifdef HAVE_AUDIOMIXER
 audio_mixer_stream_t *audio_driver_mixer_get_stream(unsigned i)
 {
@@ -1028,6 +1357,7 @@ size_t audio_driver_sample_batch_rewind(
 void audio_driver_dsp_filter_free(void)
 {
    audio_driver_state_t *audio_st  = &audio_driver_st;
+   audio_driver_processing_thread_drain();
    if (audio_st->dsp)
       retro_dsp_filter_free(audio_st->dsp);
    audio_st->dsp = NULL;
@@ -1051,6 +1381,8 @@ bool audio_driver_dsp_filter_init(const char *device)
    if (!audio_driver_dsp)
       return false;
 
+   audio_driver_processing_thread_drain();
+
    audio_driver_st.dsp = audio_driver_dsp;
 
    return true;
@@ -1767,6 +2099,7 @@ bool audio_driver_start(bool is_shutdown)
          || !audio_st->current_audio->start
          || !audio_st->context_audio_data)
       goto error;
+   audio_driver_processing_thread_drain();
    if (!audio_st->current_audio->start(
             audio_st->context_audio_data, is_shutdown))
       goto error;
@@ -1801,6 +2134,7 @@ bool audio_driver_stop(void)
          || !audio_driver_alive()
       )
       return false;
+   audio_driver_processing_thread_drain();
    stopped = audio_driver_st.current_audio->stop(
          audio_driver_st.context_audio_data);
 
@@ -179,7 +179,9 @@ typedef struct audio_driver
     * @param input_rate  Source sample rate in Hz
     * @param rate_adjust Rate adjustment multiplier for A/V sync (1.0 = normal)
     * @param volume      Volume gain to apply (0.0 = muted, 1.0 = full volume)
-    * @return Number of frames written, or -1 on error
+    * @return Number of frames written, or -1 on error or if the driver
+    *         can't take this rate, in which case the frontend resamples
+    *         the samples and passes them to write() instead
     */
    ssize_t (*write_raw)(void *data, const int16_t *samples, size_t frames,
          unsigned input_rate, double rate_adjust, float volume);
@@ -272,6 +274,10 @@ typedef struct
    retro_time_t last_flush_time;
    /* Exponential moving average */
    retro_time_t avg_flush_delta;
+#ifdef HAVE_THREADS
+   /* Runs the DSP filter and resampler when audio_processing_thread is set */
+   struct audio_processing_thread *processing_thread;
+#endif
 } audio_driver_state_t;
 
 bool audio_driver_enable_callback(void);
@@ -286,6 +292,15 @@ bool audio_driver_dsp_filter_init(const char *device);
 
 void audio_driver_set_buffer_size(size_t bufsize);
 
+/**
+ * audio_driver_processing_thread_drain:
+ *
+ * Waits until the audio processing thread has written every queued
+ * chunk to the driver. Call before using the audio driver, the DSP
+ * filter or the resampler from the main thread.
+ **/
+void audio_driver_processing_thread_drain(void);
+
 bool audio_driver_get_devices_list(void **ptr);
 
 void audio_driver_setup_rewind(void);
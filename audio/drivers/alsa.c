@@ -16,9 +16,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <lists/string_list.h>
 #include <string/stdstring.h>
+#include <audio/conversion/s16_to_float.h>
 
 #include <alsa/asoundlib.h>
 #include <alsa/pcm.h>
@@ -299,7 +301,12 @@ microphone_driver_t microphone_alsa = {
 typedef struct alsa
 {
    snd_pcm_t *pcm;
+   /* Scratch for write_raw() samples in the PCM's format */
+   void *raw_buf;
+   size_t raw_buf_size;
    alsa_stream_info_t stream_info;
+   /* Rate the PCM was opened at */
+   unsigned rate;
    bool nonblock;
    bool is_paused;
 } alsa_t;
@@ -329,6 +336,8 @@ static void *alsa_init(const char *device, unsigned rate, unsigned latency,
             latency, 2, &alsa->stream_info, new_rate, SND_PCM_NONBLOCK) < 0)
       goto error;
 
+   alsa->rate = *new_rate;
+
    return alsa;
 
 error:
@@ -448,6 +457,45 @@ static ssize_t alsa_write(void *data, const void *buf_, size_t len)
    return _len;
 }
 
+static ssize_t alsa_write_raw(void *data, const int16_t *samples,
+      size_t frames, unsigned input_rate, double rate_adjust, float volume)
+{
+   size_t i, size;
+   alsa_t *alsa = (alsa_t*)data;
+   size_t len   = frames * 2;
+
+   /* ALSA can't change the rate of an open PCM, so the raw
+    * path is only taken when the core already runs at the
+    * PCM's rate and there is no rate to adjust. Anything
+    * else goes through the frontend's resampler. */
+   if (     rate_adjust != 1.0
+         || input_rate  != alsa->rate)
+      return -1;
+
+   size = len * (alsa->stream_info.has_float ? sizeof(float) : sizeof(int16_t));
+   if (size > alsa->raw_buf_size)
+   {
+      void *raw_buf = realloc(alsa->raw_buf, size);
+      if (!raw_buf)
+         return -1;
+      alsa->raw_buf      = raw_buf;
+      alsa->raw_buf_size = size;
+   }
+
+   if (alsa->stream_info.has_float)
+      convert_s16_to_float((float*)alsa->raw_buf, samples, len, volume);
+   else if (volume == 1.0f)
+      memcpy(alsa->raw_buf, samples, size);
+   else
+   {
+      int16_t *out = (int16_t*)alsa->raw_buf;
+      for (i = 0; i < len; i++)
+         out[i]    = (int16_t)(samples[i] * volume);
+   }
+
+   return alsa_write(alsa, alsa->raw_buf, size);
+}
+
 static bool alsa_alive(void *data)
 {
    alsa_t *alsa = (alsa_t*)data;
@@ -491,6 +539,7 @@ static void alsa_free(void *data)
       alsa_free_pcm(alsa->pcm);
 
       snd_config_update_free_global();
+      free(alsa->raw_buf);
       free(alsa);
    }
 }
@@ -539,5 +588,5 @@ audio_driver_t audio_alsa = {
    alsa_device_list_free,
    alsa_write_avail,
    alsa_buffer_size,
-   NULL /* write_raw */
+   alsa_write_raw
 };
@@ -22,6 +22,7 @@
 #include <boolean.h>
 #include <retro_miscellaneous.h>
 #include <retro_endianness.h>
+#include <audio/conversion/s16_to_float.h>
 
 #include "../common/pipewire.h"
 #include "../audio_driver.h"
@@ -44,6 +45,11 @@ typedef struct pipewire_audio
    struct spa_audio_info_raw info;
    uint32_t highwater_mark;
    uint32_t frame_size;
+   /* SPA_PROP_rate last given to the stream's resampler */
+   float rate_scale;
+   /* Scratch for write_raw() samples converted to float */
+   float *raw_buf;
+   size_t raw_buf_samples;
    struct spa_ringbuffer ring;
    uint8_t buffer[RINGBUFFER_SIZE];
 } pipewire_audio_t;
@@ -663,6 +669,7 @@ static void *pwire_init(const char *device, unsigned rate,
 
    audio->highwater_mark = MIN(RINGBUFFER_SIZE,
          latency * (uint64_t)rate / 1000 * audio->frame_size);
+   audio->rate_scale     = 1.0f;
 
    pw_thread_loop_wait(audio->pw->thread_loop);
    pw_thread_loop_unlock(audio->pw->thread_loop);
@@ -679,11 +686,11 @@ error:
    return NULL;
 }
 
-static ssize_t pwire_write(void *data, const void *buf_, size_t len)
+static ssize_t pwire_write_stream(pipewire_audio_t *audio,
+      const void *buf_, size_t len, float rate_scale)
 {
    int32_t   filled, avail;
    uint32_t            idx;
-   pipewire_audio_t *audio = (pipewire_audio_t*)data;
    const char       *error = NULL;
 
    if (pw_stream_get_state(audio->stream, &error) != PW_STREAM_STATE_STREAMING)
@@ -697,6 +704,16 @@ static ssize_t pwire_write(void *data, const void *buf_, size_t len)
 
    pw_thread_loop_lock(audio->pw->thread_loop);
 
+   /* The stream's adapter resamples by this factor on top of
+    * the negotiated rate, like pipewire-pulse does for
+    * variable rate streams. */
+   if (rate_scale != audio->rate_scale)
+   {
+      if (pw_stream_set_control(audio->stream,
+               SPA_PROP_rate, 1, &rate_scale, 0) >= 0)
+         audio->rate_scale = rate_scale;
+   }
+
    for (;;)
    {
       filled = spa_ringbuffer_get_write_index(&audio->ring, &idx);
@@ -751,6 +768,39 @@ static ssize_t pwire_write(void *data, const void *buf_, size_t len)
    return len;
 }
 
+static ssize_t pwire_write(void *data, const void *buf_, size_t len)
+{
+   return pwire_write_stream((pipewire_audio_t*)data, buf_, len, 1.0f);
+}
+
+static ssize_t pwire_write_raw(void *data, const int16_t *samples,
+      size_t frames, unsigned input_rate, double rate_adjust, float volume)
+{
+   ssize_t written;
+   pipewire_audio_t *audio = (pipewire_audio_t*)data;
+   size_t len              = frames * DEFAULT_CHANNELS;
+
+   if (len > audio->raw_buf_samples)
+   {
+      float *raw_buf       = (float*)realloc(audio->raw_buf, len * sizeof(float));
+      if (!raw_buf)
+         return -1;
+      audio->raw_buf         = raw_buf;
+      audio->raw_buf_samples = len;
+   }
+
+   convert_s16_to_float(audio->raw_buf, samples, len, volume);
+
+   /* The stream stays negotiated at the output rate;
+    * the scale makes its adapter treat the samples as
+    * input_rate / rate_adjust instead. */
+   written = pwire_write_stream(audio, audio->raw_buf, len * sizeof(float),
+         (float)((double)input_rate / rate_adjust / audio->info.rate));
+   if (written < 0)
+      return -1;
+   return written / audio->frame_size;
+}
+
 static bool pwire_stop(void *data)
 {
    pipewire_audio_t *audio = (pipewire_audio_t*)data;
@@ -827,6 +877,7 @@ static void pwire_free(void *data)
       pw_thread_loop_unlock(audio->pw->thread_loop);
    }
    pipewire_core_deinit(audio->pw);
+   free(audio->raw_buf);
    free(audio);
 }
 
@@ -887,5 +938,5 @@ audio_driver_t audio_pipewire = {
       pwire_device_list_free,
       pwire_write_avail,
       pwire_buffer_size,
-      NULL /* write_raw */
+      pwire_write_raw
 };
@@ -24,6 +24,7 @@
 #include <boolean.h>
 #include <retro_miscellaneous.h>
 #include <retro_endianness.h>
+#include <audio/conversion/s16_to_float.h>
 
 #include "../audio_driver.h"
 #include "../../verbosity.h"
@@ -33,7 +34,13 @@ typedef struct
    pa_threaded_mainloop *mainloop;
    pa_context *context;
    pa_stream *stream;
+   /* Scratch for write_raw() samples converted to float */
+   float *raw_buf;
+   size_t raw_buf_samples;
    size_t buffer_size;
+   /* Rate write() expects, and the rate the stream currently plays at */
+   unsigned rate;
+   unsigned stream_rate;
    bool nonblock;
    bool success;
    bool is_paused;
@@ -69,6 +76,7 @@ static void pulse_free(void *data)
    if (pa->devicelist)
       string_list_free(pa->devicelist);
 
+   free(pa->raw_buf);
    free(pa);
 }
 
@@ -244,8 +252,10 @@ static void *pulse_init(const char *device, unsigned rate,
    buffer_attr.minreq    = -1;
    buffer_attr.fragsize  = -1;
 
+   /* Variable rate lets write_raw() hand rate control to the server */
    if (pa_stream_connect_playback(pa->stream, NULL,
-            &buffer_attr, PA_STREAM_ADJUST_LATENCY, NULL, NULL) < 0)
+            &buffer_attr, PA_STREAM_ADJUST_LATENCY | PA_STREAM_VARIABLE_RATE,
+            NULL, NULL) < 0)
       goto error;
 
    pa_threaded_mainloop_wait(pa->mainloop);
@@ -265,7 +275,9 @@ static void *pulse_init(const char *device, unsigned rate,
       pa->buffer_size = buffer_attr.tlength;
 
    pa_threaded_mainloop_unlock(pa->mainloop);
-   pa->is_ready = true;
+   pa->rate        = rate;
+   pa->stream_rate = rate;
+   pa->is_ready    = true;
 
    return pa;
 
@@ -296,11 +308,10 @@ static bool pulse_start(void *data, bool is_shutdown)
    return ret;
 }
 
-static ssize_t pulse_write(void *data, const void *s, size_t len)
+static ssize_t pulse_write_stream(pa_t *pa, const uint8_t *buf, size_t len,
+      unsigned stream_rate)
 {
    size_t _len = 0;
-   pa_t           *pa = (pa_t*)data;
-   const uint8_t *buf = (const uint8_t*)s;
 
    /* Workaround buggy menu code.
     * If a write happens while we're paused, we might never progress. */
@@ -311,6 +322,20 @@ static ssize_t pulse_write(void *data, const void *s, size_t len)
       return 0;
 
    pa_threaded_mainloop_lock(pa->mainloop);
+
+   /* Not waited on; the server picks the new rate up
+    * at its next resampler update. */
+   if (stream_rate != pa->stream_rate)
+   {
+      pa_operation *op = pa_stream_update_sample_rate(pa->stream,
+            stream_rate, NULL, NULL);
+      if (op)
+      {
+         pa_operation_unref(op);
+         pa->stream_rate = stream_rate;
+      }
+   }
+
    while (len)
    {
       size_t writable = MIN(len, pa_stream_writable_size(pa->stream));
@@ -333,6 +358,47 @@ static ssize_t pulse_write(void *data, const void *s, size_t len)
    return _len;
 }
 
+static ssize_t pulse_write(void *data, const void *s, size_t len)
+{
+   pa_t *pa = (pa_t*)data;
+   return pulse_write_stream(pa, (const uint8_t*)s, len, pa->rate);
+}
+
+static ssize_t pulse_write_raw(void *data, const int16_t *samples,
+      size_t frames, unsigned input_rate, double rate_adjust, float volume)
+{
+   ssize_t written;
+   double stream_rate;
+   pa_t *pa           = (pa_t*)data;
+   size_t len         = frames * 2;
+
+   if (len > pa->raw_buf_samples)
+   {
+      float *raw_buf  = (float*)realloc(pa->raw_buf, len * sizeof(float));
+      if (!raw_buf)
+         return -1;
+      pa->raw_buf         = raw_buf;
+      pa->raw_buf_samples = len;
+   }
+
+   convert_s16_to_float(pa->raw_buf, samples, len, volume);
+
+   /* Let the server resample from the core's rate,
+    * nudged by rate control the same way the sinc
+    * resampler would be. */
+   stream_rate        = (double)input_rate / rate_adjust;
+   if (stream_rate < 1.0)
+      stream_rate     = 1.0;
+   else if (stream_rate > PA_RATE_MAX)
+      stream_rate     = PA_RATE_MAX;
+
+   written            = pulse_write_stream(pa, (const uint8_t*)pa->raw_buf,
+         len * sizeof(float), (unsigned)(stream_rate + 0.5));
+   if (written < 0)
+      return -1;
+   return written / (2 * sizeof(float));
+}
+
 static bool pulse_stop(void *data)
 {
    bool ret;
@@ -427,5 +493,5 @@ audio_driver_t audio_pulse = {
    pulse_device_list_free,
    pulse_write_avail,
    pulse_buffer_size,
-   NULL /* write_raw */
+   pulse_write_raw
 };
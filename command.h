@@ -113,6 +113,8 @@ enum event_command
    CMD_EVENT_FPS_TOGGLE,
    /* Toggles statistics display. */
    CMD_EVENT_STATISTICS_TOGGLE,
+   /* Writes the recent frame trace to disk. */
+   CMD_EVENT_PERF_TRACE_DUMP,
    /* Initializes overlay. */
    CMD_EVENT_OVERLAY_INIT,
    /* Frees or caches overlay. */
@@ -530,6 +532,7 @@ static const struct cmd_map map[] = {
    { "PREEMPT_TOGGLE",         RARCH_PREEMPT_TOGGLE },
    { "FPS_TOGGLE",             RARCH_FPS_TOGGLE },
    { "STATISTICS_TOGGLE",      RARCH_STATISTICS_TOGGLE },
+   { "PERF_TRACE_DUMP",        RARCH_PERF_TRACE_DUMP },
    { "AI_SERVICE",             RARCH_AI_SERVICE },
 
    { "NETPLAY_PING_TOGGLE",    RARCH_NETPLAY_PING_TOGGLE },
@@ -1247,6 +1247,8 @@
 #define DEFAULT_AUDIO_FASTFORWARD_SPEEDUP false
 /* Automatically mute audio when rewind is enabled. */
 #define DEFAULT_AUDIO_REWIND_MUTE false
+/* Run the DSP filter chain and resampler on their own thread. */
+#define DEFAULT_AUDIO_PROCESSING_THREAD false
 
 #ifdef HAVE_MICROPHONE
 /* Microphone support */
@@ -1285,6 +1287,10 @@
  * depending on the save state buffer. */
 #define DEFAULT_REWIND_ENABLE false
 
+/* Stores rewind states as deduplicated blocks instead of
+ * a chain of deltas. Uses less memory when states repeat. */
+#define DEFAULT_REWIND_DEDUPLICATE false
+
 /* When set, any time a cheat is toggled it is immediately applied. */
 #define DEFAULT_APPLY_CHEATS_AFTER_TOGGLE false
 
@@ -1414,6 +1420,19 @@
  * deterministic but in some cores produces janky results depending on
  * when inputs are processed. */
 #define DEFAULT_REPLAY_CHECKPOINT_DESERIALIZE true
+/* Specifies whether replay checkpoints are encoded, compressed and
+ * written on a worker thread while recording.  Only serializing the
+ * core remains on the main thread. */
+#define DEFAULT_REPLAY_CHECKPOINT_ASYNC false
+/* Specifies whether zstd-compressed replay checkpoints use the
+ * recording's initial state as a compression dictionary. */
+#define DEFAULT_REPLAY_CHECKPOINT_DICTIONARY false
+/* Specifies whether incremental replay checkpoints use block sizes
+ * calibrated for the running core. */
+#define DEFAULT_REPLAY_CHECKPOINT_CALIBRATE false
+/* Memory, in MB, that the incremental checkpoint encoder may keep for
+ * finding repeated data while recording; 0 means no limit. */
+#define DEFAULT_REPLAY_CHECKPOINT_MEMORY_LIMIT 0
 
 /* Automatically saves a savestate at the end of RetroArch's lifetime.
  * The path is $SRAM_PATH.auto.
@@ -1460,6 +1479,10 @@
 /* When using the Run Ahead feature, use a secondary instance of the core. */
 #define DEFAULT_RUN_AHEAD_SECONDARY_INSTANCE true
 
+/* When using the secondary instance, run it on its own thread,
+ * one frame behind the main instance. */
+#define DEFAULT_RUN_AHEAD_SECONDARY_THREAD false
+
 /* Hide warning messages when using the Run Ahead feature. */
 #define DEFAULT_RUN_AHEAD_HIDE_WARNINGS false
 
@@ -633,6 +633,13 @@ static const struct retro_keybind retro_keybinds_1[] = {
       RARCH_STATISTICS_TOGGLE, NO_BTN, NO_BTN, 0,
       true
    },
+   {
+      NULL, NULL,
+      AXIS_NONE, AXIS_NONE,
+      MENU_ENUM_LABEL_VALUE_INPUT_META_PERF_TRACE_DUMP, RETROK_UNKNOWN,
+      RARCH_PERF_TRACE_DUMP, NO_BTN, NO_BTN, 0,
+      true
+   },
    {
       NULL, NULL,
       AXIS_NONE, AXIS_NONE,
@@ -1300,6 +1307,13 @@ static const struct retro_keybind retro_keybinds_1[] = {
       RARCH_STATISTICS_TOGGLE, NO_BTN, NO_BTN, 0,
       true
    },
+   {
+      NULL, NULL,
+      AXIS_NONE, AXIS_NONE,
+      MENU_ENUM_LABEL_VALUE_INPUT_META_PERF_TRACE_DUMP, RETROK_UNKNOWN,
+      RARCH_PERF_TRACE_DUMP, NO_BTN, NO_BTN, 0,
+      true
+   },
    {
       NULL, NULL,
       AXIS_NONE, AXIS_NONE,
@@ -1977,6 +1991,13 @@ static const struct retro_keybind retro_keybinds_1[] = {
       RARCH_STATISTICS_TOGGLE, NO_BTN, NO_BTN, 0,
       true
    },
+   {
+      NULL, NULL,
+      AXIS_NONE, AXIS_NONE,
+      MENU_ENUM_LABEL_VALUE_INPUT_META_PERF_TRACE_DUMP, RETROK_UNKNOWN,
+      RARCH_PERF_TRACE_DUMP, NO_BTN, NO_BTN, 0,
+      true
+   },
    {
       NULL, NULL,
       AXIS_NONE, AXIS_NONE,
@@ -2637,6 +2658,13 @@ static const struct retro_keybind retro_keybinds_rest[] = {
       RARCH_STATISTICS_TOGGLE, NO_BTN, NO_BTN, 0,
       true
    },
+   {
+      NULL, NULL,
+      AXIS_NONE, AXIS_NONE,
+      MENU_ENUM_LABEL_VALUE_INPUT_META_PERF_TRACE_DUMP, RETROK_UNKNOWN,
+      RARCH_PERF_TRACE_DUMP, NO_BTN, NO_BTN, 0,
+      true
+   },
    {
       NULL, NULL,
       AXIS_NONE, AXIS_NONE,
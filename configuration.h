@@ -240,6 +240,7 @@ typedef struct settings
       unsigned rewind_buffer_size_step;
       unsigned autosave_interval;
       unsigned replay_checkpoint_interval;
+      unsigned replay_checkpoint_memory_limit;
       unsigned replay_max_keep;
       unsigned savestate_max_keep;
       unsigned network_cmd_port;
@@ -710,6 +711,7 @@ typedef struct settings
       bool audio_fastforward_mute;
       bool audio_fastforward_speedup;
       bool audio_rewind_mute;
+      bool audio_processing_thread;
 #ifdef IOS
       bool audio_respect_silent_mode;
 #endif
@@ -1041,6 +1043,7 @@ typedef struct settings
       bool history_list_enable;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_deduplicate;
       bool fastforward_frameskip;
       bool vrr_runloop_enable;
       bool menu_throttle_framerate;
@@ -1048,6 +1051,7 @@ typedef struct settings
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_secondary_thread;
       bool run_ahead_hide_warnings;
       bool preemptive_frames_enable;
       bool pause_nonactive;
@@ -1152,6 +1156,9 @@ typedef struct settings
       bool gamemode_enable;
 #ifdef HAVE_BSV_MOVIE
       bool replay_checkpoint_deserialize;
+      bool replay_checkpoint_async;
+      bool replay_checkpoint_dictionary;
+      bool replay_checkpoint_calibrate;
 #endif
 
 #ifdef _3DS
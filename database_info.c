@@ -19,13 +19,13 @@
 #include <stdint.h>
 
 #include <compat/strl.h>
-#include <retro_endianness.h>
 #include <file/file_path.h>
 #include <lists/string_list.h>
 #include <lists/dir_list.h>
 #include <string/stdstring.h>
 
 #include "libretro-db/libretrodb.h"
+#include "libretro-db/rmsgpack.h"
 
 #include "core_info.h"
 #include "database_info.h"
@@ -502,184 +502,164 @@ char *bin_to_hex_alloc(const uint8_t *data, size_t len)
    return ret;
 }
 
+/* Replaces *s with a copy of a string or binary value,
+ * unless the value is empty */
+static void database_info_set_string(char **s,
+      const struct rmsgpack_token *val)
+{
+   size_t len;
+   const char *buff;
+   const char *nul;
+
+   if (val->type == RMSGPACK_TOKEN_STRING)
+   {
+      buff = val->val.string.buff;
+      len  = val->val.string.len;
+   }
+   else if (val->type == RMSGPACK_TOKEN_BINARY)
+   {
+      buff = (const char*)val->val.binary.buff;
+      len  = val->val.binary.len;
+   }
+   else
+      return;
+
+   /* Values are not NUL terminated in the buffer */
+   if ((nul = (const char*)memchr(buff, '\0', len)))
+      len = nul - buff;
+   if (!len)
+      return;
+
+   if (*s)
+      free(*s);
+   if ((*s = (char*)malloc(len + 1)))
+   {
+      memcpy(*s, buff, len);
+      (*s)[len] = '\0';
+   }
+}
+
 static int database_cursor_iterate(libretrodb_cursor_t *cur,
       database_info_t *db_info)
 {
-   size_t i;
-   struct rmsgpack_dom_value item;
-   const char* str                = NULL;
-
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
+   uint32_t i, pairs;
+   size_t len;
+   const void *data;
+   struct rmsgpack_reader item;
+   struct rmsgpack_token token;
+
+   /* Fields are read straight from the cursor's buffer;
+    * only the strings that are kept get allocated */
+   if (libretrodb_cursor_read_item_buf(cur, &data, &len) != 0)
       return -1;
 
-   if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
+   rmsgpack_reader_init(&item, data, len);
+
+   if (     rmsgpack_reader_next(&item, &token) != 0
+         || token.type != RMSGPACK_TOKEN_MAP)
       return 1;
-   }
 
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
    db_info->coop_supported         = -1;
 
-   for (i = 0; i < item.val.map.len; i++)
+   pairs = token.val.len;
+
+   for (i = 0; i < pairs; i++)
    {
-      struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
-      struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
-      const char *val_string         = NULL;
+      char str[64];
+      struct rmsgpack_token key;
+      struct rmsgpack_token value;
+      struct rmsgpack_reader value_reader;
+      const struct rmsgpack_token *val = &value;
 
-      if (!key || !val)
+      if (rmsgpack_reader_next(&item, &key) != 0)
+         break;
+      value_reader = item;
+      if (     rmsgpack_reader_skip(&item) != 0
+            || rmsgpack_reader_next(&value_reader, &value) != 0)
+         break;
+
+      if (     key.type != RMSGPACK_TOKEN_STRING
+            || key.val.string.len >= sizeof(str))
          continue;
 
-      val_string                     = val->val.string.buff;
-      str                            = key->val.string.buff;
+      memcpy(str, key.val.string.buff, key.val.string.len);
+      str[key.val.string.len] = '\0';
 
       if (string_is_equal(str, "publisher"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->publisher = strdup(val_string);
-      }
+         database_info_set_string(&db_info->publisher, val);
       else if (string_is_equal(str, "developer"))
       {
-         if (!string_is_empty(val_string))
-            db_info->developer = string_split(val_string, "|");
+         char *developer = NULL;
+         database_info_set_string(&developer, val);
+         if (developer)
+         {
+            string_list_free(db_info->developer);
+            db_info->developer = string_split(developer, "|");
+            free(developer);
+         }
       }
       else if (string_is_equal(str, "serial"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->serial = strdup(val_string);
-      }
+         database_info_set_string(&db_info->serial, val);
       else if (string_is_equal(str, "rom_name"))
       {
 /* rom_name is not used anywhere in codebase, but is frequently added to DB */
 #if 0
-         if (!string_is_empty(val_string))
-            db_info->rom_name = strdup(val_string);
+         database_info_set_string(&db_info->rom_name, val);
 #endif
       }
       else if (string_is_equal(str, "name"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->name = strdup(val_string);
-      }
+         database_info_set_string(&db_info->name, val);
       else if (string_is_equal(str, "description"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->description = strdup(val_string);
-      }
+         database_info_set_string(&db_info->description, val);
       else if (string_is_equal(str, "genre"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->genre = strdup(val_string);
-      }
+         database_info_set_string(&db_info->genre, val);
       else if (string_is_equal(str, "category"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->category = strdup(val_string);
-      }
+         database_info_set_string(&db_info->category, val);
       else if (string_is_equal(str, "language"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->language = strdup(val_string);
-      }
+         database_info_set_string(&db_info->language, val);
       else if (string_is_equal(str, "region"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->region = strdup(val_string);
-      }
+         database_info_set_string(&db_info->region, val);
       else if (string_is_equal(str, "score"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->score = strdup(val_string);
-      }
+         database_info_set_string(&db_info->score, val);
       else if (string_is_equal(str, "media"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->media = strdup(val_string);
-      }
+         database_info_set_string(&db_info->media, val);
       else if (string_is_equal(str, "controls"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->controls = strdup(val_string);
-      }
+         database_info_set_string(&db_info->controls, val);
       else if (string_is_equal(str, "artstyle"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->artstyle = strdup(val_string);
-      }
+         database_info_set_string(&db_info->artstyle, val);
       else if (string_is_equal(str, "gameplay"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->gameplay = strdup(val_string);
-      }
+         database_info_set_string(&db_info->gameplay, val);
       else if (string_is_equal(str, "narrative"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->narrative = strdup(val_string);
-      }
+         database_info_set_string(&db_info->narrative, val);
       else if (string_is_equal(str, "pacing"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->pacing = strdup(val_string);
-      }
+         database_info_set_string(&db_info->pacing, val);
       else if (string_is_equal(str, "perspective"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->perspective = strdup(val_string);
-      }
+         database_info_set_string(&db_info->perspective, val);
       else if (string_is_equal(str, "setting"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->setting = strdup(val_string);
-      }
+         database_info_set_string(&db_info->setting, val);
       else if (string_is_equal(str, "visual"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->visual = strdup(val_string);
-      }
+         database_info_set_string(&db_info->visual, val);
       else if (string_is_equal(str, "vehicular"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->vehicular = strdup(val_string);
-      }
+         database_info_set_string(&db_info->vehicular, val);
       else if (string_is_equal(str, "origin"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->origin = strdup(val_string);
-      }
+         database_info_set_string(&db_info->origin, val);
       else if (string_is_equal(str, "franchise"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->franchise = strdup(val_string);
-      }
+         database_info_set_string(&db_info->franchise, val);
       else if (string_ends_with_size(str, "_rating",
                strlen(str), STRLEN_CONST("_rating")))
       {
          if (string_is_equal(str, "bbfc_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->bbfc_rating = strdup(val_string);
-         }
+            database_info_set_string(&db_info->bbfc_rating, val);
          else if (string_is_equal(str, "esrb_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->esrb_rating = strdup(val_string);
-         }
+            database_info_set_string(&db_info->esrb_rating, val);
          else if (string_is_equal(str, "elspa_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->elspa_rating = strdup(val_string);
-         }
+            database_info_set_string(&db_info->elspa_rating, val);
          else if (string_is_equal(str, "cero_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->cero_rating          = strdup(val_string);
-         }
+            database_info_set_string(&db_info->cero_rating, val);
          else if (string_is_equal(str, "pegi_rating"))
-         {
-            if (!string_is_empty(val_string))
-               db_info->pegi_rating          = strdup(val_string);
-         }
+            database_info_set_string(&db_info->pegi_rating, val);
          else if (string_is_equal(str, "edge_rating"))
             db_info->edge_magazine_rating    = (unsigned)val->val.uint_;
          else if (string_is_equal(str, "famitsu_rating"))
@@ -688,15 +668,9 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
             db_info->tgdb_rating             = (unsigned)val->val.uint_;
       }
       else if (string_is_equal(str, "enhancement_hw"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->enhancement_hw       = strdup(val_string);
-      }
+         database_info_set_string(&db_info->enhancement_hw, val);
       else if (string_is_equal(str, "edge_review"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->edge_magazine_review = strdup(val_string);
-      }
+         database_info_set_string(&db_info->edge_magazine_review, val);
       else if (string_is_equal(str, "edge_issue"))
          db_info->edge_magazine_issue     = (unsigned)val->val.uint_;
       else if (string_is_equal(str, "users"))
@@ -721,32 +695,44 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
          db_info->size                    = (uint64_t)val->val.uint_;
       else if (string_is_equal(str, "crc"))
       {
-         switch (val->val.binary.len)
+         const uint8_t *crc = (const uint8_t*)val->val.binary.buff;
+         db_info->crc32     = 0;
+         /* Stored big endian, possibly unaligned */
+         if (val->type == RMSGPACK_TOKEN_BINARY)
          {
-            case 1:
-               db_info->crc32 = *(uint8_t*)val->val.binary.buff;
-               break;
-            case 2:
-               db_info->crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
-               break;
-            case 4:
-               db_info->crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
-               break;
-            default:
-               db_info->crc32 = 0;
-               break;
+            switch (val->val.binary.len)
+            {
+               case 4:
+                  db_info->crc32 = ((uint32_t)crc[0] << 24)
+                                 | ((uint32_t)crc[1] << 16)
+                                 | ((uint32_t)crc[2] << 8)
+                                 |  (uint32_t)crc[3];
+                  break;
+               case 2:
+                  db_info->crc32 = ((uint32_t)crc[0] << 8) | crc[1];
+                  break;
+               case 1:
+                  db_info->crc32 = crc[0];
+                  break;
+               default:
+                  break;
+            }
          }
       }
       else if (string_is_equal(str, "sha1"))
-         db_info->sha1 = bin_to_hex_alloc(
-               (uint8_t*)val->val.binary.buff, val->val.binary.len);
+      {
+         if (val->type == RMSGPACK_TOKEN_BINARY)
+            db_info->sha1 = bin_to_hex_alloc(
+                  val->val.binary.buff, val->val.binary.len);
+      }
       else if (string_is_equal(str, "md5"))
-         db_info->md5 = bin_to_hex_alloc(
-               (uint8_t*)val->val.binary.buff, val->val.binary.len);
+      {
+         if (val->type == RMSGPACK_TOKEN_BINARY)
+            db_info->md5 = bin_to_hex_alloc(
+                  val->val.binary.buff, val->val.binary.len);
+      }
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
@@ -52,6 +52,7 @@ RETRO_BEGIN_DECLS
 #define FILE_PATH_STATE_EXTENSION ".state"
 #define FILE_PATH_LPL_EXTENSION ".lpl"
 #define FILE_PATH_LPL_EXTENSION_NO_DOT "lpl"
+#define FILE_PATH_LPL_CACHE_EXTENSION ".lplc"
 #define FILE_PATH_PNG_EXTENSION ".png"
 #define FILE_PATH_MP3_EXTENSION ".mp3"
 #define FILE_PATH_FLAC_EXTENSION ".flac"
@@ -94,6 +95,7 @@ RETRO_BEGIN_DECLS
 #define FILE_PATH_CONTENT_IMAGE_HISTORY "content_image_history.lpl"
 #define FILE_PATH_CONTENT_MUSIC_HISTORY "content_music_history.lpl"
 #define FILE_PATH_CONTENT_VIDEO_HISTORY "content_video_history.lpl"
+#define FILE_PATH_EXPLORE_INDEX "explore.idx"
 #define FILE_PATH_CORE_OPTIONS_CONFIG "retroarch-core-options.cfg"
 #ifdef DJGPP
 #define FILE_PATH_MAIN_CONFIG "retrodos.cfg"
@@ -63,6 +63,7 @@
 #include "../driver.h"
 #include "../file_path_special.h"
 #include "../list_special.h"
+#include "../performance_trace.h"
 #include "../retroarch.h"
 #include "../verbosity.h"
 
@@ -3835,6 +3836,8 @@ void video_driver_frame(const void *data, unsigned width,
    if (!video_driver_active)
       return;
 
+   performance_trace_begin(PERF_TRACE_VIDEO_FRAME);
+
    new_time                      = cpu_features_get_time_usec();
    runloop_st->core_run_time     = new_time - runloop_st->core_run_time;
 
@@ -4480,6 +4483,8 @@ void video_driver_frame(const void *data, unsigned width,
    else if (!video_info.crt_switch_resolution)
 #endif
       video_st->flags          &= ~VIDEO_FLAG_CRT_SWITCHING_ACTIVE;
+
+   performance_trace_end(PERF_TRACE_VIDEO_FRAME);
 }
 
 static void video_driver_reinit_context(settings_t *settings, int flags)
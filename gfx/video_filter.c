@@ -29,6 +29,10 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "../frontend/frontend_driver.h"
 #include "../dynamic.h"
 #include "../performance_counters.h"
@@ -58,50 +62,78 @@ struct rarch_softfilter
    enum retro_pixel_format pix_fmt, out_pix_fmt;
 
    struct softfilter_work_packet *packets;
+   unsigned num_packets;
+   /* Threads working on a frame, including the caller of
+    * rarch_softfilter_process() */
    unsigned threads;
 
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   sthread_t **workers;
+   slock_t *lock;
+   scond_t *cond;
+   scond_t *done_cond;
+   unsigned next_packet;
+   unsigned done_packets;
+   unsigned frame;
+   bool die;
 #endif
 };
 
-#ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
+/* Work packets asked for per thread. Filters cut the frame into
+ * more strips than there are threads, and a thread that finishes
+ * its strip early takes the next unclaimed one, so one slow strip
+ * no longer holds up the whole frame. */
+#define SOFTFILTER_PACKETS_PER_THREAD 4
 
-struct filter_thread_data
+#ifdef HAVE_THREADS
+/* Claims and runs packets of the current frame until none are
+ * left. Called by the workers and by the thread submitting
+ * the frame. */
+static void softfilter_run_packets(rarch_softfilter_t *filt)
 {
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
-};
+   bool finished = false;
+
+   slock_lock(filt->lock);
+   for (;;)
+   {
+      const struct softfilter_work_packet *packet;
+
+      if (finished && ++filt->done_packets == filt->num_packets)
+         scond_signal(filt->done_cond);
+      if (filt->next_packet >= filt->num_packets)
+         break;
+
+      packet   = &filt->packets[filt->next_packet++];
+      slock_unlock(filt->lock);
+
+      if (packet->work)
+         packet->work(filt->impl_data, packet->thread_data);
+      finished = true;
+
+      slock_lock(filt->lock);
+   }
+   slock_unlock(filt->lock);
+}
 
 static void filter_thread_loop(void *data)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   rarch_softfilter_t *filt = (rarch_softfilter_t*)data;
+   unsigned frame           = 0;
 
    for (;;)
    {
       bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
+      slock_lock(filt->lock);
+      while (filt->frame == frame && !filt->die)
+         scond_wait(filt->cond, filt->lock);
+      die   = filt->die;
+      frame = filt->frame;
+      slock_unlock(filt->lock);
 
       if (die)
          break;
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
-
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
+      softfilter_run_packets(filt);
    }
 }
 #endif
@@ -204,29 +236,37 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = cpu_features_get_core_amount();
+#ifndef HAVE_THREADS
+   threads = 1;
+#endif
+   if (!threads)
+      threads = 1;
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
-         &userdata);
+         (threads > 1) ? threads * SOFTFILTER_PACKETS_PER_THREAD : 1,
+         cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("[SoftFilter] Failed to create softfilter state.\n");
       return false;
    }
 
-   threads = filt->impl->query_num_threads(filt->impl_data);
-   if (!threads)
+   filt->num_packets = filt->impl->query_num_threads(filt->impl_data);
+   if (!filt->num_packets)
    {
       RARCH_ERR("[SoftFilter] Invalid number of threads.\n");
       return false;
    }
 
-   filt->threads = threads;
-   RARCH_LOG("[SoftFilter] Using %u threads for softfilter.\n", threads);
+   filt->threads = MIN(threads, filt->num_packets);
+   RARCH_LOG("[SoftFilter] Using %u threads for %u work packets.\n",
+         filt->threads, filt->num_packets);
 
    filt->packets = (struct softfilter_work_packet*)
-      calloc(threads, sizeof(*filt->packets));
+      calloc(filt->num_packets, sizeof(*filt->packets));
    if (!filt->packets)
    {
       RARCH_ERR("[SoftFilter] Failed to allocate softfilter packets.\n");
@@ -237,24 +277,23 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    if (filt->threads > 1)
    {
       unsigned i;
-      if (!(filt->thread_data = (struct filter_thread_data*)
-         calloc(threads, sizeof(*filt->thread_data))))
+
+      if (!(filt->lock      = slock_new()))
+         return false;
+      if (!(filt->cond      = scond_new()))
+         return false;
+      if (!(filt->done_cond = scond_new()))
          return false;
 
-      for (i = 0; i < threads; i++)
-      {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
+      /* The submitting thread works too, so it needs one less */
+      if (!(filt->workers = (sthread_t**)
+         calloc(filt->threads - 1, sizeof(*filt->workers))))
+         return false;
 
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
-               filter_thread_loop, &filt->thread_data[i]);
-         if (!filt->thread_data[i].thread)
+      for (i = 0; i < filt->threads - 1; i++)
+      {
+         if (!(filt->workers[i] = sthread_create(
+               filter_thread_loop, filt)))
             return false;
       }
    }
@@ -483,6 +522,29 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    if (!filt)
       return;
 
+#ifdef HAVE_THREADS
+   if (filt->workers)
+   {
+      slock_lock(filt->lock);
+      filt->die = true;
+      scond_broadcast(filt->cond);
+      slock_unlock(filt->lock);
+
+      for (i = 0; i < filt->threads - 1; i++)
+      {
+         if (filt->workers[i])
+            sthread_join(filt->workers[i]);
+      }
+      free(filt->workers);
+   }
+   if (filt->lock)
+      slock_free(filt->lock);
+   if (filt->cond)
+      scond_free(filt->cond);
+   if (filt->done_cond)
+      scond_free(filt->done_cond);
+#endif
+
    free(filt->packets);
    if (filt->impl && filt->impl_data)
       filt->impl->destroy(filt->impl_data);
@@ -496,25 +558,6 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    free(filt->plugs);
 #endif
 
-#ifdef HAVE_THREADS
-   if (filt->threads > 1)
-   {
-      for (i = 0; i < filt->threads; i++)
-      {
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
-      }
-      free(filt->thread_data);
-   }
-#endif
-
    if (filt->conf)
       config_file_free(filt->conf);
 
@@ -560,28 +603,25 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
 #ifdef HAVE_THREADS
    if (filt->threads > 1)
    {
-      /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
-
-      /* Wait for workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      /* Wake up the workers */
+      slock_lock(filt->lock);
+      filt->next_packet  = 0;
+      filt->done_packets = 0;
+      filt->frame++;
+      scond_broadcast(filt->cond);
+      slock_unlock(filt->lock);
+
+      /* Take packets ourselves instead of sleeping on the workers */
+      softfilter_run_packets(filt);
+
+      slock_lock(filt->lock);
+      while (filt->done_packets < filt->num_packets)
+         scond_wait(filt->done_cond, filt->lock);
+      slock_unlock(filt->lock);
       return;
    }
 #endif
 
-   for (i = 0; i < filt->threads; i++)
+   for (i = 0; i < filt->num_packets; i++)
       filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
 }
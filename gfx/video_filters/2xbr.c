@@ -233,7 +233,7 @@ static void *twoxbr_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -539,7 +539,8 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
       int first, int last, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned nextline, finish;
+   unsigned finish;
+   unsigned above            = first;
    uint32_t pg_red_mask      = RED_MASK8888;
    uint32_t pg_green_mask    = GREEN_MASK8888;
    uint32_t pg_blue_mask     = BLUE_MASK8888;
@@ -549,10 +550,12 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
 
    (void)filt;
 
-   nextline = (last) ? 0 : src_stride;
-
-   for (; height; height--)
+   for (; height; height--, above++)
    {
+      /* Pixels are sampled from two rows above to two rows below,
+       * so stay on the current row near the edges of the frame */
+      unsigned nextline = (above >= 2 && height - 1 + last >= 2)
+         ? src_stride : 0;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
@@ -608,10 +611,14 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
    uint16_t pg_green_mask   = GREEN_MASK565;
    uint16_t pg_blue_mask    = BLUE_MASK565;
    uint16_t pg_lbmask       = PG_LBMASK565;
-   unsigned nextline        = (last) ? 0 : src_stride;
+   unsigned above           = first;
 
-   for (; height; height--)
+   for (; height; height--, above++)
    {
+      /* Pixels are sampled from two rows above to two rows below,
+       * so stay on the current row near the edges of the frame */
+      unsigned nextline = (above >= 2 && height - 1 + last >= 2)
+         ? src_stride : 0;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
@@ -714,10 +721,10 @@ static void twoxbr_generic_packets(void *data,
       thr->width = width;
       thr->height = y_end - y_start;
 
-      /* Workers need to know if they can access
-       * pixels outside their given buffer. */
+      /* Workers need to know how many rows outside
+       * their given buffer they can access. */
       thr->first = y_start;
-      thr->last = y_end == height;
+      thr->last = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = twoxbr_work_cb_rgb565;
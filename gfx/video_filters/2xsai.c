@@ -76,9 +76,7 @@ static void *twoxsai_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    return filt;
 }
@@ -212,10 +210,14 @@ static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned above    = first;
 
-   for (; height; height--)
+   for (; height; height--, above++)
    {
+      /* Pixels are sampled from one row above to two rows below,
+       * so stay on the current row near the edges of the frame */
+      unsigned nextline = (above >= 1 && height - 1 + last >= 2)
+         ? src_stride : 0;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
@@ -244,10 +246,14 @@ static void twoxsai_generic_rgb565(unsigned width, unsigned height,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned above    = first;
 
-   for (; height; height--)
+   for (; height; height--, above++)
    {
+      /* Pixels are sampled from one row above to two rows below,
+       * so stay on the current row near the edges of the frame */
+      unsigned nextline = (above >= 1 && height - 1 + last >= 2)
+         ? src_stride : 0;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
@@ -326,11 +332,11 @@ static void twoxsai_generic_packets(void *data,
       thr->width             = width;
       thr->height            = y_end - y_start;
 
-      /* Workers need to know if they can access pixels
-       * outside their given buffer.
+      /* Workers need to know how many rows outside
+       * their given buffer they can access.
        */
       thr->first             = y_start;
-      thr->last              = y_end == height;
+      thr->last              = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work     = twoxsai_work_cb_rgb565;
@@ -15,11 +15,10 @@
  */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 
-#include <retro_endianness.h>
-
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation epx_get_implementation
 #define softfilter_thread_data epx_softfilter_thread_data
@@ -46,6 +45,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   int simd;
 };
 
 static unsigned epx_generic_input_fmts(void)
@@ -79,8 +79,9 @@ static void *epx_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   filt->threads            = 1;
+   filt->threads            = threads;
    filt->in_fmt             = in_fmt;
+   filt->simd               = (simd & SOFTFILTER_ROW_SIMD) != 0;
    return filt;
 }
 
@@ -103,86 +104,21 @@ static void epx_generic_destroy(void *data)
    free(filt);
 }
 
-static void epx_generic_rgb565 (unsigned width, unsigned height,
-      int first, int lsat, uint16_t *src,
-      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+/* EPX is the same expansion as Scale2x, so it shares its row kernel */
+static void epx_generic_rgb565(unsigned width, unsigned height,
+      int first, int last, uint16_t *src,
+      unsigned src_stride, uint16_t *dst, unsigned dst_stride, int simd)
 {
-   uint16_t colorA;
-   int w;
+   unsigned y;
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint16_t *sP    = (uint16_t *) src;
-      uint16_t *uP    = (uint16_t *) (src - src_stride);
-      uint16_t *lP    = (uint16_t *) (src + src_stride);
-      uint32_t *dP1   = (uint32_t *) dst;
-      uint32_t *dP2   = (uint32_t *) (dst + dst_stride);
-
-      /* left edge */
-      uint16_t colorX = *sP;
-      uint16_t colorC = *++sP;
-      uint16_t colorB = *lP++;
-      uint16_t colorD = *uP++;
-
-      if ((colorX != colorC) && (colorB != colorD))
-      {
-#ifdef MSB_FIRST
-         *dP1 = (colorX << 16) + ((colorC == colorD) ? colorC : colorX);
-         *dP2 = (colorX << 16) + ((colorB == colorC) ? colorB : colorX);
-#else
-         *dP1 = colorX + (((colorC == colorD) ? colorC : colorX) << 16);
-         *dP2 = colorX + (((colorB == colorC) ? colorB : colorX) << 16);
-#endif
-      }
-      else
-         *dP1 = *dP2 = (colorX << 16) + colorX;
-
-      dP1++;
-      dP2++;
-
-      for (w = width - 2; w; w--)
-      {
-         colorA = colorX;
-         colorX = colorC;
-         colorC = *++sP;
-         colorB = *lP++;
-         colorD = *uP++;
+      /* Rows above/below, clamped at the frame edges */
+      const uint16_t *uP = (y > 0 || first) ? src - src_stride : src;
+      const uint16_t *lP = (y < height - 1 || last) ? src + src_stride : src;
 
-         if ((colorA != colorC) && (colorB != colorD))
-         {
-#ifdef MSB_FIRST
-           *dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + ((colorC == colorD) ? colorC : colorX);
-           *dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + ((colorB == colorC) ? colorB : colorX);
-#else
-           *dP1 = ((colorD == colorA) ? colorD : colorX) + (((colorC == colorD) ? colorC : colorX) << 16);
-           *dP2 = ((colorA == colorB) ? colorA : colorX) + (((colorB == colorC) ? colorB : colorX) << 16);
-#endif
-         }
-         else
-            *dP1 = *dP2 = (colorX << 16) + colorX;
-
-         dP1++;
-         dP2++;
-      }
-
-      /* right edge */
-      colorA = colorX;
-      colorX = colorC;
-      colorB = *lP;
-      colorD = *uP;
-
-      if ((colorA != colorX) && (colorB != colorD))
-      {
-#ifdef MSB_FIRST
-         *dP1 = (((colorD == colorA) ? colorD : colorX) << 16) + colorX;
-         *dP2 = (((colorA == colorB) ? colorA : colorX) << 16) + colorX;
-#else
-         *dP1 = ((colorD == colorA) ? colorD : colorX) + (colorX << 16);
-         *dP2 = ((colorA == colorB) ? colorA : colorX) + (colorX << 16);
-#endif
-      }
-      else
-         *dP1 = *dP2 = (colorX << 16) + colorX;
+      softfilter_scale2x_row_rgb565(dst, dst + dst_stride,
+            uP, src, lP, width, simd);
 
       src += src_stride;
       dst += dst_stride << 1;
@@ -191,6 +127,7 @@ static void epx_generic_rgb565 (unsigned width, unsigned height,
 
 static void epx_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint16_t *input  = (uint16_t*)thr->in_data;
@@ -202,7 +139,7 @@ static void epx_work_cb_rgb565(void *data, void *thread_data)
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
+         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565), filt->simd);
 }
 
 static void epx_generic_packets(void *data,
@@ -227,10 +164,10 @@ static void epx_generic_packets(void *data,
       thr->width         = width;
       thr->height        = y_end - y_start;
 
-      /* Workers need to know if they can
-       * access pixels outside their given buffer. */
+      /* Workers need to know how many rows outside
+       * their given buffer they can access. */
       thr->first         = y_start;
-      thr->last          = y_end == height;
+      thr->last          = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = epx_work_cb_rgb565;
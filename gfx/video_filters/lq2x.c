@@ -75,9 +75,7 @@ static void *lq2x_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    return filt;
 }
@@ -111,8 +109,9 @@ static void lq2x_generic_rgb565(unsigned width, unsigned height,
 
    for (y = 0; y < height; y++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
+      /* Clamp to the current line at the edges of the frame */
+      int prevline = (y == 0 && !first) ? 0 : src_stride;
+      int nextline = (y == height - 1 && !last) ? 0 : src_stride;
 
       for (x = 0; x < width; x++)
       {
@@ -155,8 +154,9 @@ static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
 
    for (y = 0; y < height; y++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
+      /* Clamp to the current line at the edges of the frame */
+      int prevline = (y == 0 && !first) ? 0 : src_stride;
+      int nextline = (y == height - 1 && !last) ? 0 : src_stride;
 
       for (x = 0; x < width; x++)
       {
@@ -240,10 +240,10 @@ static void lq2x_generic_packets(void *data,
       thr->width             = width;
       thr->height            = y_end - y_start;
 
-      /* Workers need to know if they can access pixels
-       * outside their given buffer. */
+      /* Workers need to know how many rows outside
+       * their given buffer they can access. */
       thr->first             = y_start;
-      thr->last              = y_end == height;
+      thr->last              = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work     = lq2x_work_cb_rgb565;
@@ -17,6 +17,7 @@
 /* Compile: gcc -o normal2x_width.so -shared normal2x_width.c -std=c99 -O3 -Wall -pedantic -fPIC */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -44,6 +45,7 @@ struct filter_data
    struct softfilter_thread_data *workers;
    unsigned threads;
    unsigned in_fmt;
+   int simd;
 };
 
 static unsigned normal2x_width_generic_input_fmts(void)
@@ -70,15 +72,14 @@ static void *normal2x_width_generic_create(const struct softfilter_config *confi
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
    if (!filt)
       return NULL;
-   if (!(filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data))))
+   if (!(filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data))))
    {
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->simd    = (simd & SOFTFILTER_ROW_SIMD) != 0;
    return filt;
 }
 
@@ -101,27 +102,18 @@ static void normal2x_width_generic_destroy(void *data)
 
 static void normal2x_width_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    const uint32_t *input              = (const uint32_t*)thr->in_data;
    uint32_t *output                   = (uint32_t*)thr->out_data;
    uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
    uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
-   uint32_t x, y;
+   uint32_t y;
 
    for (y = 0; y < thr->height; ++y)
    {
-      uint32_t *out_ptr = output;
-      for (x = 0; x < thr->width; ++x)
-      {
-         uint32_t *out_line_ptr = out_ptr;
-         uint32_t color         = *(input + x);
-
-         /* Duplicate pixels in the x direction */
-         *out_line_ptr       = color;
-         *(out_line_ptr + 1) = color;
-
-         out_ptr += 2;
-      }
+      /* Duplicate pixels in the x direction */
+      softfilter_upscale_row_xrgb8888(output, input, thr->width, 2, filt->simd);
 
       input  += in_stride;
       output += out_stride;
@@ -130,27 +122,18 @@ static void normal2x_width_work_cb_xrgb8888(void *data, void *thread_data)
 
 static void normal2x_width_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    const uint16_t *input              = (const uint16_t*)thr->in_data;
    uint16_t *output                   = (uint16_t*)thr->out_data;
-   uint16_t in_stride                 = (uint16_t)(thr->in_pitch >> 1);
-   uint16_t out_stride                = (uint16_t)(thr->out_pitch >> 1);
-   uint16_t x, y;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
+   uint32_t y;
 
    for (y = 0; y < thr->height; ++y)
    {
-      uint16_t *out_ptr = output;
-      for (x = 0; x < thr->width; ++x)
-      {
-         uint16_t *out_line_ptr = out_ptr;
-         uint16_t color         = *(input + x);
-
-         /* Duplicate pixels in the x direction */
-         *out_line_ptr       = color;
-         *(out_line_ptr + 1) = color;
-
-         out_ptr += 2;
-      }
+      /* Duplicate pixels in the x direction */
+      softfilter_upscale_row_rgb565(output, input, thr->width, 2, filt->simd);
 
       input  += in_stride;
       output += out_stride;
@@ -162,26 +145,29 @@ static void normal2x_width_generic_packets(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   /* We are guaranteed single threaded operation
-    * (filt->threads = 1) so we don't need to loop
-    * over threads and can cull some code. This only
-    * makes the tiniest performance difference, but
-    * every little helps when running on an o3DS... */
-   struct filter_data *filt           = (struct filter_data*)data;
-   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[0];
-
-   thr->out_data                      = (uint8_t*)output;
-   thr->in_data                       = (const uint8_t*)input;
-   thr->out_pitch                     = output_stride;
-   thr->in_pitch                      = input_stride;
-   thr->width                         = width;
-   thr->height                        = height;
-
-   if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-      packets[0].work                 = normal2x_width_work_cb_xrgb8888;
-   else if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-      packets[0].work                 = normal2x_width_work_cb_rgb565;
-   packets[0].thread_data             = thr;
+   unsigned i;
+   struct filter_data *filt = (struct filter_data*)data;
+
+   for (i = 0; i < filt->threads; i++)
+   {
+      struct softfilter_thread_data *thr =
+         (struct softfilter_thread_data*)&filt->workers[i];
+      unsigned y_start     = (height * i) / filt->threads;
+      unsigned y_end       = (height * (i + 1)) / filt->threads;
+
+      thr->out_data        = (uint8_t*)output + y_start * output_stride;
+      thr->in_data         = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch       = output_stride;
+      thr->in_pitch        = input_stride;
+      thr->width           = width;
+      thr->height          = y_end - y_start;
+
+      if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
+         packets[i].work   = normal2x_width_work_cb_xrgb8888;
+      else if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
+         packets[i].work   = normal2x_width_work_cb_rgb565;
+      packets[i].thread_data = thr;
+   }
 }
 
 static const struct softfilter_implementation normal2x_width_generic = {
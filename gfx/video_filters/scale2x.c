@@ -17,6 +17,7 @@
 /* Compile: gcc -o scale2x.so -shared scale2x.c -std=c99 -O3 -Wall -pedantic -fPIC */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -44,6 +45,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   int simd;
 };
 
 static unsigned scale2x_generic_input_fmts(void)
@@ -70,15 +72,14 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
    if (!filt)
       return NULL;
-   if (!(filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data))))
+   if (!(filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data))))
    {
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->simd    = (simd & SOFTFILTER_ROW_SIMD) != 0;
    return filt;
 }
 
@@ -101,97 +102,51 @@ static void scale2x_generic_destroy(void *data)
 
 static void scale2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   const uint32_t *input              = (const uint32_t*)thr->in_data;
+   uint32_t *output                   = (uint32_t*)thr->out_data;
    uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
    uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
-   const uint32_t *input              = (const uint32_t*)thr->in_data;
-   uint32_t *output0                  = (uint32_t*)thr->out_data;
-   uint32_t *output1                  = (uint32_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   uint32_t y;
 
    for (y = 0; y < thr->height; y++)
    {
-      /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
-
-      for (x = 0; x < thr->width; x++)
-      {
-         /* Get sample points */
-         uint32_t A = *(input - line_prev);
-         uint32_t B = (x > 0) ? *(input - 1) : *input;
-         uint32_t C = *input;
-         uint32_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint32_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
-      }
-
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      /* Previous/next source lines, clamped at the frame edges */
+      const uint32_t *prev = (y > 0 || thr->first) ? input - in_stride : input;
+      const uint32_t *next = (y < thr->height - 1 || thr->last)
+         ? input + in_stride : input;
+
+      softfilter_scale2x_row_xrgb8888(output, output + out_stride,
+            prev, input, next, thr->width, filt->simd);
+
+      input  += in_stride;
+      output += out_stride << 1;
    }
 }
 
 static void scale2x_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   const uint16_t *input              = (const uint16_t*)thr->in_data;
+   uint16_t *output                   = (uint16_t*)thr->out_data;
    uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
    uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
-   const uint16_t *input              = (const uint16_t*)thr->in_data;
-   uint16_t *output0                  = (uint16_t*)thr->out_data;
-   uint16_t *output1                  = (uint16_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   uint32_t y;
 
    for (y = 0; y < thr->height; y++)
    {
-      /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
-
-      for (x = 0; x < thr->width; x++)
-      {
-         /* Get sample points */
-         uint16_t A = *(input - line_prev);
-         uint16_t B = (x > 0) ? *(input - 1) : *input;
-         uint16_t C = *input;
-         uint16_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint16_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
-      }
-
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      /* Previous/next source lines, clamped at the frame edges */
+      const uint16_t *prev = (y > 0 || thr->first) ? input - in_stride : input;
+      const uint16_t *next = (y < thr->height - 1 || thr->last)
+         ? input + in_stride : input;
+
+      softfilter_scale2x_row_rgb565(output, output + out_stride,
+            prev, input, next, thr->width, filt->simd);
+
+      input  += in_stride;
+      output += out_stride << 1;
    }
 }
 
@@ -200,26 +155,34 @@ static void scale2x_generic_packets(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   /* We are guaranteed single threaded operation
-    * (filt->threads = 1) so we don't need to loop
-    * over threads and can cull some code. This only
-    * makes the tiniest performance difference, but
-    * every little helps when running on an o3DS... */
-   struct filter_data *filt           = (struct filter_data*)data;
-   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[0];
-
-   thr->out_data                      = (uint8_t*)output;
-   thr->in_data                       = (const uint8_t*)input;
-   thr->out_pitch                     = output_stride;
-   thr->in_pitch                      = input_stride;
-   thr->width                         = width;
-   thr->height                        = height;
-
-   if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-      packets[0].work                 = scale2x_work_cb_xrgb8888;
-   else if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-      packets[0].work                 = scale2x_work_cb_rgb565;
-   packets[0].thread_data             = thr;
+   unsigned i;
+   struct filter_data *filt = (struct filter_data*)data;
+
+   for (i = 0; i < filt->threads; i++)
+   {
+      struct softfilter_thread_data *thr =
+         (struct softfilter_thread_data*)&filt->workers[i];
+      unsigned y_start     = (height * i) / filt->threads;
+      unsigned y_end       = (height * (i + 1)) / filt->threads;
+
+      thr->out_data        = (uint8_t*)output + y_start * 2 * output_stride;
+      thr->in_data         = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch       = output_stride;
+      thr->in_pitch        = input_stride;
+      thr->width           = width;
+      thr->height          = y_end - y_start;
+
+      /* Workers need to know how many rows outside
+       * their given buffer they can access. */
+      thr->first           = y_start;
+      thr->last            = height - y_end;
+
+      if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
+         packets[i].work   = scale2x_work_cb_xrgb8888;
+      else if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
+         packets[i].work   = scale2x_work_cb_rgb565;
+      packets[i].thread_data = thr;
+   }
 }
 
 static const struct softfilter_implementation scale2x_generic = {
@@ -132,7 +132,12 @@ struct softfilter_work_packet
  * maximum possible input size.
  *
  * Input sizes can very per call to softfilter_process_t, but they
- * will never be larger than the maximum. */
+ * will never be larger than the maximum.
+ *
+ * 'threads' is the maximum number of work packets to split a frame
+ * into. The host asks for several packets per worker thread and
+ * hands them out to whichever worker is free, so packets must not
+ * depend on the order they run in or on how many there are. */
 typedef void *(*softfilter_create_t)(const struct softfilter_config *config,
       unsigned in_fmt, unsigned out_fmt,
       unsigned max_width, unsigned max_height,
@@ -158,9 +163,9 @@ typedef void (*softfilter_get_work_packets_t)(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride);
 
-/* Returns the number of worker threads the filter will use.
+/* Returns the number of work packets the filter will submit per frame.
  * This can differ from the value passed to create() instead the filter
- * cannot be parallelized, etc. The number of threads must be less-or-equal
+ * cannot be parallelized, etc. The number of packets must be less-or-equal
  * compared to the value passed to create(). */
 typedef unsigned (*softfilter_query_num_threads_t)(void *data);
 
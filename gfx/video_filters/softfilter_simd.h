@@ -0,0 +1,551 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2018 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Row kernels shared by the pixel-replicating softfilters
+ * (NormalNx, Scanline2x, Scale2x/EPX).
+ *
+ * Every kernel works on a single source row, so filters can
+ * split a frame into as many strips as they like. The vector
+ * paths produce the exact same output as the scalar ones and
+ * are only taken when 'simd' is non-zero, which a filter should
+ * derive from SOFTFILTER_ROW_SIMD and the mask passed to create(). */
+
+#ifndef SOFTFILTER_SIMD_H__
+#define SOFTFILTER_SIMD_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#include <retro_inline.h>
+
+#include "softfilter.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFTFILTER_ROW_SIMD SOFTFILTER_SIMD_SSE2
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+#include <arm_neon.h>
+#define SOFTFILTER_ROW_SIMD SOFTFILTER_SIMD_NEON
+#else
+#define SOFTFILTER_ROW_SIMD 0
+#endif
+
+/* Horizontal pixel replication: writes width * scale pixels */
+static INLINE void softfilter_upscale_row_xrgb8888(uint32_t *dst,
+      const uint32_t *src, unsigned width, unsigned scale, int simd)
+{
+   unsigned x = 0;
+   unsigned i;
+
+#if defined(__SSE2__)
+   if (simd && scale == 2)
+   {
+      for (; x + 4 <= width; x += 4)
+      {
+         __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+         _mm_storeu_si128((__m128i*)(dst + 2 * x),     _mm_unpacklo_epi32(v, v));
+         _mm_storeu_si128((__m128i*)(dst + 2 * x + 4), _mm_unpackhi_epi32(v, v));
+      }
+   }
+   else if (simd && scale == 4)
+   {
+      for (; x + 4 <= width; x += 4)
+      {
+         __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+         _mm_storeu_si128((__m128i*)(dst + 4 * x),      _mm_shuffle_epi32(v, 0x00));
+         _mm_storeu_si128((__m128i*)(dst + 4 * x + 4),  _mm_shuffle_epi32(v, 0x55));
+         _mm_storeu_si128((__m128i*)(dst + 4 * x + 8),  _mm_shuffle_epi32(v, 0xAA));
+         _mm_storeu_si128((__m128i*)(dst + 4 * x + 12), _mm_shuffle_epi32(v, 0xFF));
+      }
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd && scale == 2)
+   {
+      for (; x + 4 <= width; x += 4)
+      {
+         uint32x4_t v   = vld1q_u32(src + x);
+         uint32x4x2_t z = vzipq_u32(v, v);
+         vst1q_u32(dst + 2 * x,     z.val[0]);
+         vst1q_u32(dst + 2 * x + 4, z.val[1]);
+      }
+   }
+   else if (simd && scale == 4)
+   {
+      for (; x + 4 <= width; x += 4)
+      {
+         uint32x4_t v    = vld1q_u32(src + x);
+         uint32x4x2_t z  = vzipq_u32(v, v);
+         uint32x4x2_t lo = vzipq_u32(z.val[0], z.val[0]);
+         uint32x4x2_t hi = vzipq_u32(z.val[1], z.val[1]);
+         vst1q_u32(dst + 4 * x,      lo.val[0]);
+         vst1q_u32(dst + 4 * x + 4,  lo.val[1]);
+         vst1q_u32(dst + 4 * x + 8,  hi.val[0]);
+         vst1q_u32(dst + 4 * x + 12, hi.val[1]);
+      }
+   }
+#endif
+
+   if (scale == 2)
+   {
+      for (; x < width; x++)
+      {
+         uint32_t color = src[x];
+         dst[2 * x]     = color;
+         dst[2 * x + 1] = color;
+      }
+   }
+   else if (scale == 4)
+   {
+      for (; x < width; x++)
+      {
+         uint32_t color = src[x];
+         dst[4 * x]     = color;
+         dst[4 * x + 1] = color;
+         dst[4 * x + 2] = color;
+         dst[4 * x + 3] = color;
+      }
+   }
+   else
+   {
+      for (; x < width; x++)
+      {
+         uint32_t color = src[x];
+         for (i = 0; i < scale; i++)
+            dst[x * scale + i] = color;
+      }
+   }
+}
+
+static INLINE void softfilter_upscale_row_rgb565(uint16_t *dst,
+      const uint16_t *src, unsigned width, unsigned scale, int simd)
+{
+   unsigned x = 0;
+   unsigned i;
+
+#if defined(__SSE2__)
+   if (simd && scale == 2)
+   {
+      for (; x + 8 <= width; x += 8)
+      {
+         __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+         _mm_storeu_si128((__m128i*)(dst + 2 * x),     _mm_unpacklo_epi16(v, v));
+         _mm_storeu_si128((__m128i*)(dst + 2 * x + 8), _mm_unpackhi_epi16(v, v));
+      }
+   }
+   else if (simd && scale == 4)
+   {
+      for (; x + 8 <= width; x += 8)
+      {
+         __m128i v  = _mm_loadu_si128((const __m128i*)(src + x));
+         __m128i lo = _mm_unpacklo_epi16(v, v);
+         __m128i hi = _mm_unpackhi_epi16(v, v);
+         _mm_storeu_si128((__m128i*)(dst + 4 * x),      _mm_unpacklo_epi32(lo, lo));
+         _mm_storeu_si128((__m128i*)(dst + 4 * x + 8),  _mm_unpackhi_epi32(lo, lo));
+         _mm_storeu_si128((__m128i*)(dst + 4 * x + 16), _mm_unpacklo_epi32(hi, hi));
+         _mm_storeu_si128((__m128i*)(dst + 4 * x + 24), _mm_unpackhi_epi32(hi, hi));
+      }
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd && scale == 2)
+   {
+      for (; x + 8 <= width; x += 8)
+      {
+         uint16x8_t v   = vld1q_u16(src + x);
+         uint16x8x2_t z = vzipq_u16(v, v);
+         vst1q_u16(dst + 2 * x,     z.val[0]);
+         vst1q_u16(dst + 2 * x + 8, z.val[1]);
+      }
+   }
+   else if (simd && scale == 4)
+   {
+      for (; x + 8 <= width; x += 8)
+      {
+         uint16x8_t v    = vld1q_u16(src + x);
+         uint16x8x2_t z  = vzipq_u16(v, v);
+         uint16x8x2_t lo = vzipq_u16(z.val[0], z.val[0]);
+         uint16x8x2_t hi = vzipq_u16(z.val[1], z.val[1]);
+         vst1q_u16(dst + 4 * x,      lo.val[0]);
+         vst1q_u16(dst + 4 * x + 8,  lo.val[1]);
+         vst1q_u16(dst + 4 * x + 16, hi.val[0]);
+         vst1q_u16(dst + 4 * x + 24, hi.val[1]);
+      }
+   }
+#endif
+
+   if (scale == 2)
+   {
+      for (; x < width; x++)
+      {
+         uint16_t color = src[x];
+         dst[2 * x]     = color;
+         dst[2 * x + 1] = color;
+      }
+   }
+   else if (scale == 4)
+   {
+      for (; x < width; x++)
+      {
+         uint16_t color = src[x];
+         dst[4 * x]     = color;
+         dst[4 * x + 1] = color;
+         dst[4 * x + 2] = color;
+         dst[4 * x + 3] = color;
+      }
+   }
+   else
+   {
+      for (; x < width; x++)
+      {
+         uint16_t color = src[x];
+         for (i = 0; i < scale; i++)
+            dst[x * scale + i] = color;
+      }
+   }
+}
+
+/* Scanline colour is color * 0.75
+ * > First pass: 50:50 mix of color:0
+ * > Second pass: 50:50 mix of color:(color:0)
+ *   => Gives ((1 + 0.5) / 2) = 0.75
+ *
+ * c.f "Mixing Packed RGB Pixels Efficiently"
+ * http://blargg.8bitalley.com/info/rgb_mixing.html
+ *
+ * Like the upscale kernels, writes width * 2 pixels */
+static INLINE void softfilter_scanline_row_xrgb8888(uint32_t *dst,
+      const uint32_t *src, unsigned width, int simd)
+{
+   unsigned x = 0;
+
+#if defined(__SSE2__)
+   if (simd)
+   {
+      const __m128i mask = _mm_set1_epi32(0x1010101);
+      for (; x + 4 <= width; x += 4)
+      {
+         __m128i c = _mm_loadu_si128((const __m128i*)(src + x));
+         __m128i s = _mm_srli_epi32(
+               _mm_add_epi32(c, _mm_and_si128(c, mask)), 1);
+         s         = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(c, s),
+                  _mm_and_si128(_mm_xor_si128(c, s), mask)), 1);
+         _mm_storeu_si128((__m128i*)(dst + 2 * x),     _mm_unpacklo_epi32(s, s));
+         _mm_storeu_si128((__m128i*)(dst + 2 * x + 4), _mm_unpackhi_epi32(s, s));
+      }
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd)
+   {
+      const uint32x4_t mask = vdupq_n_u32(0x1010101);
+      for (; x + 4 <= width; x += 4)
+      {
+         uint32x4_t c = vld1q_u32(src + x);
+         uint32x4_t s = vshrq_n_u32(vaddq_u32(c, vandq_u32(c, mask)), 1);
+         uint32x4x2_t z;
+         s            = vshrq_n_u32(vaddq_u32(vaddq_u32(c, s),
+                  vandq_u32(veorq_u32(c, s), mask)), 1);
+         z            = vzipq_u32(s, s);
+         vst1q_u32(dst + 2 * x,     z.val[0]);
+         vst1q_u32(dst + 2 * x + 4, z.val[1]);
+      }
+   }
+#endif
+
+   for (; x < width; x++)
+   {
+      uint32_t color          = src[x];
+      uint32_t scanline_color = (color + (color & 0x1010101)) >> 1;
+      scanline_color          = (color + scanline_color +
+            ((color ^ scanline_color) & 0x1010101)) >> 1;
+      dst[2 * x]              = scanline_color;
+      dst[2 * x + 1]          = scanline_color;
+   }
+}
+
+static INLINE void softfilter_scanline_row_rgb565(uint16_t *dst,
+      const uint16_t *src, unsigned width, int simd)
+{
+   unsigned x = 0;
+
+   /* The scalar version does its sums in int, so the vector
+    * versions widen to 32-bit lanes to keep the carry bit */
+#if defined(__SSE2__)
+   if (simd)
+   {
+      const __m128i mask = _mm_set1_epi32(0x821);
+      const __m128i zero = _mm_setzero_si128();
+      for (; x + 8 <= width; x += 8)
+      {
+         unsigned half;
+         __m128i out[2];
+         __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+         for (half = 0; half < 2; half++)
+         {
+            __m128i c = half ? _mm_unpackhi_epi16(v, zero)
+                             : _mm_unpacklo_epi16(v, zero);
+            __m128i s = _mm_srli_epi32(
+                  _mm_add_epi32(c, _mm_and_si128(c, mask)), 1);
+            s         = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(c, s),
+                     _mm_and_si128(_mm_xor_si128(c, s), mask)), 1);
+            /* Sign-extend so the signed pack below is lossless */
+            out[half] = _mm_srai_epi32(_mm_slli_epi32(s, 16), 16);
+         }
+         v = _mm_packs_epi32(out[0], out[1]);
+         _mm_storeu_si128((__m128i*)(dst + 2 * x),     _mm_unpacklo_epi16(v, v));
+         _mm_storeu_si128((__m128i*)(dst + 2 * x + 8), _mm_unpackhi_epi16(v, v));
+      }
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd)
+   {
+      const uint32x4_t mask = vdupq_n_u32(0x821);
+      for (; x + 8 <= width; x += 8)
+      {
+         unsigned half;
+         uint16x8x2_t z;
+         uint16x4_t out[2];
+         uint16x8_t v = vld1q_u16(src + x);
+         for (half = 0; half < 2; half++)
+         {
+            uint32x4_t c = vmovl_u16(half ? vget_high_u16(v) : vget_low_u16(v));
+            uint32x4_t s = vshrq_n_u32(vaddq_u32(c, vandq_u32(c, mask)), 1);
+            s            = vshrq_n_u32(vaddq_u32(vaddq_u32(c, s),
+                     vandq_u32(veorq_u32(c, s), mask)), 1);
+            out[half]    = vmovn_u32(s);
+         }
+         v = vcombine_u16(out[0], out[1]);
+         z = vzipq_u16(v, v);
+         vst1q_u16(dst + 2 * x,     z.val[0]);
+         vst1q_u16(dst + 2 * x + 8, z.val[1]);
+      }
+   }
+#endif
+
+   for (; x < width; x++)
+   {
+      uint16_t color          = src[x];
+      uint16_t scanline_color = (color + (color & 0x821)) >> 1;
+      scanline_color          = (color + scanline_color +
+            ((color ^ scanline_color) & 0x821)) >> 1;
+      dst[2 * x]              = scanline_color;
+      dst[2 * x + 1]          = scanline_color;
+   }
+}
+
+/* Scale2x (a.k.a. EPX) expansion of one source row into two
+ * output rows. 'prev' and 'next' are the source rows above and
+ * below 'cur' - pass 'cur' itself for either at the frame edge.
+ *
+ * Map of the pixels:  A
+ *                   B C D
+ *                     E
+ */
+static INLINE void softfilter_scale2x_pixel_xrgb8888(
+      uint32_t *out0, uint32_t *out1,
+      uint32_t A, uint32_t B, uint32_t C, uint32_t D, uint32_t E)
+{
+   if (A != E && B != D)
+   {
+      out0[0] = (A == B ? A : C);
+      out0[1] = (A == D ? A : C);
+      out1[0] = (E == B ? E : C);
+      out1[1] = (E == D ? E : C);
+   }
+   else
+   {
+      out0[0] = C;
+      out0[1] = C;
+      out1[0] = C;
+      out1[1] = C;
+   }
+}
+
+static INLINE void softfilter_scale2x_pixel_rgb565(
+      uint16_t *out0, uint16_t *out1,
+      uint16_t A, uint16_t B, uint16_t C, uint16_t D, uint16_t E)
+{
+   if (A != E && B != D)
+   {
+      out0[0] = (A == B ? A : C);
+      out0[1] = (A == D ? A : C);
+      out1[0] = (E == B ? E : C);
+      out1[1] = (E == D ? E : C);
+   }
+   else
+   {
+      out0[0] = C;
+      out0[1] = C;
+      out1[0] = C;
+      out1[1] = C;
+   }
+}
+
+static INLINE void softfilter_scale2x_row_xrgb8888(
+      uint32_t *out0, uint32_t *out1,
+      const uint32_t *prev, const uint32_t *cur, const uint32_t *next,
+      unsigned width, int simd)
+{
+   unsigned x;
+
+   if (!width)
+      return;
+
+   /* Left edge */
+   softfilter_scale2x_pixel_xrgb8888(out0, out1, prev[0], cur[0], cur[0],
+         (width > 1) ? cur[1] : cur[0], next[0]);
+   if (width == 1)
+      return;
+
+   x = 1;
+#if defined(__SSE2__)
+   if (simd)
+   {
+      for (; x + 5 <= width; x += 4)
+      {
+         __m128i a     = _mm_loadu_si128((const __m128i*)(prev + x));
+         __m128i b     = _mm_loadu_si128((const __m128i*)(cur  + x - 1));
+         __m128i c     = _mm_loadu_si128((const __m128i*)(cur  + x));
+         __m128i d     = _mm_loadu_si128((const __m128i*)(cur  + x + 1));
+         __m128i e     = _mm_loadu_si128((const __m128i*)(next + x));
+         __m128i cond  = _mm_andnot_si128(
+               _mm_or_si128(_mm_cmpeq_epi32(a, e), _mm_cmpeq_epi32(b, d)),
+               _mm_cmpeq_epi32(c, c));
+         __m128i p0    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi32(a, b)), _mm_xor_si128(a, c)));
+         __m128i p1    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi32(a, d)), _mm_xor_si128(a, c)));
+         __m128i p2    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi32(e, b)), _mm_xor_si128(e, c)));
+         __m128i p3    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi32(e, d)), _mm_xor_si128(e, c)));
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x),     _mm_unpacklo_epi32(p0, p1));
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x + 4), _mm_unpackhi_epi32(p0, p1));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x),     _mm_unpacklo_epi32(p2, p3));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x + 4), _mm_unpackhi_epi32(p2, p3));
+      }
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd)
+   {
+      for (; x + 5 <= width; x += 4)
+      {
+         uint32x4_t a    = vld1q_u32(prev + x);
+         uint32x4_t b    = vld1q_u32(cur  + x - 1);
+         uint32x4_t c    = vld1q_u32(cur  + x);
+         uint32x4_t d    = vld1q_u32(cur  + x + 1);
+         uint32x4_t e    = vld1q_u32(next + x);
+         uint32x4_t cond = vmvnq_u32(vorrq_u32(vceqq_u32(a, e), vceqq_u32(b, d)));
+         uint32x4x2_t r0 = vzipq_u32(
+               vbslq_u32(vandq_u32(cond, vceqq_u32(a, b)), a, c),
+               vbslq_u32(vandq_u32(cond, vceqq_u32(a, d)), a, c));
+         uint32x4x2_t r1 = vzipq_u32(
+               vbslq_u32(vandq_u32(cond, vceqq_u32(e, b)), e, c),
+               vbslq_u32(vandq_u32(cond, vceqq_u32(e, d)), e, c));
+         vst1q_u32(out0 + 2 * x,     r0.val[0]);
+         vst1q_u32(out0 + 2 * x + 4, r0.val[1]);
+         vst1q_u32(out1 + 2 * x,     r1.val[0]);
+         vst1q_u32(out1 + 2 * x + 4, r1.val[1]);
+      }
+   }
+#endif
+
+   for (; x < width - 1; x++)
+      softfilter_scale2x_pixel_xrgb8888(out0 + 2 * x, out1 + 2 * x,
+            prev[x], cur[x - 1], cur[x], cur[x + 1], next[x]);
+
+   /* Right edge */
+   softfilter_scale2x_pixel_xrgb8888(out0 + 2 * x, out1 + 2 * x,
+         prev[x], cur[x - 1], cur[x], cur[x], next[x]);
+}
+
+static INLINE void softfilter_scale2x_row_rgb565(
+      uint16_t *out0, uint16_t *out1,
+      const uint16_t *prev, const uint16_t *cur, const uint16_t *next,
+      unsigned width, int simd)
+{
+   unsigned x;
+
+   if (!width)
+      return;
+
+   /* Left edge */
+   softfilter_scale2x_pixel_rgb565(out0, out1, prev[0], cur[0], cur[0],
+         (width > 1) ? cur[1] : cur[0], next[0]);
+   if (width == 1)
+      return;
+
+   x = 1;
+#if defined(__SSE2__)
+   if (simd)
+   {
+      for (; x + 9 <= width; x += 8)
+      {
+         __m128i a     = _mm_loadu_si128((const __m128i*)(prev + x));
+         __m128i b     = _mm_loadu_si128((const __m128i*)(cur  + x - 1));
+         __m128i c     = _mm_loadu_si128((const __m128i*)(cur  + x));
+         __m128i d     = _mm_loadu_si128((const __m128i*)(cur  + x + 1));
+         __m128i e     = _mm_loadu_si128((const __m128i*)(next + x));
+         __m128i cond  = _mm_andnot_si128(
+               _mm_or_si128(_mm_cmpeq_epi16(a, e), _mm_cmpeq_epi16(b, d)),
+               _mm_cmpeq_epi16(c, c));
+         __m128i p0    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi16(a, b)), _mm_xor_si128(a, c)));
+         __m128i p1    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi16(a, d)), _mm_xor_si128(a, c)));
+         __m128i p2    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi16(e, b)), _mm_xor_si128(e, c)));
+         __m128i p3    = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(cond,
+                     _mm_cmpeq_epi16(e, d)), _mm_xor_si128(e, c)));
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x),     _mm_unpacklo_epi16(p0, p1));
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x + 8), _mm_unpackhi_epi16(p0, p1));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x),     _mm_unpacklo_epi16(p2, p3));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x + 8), _mm_unpackhi_epi16(p2, p3));
+      }
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd)
+   {
+      for (; x + 9 <= width; x += 8)
+      {
+         uint16x8_t a    = vld1q_u16(prev + x);
+         uint16x8_t b    = vld1q_u16(cur  + x - 1);
+         uint16x8_t c    = vld1q_u16(cur  + x);
+         uint16x8_t d    = vld1q_u16(cur  + x + 1);
+         uint16x8_t e    = vld1q_u16(next + x);
+         uint16x8_t cond = vmvnq_u16(vorrq_u16(vceqq_u16(a, e), vceqq_u16(b, d)));
+         uint16x8x2_t r0 = vzipq_u16(
+               vbslq_u16(vandq_u16(cond, vceqq_u16(a, b)), a, c),
+               vbslq_u16(vandq_u16(cond, vceqq_u16(a, d)), a, c));
+         uint16x8x2_t r1 = vzipq_u16(
+               vbslq_u16(vandq_u16(cond, vceqq_u16(e, b)), e, c),
+               vbslq_u16(vandq_u16(cond, vceqq_u16(e, d)), e, c));
+         vst1q_u16(out0 + 2 * x,     r0.val[0]);
+         vst1q_u16(out0 + 2 * x + 8, r0.val[1]);
+         vst1q_u16(out1 + 2 * x,     r1.val[0]);
+         vst1q_u16(out1 + 2 * x + 8, r1.val[1]);
+      }
+   }
+#endif
+
+   for (; x < width - 1; x++)
+      softfilter_scale2x_pixel_rgb565(out0 + 2 * x, out1 + 2 * x,
+            prev[x], cur[x - 1], cur[x], cur[x + 1], next[x]);
+
+   /* Right edge */
+   softfilter_scale2x_pixel_rgb565(out0 + 2 * x, out1 + 2 * x,
+         prev[x], cur[x - 1], cur[x], cur[x], next[x]);
+}
+
+#endif
@@ -146,6 +146,10 @@ COMPRESSION
 #include "../libretro-common/streams/rzip_stream.c"
 #endif
 
+#ifdef HAVE_ZSTD
+#include "../libretro-common/streams/trans_stream_zstd.c"
+#endif
+
 /*============================================================
 ENCODINGS
 ============================================================ */
@@ -610,7 +614,11 @@ INPUT
 #include "../input/input_driver.c"
 #ifdef HAVE_BSV_MOVIE
 #include "../input/bsv/bsvmovie.c"
+#include "../input/bsv/bsvindex.c"
+#endif
+#ifdef HAVE_STATESTREAM
 #include "../input/bsv/uint32s_index.c"
+#include "../input/bsv/bsvcalibrate.c"
 #endif
 #include "../input/input_keymaps.c"
 #include "../tasks/task_autodetect.c"
@@ -802,6 +810,7 @@ AUDIO RESAMPLER
 ============================================================ */
 #include "../libretro-common/audio/resampler/audio_resampler.c"
 #include "../libretro-common/audio/resampler/drivers/sinc_resampler.c"
+#include "../libretro-common/audio/resampler/drivers/sinc_s16_resampler.c"
 #ifdef HAVE_NEAREST_RESAMPLER
 #include "../libretro-common/audio/resampler/drivers/nearest_resampler.c"
 #endif
@@ -1195,6 +1204,7 @@ RETROARCH
 ============================================================ */
 #include "../retroarch.c"
 #include "../runloop.c"
+#include "../performance_trace.c"
 #ifdef HAVE_RUNAHEAD
 #include "../runahead.c"
 #endif
@@ -1249,6 +1259,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/tpool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -1559,7 +1570,6 @@ XML
  LIBRETRODB
 ============================================================ */
 #ifdef HAVE_LIBRETRODB
-#include "../libretro-db/bintree.c"
 #include "../libretro-db/libretrodb.c"
 #include "../libretro-db/rmsgpack.c"
 #include "../libretro-db/rmsgpack_dom.c"
@@ -1693,7 +1703,6 @@ FFMPEG
 #ifdef HAVE_FFMPEG
 #include "../cores/libretro-ffmpeg/packet_buffer.c"
 #include "../cores/libretro-ffmpeg/video_buffer.c"
-#include "../libretro-common/rthreads/tpool.c"
 #endif
 
 /*============================================================
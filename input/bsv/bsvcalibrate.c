@@ -0,0 +1,262 @@
+/**
+ *  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with RetroArch. If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <file/config_file.h>
+#include <file/file_path.h>
+#include <string/stdstring.h>
+#include <features/features_cpu.h>
+
+#include "bsvcalibrate.h"
+#include "bsvmovie.h"
+#include "../../file_path_special.h"
+#include "../../verbosity.h"
+
+/* Checkpoints fed to every candidate.  The first one is made of new
+   blocks whatever the sizes, so it only primes the indices. */
+#define BSV_CALIBRATION_SAMPLES 6
+
+static const uint32_t bsv_calibration_block_sizes[]      = { 64, 256, 1024, 4096, 16384 };
+static const uint32_t bsv_calibration_superblock_sizes[] = { 4, 16, 64 };
+
+#define BSV_CALIBRATION_BLOCK_SIZES      ARRAY_SIZE(bsv_calibration_block_sizes)
+#define BSV_CALIBRATION_SUPERBLOCK_SIZES ARRAY_SIZE(bsv_calibration_superblock_sizes)
+#define BSV_CALIBRATION_CANDIDATES       (BSV_CALIBRATION_BLOCK_SIZES * BSV_CALIBRATION_SUPERBLOCK_SIZES)
+
+typedef struct bsv_calibration_trial
+{
+   /* Scratch movie holding just this candidate's indices */
+   bsv_movie_t *movie;
+   uint64_t bytes;
+   uint64_t micros;
+   uint32_t block_size;
+   uint32_t superblock_size;
+} bsv_calibration_trial_t;
+
+struct bsv_calibration
+{
+   bsv_calibration_trial_t trials[BSV_CALIBRATION_CANDIDATES];
+   char *path;
+   /* Every candidate sees the same states, so they share the previous
+      one and the output buffer */
+   uint8_t *last_save, *output;
+   size_t last_save_size, last_save_cap, output_cap;
+   unsigned samples;
+};
+
+bool bsv_calibration_path(char *s, size_t len, const char *core_name)
+{
+   char config_directory[DIR_MAX_LENGTH];
+   char core_directory[PATH_MAX_LENGTH];
+   if (string_is_empty(core_name))
+      return false;
+   fill_pathname_application_special(config_directory,
+         sizeof(config_directory), APPLICATION_SPECIAL_DIRECTORY_CONFIG);
+   fill_pathname_join_special(core_directory,
+         config_directory, core_name, sizeof(core_directory));
+   if (!path_is_directory(core_directory))
+      path_mkdir(core_directory);
+   fill_pathname_join_special_ext(s, config_directory, core_name,
+         core_name, BSV_CALIBRATION_EXTENSION, len);
+   return true;
+}
+
+bool bsv_calibration_load(const char *path, size_t state_size,
+      uint32_t *block_size, uint32_t *superblock_size)
+{
+   size_t saved_state_size   = 0;
+   unsigned block            = 0;
+   unsigned superblock       = 0;
+   bool ret                  = false;
+   config_file_t *conf       = path_is_valid(path)
+      ? config_file_new_from_path_to_string(path) : NULL;
+   if (!conf)
+      return false;
+   if (     config_get_size_t(conf, "statestream_state_size", &saved_state_size)
+         && config_get_uint(conf, "statestream_block_size", &block)
+         && config_get_uint(conf, "statestream_superblock_size", &superblock)
+         && saved_state_size == state_size
+         && block >= 4 && !(block & 3) && superblock > 0)
+   {
+      *block_size      = block;
+      *superblock_size = superblock;
+      ret              = true;
+   }
+   config_file_free(conf);
+   return ret;
+}
+
+static bool bsv_calibration_save(bsv_calibration_t *cal,
+      const bsv_calibration_trial_t *best, size_t state_size)
+{
+   bool ret;
+   config_file_t *conf = config_file_new_alloc();
+   if (!conf)
+      return false;
+   config_set_uint64(conf, "statestream_state_size", state_size);
+   config_set_uint(conf, "statestream_block_size", best->block_size);
+   config_set_uint(conf, "statestream_superblock_size", best->superblock_size);
+   ret = config_file_write(conf, cal->path, true);
+   config_file_free(conf);
+   return ret;
+}
+
+bsv_calibration_t *bsv_calibration_new(const char *path)
+{
+   size_t i, j;
+   bsv_calibration_t *cal = (bsv_calibration_t*)calloc(1, sizeof(*cal));
+   if (!cal)
+      return NULL;
+   if (!(cal->path = strdup(path)))
+      goto error;
+   for (i = 0; i < BSV_CALIBRATION_BLOCK_SIZES; i++)
+   {
+      for (j = 0; j < BSV_CALIBRATION_SUPERBLOCK_SIZES; j++)
+      {
+         bsv_calibration_trial_t *trial =
+            &cal->trials[i * BSV_CALIBRATION_SUPERBLOCK_SIZES + j];
+         trial->block_size      = bsv_calibration_block_sizes[i];
+         trial->superblock_size = bsv_calibration_superblock_sizes[j];
+         if (!(trial->movie = (bsv_movie_t*)calloc(1, sizeof(bsv_movie_t))))
+            goto error;
+      }
+   }
+   return cal;
+
+error:
+   bsv_calibration_free(cal);
+   return NULL;
+}
+
+void bsv_calibration_free(bsv_calibration_t *cal)
+{
+   size_t i;
+   if (!cal)
+      return;
+   for (i = 0; i < BSV_CALIBRATION_CANDIDATES; i++)
+   {
+      bsv_movie_t *movie = cal->trials[i].movie;
+      if (!movie)
+         continue;
+      uint32s_index_free(movie->blocks);
+      uint32s_index_free(movie->superblocks);
+      free(movie->superblock_seq);
+      free(movie);
+   }
+   free(cal->path);
+   free(cal->last_save);
+   free(cal->output);
+   free(cal);
+}
+
+bool bsv_calibration_sample(bsv_calibration_t *cal, bsv_movie_t *movie,
+      uint64_t frame, uint8_t *state, size_t state_size)
+{
+   size_t i;
+   double best_cost                     = 0.0;
+   const bsv_calibration_trial_t *best  = NULL;
+   size_t output_size                   = state_size + state_size / 2;
+   if (cal->output_cap < output_size)
+   {
+      uint8_t *output = (uint8_t*)realloc(cal->output, output_size);
+      if (!output)
+         return false;
+      cal->output     = output;
+      cal->output_cap = output_size;
+   }
+   for (i = 0; i < BSV_CALIBRATION_CANDIDATES; i++)
+   {
+      int64_t written;
+      retro_time_t start;
+      bsv_calibration_trial_t *trial = &cal->trials[i];
+      bsv_movie_t *scratch           = trial->movie;
+      if (!scratch->blocks)
+      {
+         scratch->blocks      = uint32s_index_new(trial->block_size / 4,
+               movie->commit_interval, movie->commit_threshold);
+         scratch->superblocks = uint32s_index_new(trial->superblock_size,
+               movie->commit_interval, movie->commit_threshold);
+      }
+      scratch->last_save      = cal->last_save;
+      scratch->last_save_size = cal->last_save_size;
+      scratch->cur_save_valid = cal->last_save_size == state_size;
+#ifdef HAVE_THREADS
+      scratch->encode_pool    = movie->encode_pool;
+      scratch->encode_threads = movie->encode_threads;
+#endif
+      start   = cpu_features_get_time_usec();
+      written = bsv_movie_write_deduped_state(scratch, frame,
+            state, state_size, cal->output, cal->output_cap);
+      if (cal->samples)
+      {
+         trial->bytes  += (uint64_t)MAX(written, 0);
+         trial->micros += cpu_features_get_time_usec() - start;
+      }
+#ifdef HAVE_THREADS
+      /* The scan may have started a pool; the movie keeps it */
+      if (!movie->encode_pool)
+      {
+         movie->encode_pool    = scratch->encode_pool;
+         movie->encode_threads = scratch->encode_threads;
+      }
+      scratch->encode_pool    = NULL;
+#endif
+      scratch->last_save      = NULL;
+      scratch->last_save_size = 0;
+   }
+
+   if (cal->last_save_cap < state_size)
+   {
+      uint8_t *last_save = (uint8_t*)realloc(cal->last_save, state_size);
+      if (!last_save)
+         return false;
+      cal->last_save     = last_save;
+      cal->last_save_cap = state_size;
+   }
+   memcpy(cal->last_save, state, state_size);
+   cal->last_save_size = state_size;
+
+   if (++cal->samples < BSV_CALIBRATION_SAMPLES)
+      return false;
+
+   /* Equal weight to relative changes in size and time, so halving
+      either one is worth the same */
+   for (i = 0; i < BSV_CALIBRATION_CANDIDATES; i++)
+   {
+      const bsv_calibration_trial_t *trial = &cal->trials[i];
+      double cost = (double)(trial->bytes + 1) * (double)(trial->micros + 1);
+      RARCH_DBG("[STATESTREAM] Calibration: block size %u, superblock size %u: "
+            "%llu bytes in %llu us.\n",
+            trial->block_size, trial->superblock_size,
+            (unsigned long long)trial->bytes,
+            (unsigned long long)trial->micros);
+      if (!best || cost < best_cost)
+      {
+         best      = trial;
+         best_cost = cost;
+      }
+   }
+   RARCH_LOG("[STATESTREAM] Calibrated block size %u, superblock size %u.\n",
+         best->block_size, best->superblock_size);
+   if (!bsv_calibration_save(cal, best, state_size))
+      RARCH_WARN("[STATESTREAM] Couldn't save calibration to \"%s\".\n",
+            cal->path);
+   return true;
+}
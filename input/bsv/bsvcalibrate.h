@@ -0,0 +1,56 @@
+/**
+ *  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with RetroArch. If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef __BSV_CALIBRATE__H
+#define __BSV_CALIBRATE__H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+#include <retro_common_api.h>
+
+/* Appended to the core name to name its saved block sizes */
+#define BSV_CALIBRATION_EXTENSION ".statestream"
+
+RETRO_BEGIN_DECLS
+
+struct bsv_movie;
+
+/* Encodes the first few checkpoints of a recording once per candidate
+   block/superblock size, then saves the best candidate for the core. */
+typedef struct bsv_calibration bsv_calibration_t;
+
+/* Fills in s with the file holding core_name's block sizes */
+bool bsv_calibration_path(char *s, size_t len, const char *core_name);
+
+/* Reads the sizes saved at path; fails if there are none or they were
+   calibrated for states of a different size. */
+bool bsv_calibration_load(const char *path, size_t state_size,
+      uint32_t *block_size, uint32_t *superblock_size);
+
+bsv_calibration_t *bsv_calibration_new(const char *path);
+void bsv_calibration_free(bsv_calibration_t *cal);
+
+/* Runs every candidate over one checkpoint's state.  movie lends its
+   encoder thread pool.  Returns true once enough checkpoints have been
+   seen and the result has been saved; cal can be freed then. */
+bool bsv_calibration_sample(bsv_calibration_t *cal, struct bsv_movie *movie,
+      uint64_t frame, uint8_t *state, size_t state_size);
+
+RETRO_END_DECLS
+
+#endif /* __BSV_CALIBRATE__H */
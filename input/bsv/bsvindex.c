@@ -0,0 +1,301 @@
+/**
+ *  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with RetroArch. If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_CONFIG_H
+#include "../../config.h"
+#endif
+
+#include <retro_endianness.h>
+#include <retro_miscellaneous.h>
+#include <streams/file_stream.h>
+
+/* Sidecars are only mapped on POSIX targets; everything else
+   (and any path the POSIX open() cannot reach) goes through VFS. */
+#if defined(HAVE_MMAP) && !defined(_WIN32) \
+   && (defined(__unix__) || defined(__APPLE__))
+#define BSV_INDEX_MMAP
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <memmap.h>
+#endif
+
+#include "bsvindex.h"
+#include "../../verbosity.h"
+
+/* Sidecar layout, all fields little-endian uint64:
+   magic and version (low and high half of the first word),
+   replay size, min_file_pos, replay identifier, frame count,
+   checkpoint count, then the two tables. */
+#define BSV_INDEX_MAGIC       0x49565342 /* "BSVI" */
+#define BSV_INDEX_VERSION     1
+#define BSV_INDEX_HEADER_LEN  6
+
+static void bsv_index_release_map(void *map, size_t len, bool mapped)
+{
+#ifdef BSV_INDEX_MMAP
+   if (mapped)
+   {
+      munmap(map, len);
+      return;
+   }
+#endif
+   free(map);
+}
+
+bsv_index_t *bsv_index_new(void)
+{
+   return (bsv_index_t*)calloc(1, sizeof(bsv_index_t));
+}
+
+/* Copies mapped tables to the heap so they can be modified */
+static bool bsv_index_unmap(bsv_index_t *index)
+{
+   uint64_t *frames      = NULL;
+   uint64_t *checkpoints = NULL;
+   if (!index->map)
+      return true;
+   frames      = (uint64_t*)malloc(MAX(index->frame_count, 1) * sizeof(uint64_t));
+   checkpoints = (uint64_t*)malloc(MAX(index->checkpoint_count, 1) * sizeof(uint64_t));
+   if (!frames || !checkpoints)
+   {
+      free(frames);
+      free(checkpoints);
+      return false;
+   }
+   memcpy(frames, index->frame_offsets,
+         index->frame_count * sizeof(uint64_t));
+   memcpy(checkpoints, index->checkpoint_frames,
+         index->checkpoint_count * sizeof(uint64_t));
+   bsv_index_release_map(index->map, index->map_size, index->mapped);
+   index->map               = NULL;
+   index->map_size          = 0;
+   index->mapped            = false;
+   index->frame_offsets     = frames;
+   index->checkpoint_frames = checkpoints;
+   index->frame_cap         = MAX(index->frame_count, 1);
+   index->checkpoint_cap    = MAX(index->checkpoint_count, 1);
+   return true;
+}
+
+void bsv_index_free(bsv_index_t *index)
+{
+   if (!index)
+      return;
+   if (index->map)
+      bsv_index_release_map(index->map, index->map_size, index->mapped);
+   else
+   {
+      free(index->frame_offsets);
+      free(index->checkpoint_frames);
+   }
+   free(index);
+}
+
+void bsv_index_clear(bsv_index_t *index)
+{
+   bsv_index_truncate(index, 0);
+}
+
+void bsv_index_truncate(bsv_index_t *index, uint64_t frames)
+{
+   if (frames >= index->frame_count)
+      return;
+   index->checkpoint_count = bsv_index_checkpoint_lower_bound(index, frames);
+   index->frame_count      = (size_t)frames;
+}
+
+bool bsv_index_set_frame(bsv_index_t *index, uint64_t frame,
+      uint64_t offset, bool checkpoint)
+{
+   if (frame > index->frame_count || !bsv_index_unmap(index))
+      return false;
+   bsv_index_truncate(index, frame);
+   if (index->frame_count == index->frame_cap)
+   {
+      size_t new_cap    = MAX(index->frame_cap * 2, 1024);
+      uint64_t *offsets = (uint64_t*)realloc(index->frame_offsets,
+            new_cap * sizeof(uint64_t));
+      if (!offsets)
+         return false;
+      index->frame_offsets = offsets;
+      index->frame_cap     = new_cap;
+   }
+   if (checkpoint && index->checkpoint_count == index->checkpoint_cap)
+   {
+      size_t new_cap    = MAX(index->checkpoint_cap * 2, 64);
+      uint64_t *frames  = (uint64_t*)realloc(index->checkpoint_frames,
+            new_cap * sizeof(uint64_t));
+      if (!frames)
+         return false;
+      index->checkpoint_frames = frames;
+      index->checkpoint_cap    = new_cap;
+   }
+   index->frame_offsets[index->frame_count++] = swap_if_big64(offset);
+   if (checkpoint)
+      index->checkpoint_frames[index->checkpoint_count++] = swap_if_big64(frame);
+   return true;
+}
+
+uint64_t bsv_index_frame_offset(const bsv_index_t *index, uint64_t frame)
+{
+   return swap_if_big64(index->frame_offsets[frame]);
+}
+
+uint64_t bsv_index_checkpoint_frame(const bsv_index_t *index, size_t i)
+{
+   return swap_if_big64(index->checkpoint_frames[i]);
+}
+
+uint64_t bsv_index_frame_lower_bound(const bsv_index_t *index, uint64_t offset)
+{
+   size_t lo = 0, hi = index->frame_count;
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (bsv_index_frame_offset(index, mid) < offset)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+int64_t bsv_index_frame_at_offset(const bsv_index_t *index, uint64_t offset)
+{
+   uint64_t frame = bsv_index_frame_lower_bound(index, offset);
+   if (     frame < index->frame_count
+         && bsv_index_frame_offset(index, frame) == offset)
+      return (int64_t)frame;
+   return -1;
+}
+
+size_t bsv_index_checkpoint_lower_bound(const bsv_index_t *index, uint64_t frame)
+{
+   size_t lo = 0, hi = index->checkpoint_count;
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (bsv_index_checkpoint_frame(index, mid) < frame)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+bsv_index_t *bsv_index_load(const char *path, uint64_t replay_size,
+      uint64_t min_file_pos, int64_t identifier)
+{
+   uint64_t header[BSV_INDEX_HEADER_LEN];
+   uint64_t frame_count, checkpoint_count;
+   bsv_index_t *index = NULL;
+   uint8_t *data      = NULL;
+   int64_t len        = 0;
+   bool mapped        = false;
+   void *buf          = NULL;
+#ifdef BSV_INDEX_MMAP
+   struct stat st;
+   int fd             = open(path, O_RDONLY);
+   if (fd >= 0)
+   {
+      if (fstat(fd, &st) == 0 && st.st_size >= (int64_t)sizeof(header))
+      {
+         len  = st.st_size;
+         data = (uint8_t*)mmap(NULL, (size_t)len, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (data == (uint8_t*)MAP_FAILED)
+            data = NULL;
+      }
+      close(fd);
+      if (!data)
+         return NULL;
+      mapped          = true;
+   }
+   else
+#endif
+   {
+      if (!filestream_read_file(path, &buf, &len))
+         return NULL;
+      data            = (uint8_t*)buf;
+   }
+
+   if (len < (int64_t)sizeof(header))
+      goto error;
+   memcpy(header, data, sizeof(header));
+   frame_count      = swap_if_big64(header[4]);
+   checkpoint_count = swap_if_big64(header[5]);
+   if (     swap_if_big64(header[0]) != (BSV_INDEX_MAGIC
+                | ((uint64_t)BSV_INDEX_VERSION << 32))
+         || swap_if_big64(header[1]) != replay_size
+         || swap_if_big64(header[2]) != min_file_pos
+         || (int64_t)swap_if_big64(header[3]) != identifier
+         || checkpoint_count > frame_count
+         || (uint64_t)len != sizeof(header)
+            + (frame_count + checkpoint_count) * sizeof(uint64_t))
+   {
+      RARCH_DBG("[Replay] Ignoring stale replay index \"%s\".\n", path);
+      goto error;
+   }
+   if (!(index = bsv_index_new()))
+      goto error;
+   index->map               = data;
+   index->map_size          = (size_t)len;
+   index->mapped            = mapped;
+   index->frame_offsets     = (uint64_t*)(data + sizeof(header));
+   index->checkpoint_frames = index->frame_offsets + frame_count;
+   index->frame_count       = (size_t)frame_count;
+   index->frame_cap         = (size_t)frame_count;
+   index->checkpoint_count  = (size_t)checkpoint_count;
+   index->checkpoint_cap    = (size_t)checkpoint_count;
+   return index;
+
+error:
+   bsv_index_release_map(data, (size_t)len, mapped);
+   return NULL;
+}
+
+bool bsv_index_save(const bsv_index_t *index, const char *path,
+      uint64_t replay_size, uint64_t min_file_pos, int64_t identifier)
+{
+   uint64_t header[BSV_INDEX_HEADER_LEN];
+   int64_t frames_len      = index->frame_count * sizeof(uint64_t);
+   int64_t checkpoints_len = index->checkpoint_count * sizeof(uint64_t);
+   RFILE *file             = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   bool ret                = false;
+   if (!file)
+      return false;
+   header[0] = swap_if_big64(BSV_INDEX_MAGIC | ((uint64_t)BSV_INDEX_VERSION << 32));
+   header[1] = swap_if_big64(replay_size);
+   header[2] = swap_if_big64(min_file_pos);
+   header[3] = swap_if_big64((uint64_t)identifier);
+   header[4] = swap_if_big64((uint64_t)index->frame_count);
+   header[5] = swap_if_big64((uint64_t)index->checkpoint_count);
+   if (     filestream_write(file, header, sizeof(header)) == sizeof(header)
+         && (!frames_len || filestream_write(file,
+               index->frame_offsets, frames_len) == frames_len)
+         && (!checkpoints_len || filestream_write(file,
+               index->checkpoint_frames, checkpoints_len) == checkpoints_len))
+      ret = true;
+   filestream_close(file);
+   if (!ret)
+      filestream_delete(path);
+   return ret;
+}
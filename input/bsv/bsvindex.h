@@ -0,0 +1,77 @@
+/**
+ *  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with RetroArch. If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef __BSV_INDEX__H
+#define __BSV_INDEX__H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+#include <retro_common_api.h>
+
+/* Appended to the replay path to name its index sidecar */
+#define BSV_INDEX_EXTENSION ".idx"
+
+RETRO_BEGIN_DECLS
+
+/* File offset of every frame record in a replay, and the frames whose
+   records carry a checkpoint, both in ascending order.  Entries are
+   stored little-endian so a sidecar file can be mapped and searched
+   in place. */
+typedef struct bsv_index
+{
+   uint64_t *frame_offsets;
+   uint64_t *checkpoint_frames;
+   size_t frame_count, frame_cap;
+   size_t checkpoint_count, checkpoint_cap;
+   /* Non-NULL while the arrays point into a mapped sidecar */
+   void *map;
+   size_t map_size;
+   /* Set when map came from mmap() rather than the heap */
+   bool mapped;
+} bsv_index_t;
+
+bsv_index_t *bsv_index_new(void);
+void bsv_index_free(bsv_index_t *index);
+void bsv_index_clear(bsv_index_t *index);
+
+/* Records that frame's record starts at offset, dropping every entry
+   from that frame on first.  Fails if frames before it are missing. */
+bool bsv_index_set_frame(bsv_index_t *index, uint64_t frame,
+      uint64_t offset, bool checkpoint);
+/* Keeps only the first frames frame records */
+void bsv_index_truncate(bsv_index_t *index, uint64_t frames);
+
+uint64_t bsv_index_frame_offset(const bsv_index_t *index, uint64_t frame);
+uint64_t bsv_index_checkpoint_frame(const bsv_index_t *index, size_t i);
+/* First frame whose record starts at or after offset, or frame_count */
+uint64_t bsv_index_frame_lower_bound(const bsv_index_t *index, uint64_t offset);
+/* Frame whose record starts exactly at offset, or -1 */
+int64_t bsv_index_frame_at_offset(const bsv_index_t *index, uint64_t offset);
+/* Number of checkpoints on frames before frame */
+size_t bsv_index_checkpoint_lower_bound(const bsv_index_t *index, uint64_t frame);
+
+/* The sidecar remembers which replay it describes; loading fails if
+   replay_size, min_file_pos or identifier do not match. */
+bsv_index_t *bsv_index_load(const char *path, uint64_t replay_size,
+      uint64_t min_file_pos, int64_t identifier);
+bool bsv_index_save(const bsv_index_t *index, const char *path,
+      uint64_t replay_size, uint64_t min_file_pos, int64_t identifier);
+
+RETRO_END_DECLS
+
+#endif /* __BSV_INDEX__H */
@@ -16,6 +16,10 @@
  **/
 
 #include "bsvmovie.h"
+#include "bsvindex.h"
+#ifdef HAVE_STATESTREAM
+#include "bsvcalibrate.h"
+#endif
 #include <retro_endianness.h>
 #include <stdint.h>
 #include "../input_driver.h"
@@ -25,6 +29,7 @@
 #include "../../libretro-db/rmsgpack.h"
 #include "../../libretro-db/rmsgpack_dom.h"
 #include "../../verbosity.h"
+#include "../../performance_trace.h"
 #ifdef HAVE_STATESTREAM
 #include "uint32s_index.h"
 #endif
@@ -40,6 +45,17 @@
 
 #ifdef HAVE_ZSTD
 #include <zstd.h>
+
+#define REPLAY_ZSTD_LEVEL 3
+/* Largest window decoders accept without being told otherwise */
+#define REPLAY_ZSTD_WINDOWLOG_MAX 27
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#ifdef HAVE_STATESTREAM
+#include <rthreads/tpool.h>
+#endif
 #endif
 
 #define BSV_IFRAME_START_TOKEN 0x00
@@ -66,18 +82,176 @@
 
 /* Later, tokens for pframes */
 
+/* Largest possible frame record: backref, key events, input events,
+   frame token and the two checkpoint scheme bytes. */
+#define BSV_FRAME_RECORD_MAX_SIZE (sizeof(uint32_t) + 1 \
+      + 128 * sizeof(bsv_key_data_t) + sizeof(uint16_t) \
+      + 512 * sizeof(bsv_input_data_t) + 3)
+
+#ifdef HAVE_THREADS
+/* Frames that can be queued behind an in-flight checkpoint before
+   the main thread blocks. */
+#define BSV_ASYNC_QUEUE_SIZE       64
+/* Serialized states that can be waiting for the encoder at once. */
+#define BSV_ASYNC_MAX_CHECKPOINTS  2
+
+typedef struct bsv_async_job
+{
+   uint8_t record[BSV_FRAME_RECORD_MAX_SIZE];
+   uint64_t frame;
+   size_t record_len;
+   size_t state_size;
+   int state_slot;   /* -1 for a regular frame */
+   uint8_t compression, encoding;
+} bsv_async_job_t;
+
+struct bsv_movie_async
+{
+   bsv_async_job_t jobs[BSV_ASYNC_QUEUE_SIZE];
+   uint8_t *states[BSV_ASYNC_MAX_CHECKPOINTS];
+   size_t state_caps[BSV_ASYNC_MAX_CHECKPOINTS];
+   bool state_busy[BSV_ASYNC_MAX_CHECKPOINTS];
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   /* Jobs are consumed from head; count includes the job
+      currently being written by the worker. */
+   unsigned head, count;
+   bool quit, failed;
+};
+#endif
+
 /* Forward declarations */
 void bsv_movie_free(bsv_movie_t*);
 
 #ifdef HAVE_STATESTREAM
-int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state, size_t state_size, uint8_t *output, size_t output_capacity);
 bool bsv_movie_read_deduped_state(bsv_movie_t *movie, uint8_t *encoded, size_t encoded_size);
 #endif
+static int64_t bsv_movie_encode_checkpoint(bsv_movie_t *handle,
+      uint8_t compression, uint8_t encoding, uint64_t frame, size_t state_size);
+
+static bool bsv_movie_peek_frame_info(bsv_movie_t *movie, uint8_t *token, uint64_t *len);
+
+/* Walks every frame record from min_file_pos to build a fresh index */
+static bsv_index_t *bsv_movie_build_index(bsv_movie_t *movie)
+{
+   uint8_t tok;
+   uint64_t frame_len;
+   uint64_t frame     = 0;
+   int64_t initial_pos;
+   bsv_index_t *index = bsv_index_new();
+   if (!index)
+      return NULL;
+   initial_pos = intfstream_tell(movie->file);
+   intfstream_seek(movie->file, movie->min_file_pos, SEEK_SET);
+   while (bsv_movie_peek_frame_info(movie, &tok, &frame_len))
+   {
+      if (!bsv_index_set_frame(index, frame++, intfstream_tell(movie->file),
+               tok == REPLAY_TOKEN_CHECKPOINT_FRAME
+            || tok == REPLAY_TOKEN_CHECKPOINT2_FRAME))
+      {
+         bsv_index_free(index);
+         index = NULL;
+         break;
+      }
+      intfstream_seek(movie->file, frame_len, SEEK_CUR);
+   }
+   intfstream_seek(movie->file, initial_pos, SEEK_SET);
+   return index;
+}
+
+/* Returns the movie's frame index, building it on first use.  A
+   playback index is complete once built, so it is also written out
+   for the next time this replay is opened. */
+static bsv_index_t *bsv_movie_get_index(bsv_movie_t *movie)
+{
+   if (!movie || movie->version == 0)
+      return NULL;
+   bsv_movie_async_flush(movie);
+   if (movie->index)
+      return movie->index;
+   if (!(movie->index = bsv_movie_build_index(movie)))
+      return NULL;
+   RARCH_DBG("[Replay] Indexed %u frames, %u checkpoints.\n",
+         (unsigned)movie->index->frame_count,
+         (unsigned)movie->index->checkpoint_count);
+   if (movie->playback && movie->index_path)
+      bsv_index_save(movie->index, movie->index_path,
+            intfstream_get_size(movie->file), movie->min_file_pos,
+            movie->identifier);
+   return movie->index;
+}
+
+void bsv_movie_save_index(bsv_movie_t *movie)
+{
+   int64_t replay_size;
+   bsv_index_t *index;
+   if (!movie || movie->playback || !movie->index_path)
+      return;
+   if (!(index = bsv_movie_get_index(movie)))
+      return;
+   /* Rewinding a recording truncates the file without writing a
+      frame, leaving entries past its end. */
+   replay_size = intfstream_get_size(movie->file);
+   bsv_index_truncate(index, bsv_index_frame_lower_bound(index, replay_size));
+   if (!bsv_index_save(index, movie->index_path, replay_size,
+            movie->min_file_pos, movie->identifier))
+      RARCH_WARN("[Replay] Could not write replay index \"%s\".\n",
+            movie->index_path);
+}
+
+/* Equivalent to reading every frame record from frame first up to pos,
+   but only visits the checkpoints in between (which still have to be
+   decoded to keep the incremental checkpoint tables in step) and the
+   last record. */
+static void bsv_movie_scan_to_indexed(bsv_movie_t *movie,
+      bsv_index_t *index, uint64_t first, int64_t pos)
+{
+   uint64_t k;
+   uint64_t base = movie->frame_counter;
+   uint64_t last = bsv_index_frame_lower_bound(index, pos);
+   size_t cp     = bsv_index_checkpoint_lower_bound(index, first);
+   if (last <= first)
+      return;
+   for (; cp < index->checkpoint_count; cp++)
+   {
+      uint64_t cp_frame = bsv_index_checkpoint_frame(index, cp);
+      if (cp_frame >= last - 1)
+         break;
+      movie->frame_counter = base + (cp_frame - first);
+      intfstream_seek(movie->file,
+            bsv_index_frame_offset(index, cp_frame), SEEK_SET);
+      if (!bsv_movie_read_next_events(movie, REPLAY_CPBEHAVIOR_UPDATE, false))
+         return;
+   }
+   movie->frame_counter = base + (last - 1 - first);
+   intfstream_seek(movie->file,
+         bsv_index_frame_offset(index, last - 1), SEEK_SET);
+   if (!bsv_movie_read_next_events(movie, REPLAY_CPBEHAVIOR_UPDATE, false))
+      return;
+   movie->frame_counter += 1;
+   /* Fill in the rewind ring for the frames skipped over */
+   for (k = MAX(first + 1, last > movie->frame_mask ? last - movie->frame_mask : 0);
+         k < last; k++)
+      movie->frame_pos[(base + (k - first)) & movie->frame_mask] =
+         bsv_index_frame_offset(index, k);
+   movie->frame_pos[movie->frame_counter & movie->frame_mask] =
+      intfstream_tell(movie->file);
+}
 
 static void bsv_movie_scan_to(bsv_movie_t *movie, int64_t pos)
 {
+   int64_t first;
+   bsv_index_t *index;
    if (!movie || movie->version == 0)
      return; /* Old movies don't store enough information to fixup the frame counters. */
+   if (     (index = bsv_movie_get_index(movie))
+         && (first = bsv_index_frame_at_offset(index,
+               intfstream_tell(movie->file))) >= 0)
+   {
+      bsv_movie_scan_to_indexed(movie, index, (uint64_t)first, pos);
+      return;
+   }
    while (intfstream_tell(movie->file) < pos
          && bsv_movie_read_next_events(movie, REPLAY_CPBEHAVIOR_UPDATE, false))
    {
@@ -95,6 +269,7 @@ static bool bsv_movie_seek_to_pos_impl(bsv_movie_t *movie, int64_t pos)
    int64_t movie_pos;
    if (!movie || movie->version == 0)
       return false;
+   bsv_movie_async_flush(movie);
    movie_pos = intfstream_tell(movie->file);
    if (pos == movie_pos)
       return true;
@@ -188,9 +363,23 @@ static bool bsv_movie_skip_to_next_checkpoint_impl(bsv_movie_t *movie)
    uint8_t tok = REPLAY_TOKEN_INVALID;
    uint64_t frame_len;
    int64_t cp_pos, initial_pos;
+   bsv_index_t *index;
    if (!movie || movie->version == 0)
       return false;
+   bsv_movie_async_flush(movie);
    initial_pos = intfstream_tell(movie->file);
+   if ((index = bsv_movie_get_index(movie)))
+   {
+      int64_t cur_frame = bsv_index_frame_at_offset(index, initial_pos);
+      if (cur_frame >= 0)
+      {
+         size_t cp = bsv_index_checkpoint_lower_bound(index, (uint64_t)cur_frame);
+         if (cp >= index->checkpoint_count)
+            return false;
+         return bsv_movie_seek_to_pos_impl(movie, bsv_index_frame_offset(index,
+                  bsv_index_checkpoint_frame(index, cp)));
+      }
+   }
    /* scan forward until peek shows a checkpoint or checkpoint2 */
    while (bsv_movie_peek_frame_info(movie, &tok, &frame_len)
          && (     tok != REPLAY_TOKEN_INVALID
@@ -218,8 +407,39 @@ static bool movie_find_checkpoint_before(bsv_movie_t *movie, int64_t frame,
    int64_t target_frame = frame, cur_frame = 0;
    int64_t initial_pos, cp_pos = -1, cp_frame = -1;
    int64_t maybe_last_frame = -1, maybe_last_pos = -1;
+   bsv_index_t *index;
    if (!movie || movie->version == 0)
       return false;
+   if ((index = bsv_movie_get_index(movie)))
+   {
+      /* Same choice as the scan below: the last checkpoint before
+         frame, or when unpaused the last one at least
+         prev_skip_min_distance frames back, unless two or more are
+         closer than that, in which case the second closest. */
+      size_t before = bsv_index_checkpoint_lower_bound(index,
+            MAX(target_frame, 0));
+      size_t far    = target_frame >= prev_skip_min_distance
+         ? bsv_index_checkpoint_lower_bound(index,
+               target_frame - prev_skip_min_distance + 1)
+         : 0;
+      size_t pick   = 0;
+      if (paused)
+         pick = before;
+      else if (before - far >= 2)
+         pick = before - 1;
+      else
+         pick = far;
+      if (pick > 0)
+      {
+         cp_frame = bsv_index_checkpoint_frame(index, pick - 1);
+         cp_pos   = bsv_index_frame_offset(index, cp_frame);
+      }
+      if (cp_pos_out)
+         *cp_pos_out = cp_pos;
+      if (cp_frame_out)
+         *cp_frame_out = cp_frame;
+      return cp_frame >= 0;
+   }
    initial_pos = intfstream_tell(movie->file);
    /* Find the right checkpoint to jump to.
       In the future, backrefs could be used to make this faster */
@@ -254,7 +474,7 @@ static bool movie_find_checkpoint_before(bsv_movie_t *movie, int64_t frame,
    if (cp_frame_out)
       *cp_frame_out = cp_frame;
    intfstream_seek(movie->file, initial_pos, SEEK_SET);
-   return cp_frame;
+   return cp_frame >= 0;
 }
 
 
@@ -268,6 +488,15 @@ static bool bsv_movie_skip_to_prev_checkpoint_impl(bsv_movie_t *movie)
    return bsv_movie_seek_to_pos_impl(movie, cp_pos);
 }
 
+/* Cuts a recording off at pos, along with its index entries */
+static void bsv_movie_truncate(bsv_movie_t *handle, int64_t pos)
+{
+   intfstream_truncate(handle->file, pos);
+   if (handle->index)
+      bsv_index_truncate(handle->index,
+            bsv_index_frame_lower_bound(handle->index, pos));
+}
+
 bool bsv_movie_reset_playback(bsv_movie_t *handle)
 {
    uint32_t vsn;
@@ -334,25 +563,54 @@ bool bsv_movie_reset_playback(bsv_movie_t *handle)
       if (!bsv_movie_load_checkpoint(handle, compression, encoding, REPLAY_CPBEHAVIOR_DESERIALIZE))
          return false;
    }
-   return bsv_movie_read_next_events(handle, REPLAY_CPBEHAVIOR_DESERIALIZE, true);
+   handle->verified_checkpoints = 0;
+   handle->desyncs              = 0;
+   handle->first_desync_frame   = -1;
+   handle->verify_start_usec    = cpu_features_get_time_usec();
+   return bsv_movie_read_next_events(handle,
+         (input_state_get_ptr()->bsv_movie_state.flags & BSV_FLAG_MOVIE_VERIFY)
+         ? REPLAY_CPBEHAVIOR_VERIFY : REPLAY_CPBEHAVIOR_DESERIALIZE, true);
 }
 
+#ifdef HAVE_ZSTD
+/* Both dictionaries are the replay's initial checkpoint, so they have
+   to go whenever that checkpoint is replaced. */
+static void bsv_movie_free_dictionaries(bsv_movie_t *handle)
+{
+   free(handle->save_dict);
+   free(handle->load_dict);
+   handle->save_dict      = NULL;
+   handle->load_dict      = NULL;
+   handle->save_dict_size = 0;
+   handle->load_dict_size = 0;
+}
+#endif
+
 bool bsv_movie_reset_recording(bsv_movie_t *handle)
 {
    size_t state_size, state_size_;
    uint8_t compression   = handle->checkpoint_compression;
 #if HAVE_STATESTREAM
    uint8_t encoding      = REPLAY_CHECKPOINT2_ENCODING_STATESTREAM;
+#else
+   uint8_t encoding       = REPLAY_CHECKPOINT2_ENCODING_RAW;
+#endif
+   /* The checkpoint worker may still be inserting into the index */
+   bsv_movie_async_flush(handle);
+#if HAVE_STATESTREAM
    /* If recording, we simply reset
     * the starting point. Nice and easy. */
    if (handle->superblocks)
       uint32s_index_clear(handle->superblocks);
    if (handle->blocks)
       uint32s_index_clear(handle->blocks);
-#else
-   uint8_t encoding       = REPLAY_CHECKPOINT2_ENCODING_RAW;
 #endif
    handle->cur_save_valid = false;
+   if (handle->index)
+      bsv_index_clear(handle->index);
+#ifdef HAVE_ZSTD
+   bsv_movie_free_dictionaries(handle);
+#endif
 
    intfstream_seek(handle->file, REPLAY_HEADER_LEN_BYTES, SEEK_SET);
    intfstream_write(handle->file, &compression, 1);
@@ -374,7 +632,10 @@ void bsv_movie_enqueue(input_driver_state_t *input_st,
    if (input_st->bsv_movie_state_next_handle)
       bsv_movie_free(input_st->bsv_movie_state_next_handle);
    input_st->bsv_movie_state_next_handle    = state;
-   input_st->bsv_movie_state.flags          = flags;
+   /* Keep the options given on the command line */
+   input_st->bsv_movie_state.flags          = flags
+      | (input_st->bsv_movie_state.flags
+            & (BSV_FLAG_MOVIE_EOF_EXIT | BSV_FLAG_MOVIE_VERIFY));
 }
 
 void bsv_movie_deinit(input_driver_state_t *input_st)
@@ -402,6 +663,7 @@ void bsv_movie_frame_rewind(void)
    if (!handle)
       return;
 
+   bsv_movie_async_flush(handle);
    handle->did_rewind     = true;
    handle->cur_save_valid = false;
    if (((handle->frame_counter & handle->frame_mask) <= 1)
@@ -419,7 +681,7 @@ void bsv_movie_frame_rewind(void)
          uint32s_index_remove_after(handle->blocks, 0);
 #endif
       if (recording)
-         intfstream_truncate(handle->file, (int)handle->min_file_pos);
+         bsv_movie_truncate(handle, handle->min_file_pos);
       else
          bsv_movie_read_next_events(handle, REPLAY_CPBEHAVIOR_DESERIALIZE, true);
    }
@@ -444,7 +706,7 @@ void bsv_movie_frame_rewind(void)
 #endif
       intfstream_seek(handle->file, (int)handle->frame_pos[handle->frame_counter & handle->frame_mask], SEEK_SET);
       if (recording)
-         intfstream_truncate(handle->file, intfstream_tell(handle->file));
+         bsv_movie_truncate(handle, intfstream_tell(handle->file));
       else
          bsv_movie_read_next_events(handle, REPLAY_CPBEHAVIOR_DESERIALIZE, true);
    }
@@ -458,7 +720,7 @@ void bsv_movie_frame_rewind(void)
       else
       {
          bsv_movie_reset_recording(handle);
-         intfstream_truncate(handle->file, intfstream_tell(handle->file));
+         bsv_movie_truncate(handle, intfstream_tell(handle->file));
       }
    }
 }
@@ -516,6 +778,160 @@ bool bsv_movie_handle_read_input_event(bsv_movie_t *movie,
    return false;
 }
 
+/* Returns a buffer of at least len bytes that stays with the movie, so
+   loading checkpoints back to back does not churn the allocator. */
+static uint8_t *bsv_movie_load_buffer(uint8_t **buf, size_t *cap, size_t len)
+{
+   if (*cap < len)
+   {
+      uint8_t *grown = (uint8_t*)realloc(*buf, len);
+      if (!grown)
+         return NULL;
+      *buf = grown;
+      *cap = len;
+   }
+   return *buf;
+}
+
+void bsv_movie_codec_free(bsv_movie_t *handle)
+{
+   free(handle->load_compressed);
+   free(handle->load_encoded);
+   handle->load_compressed     = NULL;
+   handle->load_encoded        = NULL;
+   handle->load_compressed_cap = 0;
+   handle->load_encoded_cap    = 0;
+   free(handle->verify_save);
+   handle->verify_save         = NULL;
+   handle->verify_save_cap     = 0;
+#ifdef HAVE_ZLIB
+   if (handle->load_zstream)
+   {
+      inflateEnd(handle->load_zstream);
+      free(handle->load_zstream);
+      handle->load_zstream = NULL;
+   }
+#endif
+#ifdef HAVE_ZSTD
+   ZSTD_freeDCtx(handle->load_dctx);
+   ZSTD_freeCCtx(handle->save_cctx);
+   handle->load_dctx      = NULL;
+   handle->save_cctx      = NULL;
+   bsv_movie_free_dictionaries(handle);
+#endif
+}
+
+/* Decompresses compressed_size bytes into exactly out_size bytes of out */
+static bool bsv_movie_decompress(bsv_movie_t *handle, uint8_t compression,
+      const uint8_t *compressed, uint32_t compressed_size,
+      uint8_t *out, uint32_t out_size)
+{
+   switch (compression)
+   {
+#ifdef HAVE_ZLIB
+      case REPLAY_CHECKPOINT2_COMPRESSION_ZLIB:
+         {
+            z_stream *stream = handle->load_zstream;
+            if (!stream)
+            {
+               if (!(stream = (z_stream*)calloc(1, sizeof(*stream))))
+                  return false;
+               if (inflateInit(stream) != Z_OK)
+               {
+                  free(stream);
+                  return false;
+               }
+               handle->load_zstream = stream;
+            }
+            else if (inflateReset(stream) != Z_OK)
+               return false;
+            stream->next_in   = (Bytef*)compressed;
+            stream->avail_in  = compressed_size;
+            stream->next_out  = out;
+            stream->avail_out = out_size;
+            return inflate(stream, Z_FINISH) == Z_STREAM_END
+               && stream->avail_out == 0;
+         }
+#endif
+#ifdef HAVE_ZSTD
+      case REPLAY_CHECKPOINT2_COMPRESSION_ZSTD:
+         {
+            size_t decompressed_size;
+            if (!handle->load_dctx && !(handle->load_dctx = ZSTD_createDCtx()))
+               return false;
+            decompressed_size = ZSTD_decompressDCtx(handle->load_dctx,
+                  out, out_size, compressed, compressed_size);
+            return !ZSTD_isError(decompressed_size)
+               && decompressed_size == out_size;
+         }
+      case REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT:
+         {
+            size_t decompressed_size;
+            if (!handle->load_dctx && !(handle->load_dctx = ZSTD_createDCtx()))
+               return false;
+            /* A prefix only applies to the next frame */
+            if (ZSTD_isError(ZSTD_DCtx_refPrefix(handle->load_dctx,
+                        handle->load_dict, handle->load_dict_size)))
+               return false;
+            decompressed_size = ZSTD_decompressDCtx(handle->load_dctx,
+                  out, out_size, compressed, compressed_size);
+            return !ZSTD_isError(decompressed_size)
+               && decompressed_size == out_size;
+         }
+#endif
+      default:
+         RARCH_WARN("[Replay] Unrecognized compression scheme %d\n", compression);
+         return false;
+   }
+}
+
+#ifdef HAVE_ZSTD
+/* Reads back the dictionary for REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT
+   checkpoints: the initial checkpoint, which directly follows the header,
+   decompressed but still encoded.  Leaves the file position where it was. */
+static bool bsv_movie_load_dictionary(bsv_movie_t *handle)
+{
+   uint8_t schemes[2];
+   uint32_t sizes[3];
+   uint8_t *compressed, *dict = NULL;
+   int64_t pos = intfstream_tell(handle->file);
+   bool ret    = false;
+   intfstream_seek(handle->file, REPLAY_HEADER_LEN_BYTES, SEEK_SET);
+   if (     intfstream_read(handle->file, schemes, sizeof(schemes)) != sizeof(schemes)
+         || intfstream_read(handle->file, sizes, sizeof(sizes)) != sizeof(sizes))
+      goto exit;
+   sizes[1] = swap_if_big32(sizes[1]);
+   sizes[2] = swap_if_big32(sizes[2]);
+   /* The dictionary can't be compressed with itself */
+   if (schemes[0] == REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT)
+      goto exit;
+   if (!(compressed = bsv_movie_load_buffer(&handle->load_compressed,
+               &handle->load_compressed_cap, sizes[2])))
+      goto exit;
+   if (intfstream_read(handle->file, compressed, sizes[2]) != (int64_t)sizes[2])
+      goto exit;
+   if (!(dict = (uint8_t*)malloc(MAX(sizes[1], 1))))
+      goto exit;
+   if (schemes[0] == REPLAY_CHECKPOINT2_COMPRESSION_NONE)
+   {
+      if (sizes[1] != sizes[2])
+         goto exit;
+      memcpy(dict, compressed, sizes[1]);
+   }
+   else if (!bsv_movie_decompress(handle, schemes[0], compressed, sizes[2],
+            dict, sizes[1]))
+      goto exit;
+   handle->load_dict      = dict;
+   handle->load_dict_size = sizes[1];
+   dict                   = NULL;
+   ret                    = true;
+exit:
+   free(dict);
+   intfstream_seek(handle->file, pos, SEEK_SET);
+   return ret;
+}
+#endif
+
 bool bsv_movie_load_checkpoint(bsv_movie_t *handle, uint8_t compression,
       uint8_t encoding,replay_checkpoint_behavior checkpoint_behavior)
 {
@@ -567,11 +983,55 @@ bool bsv_movie_load_checkpoint(bsv_movie_t *handle, uint8_t compression,
       handle->cur_save_valid = false;
    }
 
-   if (  compression == REPLAY_CHECKPOINT2_COMPRESSION_NONE
-         && encoding == REPLAY_CHECKPOINT2_ENCODING_RAW)
-      compressed_data = handle->cur_save;
-   else
-      compressed_data = (uint8_t*)malloc(compressed_encoded_size);
+#ifdef HAVE_ZSTD
+   /* Before anything is read into the load buffers, which this uses */
+   if (     compression == REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT
+         && !handle->load_dict
+         && !bsv_movie_load_dictionary(handle))
+   {
+      RARCH_ERR("[Replay] Couldn't rebuild checkpoint dictionary\n");
+      ret = false;
+      goto exit;
+   }
+#endif
+
+   /* A raw state is decoded straight into cur_save; only statestream
+      encodings need an intermediate buffer for the decompressed data. */
+   if (encoding == REPLAY_CHECKPOINT2_ENCODING_RAW)
+   {
+      if (encoded_size > handle->cur_save_size)
+      {
+         RARCH_ERR("[Replay] Checkpoint larger than its state size\n");
+         ret = false;
+         goto exit;
+      }
+      encoded_data = handle->cur_save;
+   }
+   else if (!(encoded_data = bsv_movie_load_buffer(&handle->load_encoded,
+               &handle->load_encoded_cap, encoded_size)))
+   {
+      ret = false;
+      goto exit;
+   }
+
+   if (compression == REPLAY_CHECKPOINT2_COMPRESSION_NONE)
+   {
+      if (compressed_encoded_size != encoded_size)
+      {
+         RARCH_ERR("[Replay] Uncompressed checkpoint has mismatched sizes\n");
+         ret = false;
+         goto exit;
+      }
+      compressed_data = encoded_data;
+   }
+   else if (!(compressed_data = bsv_movie_load_buffer(
+               &handle->load_compressed, &handle->load_compressed_cap,
+               compressed_encoded_size)))
+   {
+      ret = false;
+      goto exit;
+   }
+
    if (intfstream_read(handle->file, compressed_data,
        compressed_encoded_size) != (int64_t)compressed_encoded_size)
    {
@@ -580,62 +1040,18 @@ bool bsv_movie_load_checkpoint(bsv_movie_t *handle, uint8_t compression,
       ret = false;
       goto exit;
    }
-   switch (compression)
+   if (     compression != REPLAY_CHECKPOINT2_COMPRESSION_NONE
+         && !bsv_movie_decompress(handle, compression, compressed_data,
+               compressed_encoded_size, encoded_data, encoded_size))
    {
-      case REPLAY_CHECKPOINT2_COMPRESSION_NONE:
-         encoded_data = compressed_data;
-         compressed_data = NULL;
-         break;
-#ifdef HAVE_ZLIB
-      case REPLAY_CHECKPOINT2_COMPRESSION_ZLIB:
-         {
-            uLongf uncompressed_size_zlib = encoded_size;
-            encoded_data = (uint8_t*)calloc(encoded_size, sizeof(uint8_t));
-            if (uncompress(encoded_data, &uncompressed_size_zlib,
-                compressed_data, compressed_encoded_size) != Z_OK)
-            {
-               ret = false;
-               goto exit;
-            }
-            break;
-         }
-#endif
-#ifdef HAVE_ZSTD
-      case REPLAY_CHECKPOINT2_COMPRESSION_ZSTD:
-         {
-            size_t uncompressed_size_big;
-            /* TODO: figure out how to support in-place decompression to
-               avoid allocating a second buffer; would need to allocate
-               the compressed_data buffer to be decompressed size +
-               margin.  but, how could the margin be known without
-               calling the function that takes the compressed frames as
-               an input?  */
-            encoded_data          = (uint8_t*)calloc(encoded_size, sizeof(uint8_t));
-            uncompressed_size_big = ZSTD_decompress(encoded_data, encoded_size,
-                  compressed_data, compressed_encoded_size);
-            if (ZSTD_isError(uncompressed_size_big))
-               {
-                  ret = false;
-                  goto exit;
-               }
-            break;
-         }
-#endif
-      default:
-         RARCH_WARN("[Replay] Unrecognized compression scheme %d\n", compression);
-         ret = false;
-         goto exit;
+      RARCH_ERR("[Replay] Couldn't decompress checkpoint\n");
+      ret = false;
+      goto exit;
    }
    switch (encoding)
    {
       case REPLAY_CHECKPOINT2_ENCODING_RAW:
          size = encoded_size;
-         /* If decompression wasn't zerocopy, need to copy here;
-            otherwise decoding is also free */
-         if (handle->cur_save != encoded_data)
-            memcpy(handle->cur_save, encoded_data, size);
-         else
-            encoded_data = NULL;
          break;
 #ifdef HAVE_STATESTREAM
       case REPLAY_CHECKPOINT2_ENCODING_STATESTREAM:
@@ -652,28 +1068,21 @@ bool bsv_movie_load_checkpoint(bsv_movie_t *handle, uint8_t compression,
          ret = false;
          goto exit;
    }
-   if (checkpoint_behavior != REPLAY_CPBEHAVIOR_DESERIALIZE)
+   if (     checkpoint_behavior != REPLAY_CPBEHAVIOR_DESERIALIZE
+         && checkpoint_behavior != REPLAY_CPBEHAVIOR_VERIFY)
       goto exit;
-   handle->checkpoint_ready = true;
+   handle->checkpoint_ready  = true;
+   handle->checkpoint_verify = (checkpoint_behavior == REPLAY_CPBEHAVIOR_VERIFY);
  exit:
    handle->cur_save_size = size;
    handle->last_save_size = handle->cur_save_size;
-
-   if (compressed_data)
-      free(compressed_data);
-   if (encoded_data)
-      free(encoded_data);
    return ret;
 }
 
-int64_t bsv_movie_write_checkpoint(bsv_movie_t *handle, uint8_t compression, uint8_t encoding)
+/* Serializes the core into handle->cur_save, growing it if needed.
+   Returns the serialized size. */
+static size_t bsv_movie_serialize_cur_save(bsv_movie_t *handle)
 {
-   uint8_t *swap;
-   size_t size_swap;
-   int64_t ret = -1;
-   uint32_t encoded_size = 0, compressed_encoded_size, size_ = 0;
-   uint8_t *encoded_data = NULL, *compressed_encoded_data = NULL;
-   bool owns_encoded = false, owns_compressed_encoded = false;
    retro_ctx_serialize_info_t serial_info;
    serial_info.size = core_serialize_size();
    if (handle->cur_save_size < serial_info.size)
@@ -689,21 +1098,50 @@ int64_t bsv_movie_write_checkpoint(bsv_movie_t *handle, uint8_t compression, uin
    }
    serial_info.data = handle->cur_save;
    core_serialize(&serial_info);
+   return serial_info.size;
+}
+
+int64_t bsv_movie_write_checkpoint(bsv_movie_t *handle, uint8_t compression, uint8_t encoding)
+{
+   size_t state_size = bsv_movie_serialize_cur_save(handle);
+   return bsv_movie_encode_checkpoint(handle, compression, encoding,
+         handle->frame_counter, state_size);
+}
+
+/* Encodes, compresses and writes the state held in handle->cur_save,
+   then makes it the new last_save.  This is the only part of writing a
+   checkpoint that may run off the main thread. */
+static int64_t bsv_movie_encode_checkpoint(bsv_movie_t *handle,
+      uint8_t compression, uint8_t encoding, uint64_t frame, size_t state_size)
+{
+   uint8_t *swap;
+   size_t size_swap;
+   int64_t ret = -1;
+   uint32_t encoded_size = 0, compressed_encoded_size, size_ = 0;
+   uint8_t *encoded_data = NULL, *compressed_encoded_data = NULL;
+   bool owns_encoded = false, owns_compressed_encoded = false;
    switch (encoding)
    {
       case REPLAY_CHECKPOINT2_ENCODING_RAW:
-         /* If serial_info.size > uint32 max, we have bigger problems on our hands */
-         encoded_size = (uint32_t)serial_info.size;
-         encoded_data = (uint8_t*)serial_info.data;
+         /* If state_size > uint32 max, we have bigger problems on our hands */
+         encoded_size = (uint32_t)state_size;
+         encoded_data = handle->cur_save;
          break;
 #ifdef HAVE_STATESTREAM
       case REPLAY_CHECKPOINT2_ENCODING_STATESTREAM:
          /* encoded size estimate or actual encoded state size should not exceed uint32 max */
-         encoded_size = (uint32_t)(serial_info.size + serial_info.size / 2);
+         encoded_size = (uint32_t)(state_size + state_size / 2);
          encoded_data = (uint8_t*)malloc(encoded_size);
          owns_encoded = true;
-         encoded_size = (uint32_t)bsv_movie_write_deduped_state(handle, (uint8_t*)serial_info.data,
-               serial_info.size, encoded_data, encoded_size);
+         encoded_size = (uint32_t)bsv_movie_write_deduped_state(handle, frame,
+               handle->cur_save, state_size, encoded_data, encoded_size);
+         if (     handle->calibration
+               && bsv_calibration_sample(handle->calibration, handle,
+                  frame, handle->cur_save, state_size))
+         {
+            bsv_calibration_free(handle->calibration);
+            handle->calibration = NULL;
+         }
          break;
 #endif
       default:
@@ -734,16 +1172,63 @@ int64_t bsv_movie_write_checkpoint(bsv_movie_t *handle, uint8_t compression, uin
 #endif
 #ifdef HAVE_ZSTD
       case REPLAY_CHECKPOINT2_COMPRESSION_ZSTD:
+      case REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT:
       {
          size_t compressed_encoded_size_zstd = ZSTD_compressBound(encoded_size);
          compressed_encoded_data = (uint8_t*)calloc(compressed_encoded_size_zstd, sizeof(uint8_t));
          owns_compressed_encoded = true;
-         compressed_encoded_size_zstd = ZSTD_compress(compressed_encoded_data, compressed_encoded_size_zstd, encoded_data, encoded_size, 3);
+         if (!handle->save_cctx && !(handle->save_cctx = ZSTD_createCCtx()))
+         {
+            ret = -1;
+            goto exit;
+         }
+         if (compression == REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT)
+         {
+            /* Compressed like a patch against the initial checkpoint:
+               the window has to reach back across all of it, and long
+               distance matching finds the unchanged runs. */
+            int window_log = 10;
+            size_t total   = handle->save_dict_size + encoded_size;
+            while (window_log < REPLAY_ZSTD_WINDOWLOG_MAX
+                  && ((size_t)1 << window_log) < total)
+               window_log++;
+            if (     !handle->save_dict
+                  || ZSTD_isError(ZSTD_CCtx_reset(handle->save_cctx,
+                        ZSTD_reset_session_and_parameters))
+                  || ZSTD_isError(ZSTD_CCtx_setParameter(handle->save_cctx,
+                        ZSTD_c_compressionLevel, REPLAY_ZSTD_LEVEL))
+                  || ZSTD_isError(ZSTD_CCtx_setParameter(handle->save_cctx,
+                        ZSTD_c_windowLog, window_log))
+                  || ZSTD_isError(ZSTD_CCtx_setParameter(handle->save_cctx,
+                        ZSTD_c_enableLongDistanceMatching, 1))
+                  || ZSTD_isError(ZSTD_CCtx_refPrefix(handle->save_cctx,
+                        handle->save_dict, handle->save_dict_size)))
+            {
+               ret = -1;
+               goto exit;
+            }
+            compressed_encoded_size_zstd = ZSTD_compress2(handle->save_cctx,
+                  compressed_encoded_data, compressed_encoded_size_zstd,
+                  encoded_data, encoded_size);
+         }
+         else
+            compressed_encoded_size_zstd = ZSTD_compressCCtx(handle->save_cctx,
+                  compressed_encoded_data, compressed_encoded_size_zstd,
+                  encoded_data, encoded_size, REPLAY_ZSTD_LEVEL);
          if (ZSTD_isError(compressed_encoded_size_zstd))
          {
             ret = -1;
             goto exit;
          }
+         /* The initial checkpoint doubles as the dictionary for the rest */
+         if (     !handle->save_dict
+               && handle->checkpoint_dictionary
+               && frame == 0
+               && (handle->save_dict = (uint8_t*)malloc(MAX(encoded_size, 1))))
+         {
+            memcpy(handle->save_dict, encoded_data, encoded_size);
+            handle->save_dict_size = encoded_size;
+         }
          /* Have to cast after checking the error flags, not before */
          compressed_encoded_size = (uint32_t)compressed_encoded_size_zstd;
          break;
@@ -755,7 +1240,7 @@ int64_t bsv_movie_write_checkpoint(bsv_movie_t *handle, uint8_t compression, uin
          goto exit;
    }
    /* uncompressed, unencoded size */
-   size_ = swap_if_big32((uint32_t)serial_info.size);
+   size_ = swap_if_big32((uint32_t)state_size);
    if (intfstream_write(handle->file, &size_, sizeof(uint32_t)) < (int64_t)sizeof(uint32_t))
    {
       ret = -1;
@@ -797,11 +1282,328 @@ exit:
    return ret;
 }
 
+/* Lays out the staged key and input events of the frame that just
+   ended, followed by its frame token (and checkpoint schemes, for
+   checkpoint frames).  The first four bytes are left for the backref,
+   which can only be computed once the record's file position is known. */
+static size_t bsv_movie_build_frame_record(bsv_movie_t *handle,
+      uint8_t *record, uint8_t frame_tok, uint8_t compression, uint8_t encoding)
+{
+   size_t _len        = sizeof(uint32_t);
+   uint16_t evt_count = swap_if_big16(handle->input_event_count);
+   record[_len++]     = handle->key_event_count;
+   memcpy(record + _len, handle->key_events,
+         handle->key_event_count * sizeof(bsv_key_data_t));
+   _len              += handle->key_event_count * sizeof(bsv_key_data_t);
+   memcpy(record + _len, &evt_count, sizeof(uint16_t));
+   _len              += sizeof(uint16_t);
+   memcpy(record + _len, handle->input_events,
+         handle->input_event_count * sizeof(bsv_input_data_t));
+   _len              += handle->input_event_count * sizeof(bsv_input_data_t);
+   record[_len++]     = frame_tok;
+   if (frame_tok == REPLAY_TOKEN_CHECKPOINT2_FRAME)
+   {
+      record[_len++]  = compression;
+      record[_len++]  = encoding;
+   }
+   /* Zero out events when playing back or recording */
+   handle->key_event_count   = 0;
+   handle->input_event_count = 0;
+   return _len;
+}
+
+/* Appends a frame record built by bsv_movie_build_frame_record to the
+   replay, encoding the checkpoint in handle->cur_save after it if
+   state_size is nonzero. */
+static bool bsv_movie_write_frame_record(bsv_movie_t *handle, uint64_t frame,
+      uint8_t *record, size_t record_len, size_t state_size,
+      uint8_t compression, uint8_t encoding)
+{
+   bool ret               = true;
+   size_t last_pos        = handle->frame_pos[(MAX(frame,2)-2) & handle->frame_mask];
+   size_t cur_pos         = intfstream_tell(handle->file);
+   uint32_t back_distance = swap_if_big32((uint32_t)(cur_pos-last_pos));
+   memcpy(record, &back_distance, sizeof(uint32_t));
+#ifdef HAVE_ZSTD
+   /* save_dict belongs to whichever thread writes the checkpoints, so
+      the switch to dictionary compression is made here rather than
+      when the record is queued. */
+   if (     state_size
+         && compression == REPLAY_CHECKPOINT2_COMPRESSION_ZSTD
+         && handle->save_dict)
+   {
+      compression          = REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT;
+      record[record_len-2] = compression;
+   }
+#endif
+   intfstream_write(handle->file, record, record_len);
+   /* This record is the one read back as frame-1 */
+   if (handle->index && !bsv_index_set_frame(handle->index, frame - 1,
+            cur_pos, state_size != 0))
+   {
+      bsv_index_free(handle->index);
+      handle->index = NULL;
+   }
+   if (state_size && bsv_movie_encode_checkpoint(handle,
+            compression, encoding, frame, state_size) < 0)
+      ret = false;
+   /* To support seeking forwards during a paused replay, we would
+      need to *not* truncate here if we are in the "just paused,
+      running a frame to get the updated image, then will pause
+      again" state. */
+   intfstream_truncate(handle->file, intfstream_tell(handle->file));
+   handle->frame_pos[frame & handle->frame_mask] = intfstream_tell(handle->file);
+   return ret;
+}
+
+#ifdef HAVE_THREADS
+static void bsv_movie_async_thread(void *data)
+{
+   bsv_movie_t *handle            = (bsv_movie_t*)data;
+   struct bsv_movie_async *async  = handle->async;
+
+   slock_lock(async->lock);
+   for (;;)
+   {
+      bool ok;
+      size_t cap_swap;
+      uint8_t *buf_swap;
+      bsv_async_job_t *job;
+
+      while (!async->count && !async->quit)
+         scond_wait(async->cond, async->lock);
+      if (!async->count)
+         break;
+      job = &async->jobs[async->head];
+      slock_unlock(async->lock);
+
+      /* The worker owns cur_save/last_save and the block indices
+         while jobs are pending, so hand it the queued state by
+         swapping buffers rather than copying. */
+      if (job->state_slot >= 0)
+      {
+         buf_swap                            = handle->cur_save;
+         cap_swap                            = handle->cur_save_size;
+         handle->cur_save                    = async->states[job->state_slot];
+         handle->cur_save_size               = async->state_caps[job->state_slot];
+         async->states[job->state_slot]      = buf_swap;
+         async->state_caps[job->state_slot]  = buf_swap ? cap_swap : 0;
+      }
+      ok = bsv_movie_write_frame_record(handle, job->frame,
+            job->record, job->record_len,
+            job->state_slot >= 0 ? job->state_size : 0,
+            job->compression, job->encoding);
+
+      slock_lock(async->lock);
+      if (!ok)
+         async->failed = true;
+      if (job->state_slot >= 0)
+         async->state_busy[job->state_slot] = false;
+      async->head = (async->head + 1) % BSV_ASYNC_QUEUE_SIZE;
+      async->count--;
+      scond_broadcast(async->cond);
+   }
+   slock_unlock(async->lock);
+}
+
+bool bsv_movie_async_init(bsv_movie_t *handle)
+{
+   struct bsv_movie_async *async = NULL;
+   if (!handle || handle->async)
+      return false;
+   if (!(async = (struct bsv_movie_async*)calloc(1, sizeof(*async))))
+      return false;
+   handle->async = async;
+   if (     !(async->lock   = slock_new())
+         || !(async->cond   = scond_new())
+         || !(async->thread = sthread_create(bsv_movie_async_thread, handle)))
+   {
+      bsv_movie_async_free(handle);
+      return false;
+   }
+   return true;
+}
+
+/* Blocks until every queued frame has reached the file.  Must be
+   called before the main thread touches the replay file or the
+   checkpoint state of a recording. */
+void bsv_movie_async_flush(bsv_movie_t *handle)
+{
+   bool failed;
+   struct bsv_movie_async *async = handle ? handle->async : NULL;
+   if (!async)
+      return;
+   slock_lock(async->lock);
+   while (async->count)
+      scond_wait(async->cond, async->lock);
+   failed        = async->failed;
+   async->failed = false;
+   slock_unlock(async->lock);
+   if (failed)
+   {
+      RARCH_ERR("[Replay] failed to write checkpoint, exiting record\n");
+      input_state_get_ptr()->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
+   }
+}
+
+void bsv_movie_async_free(bsv_movie_t *handle)
+{
+   int i;
+   struct bsv_movie_async *async = handle ? handle->async : NULL;
+   if (!async)
+      return;
+   if (async->thread)
+   {
+      slock_lock(async->lock);
+      async->quit = true;
+      scond_broadcast(async->cond);
+      slock_unlock(async->lock);
+      /* The worker drains the queue before honoring quit */
+      sthread_join(async->thread);
+   }
+   if (async->cond)
+      scond_free(async->cond);
+   if (async->lock)
+      slock_free(async->lock);
+   for (i = 0; i < BSV_ASYNC_MAX_CHECKPOINTS; i++)
+      free(async->states[i]);
+   free(async);
+   handle->async = NULL;
+}
+
+/* Queues the frame that just ended.  Only core_serialize runs here for
+   checkpoint frames; everything else happens on the worker.  Blocks if
+   the worker has fallen too far behind. */
+static void bsv_movie_async_push_frame(bsv_movie_t *handle,
+      bool checkpoint, uint8_t compression, uint8_t encoding)
+{
+   int slot = -1;
+   bsv_async_job_t *job;
+   struct bsv_movie_async *async = handle->async;
+   uint8_t frame_tok             = checkpoint
+      ? REPLAY_TOKEN_CHECKPOINT2_FRAME
+      : REPLAY_TOKEN_REGULAR_FRAME;
+
+   slock_lock(async->lock);
+   if (async->failed)
+   {
+      async->failed = false;
+      slock_unlock(async->lock);
+      RARCH_ERR("[Replay] failed to write checkpoint, exiting record\n");
+      input_state_get_ptr()->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
+      slock_lock(async->lock);
+   }
+   /* Nothing in flight: regular frames go straight to the file, just
+      as with synchronous recording. */
+   if (!checkpoint && !async->count)
+   {
+      uint8_t record[BSV_FRAME_RECORD_MAX_SIZE];
+      size_t record_len;
+      slock_unlock(async->lock);
+      record_len = bsv_movie_build_frame_record(handle, record, frame_tok, 0, 0);
+      if (!bsv_movie_write_frame_record(handle, handle->frame_counter,
+               record, record_len, 0, 0, 0))
+      {
+         RARCH_ERR("[Replay] failed to write checkpoint, exiting record\n");
+         input_state_get_ptr()->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
+      }
+      return;
+   }
+   for (;;)
+   {
+      if (async->count < BSV_ASYNC_QUEUE_SIZE)
+      {
+         if (!checkpoint)
+            break;
+         for (slot = 0; slot < BSV_ASYNC_MAX_CHECKPOINTS; slot++)
+            if (!async->state_busy[slot])
+               break;
+         if (slot < BSV_ASYNC_MAX_CHECKPOINTS)
+            break;
+         slot = -1;
+      }
+      scond_wait(async->cond, async->lock);
+   }
+   if (slot >= 0)
+      async->state_busy[slot] = true;
+   /* The worker never looks past head + count, so this slot can be
+      filled without holding the lock. */
+   job = &async->jobs[(async->head + async->count) % BSV_ASYNC_QUEUE_SIZE];
+   slock_unlock(async->lock);
+
+   job->frame       = handle->frame_counter;
+   job->state_size  = 0;
+   job->compression = compression;
+   job->encoding    = encoding;
+   if (slot >= 0)
+   {
+      retro_ctx_serialize_info_t serial_info;
+      serial_info.size = core_serialize_size();
+      if (async->state_caps[slot] < serial_info.size)
+      {
+         free(async->states[slot]);
+         async->states[slot]     = (uint8_t*)malloc(serial_info.size);
+         async->state_caps[slot] = async->states[slot] ? serial_info.size : 0;
+      }
+      serial_info.data = async->states[slot];
+      if (serial_info.data && core_serialize(&serial_info))
+         job->state_size = serial_info.size;
+      else
+      {
+         /* A checkpoint token must be followed by a state, so keep
+            the frame as a regular one and end the recording the
+            same way a failed checkpoint write does. */
+         slock_lock(async->lock);
+         async->state_busy[slot] = false;
+         async->failed           = true;
+         slock_unlock(async->lock);
+         slot      = -1;
+         frame_tok = REPLAY_TOKEN_REGULAR_FRAME;
+      }
+   }
+   job->state_slot  = slot;
+   job->record_len  = bsv_movie_build_frame_record(handle, job->record,
+         frame_tok, compression, encoding);
+
+   slock_lock(async->lock);
+   async->count++;
+   scond_signal(async->cond);
+   slock_unlock(async->lock);
+}
+#endif
+
+/* Serializes the core next to the pending checkpoint in cur_save and
+   returns true if the two match; mismatches are counted as desyncs. */
+static bool bsv_movie_verify_checkpoint(bsv_movie_t *handle)
+{
+   retro_ctx_serialize_info_t serial_info;
+   input_driver_state_t *input_st = input_state_get_ptr();
+   serial_info.size = core_serialize_size();
+   if (!(serial_info.data = bsv_movie_load_buffer(&handle->verify_save,
+               &handle->verify_save_cap, MAX(serial_info.size, 1))))
+      return false;
+   handle->verified_checkpoints++;
+   if (     serial_info.size == handle->cur_save_size
+         && core_serialize(&serial_info)
+         && !memcmp(serial_info.data, handle->cur_save, serial_info.size))
+      return true;
+   if (!handle->desyncs++)
+      handle->first_desync_frame = (int64_t)handle->frame_counter;
+   input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_DESYNC;
+   RARCH_WARN("[Replay] Desync at frame %lld, reloading checkpoint.\n",
+         (long long)handle->frame_counter);
+   return false;
+}
+
 bool bsv_movie_read_next_events(bsv_movie_t *handle,
       replay_checkpoint_behavior checkpoint_behavior, bool end_movie)
 {
    input_driver_state_t *input_st  = input_state_get_ptr();
-   if (handle->checkpoint_ready)
+   /* A verified checkpoint that matches needs no reload; one that
+      doesn't is loaded so later checkpoints are judged on their own. */
+   if (     handle->checkpoint_ready
+         && !(handle->checkpoint_verify
+            && bsv_movie_verify_checkpoint(handle)))
    {
       retro_ctx_serialize_info_t serial_info;
       handle->checkpoint_ready = false;
@@ -815,6 +1617,7 @@ bool bsv_movie_read_next_events(bsv_movie_t *handle,
          return false;
       }
    }
+   handle->checkpoint_ready = false;
    /* Skip over backref */
    if (handle->version > 1)
       intfstream_seek(handle->file, sizeof(uint32_t), SEEK_CUR);
@@ -894,7 +1697,8 @@ bool bsv_movie_read_next_events(bsv_movie_t *handle,
             return false;
          }
          size = swap_if_big64(size);
-         if (checkpoint_behavior != REPLAY_CPBEHAVIOR_DESERIALIZE)
+         if (     checkpoint_behavior != REPLAY_CPBEHAVIOR_DESERIALIZE
+               && checkpoint_behavior != REPLAY_CPBEHAVIOR_VERIFY)
             intfstream_seek(handle->file, size, SEEK_CUR);
          else
          {
@@ -914,8 +1718,9 @@ bool bsv_movie_read_next_events(bsv_movie_t *handle,
                handle->cur_save = NULL;
                return false;
             }
-            handle->cur_save_size = size;
-            handle->checkpoint_ready = true;
+            handle->cur_save_size     = size;
+            handle->checkpoint_ready  = true;
+            handle->checkpoint_verify = (checkpoint_behavior == REPLAY_CPBEHAVIOR_VERIFY);
          }
       }
       else if (next_frame_type == REPLAY_TOKEN_CHECKPOINT2_FRAME)
@@ -990,72 +1795,54 @@ void bsv_movie_next_frame(input_driver_state_t *input_st)
 
    if (!handle->playback && !(input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_SEEKING))
    {
-      int i;
-      uint16_t evt_count     = swap_if_big16(handle->input_event_count);
-      size_t last_pos        = handle->frame_pos[(MAX(handle->frame_counter,2)-2) & handle->frame_mask];
-      size_t cur_pos         = intfstream_tell(handle->file);
-      uint32_t back_distance = swap_if_big32((uint32_t)(cur_pos-last_pos));
-      /* write backref */
-      intfstream_write(handle->file, &back_distance, sizeof(uint32_t));
-      /* write key events, frame is over */
-      intfstream_write(handle->file, &(handle->key_event_count), 1);
-      for (i = 0; i < handle->key_event_count; i++)
-         intfstream_write(handle->file, &(handle->key_events[i]),
-               sizeof(bsv_key_data_t));
-      /* Zero out key events when playing back or recording */
-      handle->key_event_count = 0;
-      /* write input events, frame is over */
-      intfstream_write(handle->file, &evt_count, 2);
-      for (i = 0; i < handle->input_event_count; i++)
-         intfstream_write(handle->file, &(handle->input_events[i]),
-               sizeof(bsv_input_data_t));
-      /* Zero out input events when playing back or recording */
-      handle->input_event_count = 0;
-
+      uint8_t compression = handle->checkpoint_compression;
+#if HAVE_STATESTREAM
+      uint8_t encoding    = REPLAY_CHECKPOINT2_ENCODING_STATESTREAM;
+#else
+      uint8_t encoding    = REPLAY_CHECKPOINT2_ENCODING_RAW;
+#endif
       /* Maybe record checkpoint */
-      if (     (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_FORCE_CHECKPOINT)
+      bool checkpoint     =
+               (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_FORCE_CHECKPOINT)
             || ((checkpoint_interval != 0)
             && (handle->frame_counter > 0)
-            && (handle->frame_counter % (checkpoint_interval*60) == 0)))
-      {
-         uint8_t frame_tok   = REPLAY_TOKEN_CHECKPOINT2_FRAME;
-         uint8_t compression = handle->checkpoint_compression;
-#if HAVE_STATESTREAM
-         uint8_t encoding    = REPLAY_CHECKPOINT2_ENCODING_STATESTREAM;
-#else
-         uint8_t encoding    = REPLAY_CHECKPOINT2_ENCODING_RAW;
+            && (handle->frame_counter % (checkpoint_interval*60) == 0));
+      input_st->bsv_movie_state.flags &= ~BSV_FLAG_MOVIE_FORCE_CHECKPOINT;
+      if (checkpoint)
+         performance_trace_begin(PERF_TRACE_REPLAY_CHECKPOINT);
+#ifdef HAVE_THREADS
+      if (handle->async)
+         bsv_movie_async_push_frame(handle, checkpoint, compression, encoding);
+      else
 #endif
-         input_st->bsv_movie_state.flags &= ~BSV_FLAG_MOVIE_FORCE_CHECKPOINT;
-         /* "next frame is a checkpoint" */
-         intfstream_write(handle->file, (uint8_t *)(&frame_tok), sizeof(uint8_t));
-         /* compression and encoding schemes */
-         intfstream_write(handle->file, (uint8_t *)(&compression), sizeof(uint8_t));
-         intfstream_write(handle->file, (uint8_t *)(&encoding), sizeof(uint8_t));
-         if (bsv_movie_write_checkpoint(handle, compression, encoding) < 0)
+      {
+         uint8_t record[BSV_FRAME_RECORD_MAX_SIZE];
+         size_t record_len = bsv_movie_build_frame_record(handle, record,
+               checkpoint ? REPLAY_TOKEN_CHECKPOINT2_FRAME : REPLAY_TOKEN_REGULAR_FRAME,
+               compression, encoding);
+         size_t state_size = checkpoint ? bsv_movie_serialize_cur_save(handle) : 0;
+         if (!bsv_movie_write_frame_record(handle, handle->frame_counter,
+                  record, record_len, state_size, compression, encoding))
          {
             RARCH_ERR("[Replay] failed to write checkpoint, exiting record\n");
             input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
          }
       }
-      else
-      {
-         uint8_t frame_tok = REPLAY_TOKEN_REGULAR_FRAME;
-         /* write "next frame is not a checkpoint" */
-         intfstream_write(handle->file, (uint8_t *)(&frame_tok), sizeof(uint8_t));
-      }
-      /* To support seeking forwards during a paused replay, we would
-         need to *not* truncate here if we are in the "just paused,
-         running a frame to get the updated image, then will pause
-         again" state. */
-      intfstream_truncate(handle->file, intfstream_tell(handle->file));
+      if (checkpoint)
+         performance_trace_end(PERF_TRACE_REPLAY_CHECKPOINT);
    }
    else /* either playback or seeking while recording */
    {
-      bsv_movie_read_next_events(handle, checkpoint_deserialize ? REPLAY_CPBEHAVIOR_DESERIALIZE : REPLAY_CPBEHAVIOR_UPDATE, true);
+      replay_checkpoint_behavior behavior = checkpoint_deserialize
+            ? REPLAY_CPBEHAVIOR_DESERIALIZE : REPLAY_CPBEHAVIOR_UPDATE;
+      if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_VERIFY)
+         behavior = REPLAY_CPBEHAVIOR_VERIFY;
+      bsv_movie_async_flush(handle);
+      bsv_movie_read_next_events(handle, behavior, true);
       /* clear seeking flag since we did read one frame */
       input_st->bsv_movie_state.flags &= ~BSV_FLAG_MOVIE_SEEKING;
+      handle->frame_pos[handle->frame_counter & handle->frame_mask] = intfstream_tell(handle->file);
    }
-   handle->frame_pos[handle->frame_counter & handle->frame_mask] = intfstream_tell(handle->file);
 
    if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_SEEK_TO_FRAME)
    {
@@ -1114,7 +1901,10 @@ size_t replay_get_serialize_size(void)
 {
    input_driver_state_t *input_st = input_state_get_ptr();
    if (input_st->bsv_movie_state.flags & (BSV_FLAG_MOVIE_RECORDING | BSV_FLAG_MOVIE_PLAYBACK))
+   {
+      bsv_movie_async_flush(input_st->bsv_movie_state_handle);
       return sizeof(int32_t)+intfstream_tell(input_st->bsv_movie_state_handle->file);
+   }
    return 0;
 }
 
@@ -1125,10 +1915,12 @@ bool replay_get_serialized_data(void* buffer)
 
    if (input_st->bsv_movie_state.flags & (BSV_FLAG_MOVIE_RECORDING | BSV_FLAG_MOVIE_PLAYBACK))
    {
-      int32_t file_end        = (uint32_t)intfstream_tell(handle->file);
+      int32_t file_end, file_end_;
       int64_t read_amt        = 0;
-      int32_t file_end_       = swap_if_big32(file_end);
       uint8_t *buf;
+      bsv_movie_async_flush(handle);
+      file_end                = (uint32_t)intfstream_tell(handle->file);
+      file_end_               = swap_if_big32(file_end);
       ((uint32_t *)buffer)[0] = file_end_;
       buf                     = ((uint8_t *)buffer) + sizeof(uint32_t);
       intfstream_rewind(handle->file);
@@ -1334,6 +2126,7 @@ bool replay_set_serialized_data(void *buf)
 
    if (!handle)
       return false;
+   bsv_movie_async_flush(handle);
    handle->cur_save_valid = false;
    if (!buffer)
    {
@@ -1413,6 +2206,22 @@ bool replay_set_serialized_data(void *buf)
 #endif
             intfstream_rewind(handle->file);
             intfstream_write(handle->file, header, loaded_len);
+            /* The frames are now the loaded movie's */
+            bsv_index_free(handle->index);
+            handle->index = NULL;
+#ifdef HAVE_ZSTD
+            /* And so is the initial checkpoint; keep compressing
+               against it if this recording was doing so. */
+            bsv_movie_free_dictionaries(handle);
+            if (     handle->checkpoint_dictionary
+                  && bsv_movie_load_dictionary(handle))
+            {
+               handle->save_dict      = handle->load_dict;
+               handle->save_dict_size = handle->load_dict_size;
+               handle->load_dict      = NULL;
+               handle->load_dict_size = 0;
+            }
+#endif
             /* also need to update/reinit frame_pos,
                frame_counter--rewind won't work properly unless we do. */
             /* TODO: in the future, if same_timeline, don't clear
@@ -1435,7 +2244,7 @@ bool replay_set_serialized_data(void *buf)
             /* TODO use backrefs to help here */
             bsv_movie_scan_from_start(handle, loaded_len);
             if (recording)
-               intfstream_truncate(handle->file, loaded_len);
+               bsv_movie_truncate(handle, loaded_len);
          }
       }
       else
@@ -1504,22 +2313,95 @@ int16_t bsv_movie_read_state(input_driver_state_t *input_st,
 }
 
 #ifdef HAVE_STATESTREAM
-int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state,
-      size_t state_size, uint8_t *output, size_t output_capacity)
+/* States with fewer full blocks than this are scanned on the
+   encoding thread alone. */
+#define BSV_PARALLEL_SCAN_MIN_BLOCKS 64
+#define BSV_PARALLEL_SCAN_MAX_THREADS 16
+
+/* One slice of the change detection pass over a state */
+typedef struct bsv_block_scan
+{
+   const uint8_t *state;
+   const uint8_t *last_save; /* NULL when there is nothing to compare with */
+   uint32_t *hashes;
+   uint8_t *unchanged;
+   size_t block_byte_size;
+   size_t first_block;
+   size_t end_block;
+} bsv_block_scan_t;
+
+static void bsv_movie_scan_blocks(void *data)
+{
+   size_t i;
+   bsv_block_scan_t *scan = (bsv_block_scan_t*)data;
+   for (i = scan->first_block; i < scan->end_block; i++)
+   {
+      size_t offset = i * scan->block_byte_size;
+      scan->unchanged[i] = uint32s_hash_compare(
+            (const uint32_t*)(scan->state + offset),
+            scan->last_save
+            ? (const uint32_t*)(scan->last_save + offset)
+            : NULL,
+            scan->block_byte_size, &scan->hashes[i]);
+   }
+}
+
+/* Fills in hashes[] and unchanged[] for the first block_count blocks of
+   state.  Large states are cut into runs of whole superblocks which are
+   handed to the movie's thread pool. */
+static void bsv_movie_scan_state(bsv_movie_t *movie,
+      const uint8_t *state, const uint8_t *last_save,
+      size_t block_byte_size, size_t superblock_size, size_t block_count,
+      uint32_t *hashes, uint8_t *unchanged)
+{
+   bsv_block_scan_t whole;
+   whole.state           = state;
+   whole.last_save       = last_save;
+   whole.hashes          = hashes;
+   whole.unchanged       = unchanged;
+   whole.block_byte_size = block_byte_size;
+   whole.first_block     = 0;
+   whole.end_block       = block_count;
+#ifdef HAVE_THREADS
+   if (block_count >= BSV_PARALLEL_SCAN_MIN_BLOCKS && !movie->encode_pool)
+   {
+      unsigned cores = cpu_features_get_core_amount();
+      if (cores > 1)
+      {
+         movie->encode_threads = MIN(cores, BSV_PARALLEL_SCAN_MAX_THREADS);
+         movie->encode_pool    = tpool_create(movie->encode_threads);
+      }
+   }
+   if (block_count >= BSV_PARALLEL_SCAN_MIN_BLOCKS && movie->encode_pool)
+   {
+      size_t i;
+      bsv_block_scan_t jobs[BSV_PARALLEL_SCAN_MAX_THREADS * 2];
+      /* A couple of slices per thread evens out the load */
+      size_t job_count   = movie->encode_threads * 2;
+      size_t superblocks = (block_count + superblock_size - 1) / superblock_size;
+      size_t per_job     = ((superblocks + job_count - 1) / job_count) * superblock_size;
+      for (i = 0; i < job_count; i++)
+      {
+         jobs[i]             = whole;
+         jobs[i].first_block = MIN(i * per_job, block_count);
+         jobs[i].end_block   = MIN((i + 1) * per_job, block_count);
+         if (jobs[i].first_block < jobs[i].end_block)
+            tpool_add_work(movie->encode_pool, bsv_movie_scan_blocks, &jobs[i]);
+      }
+      tpool_wait(movie->encode_pool);
+      return;
+   }
+#endif
+   bsv_movie_scan_blocks(&whole);
+}
+
+int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint64_t frame,
+      uint8_t *state, size_t state_size, uint8_t *output, size_t output_capacity)
 {
    uint32_t i;
    int64_t encoded_size;
    size_t superblock, block;
-   static uint32_t skipped_blocks     = 0;
-   static uint32_t memcmps            = 0, hashes = 0;
-   static uint32_t reused_blocks      = 0;
-   static uint32_t reused_superblocks = 0;
-   static uint32_t total_blocks       = 0;
-   static uint32_t total_superblocks  = 0;
-   static uint32_t total_checkpoints  = 0;
-   static uint32_t total_kbs_input    = 0;
-   static uint32_t total_kbs_written  = 0;
-   static retro_perf_tick_t total_encode_micros = 0;
+   struct bsv_statestream_stats *stats = &movie->stats;
    retro_perf_tick_t start     = cpu_features_get_time_usec();
    size_t block_byte_size      = movie->blocks->object_size*4;
    size_t superblock_size      = movie->superblocks->object_size;
@@ -1530,6 +2412,9 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state,
    intfstream_t *out_stream    = intfstream_open_writable_memory(output,
          RETRO_VFS_FILE_ACCESS_READ_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE,
          output_capacity);
+   size_t full_blocks          = state_size / block_byte_size;
+   uint32_t *scan_hashes       = (uint32_t*)malloc(MAX(full_blocks, 1) * sizeof(uint32_t));
+   uint8_t *scan_unchanged     = (uint8_t*)malloc(MAX(full_blocks, 1));
    bool can_compare_saves = movie->cur_save_valid && movie->last_save
       && movie->last_save_size >= state_size;
    if (movie->last_save_size < state_size)
@@ -1542,36 +2427,37 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state,
       movie->cur_save_valid = false;
       movie->superblock_seq = (uint32_t*)calloc(superblock_count, sizeof(uint32_t));
    }
+   /* Change detection and hashing only read the state and last_save,
+      so every full block is handled up front (in parallel for large
+      states); the indices and the output below are still updated
+      strictly in block order, which keeps the stream deterministic. */
+   bsv_movie_scan_state(movie, state,
+         can_compare_saves ? movie->last_save : NULL,
+         block_byte_size, superblock_size, full_blocks,
+         scan_hashes, scan_unchanged);
+   stats->bytes_scanned += full_blocks * block_byte_size;
+   if (can_compare_saves)
+      stats->compares   += (uint32_t)full_blocks;
    rmsgpack_write_int(out_stream, BSV_IFRAME_START_TOKEN);
-   rmsgpack_write_int(out_stream, movie->frame_counter);
+   rmsgpack_write_int(out_stream, frame);
    for (superblock = 0; superblock < superblock_count; superblock++)
    {
       uint32s_insert_result_t found_block;
-      total_superblocks++;
+      stats->superblocks++;
       for (block = 0; block < superblock_size; block++)
       {
          size_t block_start = superblock*superblock_byte_size+block*block_byte_size;
-         size_t block_end = MIN(block_start + block_byte_size, state_size);
          if (block_start > state_size)
          {
             /* pad superblocks with zero blocks */
             found_block.index  = 0;
             found_block.is_new = false;
          }
-         else if (   can_compare_saves
-                  && (++memcmps)
+         else if (block_start + block_byte_size > state_size
+               && !(can_compare_saves
+                  && (++stats->compares)
                   && memcmp(movie->last_save + block_start,
-                         state + block_start,
-                         block_end-block_start) == 0)
-         {
-            skipped_blocks++;
-            found_block.index = uint32s_index_get(movie->superblocks,
-                  movie->superblock_seq[superblock])[block];
-            found_block.is_new = false;
-            /* bump usage count */
-            uint32s_index_bump_count(movie->blocks, found_block.index);
-         }
-         else if (block_start + block_byte_size > state_size)
+                        state + block_start, state_size - block_start) == 0))
          {
             if (!padded_block)
                padded_block = (uint8_t*)calloc(block_byte_size, sizeof(uint8_t));
@@ -1581,17 +2467,31 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state,
             memcpy(padded_block, state+block_start, state_size - block_start);
             found_block = uint32s_index_insert(movie->blocks,
                   (uint32_t*)padded_block,
-                  movie->frame_counter);
-            hashes++;
+                  frame);
+            stats->hashes++;
          }
          else
          {
-            hashes++;
-            found_block = uint32s_index_insert(movie->blocks,
-                  (uint32_t*)(state+block_start),
-                  movie->frame_counter);
+            /* A short final block only gets here if it was already
+               found unchanged. */
+            size_t block_idx = superblock*superblock_size + block;
+            if (block_idx >= full_blocks || scan_unchanged[block_idx])
+            {
+               stats->skipped_blocks++;
+               found_block.index = uint32s_index_get(movie->superblocks,
+                     movie->superblock_seq[superblock])[block];
+               found_block.is_new = false;
+               /* bump usage count */
+               uint32s_index_bump_count(movie->blocks, found_block.index);
+            }
+            else
+            {
+               stats->hashes++;
+               found_block = uint32s_index_insert_hashed(movie->blocks,
+                     (uint32_t*)(state+block_start), scan_hashes[block_idx], frame);
+            }
          }
-         total_blocks++;
+         stats->blocks++;
 
          if (found_block.is_new)
          {
@@ -1602,10 +2502,10 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state,
             rmsgpack_write_bin(out_stream, state+block_start, (uint32_t)block_byte_size);
          }
          else
-            reused_blocks++;
+            stats->reused_blocks++;
          superblock_buf[block] = found_block.index;
       }
-      found_block = uint32s_index_insert(movie->superblocks, superblock_buf, movie->frame_counter);
+      found_block = uint32s_index_insert(movie->superblocks, superblock_buf, frame);
       if (found_block.is_new)
       {
          /* write "here is a new superblock" and new superblock to file */
@@ -1617,12 +2517,25 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state,
             rmsgpack_write_int(out_stream, superblock_buf[i]);
       }
       else
-         reused_superblocks++;
+         stats->reused_superblocks++;
       movie->superblock_seq[superblock] = found_block.index;
    }
    uint32s_index_commit(movie->blocks);
    /* Superblocks are small enough that there's no real benefit to garbage collecting them */
    /* uint32s_index_commit(movie->superblocks); */
+   if (movie->index_budget)
+   {
+      /* Only this side forgets; players keep every block and superblock,
+         so an evicted one is just written again if it comes back.  The
+         current sequence's superblocks are needed by the next checkpoint. */
+      size_t superblock_bytes;
+      uint32s_index_evict(movie->superblocks, movie->index_budget / 8,
+            movie->superblock_seq, superblock_count);
+      superblock_bytes = uint32s_index_bytes(movie->superblocks);
+      uint32s_index_evict(movie->blocks,
+            movie->index_budget > superblock_bytes
+            ? movie->index_budget - superblock_bytes : 0, NULL, 0);
+   }
    /* write "here is the superblock seq" and superblock seq to file */
    rmsgpack_write_int(out_stream, BSV_IFRAME_SUPERBLOCK_SEQ_TOKEN);
    /* Cast is fine, we won't have billions of superblocks */
@@ -1630,16 +2543,19 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state,
    for (i = 0; i < superblock_count; i++)
        rmsgpack_write_int(out_stream, movie->superblock_seq[i]);
    free(superblock_buf);
+   free(scan_hashes);
+   free(scan_unchanged);
    if (padded_block)
      free(padded_block);
    movie->cur_save_valid = true;
-   total_checkpoints++;
-   total_encode_micros += cpu_features_get_time_usec() - start;
-   total_kbs_input     += state_size / 1024;
-   encoded_size         = intfstream_tell(out_stream);
-   total_kbs_written   += encoded_size / 1024;
-   RARCH_DBG("[STATESTREAM] Encode stats at checkpoint %d: %d blocks (%d reused, %d skipped [%d checks], %d distinct [%d hashes])\n", total_checkpoints, total_blocks, reused_blocks, skipped_blocks, memcmps, uint32s_index_count(movie->blocks), hashes);
-   RARCH_DBG("[STATESTREAM] %d superblocks (%d reused, %d distinct); unencoded size (KB) %d, encoded size (KB) %d; net time (secs) %f\n", total_superblocks, reused_superblocks, uint32s_index_count(movie->superblocks), total_kbs_input, total_kbs_written, ((float)total_encode_micros) / (float)1000000.0);
+   stats->checkpoints++;
+   stats->encode_micros += cpu_features_get_time_usec() - start;
+   stats->kbs_input     += state_size / 1024;
+   encoded_size          = intfstream_tell(out_stream);
+   stats->kbs_written   += encoded_size / 1024;
+   RARCH_DBG("[STATESTREAM] Encode stats at checkpoint %d: %d blocks (%d reused, %d skipped [%d checks], %d distinct [%d hashes]), %llu KB scanned\n", stats->checkpoints, stats->blocks, stats->reused_blocks, stats->skipped_blocks, stats->compares, uint32s_index_count(movie->blocks), stats->hashes, (unsigned long long)(stats->bytes_scanned / 1024));
+   RARCH_DBG("[STATESTREAM] %d superblocks (%d reused, %d distinct); unencoded size (KB) %d, encoded size (KB) %d; net time (secs) %f\n", stats->superblocks, stats->reused_superblocks, uint32s_index_count(movie->superblocks), stats->kbs_input, stats->kbs_written, ((float)stats->encode_micros) / (float)1000000.0);
+   RARCH_DBG("[STATESTREAM] Index: %u live blocks (%u collected, %u evicted), %u live superblocks (%u evicted); %u KB resident\n", movie->blocks->live, movie->blocks->collected, movie->blocks->evicted, movie->superblocks->live, movie->superblocks->evicted, (unsigned)((uint32s_index_bytes(movie->blocks) + uint32s_index_bytes(movie->superblocks)) / 1024));
    intfstream_close(out_stream);
    return encoded_size;
 }
@@ -1648,8 +2564,6 @@ bool bsv_movie_read_deduped_state(bsv_movie_t *movie, uint8_t *encoded, size_t e
 {
    size_t i;
    struct rmsgpack_dom_value item;
-   static retro_perf_tick_t total_decode_micros = 0;
-   static retro_perf_tick_t total_decode_count  = 0;
    retro_perf_tick_t start = cpu_features_get_time_usec();
    bool ret                = false;
    size_t state_size       = movie->cur_save_size;
@@ -1667,7 +2581,7 @@ bool bsv_movie_read_deduped_state(bsv_movie_t *movie, uint8_t *encoded, size_t e
       RARCH_ERR("[STATESTREAM] movie has no current serialized save\n");
       goto exit;
    }
-   total_decode_count++;
+   movie->stats.decodes++;
    rmsgpack_dom_read_with(read_mem, &item, reader_state);
    if (item.type != RDT_INT && item.type != RDT_UINT)
    {
@@ -1837,8 +2751,8 @@ exit:
       RARCH_ERR("[STATESTREAM] made it to end without superblock seq\n");
       return false;
    }
-   total_decode_micros += cpu_features_get_time_usec() - start;
-   RARCH_DBG("[STATESTREAM] Total statestream decodes %d ; net time (secs): %f\n", total_decode_count, (double)total_decode_micros / (1000000.0));
+   movie->stats.decode_micros += cpu_features_get_time_usec() - start;
+   RARCH_DBG("[STATESTREAM] Total statestream decodes %d ; net time (secs): %f\n", movie->stats.decodes, (double)movie->stats.decode_micros / (1000000.0));
    return ret;
 }
 #endif
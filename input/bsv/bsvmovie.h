@@ -57,6 +57,26 @@ bool bsv_movie_load_checkpoint(bsv_movie_t *movie,
       replay_checkpoint_behavior cpbehavior);
 int64_t bsv_movie_write_checkpoint(bsv_movie_t *movie,
       uint8_t compression, uint8_t encoding);
+/* Releases the buffers and (de)compression contexts kept between
+   checkpoints */
+void bsv_movie_codec_free(bsv_movie_t *movie);
+/* Writes out a recording's frame index next to it */
+void bsv_movie_save_index(bsv_movie_t *movie);
+
+#ifdef HAVE_STATESTREAM
+/* Encodes state against movie's block indices, updating them, and
+   returns the number of bytes written to output */
+int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint64_t frame,
+      uint8_t *state, size_t state_size, uint8_t *output, size_t output_capacity);
+#endif
+
+#ifdef HAVE_THREADS
+bool bsv_movie_async_init(bsv_movie_t *movie);
+void bsv_movie_async_flush(bsv_movie_t *movie);
+void bsv_movie_async_free(bsv_movie_t *movie);
+#else
+#define bsv_movie_async_flush(movie) ((void)0)
+#endif
 
 RETRO_END_DECLS
 
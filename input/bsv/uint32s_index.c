@@ -25,9 +25,182 @@
 #define XXH_INLINE_ALL
 #include <xxHash/xxhash.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
 #define HASHMAP_CAP 65536
 #define uint32s_hash_bytes(bytes, len) XXH32(bytes,len,0)
 
+#define UINT32S_PRIME32_1 0x9E3779B1U
+#define UINT32S_PRIME32_2 0x85EBCA77U
+#define UINT32S_PRIME32_3 0xC2B2AE3DU
+#define UINT32S_PRIME32_4 0x27D4EB2FU
+#define UINT32S_PRIME32_5 0x165667B1U
+#define UINT32S_ROTL32(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+#if !defined(MSB_FIRST) && (defined(__AVX2__) || defined(__SSE2__) \
+      || defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON))
+#define UINT32S_HAVE_SIMD_HASH
+#endif
+
+#ifdef UINT32S_HAVE_SIMD_HASH
+/* XXH32 consumes the input as four interleaved 32-bit lanes, which maps
+ * directly onto one 128-bit vector.  This finishes the hash the same way
+ * XXH32 does once the lane accumulators have been computed, so the
+ * result is bit-identical to uint32s_hash_bytes. */
+static uint32_t uint32s_hash_finalize(const uint32_t acc[4],
+      const uint8_t *tail, size_t tail_len, size_t len)
+{
+   uint32_t h32 = UINT32S_ROTL32(acc[0], 1)  + UINT32S_ROTL32(acc[1], 7)
+                + UINT32S_ROTL32(acc[2], 12) + UINT32S_ROTL32(acc[3], 18);
+   h32 += (uint32_t)len;
+   while (tail_len >= 4)
+   {
+      uint32_t word;
+      memcpy(&word, tail, sizeof(word));
+      h32      += word * UINT32S_PRIME32_3;
+      h32       = UINT32S_ROTL32(h32, 17) * UINT32S_PRIME32_4;
+      tail     += 4;
+      tail_len -= 4;
+   }
+   while (tail_len--)
+   {
+      h32 += (*tail++) * UINT32S_PRIME32_5;
+      h32  = UINT32S_ROTL32(h32, 11) * UINT32S_PRIME32_1;
+   }
+   h32 ^= h32 >> 15;
+   h32 *= UINT32S_PRIME32_2;
+   h32 ^= h32 >> 13;
+   h32 *= UINT32S_PRIME32_3;
+   h32 ^= h32 >> 16;
+   return h32;
+}
+#endif
+
+#if defined(__SSE2__) && !defined(__AVX2__) && defined(UINT32S_HAVE_SIMD_HASH)
+/* SSE2 has no 32-bit low multiply; build it from two 32x32->64 ones. */
+static INLINE __m128i uint32s_mullo_sse2(__m128i a, __m128i b)
+{
+   __m128i even = _mm_mul_epu32(a, b);
+   __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+   return _mm_unpacklo_epi32(
+         _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+         _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+bool uint32s_hash_compare(const uint32_t *cur, const uint32_t *prev,
+      size_t len, uint32_t *out_hash)
+{
+#ifdef UINT32S_HAVE_SIMD_HASH
+   uint32_t acc_out[4];
+   const uint8_t *a = (const uint8_t*)cur;
+   const uint8_t *b = (const uint8_t*)prev;
+   size_t i         = 0;
+   bool same;
+   if (len < 16)
+   {
+      *out_hash = uint32s_hash_bytes(a, len);
+      return prev && memcmp(a, b, len) == 0;
+   }
+#if defined(__AVX2__)
+   {
+      const __m128i p1 = _mm_set1_epi32((int)UINT32S_PRIME32_1);
+      const __m128i p2 = _mm_set1_epi32((int)UINT32S_PRIME32_2);
+      __m128i acc      = _mm_setr_epi32(
+            (int)(UINT32S_PRIME32_1 + UINT32S_PRIME32_2),
+            (int)UINT32S_PRIME32_2, 0, (int)(0U - UINT32S_PRIME32_1));
+      __m256i diff     = _mm256_setzero_si256();
+      __m128i diff128  = _mm_setzero_si128();
+#define UINT32S_XXH_ROUND(acc, lanes) \
+      acc = _mm_add_epi32(acc, _mm_mullo_epi32(lanes, p2)); \
+      acc = _mm_or_si128(_mm_slli_epi32(acc, 13), _mm_srli_epi32(acc, 19)); \
+      acc = _mm_mullo_epi32(acc, p1)
+      for (; i + 32 <= len; i += 32)
+      {
+         __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+         if (prev)
+            diff    = _mm256_or_si256(diff, _mm256_xor_si256(va,
+                     _mm256_loadu_si256((const __m256i*)(b + i))));
+         UINT32S_XXH_ROUND(acc, _mm256_castsi256_si128(va));
+         UINT32S_XXH_ROUND(acc, _mm256_extracti128_si256(va, 1));
+      }
+      for (; i + 16 <= len; i += 16)
+      {
+         __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+         if (prev)
+            diff128 = _mm_or_si128(diff128, _mm_xor_si128(va,
+                     _mm_loadu_si128((const __m128i*)(b + i))));
+         UINT32S_XXH_ROUND(acc, va);
+      }
+#undef UINT32S_XXH_ROUND
+      diff128 = _mm_or_si128(diff128, _mm_or_si128(
+               _mm256_castsi256_si128(diff), _mm256_extracti128_si256(diff, 1)));
+      same    = prev && _mm_movemask_epi8(
+            _mm_cmpeq_epi8(diff128, _mm_setzero_si128())) == 0xFFFF;
+      _mm_storeu_si128((__m128i*)acc_out, acc);
+   }
+#elif defined(__SSE2__)
+   {
+      const __m128i p1 = _mm_set1_epi32((int)UINT32S_PRIME32_1);
+      const __m128i p2 = _mm_set1_epi32((int)UINT32S_PRIME32_2);
+      __m128i acc      = _mm_setr_epi32(
+            (int)(UINT32S_PRIME32_1 + UINT32S_PRIME32_2),
+            (int)UINT32S_PRIME32_2, 0, (int)(0U - UINT32S_PRIME32_1));
+      __m128i diff     = _mm_setzero_si128();
+      for (; i + 16 <= len; i += 16)
+      {
+         __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+         if (prev)
+            diff = _mm_or_si128(diff, _mm_xor_si128(va,
+                     _mm_loadu_si128((const __m128i*)(b + i))));
+         acc = _mm_add_epi32(acc, uint32s_mullo_sse2(va, p2));
+         acc = _mm_or_si128(_mm_slli_epi32(acc, 13), _mm_srli_epi32(acc, 19));
+         acc = uint32s_mullo_sse2(acc, p1);
+      }
+      same = prev && _mm_movemask_epi8(
+            _mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xFFFF;
+      _mm_storeu_si128((__m128i*)acc_out, acc);
+   }
+#else /* NEON */
+   {
+      static const uint32_t seed[4] = {
+         UINT32S_PRIME32_1 + UINT32S_PRIME32_2,
+         UINT32S_PRIME32_2, 0, 0U - UINT32S_PRIME32_1 };
+      uint32x4_t acc  = vld1q_u32(seed);
+      uint32x4_t diff = vdupq_n_u32(0);
+      uint32x2_t fold;
+      for (; i + 16 <= len; i += 16)
+      {
+         uint32x4_t va = vreinterpretq_u32_u8(vld1q_u8(a + i));
+         if (prev)
+            diff = vorrq_u32(diff, veorq_u32(va,
+                     vreinterpretq_u32_u8(vld1q_u8(b + i))));
+         acc = vmlaq_n_u32(acc, va, UINT32S_PRIME32_2);
+         acc = vsriq_n_u32(vshlq_n_u32(acc, 13), acc, 19);
+         acc = vmulq_n_u32(acc, UINT32S_PRIME32_1);
+      }
+      fold = vorr_u32(vget_low_u32(diff), vget_high_u32(diff));
+      same = prev && (vget_lane_u32(fold, 0) | vget_lane_u32(fold, 1)) == 0;
+      vst1q_u32(acc_out, acc);
+   }
+#endif
+   /* Bytes past the last full stripe still have to be compared */
+   if (same && i < len)
+      same = memcmp(a + i, b + i, len - i) == 0;
+   *out_hash = uint32s_hash_finalize(acc_out, a + i, len - i, len);
+   return same;
+#else
+   *out_hash = uint32s_hash_bytes((const uint8_t*)cur, len);
+   return prev && memcmp(cur, prev, len) == 0;
+#endif
+}
+
 uint32s_index_t *uint32s_index_new(size_t object_size,
       uint8_t commit_interval, uint8_t commit_threshold)
 {
@@ -40,6 +213,11 @@ uint32s_index_t *uint32s_index_new(size_t object_size,
    index->counts           = NULL;
    index->hashes           = NULL;
    index->additions        = NULL;
+   index->free_slots       = NULL;
+   index->live             = 0;
+   index->collected        = 0;
+   index->evicted          = 0;
+   index->evict_cursor     = 1;
    index->commit_interval  = commit_interval;
    index->commit_threshold = commit_threshold;
    /* transfers ownership of zero buffer */
@@ -119,14 +297,41 @@ bool uint32s_bucket_remove(struct uint32s_bucket *bucket, uint32_t idx)
    return false;
 }
 
+/* Stores object under a released index if there is one, else appends it */
+static uint32_t uint32s_index_push_object(uint32s_index_t *index,
+      uint32_t *object, uint32_t hash)
+{
+   uint32_t idx;
+   index->live++;
+   if (RBUF_LEN(index->free_slots) == 0)
+   {
+      idx = RBUF_LEN(index->objects);
+      RBUF_PUSH(index->objects, object);
+      RBUF_PUSH(index->counts, 1);
+      RBUF_PUSH(index->hashes, hash);
+      return idx;
+   }
+   idx                 = RBUF_POP(index->free_slots);
+   index->objects[idx] = object;
+   index->counts[idx]  = 1;
+   index->hashes[idx]  = hash;
+   return idx;
+}
+
 uint32s_insert_result_t uint32s_index_insert(uint32s_index_t *index, uint32_t *object, uint64_t frame)
+{
+   size_t size_bytes = index->object_size * sizeof(uint32_t);
+   return uint32s_index_insert_hashed(index, object,
+         uint32s_hash_bytes((uint8_t *)object, size_bytes), frame);
+}
+
+uint32s_insert_result_t uint32s_index_insert_hashed(uint32s_index_t *index, uint32_t *object, uint32_t hash, uint64_t frame)
 {
    uint32_t idx;
    uint32_t *copy;
    struct uint32s_bucket *bucket;
    uint32s_insert_result_t result;
    size_t size_bytes      = index->object_size * sizeof(uint32_t);
-   uint32_t hash          = uint32s_hash_bytes((uint8_t *)object, size_bytes);
    uint32_t additions_len = RBUF_LEN(index->additions);
    result.index  = 0;
    result.is_new = false;
@@ -144,12 +349,9 @@ uint32s_insert_result_t uint32s_index_insert(uint32s_index_t *index, uint32_t *o
 
          RARCH_LOG("[STATESTREAM] accessed collected index %d\n",result.index);
       }
-      idx  = RBUF_LEN(index->objects);
       copy = (uint32_t*)malloc(size_bytes);
       memcpy(copy, object, size_bytes);
-      RBUF_PUSH(index->objects, copy);
-      RBUF_PUSH(index->counts, 1);
-      RBUF_PUSH(index->hashes, hash);
+      idx  = uint32s_index_push_object(index, copy, hash);
       result.index = idx;
       result.is_new = true;
       uint32s_bucket_expand(bucket, idx);
@@ -157,12 +359,9 @@ uint32s_insert_result_t uint32s_index_insert(uint32s_index_t *index, uint32_t *o
    else
    {
       struct uint32s_bucket new_bucket;
-      idx  = RBUF_LEN(index->objects);
       copy = (uint32_t*)malloc(size_bytes);
       memcpy(copy, object, size_bytes);
-      RBUF_PUSH(index->objects, copy);
-      RBUF_PUSH(index->counts, 1);
-      RBUF_PUSH(index->hashes, hash);
+      idx  = uint32s_index_push_object(index, copy, hash);
       new_bucket.len = 1;
       new_bucket.contents.idxs[0] = idx;
       new_bucket.contents.idxs[1] = 0;
@@ -208,6 +407,7 @@ bool uint32s_index_insert_exact(uint32s_index_t *index, uint32_t idx, uint32_t *
       RHMAP_SET(index->index, hash, new_bucket);
    }
    /* RARCH_LOG("[STATESTREAM] insert index %d\n",idx); */
+   index->live++;
    RBUF_PUSH(index->objects, object);
    RBUF_PUSH(index->counts, 1);
    RBUF_PUSH(index->hashes, hash);
@@ -222,6 +422,23 @@ bool uint32s_index_insert_exact(uint32s_index_t *index, uint32_t idx, uint32_t *
    return true;
 }
 
+/* Frees object idx and forgets its hash; the index itself stays taken */
+static void uint32s_index_drop(uint32s_index_t *index, uint32_t idx)
+{
+   struct uint32s_bucket *bucket;
+   free(index->objects[idx]);
+   index->objects[idx] = NULL;
+   index->live--;
+   bucket = RHMAP_PTR(index->index, index->hashes[idx]);
+   uint32s_bucket_remove(bucket, idx);
+   if (bucket->len == 0)
+   {
+      uint32s_bucket_free(bucket);
+      if (!RHMAP_DEL(index->index, index->hashes[idx]))
+         RARCH_ERR("[STATESTREAM] Trying to remove absent hash %x\n",index->hashes[idx]);
+   }
+}
+
 void uint32s_index_commit(uint32s_index_t *index)
 {
    uint32_t i, interval=index->commit_interval,threshold=index->commit_threshold;
@@ -234,20 +451,94 @@ void uint32s_index_commit(uint32s_index_t *index)
    limit = cur.first_index;
    for (i = prev.first_index; i < limit; i++)
    {
-      struct uint32s_bucket *bucket;
-      if (index->counts[i] >= threshold)
+      if (index->counts[i] >= threshold || !index->objects[i])
          continue;
-      free(index->objects[i]);
-      index->objects[i] = NULL;
-      bucket = RHMAP_PTR(index->index, index->hashes[i]);
-      uint32s_bucket_remove(bucket, i);
-      if (bucket->len == 0)
+      uint32s_index_drop(index, i);
+      index->collected++;
+   }
+}
+
+size_t uint32s_index_bytes(uint32s_index_t *index)
+{
+   size_t len = RBUF_LEN(index->objects);
+   return   (size_t)index->live * index->object_size * sizeof(uint32_t)
+          + len * (sizeof(uint32_t*) + 2 * sizeof(uint32_t))
+          + RHMAP_CAP(index->index) * sizeof(struct uint32s_bucket);
+}
+
+uint32_t uint32s_index_evict(uint32s_index_t *index, size_t budget,
+      const uint32_t *pinned, size_t pinned_count)
+{
+   size_t i, bytes, target;
+   uint32_t idx, tenured_end, evicted = 0;
+   uint8_t *pins          = NULL;
+   bool changed           = true;
+   uint32_t additions_len = RBUF_LEN(index->additions);
+   size_t object_bytes    = index->object_size * sizeof(uint32_t);
+   if ((bytes = uint32s_index_bytes(index)) <= budget)
+      return 0;
+   /* Objects from the last commit_interval additions are still up
+      for commit; everything older is tenured */
+   if (index->commit_interval == 0)
+      tenured_end = RBUF_LEN(index->objects);
+   else if (additions_len >= index->commit_interval)
+      tenured_end = index->additions[additions_len - index->commit_interval].first_index;
+   else
+      return 0;
+   if (tenured_end <= 1)
+      return 0;
+   if (pinned_count)
+   {
+      if (!(pins = (uint8_t*)calloc(tenured_end, sizeof(uint8_t))))
+         return 0;
+      for (i = 0; i < pinned_count; i++)
+         if (pinned[i] < tenured_end)
+            pins[pinned[i]] = 1;
+   }
+   /* Stop an eighth below the budget so this doesn't run every commit */
+   target = budget - budget / 8;
+   idx    = index->evict_cursor;
+   /* Each full sweep either drops something or halves some count, so
+      this ends once nothing is left but pinned or unused objects */
+   while (bytes > target && changed)
+   {
+      uint32_t start = idx = (idx < 1 || idx >= tenured_end) ? 1 : idx;
+      changed        = false;
+      do
       {
-         uint32s_bucket_free(bucket);
-         if (!RHMAP_DEL(index->index, index->hashes[i]))
-            RARCH_ERR("[STATESTREAM] Trying to remove absent hash %x\n",index->hashes[i]);
-      }
+         if (index->objects[idx] && !(pins && pins[idx]))
+         {
+            if (index->counts[idx] > 1)
+               index->counts[idx] >>= 1;
+            else
+            {
+               uint32s_index_drop(index, idx);
+               bytes -= object_bytes;
+               evicted++;
+            }
+            changed = true;
+         }
+         if (++idx >= tenured_end)
+            idx = 1;
+      } while (idx != start && bytes > target);
    }
+   index->evict_cursor = idx;
+   index->evicted     += evicted;
+   free(pins);
+   return evicted;
+}
+
+bool uint32s_index_release(uint32s_index_t *index, uint32_t which)
+{
+   if (     which == 0
+         || which >= RBUF_LEN(index->objects)
+         || !index->objects[which])
+      return false;
+   if (--index->counts[which] > 0)
+      return false;
+   uint32s_index_drop(index, which);
+   RBUF_PUSH(index->free_slots, which);
+   return true;
 }
 
 void uint32s_index_bump_count(uint32s_index_t *index, uint32_t which)
@@ -281,23 +572,14 @@ uint32_t *uint32s_index_get(uint32s_index_t *index, uint32_t which)
 void uint32s_index_pop(uint32s_index_t *index)
 {
    uint32_t idx  = RBUF_LEN(index->objects)-1;
-   uint32_t hash = index->hashes[idx];
-   struct uint32s_bucket *bucket = RHMAP_PTR(index->index, hash);
-   uint32_t old_len = bucket->len;
-   if (old_len == 0) {
-      RARCH_ERR("[STATESTREAM] trying to pop from empty bucket\n");
-      return;
-   }
+   /* Collected and evicted objects are already out of the hash map */
+   if (index->objects[idx])
+      uint32s_index_drop(index, idx);
    RBUF_RESIZE(index->objects, idx);
    RBUF_RESIZE(index->counts, idx);
    RBUF_RESIZE(index->hashes, idx);
-   uint32s_bucket_remove(bucket, idx);
-   if (old_len - 1 == 0)
-   {
-      uint32s_bucket_free(bucket);
-      if (!RHMAP_DEL(index->index, hash))
-         RARCH_ERR("[STATESTREAM] Trying to remove absent hash %x\n",hash);
-   }
+   if (index->evict_cursor > idx)
+      index->evict_cursor = 1;
 }
 
 /* goes backwards from end of additions */
@@ -330,6 +612,9 @@ void uint32s_index_clear(uint32s_index_t *index)
    RBUF_CLEAR(index->objects);
    RBUF_CLEAR(index->counts);
    RBUF_CLEAR(index->hashes);
+   RBUF_CLEAR(index->free_slots);
+   index->live         = 0;
+   index->evict_cursor = 1;
    uint32s_index_insert_exact(index, 0, zeros, 0);
    /* wipe additions */
    RBUF_CLEAR(index->additions);
@@ -350,6 +635,7 @@ void uint32s_index_free(uint32s_index_t *index)
    RBUF_FREE(index->counts);
    RBUF_FREE(index->hashes);
    RBUF_FREE(index->additions);
+   RBUF_FREE(index->free_slots);
    free(index);
 }
 
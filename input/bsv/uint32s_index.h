@@ -52,6 +52,11 @@ struct uint32s_index
    uint32_t *counts;   /* an rbuf of the times each object was used */
    uint32_t *hashes;   /* an rbuf of each object's hash code */
    struct uint32s_frame_addition *additions; /* an rbuf of addition info */
+   uint32_t *free_slots; /* an rbuf of released indices, reused by inserts */
+   uint32_t live;        /* objects currently held */
+   uint32_t collected;   /* transient objects dropped by commit */
+   uint32_t evicted;     /* tenured objects dropped by evict */
+   uint32_t evict_cursor; /* where the next eviction sweep starts */
    uint8_t commit_interval, commit_threshold;
 };
 
@@ -69,14 +74,30 @@ RETRO_BEGIN_DECLS
 uint32s_index_t *uint32s_index_new(size_t object_size, uint8_t commit_interval, uint8_t commit_threshold);
 /* Does not take ownership of object */
 uint32s_insert_result_t uint32s_index_insert(uint32s_index_t *index, uint32_t *object, uint64_t frame);
+/* As above, for callers that already have the object's hash from uint32s_hash_compare */
+uint32s_insert_result_t uint32s_index_insert_hashed(uint32s_index_t *index, uint32_t *object, uint32_t hash, uint64_t frame);
 /* Does take ownership, requires idx is the exact next index and object not in index */
 bool uint32s_index_insert_exact(uint32s_index_t *index, uint32_t idx, uint32_t *object, uint64_t frame);
 /* Does not grant ownership of return value */
 uint32_t *uint32s_index_get(uint32s_index_t *index, uint32_t which);
 /* Just bump the count, don't try to get the results back */
 void uint32s_index_bump_count(uint32s_index_t *index, uint32_t which);
+/* Drops one use of the object; once none are left it is freed and its
+   index becomes available to later inserts.  Returns true if it was freed.
+   Object 0 (all zeros) is never freed. */
+bool uint32s_index_release(uint32s_index_t *index, uint32_t which);
 /* Call once the superblocks and blocks are all identified; transient blocks that have not been used this frame will be dropped. */
 void uint32s_index_commit(uint32s_index_t *index);
+/* Bytes held by the objects and their bookkeeping */
+size_t uint32s_index_bytes(uint32s_index_t *index);
+/* If the index holds more than budget bytes, drops objects that have
+   outlived the commit window until it is comfortably below.  Objects are
+   swept oldest first; one used since the last sweep has its count halved
+   and survives the pass.  Dropped indices are never reused, and the
+   pinned indices (which may be NULL) are kept.  Returns the number of
+   objects dropped. */
+uint32_t uint32s_index_evict(uint32s_index_t *index, size_t budget,
+      const uint32_t *pinned, size_t pinned_count);
 void uint32s_index_free(uint32s_index_t *index);
 
 /* goes backwards from end of additions */
@@ -84,6 +105,10 @@ void uint32s_index_remove_after(uint32s_index_t *index, uint64_t frame);
 /* removes all data from index */
 void uint32s_index_clear(uint32s_index_t *index);
 uint32_t uint32s_index_count(uint32s_index_t *index);
+/* Hashes len bytes of cur with the same function the index uses and,
+   in the same pass, compares them against prev (which may be NULL).
+   Returns true if the two buffers are identical. */
+bool uint32s_hash_compare(const uint32_t *cur, const uint32_t *prev, size_t len, uint32_t *out_hash);
 #if DEBUG
 void uint32s_index_print_count_data(uint32s_index_t *index);
 #endif
@@ -184,6 +184,7 @@ enum
    RARCH_PREEMPT_TOGGLE,
    RARCH_FPS_TOGGLE,
    RARCH_STATISTICS_TOGGLE,
+   RARCH_PERF_TRACE_DUMP,
    RARCH_AI_SERVICE,
 
    RARCH_NETPLAY_PING_TOGGLE,
@@ -61,6 +61,7 @@
 #include "../list_special.h"
 #include "../paths.h"
 #include "../performance_counters.h"
+#include "../performance_trace.h"
 #include "../retroarch.h"
 #include "../tasks/tasks_internal.h"
 #include "../verbosity.h"
@@ -6324,6 +6325,8 @@ void input_driver_poll(void)
    float input_axis_threshold     = settings->floats.input_axis_threshold;
    uint8_t max_users              = (uint8_t)settings->uints.input_max_users;
 
+   performance_trace_begin(PERF_TRACE_INPUT_POLL);
+
    if (joypad && joypad->poll)
       joypad->poll();
    if (sec_joypad && sec_joypad->poll)
@@ -6389,6 +6392,7 @@ void input_driver_poll(void)
          input_st->turbo_btns.frame_enable[i] = 0;
          input_st->hold_btns.frame_enable[i]  = 0;
       }
+      performance_trace_end(PERF_TRACE_INPUT_POLL);
       return;
    }
 
@@ -6780,7 +6784,10 @@ void input_driver_poll(void)
 #else
             if (input_st->remote->net_fd[user] < 0)
 #endif
+            {
+               performance_trace_end(PERF_TRACE_INPUT_POLL);
                return;
+            }
 
             FD_ZERO(&fds);
             FD_SET(input_st->remote->net_fd[user], &fds);
@@ -6809,6 +6816,8 @@ void input_driver_poll(void)
    if (BSV_MOVIE_IS_PLAYBACK_ON())
       bsv_movie_poll(input_st);
 #endif
+
+   performance_trace_end(PERF_TRACE_INPUT_POLL);
 }
 
 int16_t input_driver_state_wrapper(unsigned port, unsigned device,
@@ -131,6 +131,9 @@
 #define REPLAY_CHECKPOINT2_COMPRESSION_NONE 0
 #define REPLAY_CHECKPOINT2_COMPRESSION_ZLIB 1
 #define REPLAY_CHECKPOINT2_COMPRESSION_ZSTD 2
+/* zstd, with the replay's initial checkpoint (as encoded, before
+   compression) for a dictionary. */
+#define REPLAY_CHECKPOINT2_COMPRESSION_ZSTD_DICT 3
 
 /* Which encoding to use.
    RAW: Just raw checkpoint data, possibly compressed.
@@ -207,7 +210,11 @@ enum bsv_flags
    BSV_FLAG_MOVIE_PREV_CHECKPOINT    = (1 << 7),
    BSV_FLAG_MOVIE_NEXT_CHECKPOINT    = (1 << 8),
    BSV_FLAG_MOVIE_SEEK_TO_FRAME      = (1 << 9),
-   BSV_FLAG_MOVIE_SEEKING            = (1 << 10)
+   BSV_FLAG_MOVIE_SEEKING            = (1 << 10),
+   /* Compare checkpoints against the core instead of loading them */
+   BSV_FLAG_MOVIE_VERIFY             = (1 << 11),
+   /* Set when a verified playback found a desync */
+   BSV_FLAG_MOVIE_DESYNC             = (1 << 12)
 };
 
 struct bsv_state
@@ -244,6 +251,27 @@ struct bsv_input_data
 };
 typedef struct bsv_input_data bsv_input_data_t;
 
+#ifdef HAVE_STATESTREAM
+/* Running totals for the incremental checkpoint encoder/decoder */
+struct bsv_statestream_stats
+{
+   uint64_t bytes_scanned;    /* state bytes run through the hash/compare kernel */
+   uint64_t encode_micros;
+   uint64_t decode_micros;
+   uint32_t checkpoints;
+   uint32_t decodes;
+   uint32_t blocks;
+   uint32_t superblocks;
+   uint32_t compares;         /* blocks checked against the last save */
+   uint32_t skipped_blocks;   /* ...and found unchanged */
+   uint32_t hashes;           /* blocks looked up in the block index */
+   uint32_t reused_blocks;
+   uint32_t reused_superblocks;
+   uint32_t kbs_input;
+   uint32_t kbs_written;
+};
+#endif
+
 struct bsv_movie
 {
    intfstream_t *file;
@@ -257,6 +285,11 @@ struct bsv_movie
    size_t frame_mask;
    uint64_t frame_counter;
 
+   /* Offsets of every frame and checkpoint, for seeking; NULL until
+    * loaded from the sidecar at index_path or built by a scan. */
+   struct bsv_index *index;
+   char *index_path;
+
    /* Staging variables for events */
    uint8_t key_event_count;
    uint16_t input_event_count;
@@ -268,13 +301,34 @@ struct bsv_movie
    bool first_rewind;
    bool did_rewind;
    bool checkpoint_ready;
+   /* cur_save is to be compared against the core, not loaded */
+   bool checkpoint_verify;
+
+   /* Verified playback; the core is serialized into verify_save */
+   uint8_t *verify_save;
+   size_t verify_save_cap;
+   uint32_t verified_checkpoints;
+   uint32_t desyncs;
+   int64_t first_desync_frame;
+   retro_time_t verify_start_usec;
 
 #ifdef HAVE_STATESTREAM
    /* Block index and superblock index for incremental checkpoints */
    uint32s_index_t *superblocks;
    uint32s_index_t *blocks;
    uint32_t *superblock_seq;
+   struct bsv_statestream_stats stats;
+#ifdef HAVE_THREADS
+   /* Splits block change detection and hashing of large states */
+   struct tpool *encode_pool;
+   unsigned encode_threads;
+#endif
    uint8_t commit_interval, commit_threshold;
+   /* Memory the recorder's indices may use, in bytes; 0 for no limit */
+   size_t index_budget;
+   /* Trying other block sizes on the first checkpoints; NULL unless
+    * recording with replay_checkpoint_calibrate set */
+   struct bsv_calibration *calibration;
 #endif
 
    uint8_t checkpoint_compression, checkpoint_encoding;
@@ -282,6 +336,30 @@ struct bsv_movie
    uint8_t *last_save, *cur_save;
    size_t last_save_size, cur_save_size;
 
+   /* Kept between checkpoint loads so seeking does not reallocate;
+    * raw states are decompressed straight into cur_save. */
+   uint8_t *load_compressed, *load_encoded;
+   size_t load_compressed_cap, load_encoded_cap;
+#ifdef HAVE_ZLIB
+   struct z_stream_s *load_zstream;
+#endif
+#ifdef HAVE_ZSTD
+   struct ZSTD_DCtx_s *load_dctx;
+   struct ZSTD_CCtx_s *save_cctx;
+   /* The encoded initial checkpoint, which zstd checkpoints may be
+    * compressed against; save_dict is only kept when recording with
+    * checkpoint_dictionary set, load_dict is read back on demand. */
+   uint8_t *save_dict, *load_dict;
+   size_t save_dict_size, load_dict_size;
+   bool checkpoint_dictionary;
+#endif
+
+#ifdef HAVE_THREADS
+   /* Checkpoint encoder worker; NULL unless recording with
+    * replay_checkpoint_async enabled. */
+   struct bsv_movie_async *async;
+#endif
+
    bool cur_save_valid;
 };
 
@@ -290,7 +368,10 @@ typedef struct bsv_movie bsv_movie_t;
 enum replay_checkpoint_behavior_ {
    REPLAY_CPBEHAVIOR_SKIP,
    REPLAY_CPBEHAVIOR_UPDATE,
-   REPLAY_CPBEHAVIOR_DESERIALIZE
+   REPLAY_CPBEHAVIOR_DESERIALIZE,
+   /* As DESERIALIZE, but compares the core against the checkpoint
+    * and only loads it if they differ */
+   REPLAY_CPBEHAVIOR_VERIFY
 };
 
 typedef enum replay_checkpoint_behavior_ replay_checkpoint_behavior;
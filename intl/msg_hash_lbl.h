@@ -288,6 +288,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_FASTFORWARD_SPEEDUP,
    "audio_fastforward_speedup"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD,
+   "audio_processing_thread"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_OUTPUT_RATE,
    "audio_output_rate"
@@ -394,6 +398,22 @@ MSG_HASH(
    MENU_ENUM_LABEL_REPLAY_CHECKPOINT_DESERIALIZE,
    "replay_checkpoint_deserialize"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REPLAY_CHECKPOINT_ASYNC,
+   "replay_checkpoint_async"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REPLAY_CHECKPOINT_DICTIONARY,
+   "replay_checkpoint_dictionary"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REPLAY_CHECKPOINT_CALIBRATE,
+   "replay_checkpoint_calibrate"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REPLAY_CHECKPOINT_MEMORY_LIMIT,
+   "replay_checkpoint_memory_limit"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUTO_OVERRIDES_ENABLE,
    "auto_overrides_enable"
@@ -3268,6 +3288,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
    "rewind_buffer_size_step"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_DEDUPLICATE,
+   "rewind_deduplicate"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_FRAME_THROTTLE_SETTINGS,
    "frame_throttle_settings"
@@ -3634,6 +3658,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,
    "run_ahead_hide_warnings"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD,
+   "run_ahead_secondary_thread"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
    "run_ahead_frames"
@@ -2751,6 +2751,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_REWIND_MUTE,
    "Automatically mute audio when using rewind."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_PROCESSING_THREAD,
+   "Threaded Audio Processing"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_PROCESSING_THREAD,
+   "Run the audio DSP filter and resampler on a separate thread. Frees up the main thread for heavy filters, but adds up to one audio chunk of latency."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_AUDIO_VOLUME,
    "Volume Gain (dB)"
@@ -4067,6 +4075,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_INPUT_META_STATISTICS_TOGGLE,
    "Switches the display of on-screen technical statistics on/off."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_INPUT_META_PERF_TRACE_DUMP,
+   "Save Frame Trace"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_INPUT_META_PERF_TRACE_DUMP,
+   "Writes the last seconds of per-frame timings to the log directory as a Chrome trace. Requires performance counters."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_INPUT_META_OSK,
    "Keyboard Overlay (Toggle)"
@@ -4432,6 +4448,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS,
    "Hide the warning message that appears when using Run-Ahead and the core does not support save states."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREAD,
+   "Run Second Instance on Its Own Thread"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREAD,
+   "Run the second instance alongside the main one on another CPU core. It works one frame behind, so one more frame of Run-Ahead gives the same latency. Not available for hardware-rendered cores."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PREEMPT_FRAMES,
    "Number of Preemptive Frames"
@@ -4715,6 +4739,54 @@ MSG_HASH(
    MENU_ENUM_LABEL_HELP_REPLAY_CHECKPOINT_DESERIALIZE,
    "Whether to deserialize checkpoints stored in replays during regular playback. Should be set to true for most cores, but some may exhibit janky behavior when deserializing content."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_ASYNC,
+   "Replay: Threaded Checkpoint Encoding"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_ASYNC,
+   "Encode, compress and write replay checkpoints on a separate thread while recording. Reduces frame time spikes at each checkpoint on cores with large save states."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_HELP_REPLAY_CHECKPOINT_ASYNC,
+   "Encode, compress and write replay checkpoints on a separate thread while recording. Only serializing the core happens during the frame; the rest is queued and written in order with the recorded inputs. Frames are held back if the encoder falls too far behind."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_DICTIONARY,
+   "Replay: Checkpoint Compression Dictionary"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_DICTIONARY,
+   "Compress replay checkpoints against the recording's initial state. Makes replays with many checkpoints much smaller when save state file compression is enabled."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_HELP_REPLAY_CHECKPOINT_DICTIONARY,
+   "Use the recording's first checkpoint as a zstd dictionary for every later checkpoint, so data that has not changed since the recording started is stored as references instead of being compressed again. The dictionary is not stored separately; players rebuild it from the first checkpoint. Only applies when save state file compression uses zstd."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_CALIBRATE,
+   "Replay: Calibrate Checkpoint Block Size"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_CALIBRATE,
+   "Pick the incremental checkpoint block sizes for each core from its own save states, and use them for later recordings."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_HELP_REPLAY_CHECKPOINT_CALIBRATE,
+   "While recording with a core that has not been calibrated yet, encode the first few checkpoints with several block and superblock sizes and keep the one with the best balance of output size and encoding time. The choice is saved next to the core's options and used for every later recording with that core. The recording that does the calibration still uses the default sizes."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_MEMORY_LIMIT,
+   "Replay: Checkpoint Memory Limit (MB)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_MEMORY_LIMIT,
+   "Limit the memory used to spot repeated data in replay checkpoints while recording. 0 means no limit."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_HELP_REPLAY_CHECKPOINT_MEMORY_LIMIT,
+   "Incremental checkpoints only store the parts of the save state that were not seen before, which means remembering everything seen so far. Past this limit, the oldest data that has not come up again recently is forgotten, and is stored again if it reappears. Long recordings stay within the limit at the cost of somewhat larger replay files. 0 means no limit."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SAVESTATE_AUTO_INDEX,
    "Save State: Increment Index Automatically"
@@ -5063,6 +5135,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
    "Each time the rewind buffer size value is increased or decreased, it will change by this amount."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_DEDUPLICATE,
+   "Deduplicate Rewind States"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_DEDUPLICATE,
+   "Store rewind states as shared blocks that are kept only once, instead of as a chain of differences. Holds more history in the same buffer size when the game often returns to the same state."
+   )
 
 /* Settings > Frame Throttle > Frame Time Counter */
 
@@ -15003,6 +15083,14 @@ MSG_HASH(
    MSG_SCREENSHOT_SAVED,
    "Screenshot saved"
    )
+MSG_HASH(
+   MSG_PERF_TRACE_SAVED,
+   "Frame trace saved"
+   )
+MSG_HASH(
+   MSG_PERF_TRACE_EMPTY,
+   "No frame trace recorded. Enable performance counters first."
+   )
 MSG_HASH(
    MSG_ACHIEVEMENT_UNLOCKED,
    "Achievement Unlocked"
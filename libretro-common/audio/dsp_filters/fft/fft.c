@@ -27,6 +27,12 @@
 
 #include <retro_miscellaneous.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+#include <arm_neon.h>
+#endif
+
 struct fft
 {
    fft_complex_t *interleave_buffer;
@@ -140,6 +146,51 @@ static void butterfly(fft_complex_t *a, fft_complex_t *b, fft_complex_t mod)
    *a  = fft_complex_add(*a, mod);
 }
 
+#if defined(__SSE__)
+/* Two butterflies at once. The twiddles are phase_step apart in the
+ * table, the inputs are next to each other. */
+static INLINE void butterfly2(fft_complex_t *a, fft_complex_t *b,
+      const fft_complex_t *mod0, const fft_complex_t *mod1)
+{
+   static const float signs[4] = { -1.0f, 1.0f, -1.0f, 1.0f };
+   __m128 mod     = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+            (const __m64*)mod0), (const __m64*)mod1);
+   __m128 in_a    = _mm_loadu_ps(&a->real);
+   __m128 in_b    = _mm_loadu_ps(&b->real);
+   __m128 mod_re  = _mm_shuffle_ps(mod, mod, _MM_SHUFFLE(2, 2, 0, 0));
+   __m128 mod_im  = _mm_shuffle_ps(mod, mod, _MM_SHUFFLE(3, 3, 1, 1));
+   __m128 b_swap  = _mm_shuffle_ps(in_b, in_b, _MM_SHUFFLE(2, 3, 0, 1));
+   __m128 product = _mm_add_ps(_mm_mul_ps(mod_re, in_b),
+         _mm_mul_ps(_mm_mul_ps(mod_im, b_swap), _mm_loadu_ps(signs)));
+   _mm_storeu_ps(&b->real, _mm_sub_ps(in_a, product));
+   _mm_storeu_ps(&a->real, _mm_add_ps(in_a, product));
+}
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+static INLINE void butterfly2(fft_complex_t *a, fft_complex_t *b,
+      const fft_complex_t *mod0, const fft_complex_t *mod1)
+{
+   /* De-interleaved, so val[0] holds the real parts
+    * and val[1] the imaginary ones */
+   float32x2x2_t in_a = vld2_f32(&a->real);
+   float32x2x2_t in_b = vld2_f32(&b->real);
+   float32x2x2_t out_a, out_b;
+   float32x2_t mod_re = vset_lane_f32(mod1->real,
+         vdup_n_f32(mod0->real), 1);
+   float32x2_t mod_im = vset_lane_f32(mod1->imag,
+         vdup_n_f32(mod0->imag), 1);
+   float32x2_t prod_re = vmls_f32(vmul_f32(mod_re, in_b.val[0]),
+         mod_im, in_b.val[1]);
+   float32x2_t prod_im = vmla_f32(vmul_f32(mod_im, in_b.val[0]),
+         mod_re, in_b.val[1]);
+   out_b.val[0]        = vsub_f32(in_a.val[0], prod_re);
+   out_b.val[1]        = vsub_f32(in_a.val[1], prod_im);
+   out_a.val[0]        = vadd_f32(in_a.val[0], prod_re);
+   out_a.val[1]        = vadd_f32(in_a.val[1], prod_im);
+   vst2_f32(&b->real, out_b);
+   vst2_f32(&a->real, out_a);
+}
+#endif
+
 static void butterflies(fft_complex_t *butterfly_buf,
       const fft_complex_t *phase_lut,
       int phase_dir, unsigned step_size, unsigned samples)
@@ -148,7 +199,15 @@ static void butterflies(fft_complex_t *butterfly_buf,
    for (i = 0; i < samples; i += step_size << 1)
    {
       int phase_step = (int)samples * phase_dir / (int)step_size;
-      for (j = i; j < i + step_size; j++)
+      j              = i;
+#if defined(__SSE__) || defined(__ARM_NEON__) || defined(HAVE_NEON)
+      /* Every step size past the first is a power of two >= 2 */
+      for (; j + 2 <= i + step_size; j += 2)
+         butterfly2(&butterfly_buf[j], &butterfly_buf[j + step_size],
+               &phase_lut[phase_step * (int)(j - i)],
+               &phase_lut[phase_step * (int)(j - i + 1)]);
+#endif
+      for (; j < i + step_size; j++)
          butterfly(&butterfly_buf[j], &butterfly_buf[j + step_size],
                phase_lut[phase_step * (int)(j - i)]);
    }
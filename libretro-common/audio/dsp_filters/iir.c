@@ -28,6 +28,12 @@
 #include <libretro_dspfilter.h>
 #include <string/stdstring.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+#include <arm_neon.h>
+#endif
+
 #define sqr(a) ((a) * (a))
 
 /* filter types */
@@ -124,6 +130,126 @@ static void iir_process(void *data, struct dspfilter_output *output,
    iir->r.yn2 = yn2_r;
 }
 
+/* The SIMD versions run both channels in one vector, left in lane 0
+ * and right in lane 1, and fold a0 into the other coefficients up
+ * front so the feedback path has no division in it. */
+#if defined(__SSE__)
+static void iir_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   float state[4];
+   struct iir_data *iir = (struct iir_data*)data;
+   float *out           = output->samples;
+
+   __m128 b0            = _mm_set1_ps(iir->b0 / iir->a0);
+   __m128 b1            = _mm_set1_ps(iir->b1 / iir->a0);
+   __m128 b2            = _mm_set1_ps(iir->b2 / iir->a0);
+   __m128 a1            = _mm_set1_ps(iir->a1 / iir->a0);
+   __m128 a2            = _mm_set1_ps(iir->a2 / iir->a0);
+
+   __m128 xn1           = _mm_setr_ps(iir->l.xn1, iir->r.xn1, 0.0f, 0.0f);
+   __m128 xn2           = _mm_setr_ps(iir->l.xn2, iir->r.xn2, 0.0f, 0.0f);
+   __m128 yn1           = _mm_setr_ps(iir->l.yn1, iir->r.yn1, 0.0f, 0.0f);
+   __m128 yn2           = _mm_setr_ps(iir->l.yn2, iir->r.yn2, 0.0f, 0.0f);
+
+   output->samples      = input->samples;
+   output->frames       = input->frames;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      __m128 in = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+      __m128 x  = _mm_add_ps(_mm_mul_ps(b0, in),
+            _mm_add_ps(_mm_mul_ps(b1, xn1), _mm_mul_ps(b2, xn2)));
+      __m128 y  = _mm_sub_ps(x,
+            _mm_add_ps(_mm_mul_ps(a1, yn1), _mm_mul_ps(a2, yn2)));
+
+      xn2       = xn1;
+      xn1       = in;
+      yn2       = yn1;
+      yn1       = y;
+
+      _mm_storel_pi((__m64*)out, y);
+   }
+
+   _mm_storeu_ps(state, xn1);
+   iir->l.xn1 = state[0];
+   iir->r.xn1 = state[1];
+   _mm_storeu_ps(state, xn2);
+   iir->l.xn2 = state[0];
+   iir->r.xn2 = state[1];
+   _mm_storeu_ps(state, yn1);
+   iir->l.yn1 = state[0];
+   iir->r.yn1 = state[1];
+   _mm_storeu_ps(state, yn2);
+   iir->l.yn2 = state[0];
+   iir->r.yn2 = state[1];
+}
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+static void iir_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned i;
+   float state[2];
+   struct iir_data *iir = (struct iir_data*)data;
+   float *out           = output->samples;
+
+   float b0             = iir->b0 / iir->a0;
+   float b1             = iir->b1 / iir->a0;
+   float b2             = iir->b2 / iir->a0;
+   float a1             = iir->a1 / iir->a0;
+   float a2             = iir->a2 / iir->a0;
+
+   float32x2_t xn1, xn2, yn1, yn2;
+
+   state[0] = iir->l.xn1;
+   state[1] = iir->r.xn1;
+   xn1      = vld1_f32(state);
+   state[0] = iir->l.xn2;
+   state[1] = iir->r.xn2;
+   xn2      = vld1_f32(state);
+   state[0] = iir->l.yn1;
+   state[1] = iir->r.yn1;
+   yn1      = vld1_f32(state);
+   state[0] = iir->l.yn2;
+   state[1] = iir->r.yn2;
+   yn2      = vld1_f32(state);
+
+   output->samples      = input->samples;
+   output->frames       = input->frames;
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      float32x2_t in = vld1_f32(out);
+      float32x2_t y  = vmul_n_f32(in, b0);
+      y              = vmla_n_f32(y, xn1, b1);
+      y              = vmla_n_f32(y, xn2, b2);
+      y              = vmls_n_f32(y, yn1, a1);
+      y              = vmls_n_f32(y, yn2, a2);
+
+      xn2            = xn1;
+      xn1            = in;
+      yn2            = yn1;
+      yn1            = y;
+
+      vst1_f32(out, y);
+   }
+
+   vst1_f32(state, xn1);
+   iir->l.xn1 = state[0];
+   iir->r.xn1 = state[1];
+   vst1_f32(state, xn2);
+   iir->l.xn2 = state[0];
+   iir->r.xn2 = state[1];
+   vst1_f32(state, yn1);
+   iir->l.yn1 = state[0];
+   iir->r.yn1 = state[1];
+   vst1_f32(state, yn2);
+   iir->l.yn2 = state[0];
+   iir->r.yn2 = state[1];
+}
+#endif
+
 #define CHECK(x) if (string_is_equal(str, #x)) return x
 static enum IIRFilter str_to_type(const char *str)
 {
@@ -359,12 +485,41 @@ static const struct dspfilter_implementation iir_plug = {
    "iir",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation iir_sse_plug = {
+   iir_init,
+   iir_process_sse,
+   iir_free,
+
+   DSPFILTER_API_VERSION,
+   "IIR",
+   "iir",
+};
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+static const struct dspfilter_implementation iir_neon_plug = {
+   iir_init,
+   iir_process_neon,
+   iir_free,
+
+   DSPFILTER_API_VERSION,
+   "IIR",
+   "iir",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation iir_dspfilter_get_implementation
 #endif
 
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &iir_sse_plug;
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &iir_neon_plug;
+#endif
    return &iir_plug;
 }
 
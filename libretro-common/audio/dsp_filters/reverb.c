@@ -25,8 +25,15 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <libretro_dspfilter.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+#include <arm_neon.h>
+#endif
+
 struct comb
 {
    float *buffer;
@@ -123,6 +130,196 @@ static float revmodel_process(struct revmodel *rev, float in)
    return mono_in * rev->dry + mono_out * rev->wet1;
 }
 
+#if defined(__SSE__) || defined(__ARM_NEON__) || defined(HAVE_NEON)
+/* The SIMD version runs each channel through the model a block at a
+ * time, so every comb and allpass walks its delay line with contiguous
+ * four-wide loads and stores. */
+#define REVERB_BLOCK_FRAMES 256
+
+#if defined(__SSE__)
+typedef __m128 reverb_vec_t;
+#define reverb_vec_splat(x)     _mm_set1_ps(x)
+#define reverb_vec_set(a,b,c,d) _mm_setr_ps(a, b, c, d)
+#define reverb_vec_load(p)      _mm_loadu_ps(p)
+#define reverb_vec_store(p, v)  _mm_storeu_ps(p, v)
+#define reverb_vec_add(a, b)    _mm_add_ps(a, b)
+#define reverb_vec_sub(a, b)    _mm_sub_ps(a, b)
+#define reverb_vec_mul(a, b)    _mm_mul_ps(a, b)
+#define reverb_vec_get0(v)      _mm_cvtss_f32(v)
+/* { v[3], v[3], v[3], v[3] } */
+#define reverb_vec_last(v)      _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))
+/* { 0, 0, v[0], v[1] } */
+#define reverb_vec_shift2(v)    _mm_movelh_ps(_mm_setzero_ps(), v)
+
+/* { 0, v[0], v[1], v[2] } */
+static INLINE __m128 reverb_vec_shift1(__m128 v)
+{
+   return _mm_move_ss(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 1, 0, 0)),
+         _mm_setzero_ps());
+}
+#else
+typedef float32x4_t reverb_vec_t;
+#define reverb_vec_splat(x)     vdupq_n_f32(x)
+#define reverb_vec_load(p)      vld1q_f32(p)
+#define reverb_vec_store(p, v)  vst1q_f32(p, v)
+#define reverb_vec_add(a, b)    vaddq_f32(a, b)
+#define reverb_vec_sub(a, b)    vsubq_f32(a, b)
+#define reverb_vec_mul(a, b)    vmulq_f32(a, b)
+#define reverb_vec_get0(v)      vgetq_lane_f32(v, 0)
+#define reverb_vec_last(v)      vdupq_n_f32(vgetq_lane_f32(v, 3))
+#define reverb_vec_shift1(v)    vextq_f32(vdupq_n_f32(0.0f), v, 3)
+#define reverb_vec_shift2(v)    vextq_f32(vdupq_n_f32(0.0f), v, 2)
+
+static INLINE float32x4_t reverb_vec_set(float a, float b, float c, float d)
+{
+   float v[4];
+   v[0] = a;
+   v[1] = b;
+   v[2] = c;
+   v[3] = d;
+   return vld1q_f32(v);
+}
+#endif
+
+/* Adds the comb's output for each frame to acc. A run never reaches
+ * past the end of the delay line, so it's at most bufsize long and
+ * every slot it reads was written before the run started. */
+static void comb_process_block(struct comb *c, float *acc,
+      const float *input, unsigned frames)
+{
+   float d1                   = c->damp1;
+   float d2                   = c->damp2;
+   float feedback             = c->feedback;
+   float filterstore          = c->filterstore;
+   reverb_vec_t d1_v          = reverb_vec_splat(d1);
+   reverb_vec_t d1_sq         = reverb_vec_splat(d1 * d1);
+   reverb_vec_t d2_v          = reverb_vec_splat(d2);
+   reverb_vec_t feedback_v    = reverb_vec_splat(feedback);
+   /* How much of the previous filterstore reaches each lane */
+   reverb_vec_t carry_weights = reverb_vec_set(d1, d1 * d1,
+         d1 * d1 * d1, d1 * d1 * d1 * d1);
+
+   while (frames)
+   {
+      unsigned i;
+      float *buf         = c->buffer + c->bufidx;
+      unsigned run       = MIN(frames, c->bufsize - c->bufidx);
+      reverb_vec_t store = reverb_vec_splat(filterstore);
+
+      for (i = 0; i + 4 <= run; i += 4)
+      {
+         reverb_vec_t output = reverb_vec_load(buf + i);
+         /* filterstore[k] = d2 * output[k] + d1 * filterstore[k - 1],
+          * as a prefix sum over the four lanes plus the carry-in */
+         reverb_vec_t x      = reverb_vec_mul(output, d2_v);
+         x                   = reverb_vec_add(x,
+               reverb_vec_mul(d1_v, reverb_vec_shift1(x)));
+         x                   = reverb_vec_add(x,
+               reverb_vec_mul(d1_sq, reverb_vec_shift2(x)));
+         x                   = reverb_vec_add(x,
+               reverb_vec_mul(carry_weights, store));
+         store               = reverb_vec_last(x);
+
+         reverb_vec_store(acc + i,
+               reverb_vec_add(reverb_vec_load(acc + i), output));
+         reverb_vec_store(buf + i, reverb_vec_add(reverb_vec_load(input + i),
+                  reverb_vec_mul(x, feedback_v)));
+      }
+
+      filterstore = reverb_vec_get0(store);
+
+      for (; i < run; i++)
+      {
+         float output = buf[i];
+         filterstore  = (output * d2) + (filterstore * d1);
+         buf[i]       = input[i] + (filterstore * feedback);
+         acc[i]      += output;
+      }
+
+      acc        += run;
+      input      += run;
+      frames     -= run;
+      c->bufidx  += run;
+      if (c->bufidx >= c->bufsize)
+         c->bufidx = 0;
+   }
+
+   c->filterstore = filterstore;
+}
+
+static void allpass_process_block(struct allpass *a, float *samples,
+      unsigned frames)
+{
+   reverb_vec_t feedback = reverb_vec_splat(a->feedback);
+
+   while (frames)
+   {
+      unsigned i;
+      float *buf   = a->buffer + a->bufidx;
+      unsigned run = MIN(frames, a->bufsize - a->bufidx);
+
+      for (i = 0; i + 4 <= run; i += 4)
+      {
+         reverb_vec_t bufout = reverb_vec_load(buf + i);
+         reverb_vec_t input  = reverb_vec_load(samples + i);
+         reverb_vec_store(samples + i, reverb_vec_sub(bufout, input));
+         reverb_vec_store(buf + i, reverb_vec_add(input,
+                  reverb_vec_mul(bufout, feedback)));
+      }
+
+      for (; i < run; i++)
+      {
+         float bufout = buf[i];
+         float input  = samples[i];
+         samples[i]   = -input + bufout;
+         buf[i]       = input + bufout * a->feedback;
+      }
+
+      samples   += run;
+      frames    -= run;
+      a->bufidx += run;
+      if (a->bufidx >= a->bufsize)
+         a->bufidx = 0;
+   }
+}
+
+static void revmodel_process_block(struct revmodel *rev, float *samples,
+      unsigned frames)
+{
+   unsigned i;
+   float input[REVERB_BLOCK_FRAMES];
+   float mono_out[REVERB_BLOCK_FRAMES];
+   reverb_vec_t gain = reverb_vec_splat(rev->gain);
+   reverb_vec_t dry  = reverb_vec_splat(rev->dry);
+   reverb_vec_t wet1 = reverb_vec_splat(rev->wet1);
+
+   for (i = 0; i + 4 <= frames; i += 4)
+   {
+      reverb_vec_store(input + i,
+            reverb_vec_mul(reverb_vec_load(samples + i), gain));
+      reverb_vec_store(mono_out + i, reverb_vec_splat(0.0f));
+   }
+   for (; i < frames; i++)
+   {
+      input[i]    = samples[i] * rev->gain;
+      mono_out[i] = 0.0f;
+   }
+
+   for (i = 0; i < numcombs; i++)
+      comb_process_block(&rev->combL[i], mono_out, input, frames);
+
+   for (i = 0; i < numallpasses; i++)
+      allpass_process_block(&rev->allpassL[i], mono_out, frames);
+
+   for (i = 0; i + 4 <= frames; i += 4)
+      reverb_vec_store(samples + i, reverb_vec_add(
+               reverb_vec_mul(reverb_vec_load(samples + i), dry),
+               reverb_vec_mul(reverb_vec_load(mono_out + i), wet1)));
+   for (; i < frames; i++)
+      samples[i] = samples[i] * rev->dry + mono_out[i] * rev->wet1;
+}
+#endif
+
 static void revmodel_update(struct revmodel *rev)
 {
    int i;
@@ -261,6 +458,45 @@ static void reverb_process(void *data, struct dspfilter_output *output,
    }
 }
 
+#if defined(__SSE__) || defined(__ARM_NEON__) || defined(HAVE_NEON)
+static void reverb_process_simd(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   float left[REVERB_BLOCK_FRAMES];
+   float right[REVERB_BLOCK_FRAMES];
+   unsigned frames         = input->frames;
+   struct reverb_data *rev = (struct reverb_data*)data;
+   float *out              = input->samples;
+
+   output->samples         = input->samples;
+   output->frames          = input->frames;
+
+   while (frames)
+   {
+      unsigned i;
+      unsigned block = MIN(frames, REVERB_BLOCK_FRAMES);
+
+      for (i = 0; i < block; i++)
+      {
+         left[i]  = out[2 * i + 0];
+         right[i] = out[2 * i + 1];
+      }
+
+      revmodel_process_block(&rev->left, left, block);
+      revmodel_process_block(&rev->right, right, block);
+
+      for (i = 0; i < block; i++)
+      {
+         out[2 * i + 0] = left[i];
+         out[2 * i + 1] = right[i];
+      }
+
+      out    += 2 * block;
+      frames -= block;
+   }
+}
+#endif
+
 static void *reverb_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
 {
@@ -304,12 +540,31 @@ static const struct dspfilter_implementation reverb_plug = {
    "reverb",
 };
 
+#if defined(__SSE__) || defined(__ARM_NEON__) || defined(HAVE_NEON)
+static const struct dspfilter_implementation reverb_simd_plug = {
+   reverb_init,
+   reverb_process_simd,
+   reverb_free,
+
+   DSPFILTER_API_VERSION,
+   "Reverb",
+   "reverb",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation reverb_dspfilter_get_implementation
 #endif
 
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &reverb_simd_plug;
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &reverb_simd_plug;
+#endif
    return &reverb_plug;
 }
 
@@ -0,0 +1,453 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (sinc_s16_resampler.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Fixed-point polyphase SINC, working on 16-bit frames end to end.
+ * Trades the float resampler's interpolated phases for a denser
+ * table of Q14 coefficients, so the inner loop is a plain 16x16->32
+ * multiply-accumulate (pmaddwd on SSE2, vmlal on NEON). */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <filters.h>
+#include <memalign.h>
+
+#include <audio/audio_resampler.h>
+#include <audio/conversion/float_to_s16.h>
+#include <audio/conversion/s16_to_float.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+#include <arm_neon.h>
+#endif
+
+/* Q14 leaves headroom for filters whose taps sum past 1.0
+ * in magnitude without overflowing the 32-bit accumulators. */
+#define SINC_S16_COEFF_BITS 14
+
+typedef struct rarch_sinc_s16_resampler
+{
+   /* phase_table, buffer_l and buffer_r share one allocation,
+    * as in the float resampler. */
+   int16_t *main_buffer;
+   int16_t *phase_table;
+   int16_t *buffer_l;
+   int16_t *buffer_r;
+   /* Scratch for the float entry point */
+   int16_t *conv_in;
+   int16_t *conv_out;
+   size_t conv_in_frames;
+   size_t conv_out_frames;
+   resampler_process_s16_t process;
+   unsigned phase_bits;
+   unsigned subphase_bits;
+   unsigned taps;
+   unsigned ptr;
+   uint32_t time;
+} rarch_sinc_s16_resampler_t;
+
+typedef void (*sinc_s16_kernel_t)(int16_t *out, const int16_t *left,
+      const int16_t *right, const int16_t *coeffs, unsigned taps);
+
+static INLINE int16_t sinc_s16_clamp(int32_t val)
+{
+   if (val > 0x7fff)
+      return 0x7fff;
+   if (val < -0x8000)
+      return -0x8000;
+   return (int16_t)val;
+}
+
+static void sinc_s16_kernel_c(int16_t *out, const int16_t *left,
+      const int16_t *right, const int16_t *coeffs, unsigned taps)
+{
+   unsigned i;
+   int32_t sum_l = 1 << (SINC_S16_COEFF_BITS - 1);
+   int32_t sum_r = 1 << (SINC_S16_COEFF_BITS - 1);
+
+   for (i = 0; i < taps; i++)
+   {
+      sum_l     += left[i]  * coeffs[i];
+      sum_r     += right[i] * coeffs[i];
+   }
+
+   out[0]        = sinc_s16_clamp(sum_l >> SINC_S16_COEFF_BITS);
+   out[1]        = sinc_s16_clamp(sum_r >> SINC_S16_COEFF_BITS);
+}
+
+#if defined(__SSE2__)
+/* Assumes that taps is a multiple of 8. */
+static void sinc_s16_kernel_sse2(int16_t *out, const int16_t *left,
+      const int16_t *right, const int16_t *coeffs, unsigned taps)
+{
+   unsigned i;
+   int32_t frame;
+   __m128i sum_l = _mm_setzero_si128();
+   __m128i sum_r = _mm_setzero_si128();
+   __m128i lo, hi;
+
+   for (i = 0; i < taps; i += 8)
+   {
+      __m128i coeff = _mm_load_si128((const __m128i*)(coeffs + i));
+      sum_l = _mm_add_epi32(sum_l, _mm_madd_epi16(
+               _mm_loadu_si128((const __m128i*)(left + i)), coeff));
+      sum_r = _mm_add_epi32(sum_r, _mm_madd_epi16(
+               _mm_loadu_si128((const __m128i*)(right + i)), coeff));
+   }
+
+   /* Fold both channels at once, ending with L in lane 0, R in lane 1 */
+   lo    = _mm_unpacklo_epi32(sum_l, sum_r);
+   hi    = _mm_unpackhi_epi32(sum_l, sum_r);
+   lo    = _mm_add_epi32(lo, hi);
+   lo    = _mm_add_epi32(lo, _mm_unpackhi_epi64(lo, lo));
+   lo    = _mm_add_epi32(lo, _mm_set1_epi32(1 << (SINC_S16_COEFF_BITS - 1)));
+   lo    = _mm_srai_epi32(lo, SINC_S16_COEFF_BITS);
+   frame = _mm_cvtsi128_si32(_mm_packs_epi32(lo, lo));
+   memcpy(out, &frame, sizeof(frame));
+}
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+/* Assumes that taps is a multiple of 8. */
+static void sinc_s16_kernel_neon(int16_t *out, const int16_t *left,
+      const int16_t *right, const int16_t *coeffs, unsigned taps)
+{
+   unsigned i;
+   int32x2_t sum;
+   int32x4_t sum_l = vdupq_n_s32(0);
+   int32x4_t sum_r = vdupq_n_s32(0);
+
+   for (i = 0; i < taps; i += 8)
+   {
+      int16x8_t coeff = vld1q_s16(coeffs + i);
+      int16x8_t l     = vld1q_s16(left   + i);
+      int16x8_t r     = vld1q_s16(right  + i);
+
+      sum_l = vmlal_s16(sum_l, vget_low_s16(l),  vget_low_s16(coeff));
+      sum_l = vmlal_s16(sum_l, vget_high_s16(l), vget_high_s16(coeff));
+      sum_r = vmlal_s16(sum_r, vget_low_s16(r),  vget_low_s16(coeff));
+      sum_r = vmlal_s16(sum_r, vget_high_s16(r), vget_high_s16(coeff));
+   }
+
+   sum = vpadd_s32(
+         vadd_s32(vget_low_s32(sum_l), vget_high_s32(sum_l)),
+         vadd_s32(vget_low_s32(sum_r), vget_high_s32(sum_r)));
+   /* Rounding, saturating narrow to L, R */
+   vst1_lane_s32((int32_t*)out, vreinterpret_s32_s16(
+            vqrshrn_n_s32(vcombine_s32(sum, sum), SINC_S16_COEFF_BITS)), 0);
+}
+#endif
+
+/* Always called with a constant kernel, so each
+ * wrapper below gets its own copy with the kernel inlined. */
+static INLINE void sinc_s16_process(void *re_,
+      struct resampler_data_s16 *data, sinc_s16_kernel_t kernel)
+{
+   rarch_sinc_s16_resampler_t *resamp = (rarch_sinc_s16_resampler_t*)re_;
+   unsigned phases                    = 1 << (resamp->phase_bits + resamp->subphase_bits);
+   uint32_t ratio                     = phases / data->ratio;
+   const int16_t *input               = data->data_in;
+   int16_t *output                    = data->data_out;
+   size_t frames                      = data->input_frames;
+   size_t out_frames                  = 0;
+   unsigned taps                      = resamp->taps;
+   /* Kept in locals; the 16-bit output stores would otherwise
+    * force them back to memory every frame. */
+   uint32_t time                      = resamp->time;
+   unsigned ptr                       = resamp->ptr;
+
+   while (frames)
+   {
+      while (frames && time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!ptr)
+            ptr = taps;
+         ptr--;
+
+         resamp->buffer_l[ptr + taps] =
+            resamp->buffer_l[ptr]     = *input++;
+
+         resamp->buffer_r[ptr + taps] =
+            resamp->buffer_r[ptr]     = *input++;
+
+         time                        -= phases;
+         frames--;
+      }
+
+      {
+         const int16_t *buffer_l = resamp->buffer_l + ptr;
+         const int16_t *buffer_r = resamp->buffer_r + ptr;
+         while (time < phases)
+         {
+            unsigned phase       = time >> resamp->subphase_bits;
+            kernel(output, buffer_l, buffer_r,
+                  resamp->phase_table + phase * taps, taps);
+            output              += 2;
+            out_frames++;
+            time                += ratio;
+         }
+      }
+   }
+
+   resamp->time        = time;
+   resamp->ptr         = ptr;
+   data->output_frames = out_frames;
+}
+
+static void resampler_sinc_s16_process_c(void *re_,
+      struct resampler_data_s16 *data)
+{
+   sinc_s16_process(re_, data, sinc_s16_kernel_c);
+}
+
+#if defined(__SSE2__)
+static void resampler_sinc_s16_process_sse2(void *re_,
+      struct resampler_data_s16 *data)
+{
+   sinc_s16_process(re_, data, sinc_s16_kernel_sse2);
+}
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+static void resampler_sinc_s16_process_neon(void *re_,
+      struct resampler_data_s16 *data)
+{
+   sinc_s16_process(re_, data, sinc_s16_kernel_neon);
+}
+#endif
+
+static void resampler_sinc_s16_process_s16(void *re_,
+      struct resampler_data_s16 *data)
+{
+   rarch_sinc_s16_resampler_t *resamp = (rarch_sinc_s16_resampler_t*)re_;
+   resamp->process(resamp, data);
+}
+
+/* For callers that still hand over float frames, e.g. after a DSP filter */
+static void resampler_sinc_s16_process(void *re_, struct resampler_data *data)
+{
+   struct resampler_data_s16 s16_data;
+   rarch_sinc_s16_resampler_t *resamp = (rarch_sinc_s16_resampler_t*)re_;
+   size_t out_frames                  = (size_t)(data->input_frames * data->ratio) + 16;
+
+   data->output_frames                = 0;
+
+   if (data->input_frames > resamp->conv_in_frames)
+   {
+      int16_t *conv_in = (int16_t*)realloc(resamp->conv_in,
+            data->input_frames * 2 * sizeof(int16_t));
+      if (!conv_in)
+         return;
+      resamp->conv_in         = conv_in;
+      resamp->conv_in_frames  = data->input_frames;
+   }
+
+   if (out_frames > resamp->conv_out_frames)
+   {
+      int16_t *conv_out = (int16_t*)realloc(resamp->conv_out,
+            out_frames * 2 * sizeof(int16_t));
+      if (!conv_out)
+         return;
+      resamp->conv_out        = conv_out;
+      resamp->conv_out_frames = out_frames;
+   }
+
+   convert_float_to_s16(resamp->conv_in, data->data_in,
+         data->input_frames * 2);
+
+   s16_data.data_in       = resamp->conv_in;
+   s16_data.data_out      = resamp->conv_out;
+   s16_data.input_frames  = data->input_frames;
+   s16_data.output_frames = 0;
+   s16_data.ratio         = data->ratio;
+
+   resampler_sinc_s16_process_s16(resamp, &s16_data);
+
+   convert_s16_to_float(data->data_out, resamp->conv_out,
+         s16_data.output_frames * 2, 1.0f);
+   data->output_frames    = s16_data.output_frames;
+}
+
+static void resampler_sinc_s16_free(void *data)
+{
+   rarch_sinc_s16_resampler_t *resamp = (rarch_sinc_s16_resampler_t*)data;
+   if (resamp)
+   {
+      memalign_free(resamp->main_buffer);
+      free(resamp->conv_in);
+      free(resamp->conv_out);
+   }
+   free(resamp);
+}
+
+static void sinc_s16_init_table_kaiser(int16_t *phase_table,
+      double cutoff, double kaiser_beta, int phases, int taps)
+{
+   int i, j;
+   double window_mod = besseli0(kaiser_beta);
+   double sidelobes  = taps / 2.0;
+   double *row       = (double*)malloc(taps * sizeof(double));
+
+   if (!row)
+      return;
+
+   for (i = 0; i < phases; i++)
+   {
+      int center;
+      int32_t total = 0;
+      double sum    = 0.0;
+
+      for (j = 0; j < taps; j++)
+      {
+         int               n = j * phases + i;
+         double window_phase = (double)n / (phases * taps); /* [0, 1). */
+         window_phase        = 2.0 * window_phase - 1.0; /* [-1, 1) */
+         row[j]              = cutoff * sinc(M_PI * sidelobes * window_phase * cutoff) *
+            besseli0(kaiser_beta * sqrt(1 - window_phase * window_phase))
+            / window_mod;
+         sum                += row[j];
+      }
+
+      /* Every phase gets exactly unity gain at DC once quantized,
+       * so stepping through phases doesn't ripple a constant signal. */
+      for (j = 0; j < taps; j++)
+      {
+         phase_table[i * taps + j] = (int16_t)floor(
+               row[j] / sum * (1 << SINC_S16_COEFF_BITS) + 0.5);
+         total                    += phase_table[i * taps + j];
+      }
+
+      center = (i * 2 < phases) ? taps / 2 : taps / 2 - 1;
+      phase_table[i * taps + center] += (1 << SINC_S16_COEFF_BITS) - total;
+   }
+
+   free(row);
+}
+
+static void *resampler_sinc_s16_new(const struct resampler_config *config,
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask)
+{
+   double cutoff                      = 0.0;
+   double kaiser_beta                 = 0.0;
+   size_t phase_elems                 = 0;
+   size_t elems                       = 0;
+   unsigned sidelobes                 = 0;
+   rarch_sinc_s16_resampler_t *re     = (rarch_sinc_s16_resampler_t*)
+      calloc(1, sizeof(*re));
+
+   if (!re)
+      return NULL;
+
+   /* Without delta tables, more phases stand in for
+    * the float resampler's subphase interpolation. */
+   switch (quality)
+   {
+      case RESAMPLER_QUALITY_LOWEST:
+         cutoff            = 0.90;
+         sidelobes         = 2;
+         re->phase_bits    = 8;
+         kaiser_beta       = 3.5;
+         break;
+      case RESAMPLER_QUALITY_LOWER:
+         cutoff            = 0.85;
+         sidelobes         = 4;
+         re->phase_bits    = 9;
+         kaiser_beta       = 4.5;
+         break;
+      case RESAMPLER_QUALITY_HIGHER:
+         cutoff            = 0.90;
+         sidelobes         = 16;
+         re->phase_bits    = 10;
+         kaiser_beta       = 8.5;
+         break;
+      case RESAMPLER_QUALITY_HIGHEST:
+         cutoff            = 0.93;
+         sidelobes         = 32;
+         re->phase_bits    = 10;
+         kaiser_beta       = 10.5;
+         break;
+      case RESAMPLER_QUALITY_NORMAL:
+      case RESAMPLER_QUALITY_DONTCARE:
+         cutoff            = 0.825;
+         sidelobes         = 8;
+         re->phase_bits    = 10;
+         kaiser_beta       = 5.5;
+         break;
+   }
+
+   re->subphase_bits = 24 - re->phase_bits;
+   re->taps          = sidelobes * 2;
+
+   /* Downsampling, must lower cutoff, and extend number of
+    * taps accordingly to keep same stopband attenuation. */
+   if (bandwidth_mod < 1.0)
+   {
+      cutoff  *= bandwidth_mod;
+      re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
+   }
+
+   /* Be SIMD-friendly. */
+   re->taps    = (re->taps + 7) & ~7;
+
+   phase_elems = (1 << re->phase_bits) * re->taps;
+   elems       = phase_elems + 4 * re->taps;
+
+   re->main_buffer = (int16_t*)memalign_alloc(128, sizeof(int16_t) * elems);
+   if (!re->main_buffer)
+      goto error;
+
+   memset(re->main_buffer, 0, sizeof(int16_t) * elems);
+
+   re->phase_table = re->main_buffer;
+   re->buffer_l    = re->main_buffer + phase_elems;
+   re->buffer_r    = re->buffer_l + 2 * re->taps;
+
+   sinc_s16_init_table_kaiser(re->phase_table, cutoff, kaiser_beta,
+         1 << re->phase_bits, re->taps);
+
+   re->process     = resampler_sinc_s16_process_c;
+#if defined(__SSE2__)
+   if (mask & RESAMPLER_SIMD_SSE2)
+      re->process  = resampler_sinc_s16_process_sse2;
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON))
+   if (mask & RESAMPLER_SIMD_NEON)
+      re->process  = resampler_sinc_s16_process_neon;
+#endif
+
+   return re;
+
+error:
+   resampler_sinc_s16_free(re);
+   return NULL;
+}
+
+retro_resampler_t sinc_s16_resampler = {
+   resampler_sinc_s16_new,
+   resampler_sinc_s16_process,
+   resampler_sinc_s16_free,
+   RESAMPLER_API_VERSION,
+   "sinc_s16",
+   "sinc_s16",
+   resampler_sinc_s16_process_s16
+};
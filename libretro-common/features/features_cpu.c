@@ -595,6 +595,22 @@ unsigned cpu_features_get_core_amount(void)
 #define VENDOR_INTEL_c  0x6c65746e
 #define VENDOR_INTEL_d  0x49656e69
 
+bool cpu_features_has_pclmul(void)
+{
+#if defined(CPU_X86) && !defined(__MACH__)
+   int32_t flags[4];
+
+   x86_cpuid(0, flags);
+   if (flags[0] < 1)
+      return false;
+
+   x86_cpuid(1, flags);
+   return (flags[2] & (1 << 1)) != 0;
+#else
+   return false;
+#endif
+}
+
 uint64_t cpu_features_get(void)
 {
    uint64_t cpu        = 0;
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
 
 #include <gfx/scaler/pixconv.h>
@@ -45,6 +46,205 @@
 #include <arm_neon.h>
 #endif
 
+/* AVX2 row kernels, picked at runtime. The intrinsics are compiled
+ * for that target only, so the rest of the file keeps the build's
+ * baseline instruction set. */
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__)) \
+      && !defined(__MACH__) && (defined(__clang__) || (defined(__GNUC__) \
+      && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define PIXCONV_HAVE_AVX2
+#define PIXCONV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#ifdef PIXCONV_HAVE_AVX2
+#include <immintrin.h>
+#include <features/features_cpu.h>
+
+static bool pixconv_have_avx2(void)
+{
+   /* 0 = not checked yet, 1 = SSE2 only, 2 = AVX2.
+    * AVX2 is only usable when the OS saves YMM state, which
+    * RETRO_SIMD_AVX reports. */
+   static int simd = 0;
+   if (!simd)
+      simd = ((cpu_features_get() & (RETRO_SIMD_AVX | RETRO_SIMD_AVX2))
+            == (RETRO_SIMD_AVX | RETRO_SIMD_AVX2)) ? 2 : 1;
+   return simd == 2;
+}
+
+/* Each kernel converts as many whole vectors of one row as fit in
+ * @width and returns the number of pixels it wrote; the caller
+ * finishes the row with the SSE2 and C loops. */
+
+PIXCONV_TARGET_AVX2
+static int conv_0rgb1555_argb8888_avx2(uint32_t *output,
+      const uint16_t *input, int width)
+{
+   int w;
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+   const __m256i a           = _mm256_set1_epi16(0x00ff);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i res_lo, res_hi;
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r = _mm256_and_si256(in, pix_mask_r);
+      __m256i g = _mm256_and_si256(in, pix_mask_gb);
+      __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_gb);
+
+      r      = _mm256_mulhi_epi16(r, mul15_hi);
+      g      = _mm256_mulhi_epi16(g, mul15_mid);
+      b      = _mm256_mulhi_epi16(b, mul15_mid);
+
+      /* Unpacks stay inside 128-bit lanes, so res_lo holds
+       * pixels 0-3 and 8-11, res_hi pixels 4-7 and 12-15. */
+      res_lo = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+            _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+      res_hi = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+            _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+      _mm256_storeu_si256((__m256i*)(output + w + 0),
+            _mm256_permute2x128_si256(res_lo, res_hi, 0x20));
+      _mm256_storeu_si256((__m256i*)(output + w + 8),
+            _mm256_permute2x128_si256(res_lo, res_hi, 0x31));
+   }
+
+   return w;
+}
+
+PIXCONV_TARGET_AVX2
+static int conv_rgb565_argb8888_avx2(uint32_t *output,
+      const uint16_t *input, int width)
+{
+   int w;
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+   const __m256i a          = _mm256_set1_epi16(0x00ff);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i res_lo, res_hi;
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r = _mm256_and_si256(_mm256_srli_epi16(in, 1), pix_mask_r);
+      __m256i g = _mm256_and_si256(in, pix_mask_g);
+      __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_b);
+
+      r      = _mm256_mulhi_epi16(r, mul16_r);
+      g      = _mm256_mulhi_epi16(g, mul16_g);
+      b      = _mm256_mulhi_epi16(b, mul16_b);
+
+      res_lo = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+            _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+      res_hi = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+            _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+      _mm256_storeu_si256((__m256i*)(output + w + 0),
+            _mm256_permute2x128_si256(res_lo, res_hi, 0x20));
+      _mm256_storeu_si256((__m256i*)(output + w + 8),
+            _mm256_permute2x128_si256(res_lo, res_hi, 0x31));
+   }
+
+   return w;
+}
+
+PIXCONV_TARGET_AVX2
+static int conv_argb8888_0rgb1555_avx2(uint16_t *output,
+      const uint32_t *input, int width)
+{
+   int w;
+   const __m256i r_mask = _mm256_set1_epi32(0x1f << 10);
+   const __m256i g_mask = _mm256_set1_epi32(0x1f <<  5);
+   const __m256i b_mask = _mm256_set1_epi32(0x1f);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      __m256i c0  = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+      __m256i c1  = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+      __m256i res;
+
+      c0  = _mm256_or_si256(
+            _mm256_or_si256(
+               _mm256_and_si256(_mm256_srli_epi32(c0, 9), r_mask),
+               _mm256_and_si256(_mm256_srli_epi32(c0, 6), g_mask)),
+            _mm256_and_si256(_mm256_srli_epi32(c0, 3), b_mask));
+      c1  = _mm256_or_si256(
+            _mm256_or_si256(
+               _mm256_and_si256(_mm256_srli_epi32(c1, 9), r_mask),
+               _mm256_and_si256(_mm256_srli_epi32(c1, 6), g_mask)),
+            _mm256_and_si256(_mm256_srli_epi32(c1, 3), b_mask));
+
+      /* Values fit in 15 bits, so the signed pack never saturates.
+       * It packs per 128-bit lane; put the quadwords back in order. */
+      res = _mm256_permute4x64_epi64(_mm256_packs_epi32(c0, c1),
+            _MM_SHUFFLE(3, 1, 2, 0));
+      _mm256_storeu_si256((__m256i*)(output + w), res);
+   }
+
+   return w;
+}
+
+PIXCONV_TARGET_AVX2
+static int conv_bgr24_argb8888_avx2(uint32_t *output,
+      const uint8_t *input, int width)
+{
+   int w;
+   /* The upper half of the second vector is loaded 4 bytes early
+    * so the last load ends on the last byte of the 16 pixels. */
+   const __m256i shuf_lo = _mm256_setr_epi8(
+          0,  1,  2, -1,  3,  4,  5, -1,  6,  7,  8, -1,  9, 10, 11, -1,
+          0,  1,  2, -1,  3,  4,  5, -1,  6,  7,  8, -1,  9, 10, 11, -1);
+   const __m256i shuf_hi = _mm256_setr_epi8(
+          0,  1,  2, -1,  3,  4,  5, -1,  6,  7,  8, -1,  9, 10, 11, -1,
+          4,  5,  6, -1,  7,  8,  9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+   const __m256i a       = _mm256_set1_epi32((int)0xff000000u);
+
+   for (w = 0; w + 16 <= width; w += 16)
+   {
+      const uint8_t *inp = input + w * 3;
+      __m256i lo = _mm256_inserti128_si256(_mm256_castsi128_si256(
+               _mm_loadu_si128((const __m128i*)(inp +  0))),
+            _mm_loadu_si128((const __m128i*)(inp + 12)), 1);
+      __m256i hi = _mm256_inserti128_si256(_mm256_castsi128_si256(
+               _mm_loadu_si128((const __m128i*)(inp + 24))),
+            _mm_loadu_si128((const __m128i*)(inp + 32)), 1);
+
+      lo = _mm256_or_si256(_mm256_shuffle_epi8(lo, shuf_lo), a);
+      hi = _mm256_or_si256(_mm256_shuffle_epi8(hi, shuf_hi), a);
+
+      _mm256_storeu_si256((__m256i*)(output + w + 0), lo);
+      _mm256_storeu_si256((__m256i*)(output + w + 8), hi);
+   }
+
+   return w;
+}
+
+PIXCONV_TARGET_AVX2
+static int conv_argb8888_abgr8888_avx2(uint32_t *output,
+      const uint32_t *input, int width)
+{
+   int w;
+   const __m256i shuf = _mm256_setr_epi8(
+          2,  1,  0,  3,  6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15,
+          2,  1,  0,  3,  6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15);
+
+   for (w = 0; w + 8 <= width; w += 8)
+   {
+      __m256i c = _mm256_loadu_si256((const __m256i*)(input + w));
+      _mm256_storeu_si256((__m256i*)(output + w),
+            _mm256_shuffle_epi8(c, shuf));
+   }
+
+   return w;
+}
+#endif
+
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -57,6 +257,10 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
    int max_width           = width - 7;
    const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width           = width - 7;
+   const uint16x8_t hi_mask = vdupq_n_u16(0x7fe0);
+   const uint16x8_t lo_mask = vdupq_n_u16(0x1f);
 #endif
 
    for (h = 0; h < height;
@@ -67,10 +271,18 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+         __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
          __m128i lo = _mm_and_si128(in, lo_mask);
          _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t hi = vandq_u16(vshrq_n_u16(in, 1), hi_mask);
+         uint16x8_t lo = vandq_u16(in, lo_mask);
+         vst1q_u16(output + w, vorrq_u16(hi, lo));
+      }
 #endif
 
       for (; w < width; w++)
@@ -98,6 +310,11 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          (int16_t)((0x1f << 11) | (0x1f << 6)));
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
    const __m128i glow_mask = _mm_set1_epi16(1 << 5);
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width              = width - 7;
+   const uint16x8_t hi_mask   = vdupq_n_u16((0x1f << 11) | (0x1f << 6));
+   const uint16x8_t lo_mask   = vdupq_n_u16(0x1f);
+   const uint16x8_t glow_mask = vdupq_n_u16(1 << 5);
 #endif
 
    for (h = 0; h < height;
@@ -114,6 +331,15 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w),
                _mm_or_si128(rg, _mm_or_si128(b, glow)));
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         uint16x8_t in   = vld1q_u16(input + w);
+         uint16x8_t rg   = vandq_u16(vshlq_n_u16(in, 1), hi_mask);
+         uint16x8_t b    = vandq_u16(in, lo_mask);
+         uint16x8_t glow = vandq_u16(vshrq_n_u16(in, 4), glow_mask);
+         vst1q_u16(output + w, vorrq_u16(rg, vorrq_u16(b, glow)));
+      }
 #endif
 
       for (; w < width; w++)
@@ -142,13 +368,22 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
    const __m128i mul15_hi    = _mm_set1_epi16(0x0210);
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
+   int max_width = width - 7;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
    int max_width = width - 7;
 #endif
+#ifdef PIXCONV_HAVE_AVX2
+   bool avx2     = pixconv_have_avx2();
+#endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
+#ifdef PIXCONV_HAVE_AVX2
+      if (avx2)
+         w = conv_0rgb1555_argb8888_avx2(output, input, width);
+#endif
 #ifdef __SSE2__
       for (; w < max_width; w += 8)
       {
@@ -177,6 +412,25 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         uint16x8_t in = vld1q_u16(input + w);
+
+         /* Narrow so each 5-bit field sits in the top of a byte,
+          * then copy its top 3 bits into the bottom. */
+         uint8x8_t r   = vshrn_n_u16(in, 7);
+         uint8x8_t g   = vshrn_n_u16(in, 2);
+         uint8x8_t b   = vmovn_u16(vshlq_n_u16(in, 3));
+
+         uint8x8x4_t res;
+         res.val[3]    = vdup_n_u8(0xffu);
+         res.val[2]    = vsri_n_u8(r, r, 5);
+         res.val[1]    = vsri_n_u8(g, g, 5);
+         res.val[0]    = vsri_n_u8(b, b, 5);
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -225,11 +479,18 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
 #elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
    int max_width            = width - 7;
 #endif
+#ifdef PIXCONV_HAVE_AVX2
+   bool avx2                = pixconv_have_avx2();
+#endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
+#ifdef PIXCONV_HAVE_AVX2
+      if (avx2)
+         w = conv_rgb565_argb8888_avx2(output, input, width);
+#endif
 #if defined(__SSE2__)
       for (; w < max_width; w += 8)
       {
@@ -347,7 +608,7 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
       for (; w < max_width; w += 8)
       {
          __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+         __m128i res_lo_rg, res_hi_rg, res_lo_ba, res_hi_ba;
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
          __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
          __m128i        g = _mm_and_si128(in, pix_mask_g);
@@ -355,14 +616,14 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
          r                = _mm_mulhi_epi16(r, mul16_r);
          g                = _mm_mulhi_epi16(g, mul16_g);
          b                = _mm_mulhi_epi16(b, mul16_b);
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-         res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
+         res_lo_rg        = _mm_unpacklo_epi8(r, g);
+         res_hi_rg        = _mm_unpackhi_epi8(r, g);
+         res_lo_ba        = _mm_unpacklo_epi8(b, a);
+         res_hi_ba        = _mm_unpackhi_epi8(b, a);
+         res_lo           = _mm_or_si128(res_lo_rg,
+               _mm_slli_si128(res_lo_ba, 2));
+         res_hi           = _mm_or_si128(res_hi_rg,
+               _mm_slli_si128(res_hi_ba, 2));
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
@@ -402,24 +663,64 @@ void conv_argb8888_rgba4444(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i r_mask  = _mm_set1_epi32(0xf << 12);
+   const __m128i g_mask  = _mm_set1_epi32(0xf <<  8);
+   const __m128i b_mask  = _mm_set1_epi32(0xf <<  4);
+
+   int max_width         = width - 7;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i c0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         __m128i c1 = _mm_loadu_si128((const __m128i*)(input + w + 4));
+
+         c0 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c0, 8), r_mask),
+                  _mm_and_si128(_mm_srli_epi32(c0, 4), g_mask)),
+               _mm_or_si128(_mm_and_si128(c0, b_mask),
+                  _mm_srli_epi32(c0, 28)));
+         c1 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c1, 8), r_mask),
+                  _mm_and_si128(_mm_srli_epi32(c1, 4), g_mask)),
+               _mm_or_si128(_mm_and_si128(c1, b_mask),
+                  _mm_srli_epi32(c1, 28)));
+
+         /* Sign-extend so the signed pack keeps all 16 bits */
+         c0 = _mm_srai_epi32(_mm_slli_epi32(c0, 16), 16);
+         c1 = _mm_srai_epi32(_mm_slli_epi32(c1, 16), 16);
+         _mm_storeu_si128((__m128i*)(output + w), _mm_packs_epi32(c0, c1));
+      }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+         uint8x8x2_t res;
+         res.val[0]     = vsri_n_u8(in.val[0], in.val[3], 4);
+         res.val[1]     = vsri_n_u8(in.val[2], in.val[1], 4);
+         vst2_u8((uint8_t*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r   = (col >> 16) & 0xf;
-         uint32_t g   = (col >>  8) & 0xf;
-         uint32_t b   = (col) & 0xf;
-         uint32_t a   = (col >>  24) & 0xf;
-         r            = (r >> 4) | r;
-         g            = (g >> 4) | g;
-         b            = (b >> 4) | b;
-         a            = (a >> 4) | a;
+         uint32_t r   = (col >> 20) & 0xf;
+         uint32_t g   = (col >> 12) & 0xf;
+         uint32_t b   = (col >>  4) & 0xf;
+         uint32_t a   = (col >> 28) & 0xf;
 
          output[w]    = (r << 12) | (g << 8) | (b << 4) | a;
       }
@@ -434,23 +735,66 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
    const uint16_t *input = (const uint16_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
-#if defined(__MMX__)
+#if defined(__SSE2__)
+   const __m128i pix_mask_r = _mm_set1_epi16(0xf << 10);
+   const __m128i pix_mask_g = _mm_set1_epi16(0xf << 8);
+   const __m128i pix_mask_b = _mm_set1_epi16(0xf << 8);
+   const __m128i pix_mask_a = _mm_set1_epi16(0xf);
+   const __m128i mul16_r    = _mm_set1_epi16(0x0440);
+   const __m128i mul16_g    = _mm_set1_epi16(0x1100);
+   const __m128i mul16_b    = _mm_set1_epi16(0x1100);
+   const __m128i mul16_a    = _mm_set1_epi16(0x0011);
+
+   int max_width            = width - 7;
+#elif defined(__MMX__)
    const __m64 pix_mask_r = _mm_set1_pi16(0xf << 10);
    const __m64 pix_mask_g = _mm_set1_pi16(0xf << 8);
    const __m64 pix_mask_b = _mm_set1_pi16(0xf << 8);
+   const __m64 pix_mask_a = _mm_set1_pi16(0xf);
    const __m64 mul16_r    = _mm_set1_pi16(0x0440);
    const __m64 mul16_g    = _mm_set1_pi16(0x1100);
    const __m64 mul16_b    = _mm_set1_pi16(0x1100);
-   const __m64 a          = _mm_set1_pi16(0x00ff);
+   const __m64 mul16_a    = _mm_set1_pi16(0x0011);
 
    int max_width            = width - 3;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width            = width - 7;
 #endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__MMX__)
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i res_lo, res_hi;
+         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 2), pix_mask_r);
+         __m128i        g = _mm_and_si128(in, pix_mask_g);
+         __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 4), pix_mask_b);
+         __m128i        a = _mm_and_si128(in, pix_mask_a);
+
+         r                = _mm_mulhi_epi16(r, mul16_r);
+         g                = _mm_mulhi_epi16(g, mul16_g);
+         b                = _mm_mulhi_epi16(b, mul16_b);
+         a                = _mm_mullo_epi16(a, mul16_a);
+
+         res_lo_bg        = _mm_unpacklo_epi8(b, g);
+         res_hi_bg        = _mm_unpackhi_epi8(b, g);
+         res_lo_ra        = _mm_unpacklo_epi8(r, a);
+         res_hi_ra        = _mm_unpackhi_epi8(r, a);
+
+         res_lo           = _mm_or_si128(res_lo_bg,
+               _mm_slli_si128(res_lo_ra, 2));
+         res_hi           = _mm_or_si128(res_hi_bg,
+               _mm_slli_si128(res_hi_ra, 2));
+
+         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+         _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+      }
+#elif defined(__MMX__)
       for (; w < max_width; w += 4)
       {
          __m64 res_lo, res_hi;
@@ -459,10 +803,12 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
          __m64          r = _mm_and_si64(_mm_srli_pi16(in, 2), pix_mask_r);
          __m64          g = _mm_and_si64(in, pix_mask_g);
          __m64          b = _mm_and_si64(_mm_slli_pi16(in, 4), pix_mask_b);
+         __m64          a = _mm_and_si64(in, pix_mask_a);
 
          r                = _mm_mulhi_pi16(r, mul16_r);
          g                = _mm_mulhi_pi16(g, mul16_g);
          b                = _mm_mulhi_pi16(b, mul16_b);
+         a                = _mm_mullo_pi16(a, mul16_a);
 
          res_lo_bg        = _mm_unpacklo_pi8(b, g);
          res_hi_bg        = _mm_unpackhi_pi8(b, g);
@@ -479,6 +825,20 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
       }
 
       _mm_empty();
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         /* Low byte of each pixel is BA, high byte is RG */
+         uint8x8x2_t in = vld2_u8((const uint8_t*)(input + w));
+
+         uint8x8x4_t res;
+         res.val[3]     = vsli_n_u8(in.val[0], in.val[0], 4);
+         res.val[2]     = vsri_n_u8(in.val[1], in.val[1], 4);
+         res.val[1]     = vsli_n_u8(in.val[1], in.val[1], 4);
+         res.val[0]     = vsri_n_u8(in.val[0], in.val[0], 4);
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -502,14 +862,50 @@ void conv_rgba4444_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint16_t *input = (const uint16_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i r_mask  = _mm_set1_epi16((int16_t)0xf000);
+   const __m128i g_mask  = _mm_set1_epi16(0x0f00 >> 1);
+   const __m128i b_mask  = _mm_set1_epi16(0x00f0 >> 3);
+
+   int max_width         = width - 7;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   const uint16x8_t r_mask = vdupq_n_u16(0xf000);
+   const uint16x8_t g_mask = vdupq_n_u16(0x0f00 >> 1);
+   const uint16x8_t b_mask = vdupq_n_u16(0x00f0 >> 3);
+
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i r = _mm_and_si128(in, r_mask);
+         __m128i g = _mm_and_si128(_mm_srli_epi16(in, 1), g_mask);
+         __m128i b = _mm_and_si128(_mm_srli_epi16(in, 3), b_mask);
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_or_si128(r, _mm_or_si128(g, b)));
+      }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t r  = vandq_u16(in, r_mask);
+         uint16x8_t g  = vandq_u16(vshrq_n_u16(in, 1), g_mask);
+         uint16x8_t b  = vandq_u16(vshrq_n_u16(in, 3), b_mask);
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 12) & 0xf;
@@ -584,6 +980,8 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
    int max_width             = width - 15;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width             = width - 7;
 #endif
 
    for (h = 0; h < height;
@@ -635,6 +1033,21 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
          /* Non-POT pixel sizes for the loss */
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8, out += 24)
+      {
+         uint16x8_t in = vld1q_u16(input + w);
+         uint8x8_t r   = vshrn_n_u16(in, 7);
+         uint8x8_t g   = vshrn_n_u16(in, 2);
+         uint8x8_t b   = vmovn_u16(vshlq_n_u16(in, 3));
+
+         uint8x8x3_t res;
+         res.val[2]    = vsri_n_u8(r, r, 5);
+         res.val[1]    = vsri_n_u8(g, g, 5);
+         res.val[0]    = vsri_n_u8(b, b, 5);
+
+         vst3_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -672,6 +1085,8 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    const __m128i a          = _mm_set1_epi16(0x00ff);
 
    int max_width            = width - 15;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width            = width - 7;
 #endif
 
    for (h = 0; h < height; h++, output += out_stride, input += in_stride >> 1)
@@ -720,6 +1135,22 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
 
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8, out += 24)
+      {
+         uint16x8_t in = vld1q_u16(input + w);
+
+         uint16x8_t r  = vsriq_n_u16(in, in, 5);
+         uint16x8_t b  = vsliq_n_u16(in, in, 5);
+         uint16x8_t g  = vsriq_n_u16(b,  b,  6);
+
+         uint8x8x3_t res;
+         res.val[2]    = vshrn_n_u16(r, 8);
+         res.val[1]    = vshrn_n_u16(g, 8);
+         res.val[0]    = vshrn_n_u16(b, 2);
+
+         vst3_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -743,15 +1174,42 @@ void conv_bgr24_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint8_t *input = (const uint8_t*)input_;
    uint32_t *output     = (uint32_t*)output_;
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width        = width - 7;
+#endif
+#ifdef PIXCONV_HAVE_AVX2
+   bool avx2            = pixconv_have_avx2();
+#endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride)
    {
       const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int              w = 0;
+#ifdef PIXCONV_HAVE_AVX2
+      if (avx2)
+      {
+         w    = conv_bgr24_argb8888_avx2(output, input, width);
+         inp += w * 3;
+      }
+#endif
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8, inp += 24)
+      {
+         uint8x8x3_t in = vld3_u8(inp);
+         uint8x8x4_t res;
+         res.val[3]     = vdup_n_u8(0xffu);
+         res.val[2]     = in.val[2];
+         res.val[1]     = in.val[1];
+         res.val[0]     = in.val[0];
+         vst4_u8((uint8_t*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t b = *inp++;
          uint32_t g = *inp++;
@@ -765,14 +1223,31 @@ void conv_bgr24_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint8_t *input = (const uint8_t*)input_;
    uint16_t *output     = (uint16_t*)output_;
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width        = width - 7;
+#endif
+
    for (h = 0; h < height;
-         h++, output += out_stride, input += in_stride)
+         h++, output += out_stride >> 1, input += in_stride)
    {
       const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int              w = 0;
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8, inp += 24)
+      {
+         uint8x8x3_t in = vld3_u8(inp);
+         /* Insert G and B under the top bits of R */
+         uint16x8_t res = vshll_n_u8(in.val[2], 8);
+         res            = vsriq_n_u16(res, vshll_n_u8(in.val[1], 8), 5);
+         res            = vsriq_n_u16(res, vshll_n_u8(in.val[0], 8), 11);
+         vst1q_u16(output + w, res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint16_t b = *inp++;
          uint16_t g = *inp++;
@@ -787,14 +1262,61 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i r_mask  = _mm_set1_epi32(0x1f << 10);
+   const __m128i g_mask  = _mm_set1_epi32(0x1f <<  5);
+   const __m128i b_mask  = _mm_set1_epi32(0x1f);
+
+   int max_width         = width - 7;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width         = width - 7;
+#endif
+#ifdef PIXCONV_HAVE_AVX2
+   bool avx2             = pixconv_have_avx2();
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#ifdef PIXCONV_HAVE_AVX2
+      if (avx2)
+         w = conv_argb8888_0rgb1555_avx2(output, input, width);
+#endif
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i c0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         __m128i c1 = _mm_loadu_si128((const __m128i*)(input + w + 4));
+
+         c0 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c0, 9), r_mask),
+                  _mm_and_si128(_mm_srli_epi32(c0, 6), g_mask)),
+               _mm_and_si128(_mm_srli_epi32(c0, 3), b_mask));
+         c1 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c1, 9), r_mask),
+                  _mm_and_si128(_mm_srli_epi32(c1, 6), g_mask)),
+               _mm_and_si128(_mm_srli_epi32(c1, 3), b_mask));
+
+         /* 15-bit values, the signed pack never saturates */
+         _mm_storeu_si128((__m128i*)(output + w), _mm_packs_epi32(c0, c1));
+      }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+         uint16x8_t r   = vshlq_n_u16(vmovl_u8(vshr_n_u8(in.val[2], 3)), 10);
+         uint16x8_t g   = vshlq_n_u16(vmovl_u8(vshr_n_u8(in.val[1], 3)),  5);
+         uint16x8_t b   = vmovl_u8(vshr_n_u8(in.val[0], 3));
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint16_t r   = (col >> 19) & 0x1f;
@@ -813,7 +1335,7 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint8_t *output       = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(__SSE2__) || (defined(__ARM_NEON__) || defined(__ARM_NEON))
    int max_width = width - 15;
 #endif
 
@@ -831,6 +1353,16 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
          __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
          store_bgr24_sse2(out, l0, l1, l2, l3);
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 16, out += 48)
+      {
+         uint8x16x4_t in = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16x3_t res;
+         res.val[0]      = in.val[0];
+         res.val[1]      = in.val[1];
+         res.val[2]      = in.val[2];
+         vst3q_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -866,7 +1398,7 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint8_t *output       = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(__SSE2__) || (defined(__ARM_NEON__) || defined(__ARM_NEON))
    int max_width = width - 15;
 #endif
 
@@ -888,6 +1420,16 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
          d = conv_shuffle_rb_epi32(d);
          store_bgr24_sse2(out, a, b, c, d);
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 16, out += 48)
+      {
+         uint8x16x4_t in = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16x3_t res;
+         res.val[0]      = in.val[2];
+         res.val[1]      = in.val[1];
+         res.val[2]      = in.val[0];
+         vst3q_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -904,14 +1446,53 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i ag_mask = _mm_set1_epi32((int)0xff00ff00u);
+   const __m128i b_mask  = _mm_set1_epi32(0x000000ff);
+   const __m128i r_mask  = _mm_set1_epi32(0x00ff0000);
+
+   int max_width         = width - 3;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width         = width - 15;
+#endif
+#ifdef PIXCONV_HAVE_AVX2
+   bool avx2             = pixconv_have_avx2();
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#ifdef PIXCONV_HAVE_AVX2
+      if (avx2)
+         w = conv_argb8888_abgr8888_avx2(output, input, width);
+#endif
+#if defined(__SSE2__)
+      for (; w < max_width; w += 4)
+      {
+         __m128i c  = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i rb = _mm_or_si128(
+               _mm_and_si128(_mm_slli_epi32(c, 16), r_mask),
+               _mm_and_si128(_mm_srli_epi32(c, 16), b_mask));
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_or_si128(_mm_and_si128(c, ag_mask), rb));
+      }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 16)
+      {
+         uint8x16x4_t c = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16_t   t = c.val[0];
+         c.val[0]       = c.val[2];
+         c.val[2]       = t;
+         vst4q_u8((uint8_t*)(output + w), c);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
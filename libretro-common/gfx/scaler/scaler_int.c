@@ -22,6 +22,7 @@
 
 #include <gfx/scaler/scaler_int.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
 
 #ifdef SCALER_NO_SIMD
@@ -33,6 +34,84 @@
 #ifdef _WIN32
 #include <intrin.h>
 #endif
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#endif
+
+/* AVX2 kernels, picked at runtime. The intrinsics are compiled
+ * for that target only, so the rest of the file keeps the build's
+ * baseline instruction set. */
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__)) \
+      && !defined(__MACH__) && (defined(__clang__) || (defined(__GNUC__) \
+      && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SCALER_HAVE_AVX2
+#define SCALER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#ifdef SCALER_HAVE_AVX2
+#include <immintrin.h>
+#include <features/features_cpu.h>
+
+static bool scaler_have_avx2(void)
+{
+   /* 0 = not checked yet, 1 = SSE2 only, 2 = AVX2 */
+   static int simd = 0;
+   if (!simd)
+      simd = ((cpu_features_get() & (RETRO_SIMD_AVX | RETRO_SIMD_AVX2))
+            == (RETRO_SIMD_AVX | RETRO_SIMD_AVX2)) ? 2 : 1;
+   return simd == 2;
+}
+
+/* Four output pixels of one row per iteration. Returns the number
+ * of pixels written; the caller finishes the row. */
+SCALER_TARGET_AVX2
+static int scaler_argb8888_vert_avx2(uint32_t *output,
+      const uint64_t *input_base, const int16_t *filter_vert,
+      int filter_len, int in_stride, int width)
+{
+   int w, y;
+
+   for (w = 0; w + 4 <= width; w += 4)
+   {
+      __m128i final;
+      const uint64_t *input_base_y = input_base + w;
+      __m256i res                  = _mm256_setzero_si256();
+
+      for (y = 0; y < filter_len; y++, input_base_y += in_stride)
+      {
+         __m256i coeff = _mm256_set1_epi16(filter_vert[y]);
+         __m256i col   = _mm256_loadu_si256((const __m256i*)input_base_y);
+
+         res           = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res);
+      }
+
+      res   = _mm256_srai_epi16(res, (7 - 2 - 2));
+      final = _mm_packus_epi16(_mm256_castsi256_si128(res),
+            _mm256_extracti128_si256(res, 1));
+
+      _mm_storeu_si128((__m128i*)(output + w), final);
+   }
+
+   return w;
+}
+
+SCALER_TARGET_AVX2
+static int scaler_argb8888_point_avx2(uint32_t *output,
+      const uint32_t *inp, int x, int x_step, int width)
+{
+   int w;
+   const __m256i step = _mm256_set1_epi32(x_step * 8);
+   __m256i pos        = _mm256_add_epi32(_mm256_set1_epi32(x),
+         _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_set1_epi32(x_step)));
+
+   for (w = 0; w + 8 <= width; w += 8, pos = _mm256_add_epi32(pos, step))
+      _mm256_storeu_si256((__m256i*)(output + w),
+            _mm256_i32gather_epi32((const int*)inp,
+               _mm256_srli_epi32(pos, 16), 4));
+
+   return w;
+}
 #endif
 
 /* ARGB8888 scaler is split in two:
@@ -69,6 +148,9 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
    uint32_t           *output = (uint32_t*)output_;
 
    const int16_t *filter_vert = ctx->vert.filter;
+#ifdef SCALER_HAVE_AVX2
+   bool avx2                  = scaler_have_avx2();
+#endif
 
    for (h = 0; h < ctx->out_height; h++,
          filter_vert += ctx->vert.filter_stride, output += stride >> 2)
@@ -76,37 +158,70 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
       const uint64_t *input_base = input + ctx->vert.filter_pos[h]
          * (ctx->scaled.stride >> 3);
 
-      for (w = 0; w < ctx->out_width; w++)
-      {
-         const uint64_t *input_base_y = input_base + w;
+      /* Every pixel of an output row shares the same taps, so the
+       * SIMD paths filter several pixels at once. Scaled rows are
+       * padded to a multiple of 8 pixels, which lets the last
+       * vector read past out_width. */
 #if defined(__SSE2__)
+      w = 0;
+#ifdef SCALER_HAVE_AVX2
+      if (avx2)
+         w = scaler_argb8888_vert_avx2(output, input_base, filter_vert,
+               ctx->vert.filter_len, ctx->scaled.stride >> 3,
+               ctx->out_width);
+#endif
+      for (; w < ctx->out_width; w += 2)
+      {
          __m128i final;
-         __m128i res = _mm_setzero_si128();
+         const uint64_t *input_base_y = input_base + w;
+         __m128i res                  = _mm_setzero_si128();
 
-         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
-               input_base_y += (ctx->scaled.stride >> 2))
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += (ctx->scaled.stride >> 3))
          {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
+            __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+            __m128i col   = _mm_loadu_si128((const __m128i*)input_base_y);
 
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
          }
 
-         for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
+         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+         final     = _mm_packus_epi16(res, res);
+
+         if (w + 1 < ctx->out_width)
+            _mm_storel_epi64((__m128i*)(output + w), final);
+         else
+            output[w] = _mm_cvtsi128_si32(final);
+      }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (w = 0; w < ctx->out_width; w += 2)
+      {
+         uint8x8_t final;
+         const uint64_t *input_base_y = input_base + w;
+         int16x8_t res                = vdupq_n_s16(0);
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += (ctx->scaled.stride >> 3))
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
+            int16x8_t col = vld1q_s16((const int16_t*)input_base_y);
+            int16x8_t mul = vcombine_s16(
+                  vshrn_n_s32(vmull_n_s16(vget_low_s16(col),  filter_vert[y]), 16),
+                  vshrn_n_s32(vmull_n_s16(vget_high_s16(col), filter_vert[y]), 16));
 
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+            res           = vqaddq_s16(mul, res);
          }
 
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-         res       = _mm_srai_epi16(res, (7 - 2 - 2));
-
-         final     = _mm_packus_epi16(res, res);
+         final = vqshrun_n_s16(res, (7 - 2 - 2));
 
-         output[w] = _mm_cvtsi128_si32(final);
+         if (w + 1 < ctx->out_width)
+            vst1_u8((uint8_t*)(output + w), final);
+         else
+            vst1_lane_u32(output + w, vreinterpret_u32_u8(final), 0);
+      }
 #else
+      for (w = 0; w < ctx->out_width; w++)
+      {
+         const uint64_t *input_base_y = input_base + w;
          int16_t res_a = 0;
          int16_t res_r = 0;
          int16_t res_g = 0;
@@ -140,8 +255,8 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
             (clamp_8bit(res_r) << 16) |
             (clamp_8bit(res_g) << 8)  |
             (clamp_8bit(res_b) << 0);
-#endif
       }
+#endif
    }
 }
 
@@ -171,7 +286,8 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 #endif
          for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
          {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
+            __m128i coeff = _mm_unpacklo_epi64(_mm_set1_epi16(filter_horiz[x + 0]),
+                  _mm_set1_epi16(filter_horiz[x + 1]));
 
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi64x(0,
                      ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
@@ -182,7 +298,7 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 
          for (; x < ctx->horiz.filter_len; x++)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set1_epi16(filter_horiz[x]);
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
 
             col           = _mm_slli_epi16(col, 7);
@@ -198,6 +314,33 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
          u.u32[0] = _mm_cvtsi128_si32(res);
          u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
 #endif
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+         /* Even and odd taps are summed apart, like the SSE2 path */
+         int16x4_t res_even = vdup_n_s16(0);
+         int16x4_t res_odd  = vdup_n_s16(0);
+
+         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            int16x8_t col = vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(
+                        vld1_u8((const uint8_t*)(input_base_x + x))), 7));
+
+            res_even      = vqadd_s16(vshrn_n_s32(vmull_n_s16(
+                        vget_low_s16(col),  filter_horiz[x + 0]), 16), res_even);
+            res_odd       = vqadd_s16(vshrn_n_s32(vmull_n_s16(
+                        vget_high_s16(col), filter_horiz[x + 1]), 16), res_odd);
+         }
+
+         for (; x < ctx->horiz.filter_len; x++)
+         {
+            int16x4_t col = vreinterpret_s16_u16(vget_low_u16(vshlq_n_u16(
+                        vmovl_u8(vreinterpret_u8_u32(
+                              vld1_dup_u32(input_base_x + x))), 7)));
+
+            res_even      = vqadd_s16(vshrn_n_s32(vmull_n_s16(
+                        col, filter_horiz[x]), 16), res_even);
+         }
+
+         vst1_s16((int16_t*)(output + w), vqadd_s16(res_odd, res_even));
 #else
          int16_t res_a = 0;
          int16_t res_r = 0;
@@ -221,11 +364,12 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
             res_b         += (b * coeff) >> 16;
          }
 
+         /* Negative lanes must not sign-extend into their neighbours */
          output[w]         = (
-               (uint64_t)res_a  << 48)  |
-               ((uint64_t)res_r << 32)  |
-               ((uint64_t)res_g << 16)  |
-               ((uint64_t)res_b << 0);
+               (uint64_t)(uint16_t)res_a  << 48)  |
+               ((uint64_t)(uint16_t)res_r << 32)  |
+               ((uint64_t)(uint16_t)res_g << 16)  |
+               ((uint64_t)(uint16_t)res_b << 0);
 #endif
       }
    }
@@ -244,6 +388,9 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
    int y_step            = (1 << 16) * in_height / out_height;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
+#ifdef SCALER_HAVE_AVX2
+   bool avx2             = scaler_have_avx2();
+#endif
 
    if (x_pos < 0)
       x_pos = 0;
@@ -255,7 +402,15 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       int               x = x_pos;
       const uint32_t *inp = input + (y_pos >> 16) * (in_stride >> 2);
 
-      for (w = 0; w < out_width; w++, x += x_step)
+      w = 0;
+#ifdef SCALER_HAVE_AVX2
+      if (avx2)
+      {
+         w  = scaler_argb8888_point_avx2(output, inp, x, x_step, out_width);
+         x += w * x_step;
+      }
+#endif
+      for (; w < out_width; w++, x += x_step)
          output[w] = inp[x >> 16];
    }
 }
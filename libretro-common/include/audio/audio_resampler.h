@@ -105,6 +105,18 @@ struct resampler_data
    double ratio;
 };
 
+/**
+ * Same as struct resampler_data, for interleaved 16-bit stereo frames.
+ */
+struct resampler_data_s16
+{
+   const int16_t *data_in;
+   int16_t *data_out;
+   size_t input_frames;
+   size_t output_frames;
+   double ratio;
+};
+
 /* Returns true if config key was found. Otherwise,
  * returns false, and sets value to default value.
  */
@@ -156,6 +168,10 @@ typedef void (*resampler_free_t)(void *data);
 /* Processes input data. */
 typedef void (*resampler_process_t)(void *_data, struct resampler_data *data);
 
+/* Processes 16-bit input data without converting it to float. */
+typedef void (*resampler_process_s16_t)(void *_data,
+      struct resampler_data_s16 *data);
+
 typedef struct retro_resampler
 {
    resampler_init_t     init;
@@ -171,6 +187,10 @@ typedef struct retro_resampler
    /* Computer-friendly short version of ident.
     * Lower case, no spaces and special characters, etc. */
    const char *short_ident;
+
+   /* Optional. Lets a host with 16-bit input and output
+    * skip the conversions to and from float. */
+   resampler_process_s16_t process_s16;
 } retro_resampler_t;
 
 typedef struct audio_frame_float
@@ -180,6 +200,7 @@ typedef struct audio_frame_float
 } audio_frame_float_t;
 
 extern retro_resampler_t sinc_resampler;
+extern retro_resampler_t sinc_s16_resampler;
 #ifdef HAVE_CC_RESAMPLER
 extern retro_resampler_t CC_resampler;
 #endif
@@ -26,6 +26,7 @@
 #include <retro_common_api.h>
 
 #include <stdint.h>
+#include <boolean.h>
 
 #include <libretro.h>
 
@@ -74,6 +75,14 @@ retro_time_t cpu_features_get_time_usec(void);
  */
 uint64_t cpu_features_get(void);
 
+/**
+ * Checks for the PCLMULQDQ instruction, which encoding_crc32
+ * uses when available. Not part of the libretro SIMD flags.
+ *
+ * @return \c true if the CPU supports PCLMULQDQ.
+ */
+bool cpu_features_has_pclmul(void);
+
 /**
  * @return The number of CPU cores available,
  * or 1 if the number of cores could not be determined.
@@ -86,6 +86,24 @@ const struct trans_stream_backend* trans_stream_get_zlib_inflate_backend(void)
 #endif
 }
 
+const struct trans_stream_backend* trans_stream_get_zstd_compress_backend(void)
+{
+#ifdef HAVE_ZSTD
+   return &zstd_compress_backend;
+#else
+   return NULL;
+#endif
+}
+
+const struct trans_stream_backend* trans_stream_get_zstd_decompress_backend(void)
+{
+#ifdef HAVE_ZSTD
+   return &zstd_decompress_backend;
+#else
+   return NULL;
+#endif
+}
+
 const struct trans_stream_backend* trans_stream_get_pipe_backend(void)
 {
    return &pipe_backend;
@@ -0,0 +1,237 @@
+/* Copyright  (C) 2010-2024 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (trans_stream_zstd.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstd.h>
+#include <string/stdstring.h>
+#include <streams/trans_stream.h>
+
+struct zstd_trans_stream
+{
+   ZSTD_CCtx *cctx;
+   ZSTD_DCtx *dctx;
+   ZSTD_inBuffer in;
+   ZSTD_outBuffer out;
+   int level;
+};
+
+static void *zstd_stream_new(void)
+{
+   struct zstd_trans_stream *ret = (struct zstd_trans_stream*)
+      calloc(1, sizeof(*ret));
+   if (!ret)
+      return NULL;
+   ret->level = ZSTD_CLEVEL_DEFAULT;
+   return (void *)ret;
+}
+
+static void zstd_stream_free(void *data)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   if (!z)
+      return;
+   if (z->cctx)
+      ZSTD_freeCCtx(z->cctx);
+   if (z->dctx)
+      ZSTD_freeDCtx(z->dctx);
+   free(z);
+}
+
+static bool zstd_compress_define(void *data, const char *prop, uint32_t val)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream*)data;
+   if (!data)
+      return false;
+
+   if (string_is_equal(prop, "level"))
+   {
+      z->level = (int) val;
+      if (z->cctx)
+         ZSTD_CCtx_setParameter(z->cctx, ZSTD_c_compressionLevel, z->level);
+      return true;
+   }
+   return false;
+}
+
+static void zstd_set_in(void *data, const uint8_t *in, uint32_t in_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->in.src  = in;
+   z->in.size = in_size;
+   z->in.pos  = 0;
+}
+
+static void zstd_set_out(void *data, uint8_t *out, uint32_t out_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->out.dst  = out;
+   z->out.size = out_size;
+   z->out.pos  = 0;
+}
+
+static bool zstd_compress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *err)
+{
+   size_t zret;
+   bool ret                     = true;
+   size_t pre_in_pos            = 0;
+   size_t pre_out_pos           = 0;
+   struct zstd_trans_stream *zt = (struct zstd_trans_stream *) data;
+
+   if (!zt->cctx)
+   {
+      if (!(zt->cctx = ZSTD_createCCtx()))
+      {
+         if (err)
+            *err = TRANS_STREAM_ERROR_ALLOCATION_FAILURE;
+         return false;
+      }
+      ZSTD_CCtx_setParameter(zt->cctx, ZSTD_c_compressionLevel, zt->level);
+   }
+
+   pre_in_pos  = zt->in.pos;
+   pre_out_pos = zt->out.pos;
+   zret        = ZSTD_compressStream2(zt->cctx, &zt->out, &zt->in,
+         flush ? ZSTD_e_end : ZSTD_e_continue);
+
+   if (ZSTD_isError(zret))
+   {
+      if (err)
+         *err = TRANS_STREAM_ERROR_OTHER;
+      ZSTD_CCtx_reset(zt->cctx, ZSTD_reset_session_only);
+      return false;
+   }
+
+   if (err)
+      *err = zret ? TRANS_STREAM_ERROR_AGAIN : TRANS_STREAM_ERROR_NONE;
+
+   if (zt->out.pos == zt->out.size)
+   {
+      /* Filled buffer, maybe an error */
+      if (zt->in.pos != zt->in.size || (flush && zret))
+      {
+         ret = false;
+         if (err)
+            *err = TRANS_STREAM_ERROR_BUFFER_FULL;
+      }
+   }
+
+   *rd = (uint32_t)(zt->in.pos  - pre_in_pos);
+   *wn = (uint32_t)(zt->out.pos - pre_out_pos);
+
+   /* Don't leave half a frame behind for the next caller */
+   if (flush && !ret)
+      ZSTD_CCtx_reset(zt->cctx, ZSTD_reset_session_only);
+
+   return ret;
+}
+
+static bool zstd_decompress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *err)
+{
+   size_t zret;
+   bool ret                     = true;
+   size_t pre_in_pos            = 0;
+   size_t pre_out_pos           = 0;
+   struct zstd_trans_stream *zt = (struct zstd_trans_stream *) data;
+
+   if (!zt->dctx)
+   {
+      if (!(zt->dctx = ZSTD_createDCtx()))
+      {
+         if (err)
+            *err = TRANS_STREAM_ERROR_ALLOCATION_FAILURE;
+         return false;
+      }
+   }
+
+   pre_in_pos  = zt->in.pos;
+   pre_out_pos = zt->out.pos;
+   zret        = ZSTD_decompressStream(zt->dctx, &zt->out, &zt->in);
+
+   if (ZSTD_isError(zret))
+   {
+      if (err)
+         *err = TRANS_STREAM_ERROR_OTHER;
+      ZSTD_DCtx_reset(zt->dctx, ZSTD_reset_session_only);
+      return false;
+   }
+
+   if (err)
+      *err = zret ? TRANS_STREAM_ERROR_AGAIN : TRANS_STREAM_ERROR_NONE;
+
+   if (zt->out.pos == zt->out.size)
+   {
+      /* Filled buffer, maybe an error */
+      if (zt->in.pos != zt->in.size)
+      {
+         ret = false;
+         if (err)
+            *err = TRANS_STREAM_ERROR_BUFFER_FULL;
+      }
+   }
+
+   *rd = (uint32_t)(zt->in.pos  - pre_in_pos);
+   *wn = (uint32_t)(zt->out.pos - pre_out_pos);
+
+   /* A truncated frame can't be finished by the next caller's input */
+   if (flush && (zret || !ret))
+      ZSTD_DCtx_reset(zt->dctx, ZSTD_reset_session_only);
+
+   return ret;
+}
+
+const struct trans_stream_backend zstd_compress_backend = {
+   "zstd_compress",
+   &zstd_decompress_backend,
+   zstd_stream_new,
+   zstd_stream_free,
+   zstd_compress_define,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_compress_trans
+};
+
+const struct trans_stream_backend zstd_decompress_backend = {
+   "zstd_decompress",
+   &zstd_compress_backend,
+   zstd_stream_new,
+   zstd_stream_free,
+   NULL,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_decompress_trans
+};
@@ -0,0 +1,270 @@
+/* Copyright  (C) 2010-2024 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_pixconv.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Times the pixconv converters against plain per-pixel versions and
+ * checks that both agree, then times the point and bilinear scalers.
+ *
+ * Build with something like:
+ *   cc -O2 -Iinclude test/gfx/bench_pixconv.c gfx/scaler/pixconv.c \
+ *      gfx/scaler/scaler.c gfx/scaler/scaler_int.c gfx/scaler/scaler_filter.c \
+ *      features/features_cpu.c compat/compat_strl.c -lm -o bench_pixconv
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <gfx/scaler/pixconv.h>
+#include <gfx/scaler/scaler.h>
+
+/* Odd width so every converter also runs its tail loop */
+#define BENCH_WIDTH  1021
+#define BENCH_HEIGHT 256
+#define BENCH_FRAMES 64
+
+typedef void (*conv_fn)(void *output, const void *input,
+      int width, int height, int out_stride, int in_stride);
+
+static void reference_0rgb1555_argb8888(void *output_, const void *input_,
+      int width, int height, int out_stride, int in_stride)
+{
+   int h, w;
+   for (h = 0; h < height; h++)
+   {
+      const uint16_t *input = (const uint16_t*)((const uint8_t*)input_ + h * in_stride);
+      uint32_t *output      = (uint32_t*)((uint8_t*)output_ + h * out_stride);
+      for (w = 0; w < width; w++)
+      {
+         uint32_t r = (input[w] >> 10) & 0x1f;
+         uint32_t g = (input[w] >>  5) & 0x1f;
+         uint32_t b = (input[w] >>  0) & 0x1f;
+         output[w]  = 0xff000000u | (((r << 3) | (r >> 2)) << 16)
+            | (((g << 3) | (g >> 2)) << 8) | ((b << 3) | (b >> 2));
+      }
+   }
+}
+
+static void reference_rgb565_argb8888(void *output_, const void *input_,
+      int width, int height, int out_stride, int in_stride)
+{
+   int h, w;
+   for (h = 0; h < height; h++)
+   {
+      const uint16_t *input = (const uint16_t*)((const uint8_t*)input_ + h * in_stride);
+      uint32_t *output      = (uint32_t*)((uint8_t*)output_ + h * out_stride);
+      for (w = 0; w < width; w++)
+      {
+         uint32_t r = (input[w] >> 11) & 0x1f;
+         uint32_t g = (input[w] >>  5) & 0x3f;
+         uint32_t b = (input[w] >>  0) & 0x1f;
+         output[w]  = 0xff000000u | (((r << 3) | (r >> 2)) << 16)
+            | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+      }
+   }
+}
+
+static void reference_rgba4444_argb8888(void *output_, const void *input_,
+      int width, int height, int out_stride, int in_stride)
+{
+   int h, w;
+   for (h = 0; h < height; h++)
+   {
+      const uint16_t *input = (const uint16_t*)((const uint8_t*)input_ + h * in_stride);
+      uint32_t *output      = (uint32_t*)((uint8_t*)output_ + h * out_stride);
+      for (w = 0; w < width; w++)
+      {
+         uint32_t col = input[w];
+         output[w]    = (((col >>  0) & 0xf) * 0x11u << 24)
+            | (((col >> 12) & 0xf) * 0x11u << 16)
+            | (((col >>  8) & 0xf) * 0x11u << 8)
+            | (((col >>  4) & 0xf) * 0x11u);
+      }
+   }
+}
+
+static void reference_bgr24_argb8888(void *output_, const void *input_,
+      int width, int height, int out_stride, int in_stride)
+{
+   int h, w;
+   for (h = 0; h < height; h++)
+   {
+      const uint8_t *input = (const uint8_t*)input_ + h * in_stride;
+      uint32_t *output     = (uint32_t*)((uint8_t*)output_ + h * out_stride);
+      for (w = 0; w < width; w++)
+         output[w] = 0xff000000u | ((uint32_t)input[w * 3 + 2] << 16)
+            | ((uint32_t)input[w * 3 + 1] << 8) | input[w * 3 + 0];
+   }
+}
+
+static void reference_argb8888_0rgb1555(void *output_, const void *input_,
+      int width, int height, int out_stride, int in_stride)
+{
+   int h, w;
+   for (h = 0; h < height; h++)
+   {
+      const uint32_t *input = (const uint32_t*)((const uint8_t*)input_ + h * in_stride);
+      uint16_t *output      = (uint16_t*)((uint8_t*)output_ + h * out_stride);
+      for (w = 0; w < width; w++)
+         output[w] = (uint16_t)(((input[w] >> 19) & 0x1f) << 10
+               | ((input[w] >> 11) & 0x1f) << 5 | ((input[w] >> 3) & 0x1f));
+   }
+}
+
+static void reference_argb8888_abgr8888(void *output_, const void *input_,
+      int width, int height, int out_stride, int in_stride)
+{
+   int h, w;
+   for (h = 0; h < height; h++)
+   {
+      const uint32_t *input = (const uint32_t*)((const uint8_t*)input_ + h * in_stride);
+      uint32_t *output      = (uint32_t*)((uint8_t*)output_ + h * out_stride);
+      for (w = 0; w < width; w++)
+         output[w] = (input[w] & 0xff00ff00u)
+            | ((input[w] >> 16) & 0xff) | ((input[w] & 0xff) << 16);
+   }
+}
+
+struct bench_conv
+{
+   const char *name;
+   conv_fn ref;
+   conv_fn fast;
+   unsigned in_bpp;
+   unsigned out_bpp;
+};
+
+static const struct bench_conv convs[] = {
+   { "0rgb1555 -> argb8888", reference_0rgb1555_argb8888, conv_0rgb1555_argb8888, 2, 4 },
+   { "rgb565 -> argb8888",   reference_rgb565_argb8888,   conv_rgb565_argb8888,   2, 4 },
+   { "rgba4444 -> argb8888", reference_rgba4444_argb8888, conv_rgba4444_argb8888, 2, 4 },
+   { "bgr24 -> argb8888",    reference_bgr24_argb8888,    conv_bgr24_argb8888,    3, 4 },
+   { "argb8888 -> 0rgb1555", reference_argb8888_0rgb1555, conv_argb8888_0rgb1555, 4, 2 },
+   { "argb8888 -> abgr8888", reference_argb8888_abgr8888, conv_argb8888_abgr8888, 4, 4 },
+};
+
+/* Returns megapixels per second */
+static double bench_conv(conv_fn fn, void *output, const void *input,
+      int out_stride, int in_stride)
+{
+   unsigned i;
+   retro_time_t start = cpu_features_get_time_usec();
+   retro_time_t elapsed;
+   for (i = 0; i < BENCH_FRAMES; i++)
+      fn(output, input, BENCH_WIDTH, BENCH_HEIGHT, out_stride, in_stride);
+   elapsed = cpu_features_get_time_usec() - start;
+   if (elapsed <= 0)
+      elapsed = 1;
+   return ((double)BENCH_FRAMES * BENCH_WIDTH * BENCH_HEIGHT) / (double)elapsed;
+}
+
+static double bench_scaler(enum scaler_type type, const uint32_t *input,
+      uint32_t *output, int out_width, int out_height)
+{
+   unsigned i;
+   retro_time_t start, elapsed;
+   struct scaler_ctx ctx;
+
+   memset(&ctx, 0, sizeof(ctx));
+   ctx.in_width    = BENCH_WIDTH;
+   ctx.in_height   = BENCH_HEIGHT;
+   ctx.in_stride   = BENCH_WIDTH * sizeof(uint32_t);
+   ctx.out_width   = out_width;
+   ctx.out_height  = out_height;
+   ctx.out_stride  = out_width * sizeof(uint32_t);
+   ctx.in_fmt      = SCALER_FMT_ARGB8888;
+   ctx.out_fmt     = SCALER_FMT_ARGB8888;
+   ctx.scaler_type = type;
+
+   if (!scaler_ctx_gen_filter(&ctx))
+      return 0.0;
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < BENCH_FRAMES / 8; i++)
+      scaler_ctx_scale(&ctx, output, input);
+   elapsed = cpu_features_get_time_usec() - start;
+   if (elapsed <= 0)
+      elapsed = 1;
+
+   scaler_ctx_gen_reset(&ctx);
+   return ((double)(BENCH_FRAMES / 8) * out_width * out_height) / (double)elapsed;
+}
+
+int main(void)
+{
+   size_t i;
+   int ret          = EXIT_SUCCESS;
+   size_t in_size   = BENCH_WIDTH * 4 * BENCH_HEIGHT;
+   size_t out_size  = BENCH_WIDTH * 4 * 2 * BENCH_HEIGHT * 2;
+   uint8_t *input   = (uint8_t*)malloc(in_size + 1);
+   uint8_t *ref_out = (uint8_t*)malloc(out_size);
+   uint8_t *out     = (uint8_t*)malloc(out_size);
+   uint64_t simd    = cpu_features_get();
+   uint32_t x       = 1;
+
+   if (!input || !ref_out || !out)
+      return EXIT_FAILURE;
+
+   for (i = 0; i < in_size + 1; i++)
+   {
+      x        = x * 1103515245u + 12345u;
+      input[i] = (uint8_t)(x >> 16);
+   }
+
+   printf("SSE2: %s, AVX2: %s, NEON: %s\n",
+         (simd & RETRO_SIMD_SSE2) ? "yes" : "no",
+         (simd & RETRO_SIMD_AVX2) ? "yes" : "no",
+         (simd & RETRO_SIMD_NEON) ? "yes" : "no");
+   printf("%-22s %14s %14s\n", "conversion", "C Mpix/s", "pixconv Mpix/s");
+
+   for (i = 0; i < sizeof(convs) / sizeof(convs[0]); i++)
+   {
+      int in_stride  = BENCH_WIDTH * convs[i].in_bpp;
+      int out_stride = BENCH_WIDTH * convs[i].out_bpp;
+      size_t size    = (size_t)out_stride * BENCH_HEIGHT;
+      double ref, fast;
+      bool match;
+
+      memset(ref_out, 0, size);
+      memset(out, 0, size);
+      ref   = bench_conv(convs[i].ref,  ref_out, input, out_stride, in_stride);
+      fast  = bench_conv(convs[i].fast, out,     input, out_stride, in_stride);
+      match = !memcmp(ref_out, out, size);
+      printf("%-22s %14.1f %14.1f%s\n", convs[i].name, ref, fast,
+            match ? "" : "  MISMATCH");
+      if (!match)
+         ret = EXIT_FAILURE;
+   }
+
+   printf("%-22s %14s\n", "scaler (2x)", "Mpix/s");
+   printf("%-22s %14.1f\n", "point", bench_scaler(SCALER_TYPE_POINT,
+            (const uint32_t*)input, (uint32_t*)out,
+            BENCH_WIDTH * 2, BENCH_HEIGHT * 2));
+   printf("%-22s %14.1f\n", "bilinear", bench_scaler(SCALER_TYPE_BILINEAR,
+            (const uint32_t*)input, (uint32_t*)out,
+            BENCH_WIDTH * 2, BENCH_HEIGHT * 2));
+
+   free(input);
+   free(ref_out);
+   free(out);
+   return ret;
+}
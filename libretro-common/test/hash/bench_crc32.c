@@ -0,0 +1,114 @@
+/* Copyright  (C) 2010-2024 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_crc32.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Times encoding_crc32() against a plain byte-at-a-time CRC32 over a
+ * range of buffer sizes, and checks that both agree.
+ *
+ * Build with something like:
+ *   cc -O2 -Iinclude test/hash/bench_crc32.c encodings/encoding_crc32.c \
+ *      features/features_cpu.c compat/compat_strl.c -o bench_crc32
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+
+/* Bytes hashed per buffer size, so every size does the same work */
+#define BENCH_TOTAL_BYTES (256u << 20)
+
+static uint32_t reference_table[256];
+
+static void reference_init(void)
+{
+   unsigned i, j;
+   for (i = 0; i < 256; i++)
+   {
+      uint32_t c = i;
+      for (j = 0; j < 8; j++)
+         c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+      reference_table[i] = c;
+   }
+}
+
+static uint32_t reference_crc32(uint32_t crc, const uint8_t *s, size_t len)
+{
+   crc = ~crc;
+   while (len--)
+      crc = reference_table[(crc ^ (*s++)) & 0xff] ^ (crc >> 8);
+   return ~crc;
+}
+
+static double bench(uint32_t (*fn)(uint32_t, const uint8_t*, size_t),
+      const uint8_t *buf, size_t len, uint32_t *crc)
+{
+   size_t i;
+   size_t iterations   = BENCH_TOTAL_BYTES / len;
+   retro_time_t start  = cpu_features_get_time_usec();
+   retro_time_t elapsed;
+   *crc                = 0;
+   for (i = 0; i < iterations; i++)
+      *crc = fn(*crc, buf, len);
+   elapsed = cpu_features_get_time_usec() - start;
+   if (elapsed <= 0)
+      elapsed = 1;
+   return ((double)iterations * len) / (double)elapsed;
+}
+
+int main(void)
+{
+   static const size_t sizes[] = { 16, 63, 64, 256, 1024, 4096, 65536, 1 << 20 };
+   size_t i;
+   int ret       = EXIT_SUCCESS;
+   uint8_t *buf  = (uint8_t*)malloc((1 << 20) + 1);
+   uint32_t x    = 1;
+
+   if (!buf)
+      return EXIT_FAILURE;
+
+   reference_init();
+   for (i = 0; i < (1 << 20) + 1; i++)
+   {
+      x      = x * 1103515245u + 12345u;
+      buf[i] = (uint8_t)(x >> 16);
+   }
+
+   printf("PCLMULQDQ: %s\n",
+         cpu_features_has_pclmul() ? "yes" : "no");
+   printf("%10s %14s %14s\n", "bytes", "byte MB/s", "crc32 MB/s");
+
+   for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+   {
+      uint32_t ref_crc, crc;
+      /* Start one byte in so the loads are unaligned */
+      double ref  = bench(reference_crc32, buf + 1, sizes[i], &ref_crc);
+      double fast = bench(encoding_crc32,  buf + 1, sizes[i], &crc);
+      printf("%10u %14.1f %14.1f%s\n", (unsigned)sizes[i], ref, fast,
+            ref_crc == crc ? "" : "  MISMATCH");
+      if (ref_crc != crc)
+         ret = EXIT_FAILURE;
+   }
+
+   free(buf);
+   return ret;
+}
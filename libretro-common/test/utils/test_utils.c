@@ -71,6 +71,24 @@ START_TEST (test_crc32)
 }
 END_TEST
 
+START_TEST (test_crc32_long)
+{
+   /* Long enough for the folded paths, with unaligned starts and
+    * lengths that leave a tail, fed whole and in pieces */
+   unsigned i;
+   uint32_t crc;
+   uint8_t buf[1000];
+   for (i = 0; i < sizeof(buf); i++)
+      buf[i] = (uint8_t)(i * 7 + 3);
+   ck_assert_uint_eq(0x17bc2a46, encoding_crc32(0, buf, sizeof(buf)));
+   ck_assert_uint_eq(0x164425d6, encoding_crc32(0, buf + 1, 77));
+   crc = encoding_crc32(0,   buf,       13);
+   crc = encoding_crc32(crc, buf + 13,  500);
+   crc = encoding_crc32(crc, buf + 513, 487);
+   ck_assert_uint_eq(0x17bc2a46, crc);
+}
+END_TEST
+
 #define CRC32_BUFFER_SIZE 1048576
 #define CRC32_MAX_MB 64
 
@@ -141,6 +159,7 @@ Suite *create_suite(void)
    TCase *tc_core = tcase_create("Core");
    tcase_add_test(tc_core, test_md5);
    tcase_add_test(tc_core, test_crc32);
+   tcase_add_test(tc_core, test_crc32_long);
    tcase_add_test(tc_core, test_crc32_file);
    suite_add_tcase(s, tc_core);
 
@@ -852,6 +852,21 @@ int main(int argc, char** argv)
 
    intfstream_close(rdb_file);
 
+   {
+      libretrodb_t *db = libretrodb_new();
+
+      if (!db || libretrodb_open(rdb_path, db, true) != 0)
+         printf("Could not reopen '%s' to index it\n", rdb_path);
+      else if (libretrodb_create_default_indexes(db) != 0)
+         printf("Could not index '%s'\n", rdb_path);
+
+      if (db)
+      {
+         libretrodb_close(db);
+         libretrodb_free(db);
+      }
+   }
+
    dat_converter_list_free(dat_parser_list);
 
    while (dat_count--)
@@ -20,6 +20,11 @@ for dat_file in $DAT_dir/*.dat ; do
 done
 ./lua_converter "$lua_RDB_outdir/merged.rdb" dat_converter.lua rom.sha1 $DAT_dir/N*.dat
 
+# c_converter also writes the default indexes
+for rdb_file in $lua_RDB_outdir/*.rdb ; do
+   ./libretrodb_tool "$rdb_file" create-indexes
+done
+
 echo
 echo "==========================================================="
 echo "=================== running C converter ==================="
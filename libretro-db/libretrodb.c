@@ -32,23 +32,23 @@
 
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
+#include <retro_miscellaneous.h>
 #include <string/stdstring.h>
 #include <compat/strl.h>
+#include <array/rbuf.h>
 
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 #include "rmsgpack.h"
-#include "bintree.h"
 #include "query.h"
 #include "libretrodb.h"
 
 #define MAGIC_NUMBER "RARCHDB"
 
-struct node_iter_ctx
-{
-   libretrodb_t *db;
-   libretrodb_index_t *idx;
-};
+/* Initial size of the window cursors read items through;
+ * it grows if a single item does not fit */
+#define LIBRETRODB_CURSOR_BUFFER_SIZE 0x10000
+
 
 struct libretrodb
 {
@@ -63,11 +63,39 @@ struct libretrodb
 struct libretrodb_index
 {
    char name[50];
-   uint64_t key_size;
-   uint64_t next;
+   char field[50];
+   uint64_t type;
    uint64_t count;
+   uint64_t next;
+   uint64_t offset;   /* Start of the index body */
+   uint64_t key_size; /* Key length of old-format indexes */
+   bool legacy;       /* Written before indexes recorded their field */
 };
 
+typedef struct libretrodb_index_key
+{
+   const uint8_t *data;
+   uint32_t len;
+   uint8_t num[8];
+} libretrodb_index_key_t;
+
+typedef struct libretrodb_index_reader
+{
+   uint8_t *key;
+   uint32_t *items;
+   uint32_t key_len;
+   uint32_t key_cap;
+   uint32_t count;
+   uint32_t items_cap;
+} libretrodb_index_reader_t;
+
+typedef struct libretrodb_index_entry
+{
+   uint8_t *key;
+   uint32_t item;
+   uint32_t key_len;
+} libretrodb_index_entry_t;
+
 typedef struct libretrodb_metadata
 {
    uint64_t count;
@@ -84,10 +112,27 @@ struct libretrodb_cursor
    intfstream_t *fd;
    libretrodb_query_t *query;
    libretrodb_t *db;
+   const uint64_t *plan;  /* Item offsets picked by the query planner */
+   uint8_t *buf;          /* Window of the file items are decoded from */
+   uint64_t buf_offset;   /* File offset of buf[0] */
+   size_t buf_len;
+   size_t buf_pos;
+   size_t buf_cap;
+   ssize_t plan_count;    /* -1 to scan every item */
+   ssize_t plan_pos;
    int is_valid;
    int eof;
 };
 
+/* Fields indexed by c_converter */
+static const char *libretrodb_default_index_fields[] = {
+   "crc",
+   "serial",
+   "name",
+   "developer",
+   "releaseyear"
+};
+
 static int libretrodb_validate_document(const struct rmsgpack_dom_value *doc)
 {
    unsigned i;
@@ -221,101 +266,451 @@ error:
    return -1;
 }
 
-static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
+static struct rmsgpack_dom_value *libretrodb_map_get(
+      const struct rmsgpack_dom_value *map, const char *name)
+{
+   struct rmsgpack_dom_value key;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(name);
+   key.val.string.buff = (char*)name;
+
+   return rmsgpack_dom_value_map_value(map, &key);
+}
+
+static int libretrodb_read_index_header(intfstream_t *fd,
       libretrodb_index_t *idx)
 {
-   intfstream_seek(db->fd,
-                   (ssize_t)db->first_index_offset,
-                   RETRO_VFS_SEEK_POSITION_START);
+   struct rmsgpack_dom_value map;
+   struct rmsgpack_dom_value *value;
+   int rv = -1;
+
+   if (rmsgpack_dom_read(fd, &map) < 0)
+      return -1;
+
+   idx->name[0]  = '\0';
+   idx->field[0] = '\0';
+   idx->type     = RDT_NULL;
+   idx->count    = 0;
+   idx->key_size = 0;
+   idx->legacy   = true;
+
+   if (map.type != RDT_MAP)
+      goto end;
+
+   /* Without the body size there is no way to reach
+    * the next index */
+   if (     !(value = libretrodb_map_get(&map, "next"))
+         || value->type != RDT_UINT)
+      goto end;
+   idx->next = value->val.uint_;
+
+   if (     (value = libretrodb_map_get(&map, "name"))
+         && value->type == RDT_STRING)
+      strlcpy(idx->name, value->val.string.buff, sizeof(idx->name));
+   if (     (value = libretrodb_map_get(&map, "field"))
+         && value->type == RDT_STRING)
+   {
+      strlcpy(idx->field, value->val.string.buff, sizeof(idx->field));
+      idx->legacy = false;
+   }
+   if (     (value = libretrodb_map_get(&map, "type"))
+         && value->type == RDT_UINT)
+      idx->type  = value->val.uint_;
+   if (     (value = libretrodb_map_get(&map, "count"))
+         && value->type == RDT_UINT)
+      idx->count = value->val.uint_;
+   if (     (value = libretrodb_map_get(&map, "key_size"))
+         && value->type == RDT_UINT)
+      idx->key_size = value->val.uint_;
+
+   rv = 0;
+end:
+   rmsgpack_dom_value_free(&map);
+   return rv;
+}
+
+/* Looks an index up by @index_name, or by the field
+ * it covers if @index_name is NULL. An old-format index
+ * is only returned by name, and only when it has not
+ * been rebuilt since */
+static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
+      const char *field_name, libretrodb_index_t *idx)
+{
+   libretrodb_index_t legacy;
+   int64_t size     = intfstream_get_size(db->fd);
+   int64_t pos      = (int64_t)db->first_index_offset;
+   bool have_legacy = false;
 
-   while (!intfstream_eof(db->fd))
+   while (pos < size)
    {
-      uint64_t name_len = 50;
-      /* Read index header */
-      if (rmsgpack_dom_read_into(db->fd,
-            "name",     idx->name, &name_len,
-            "key_size", &idx->key_size,
-            "next",     &idx->next,
-            "count",    &idx->count,
-                                 NULL) < 0)
+      intfstream_seek(db->fd, pos, RETRO_VFS_SEEK_POSITION_START);
+
+      if (libretrodb_read_index_header(db->fd, idx) < 0)
+         break;
+
+      idx->offset = intfstream_tell(db->fd);
+
+      if (index_name)
       {
-        printf("Invalid index header\n");
-        break;
+         if (string_is_equal(index_name, idx->name))
+         {
+            if (!idx->legacy)
+               return 0;
+            if (!have_legacy)
+            {
+               legacy      = *idx;
+               have_legacy = true;
+            }
+         }
       }
-
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
+      else if (!idx->legacy && string_is_equal(field_name, idx->field))
          return 0;
 
-      intfstream_seek(db->fd, (ssize_t)idx->next,
-            RETRO_VFS_SEEK_POSITION_CURRENT);
+      pos = (int64_t)(idx->offset + idx->next);
+   }
+
+   if (have_legacy)
+   {
+      *idx = legacy;
+      return 0;
    }
 
    return -1;
 }
 
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+/* Index keys are compared with memcmp, so numbers are stored
+ * big endian, with the sign bit of signed values flipped */
+static bool libretrodb_index_key_init(libretrodb_index_key_t *key,
+      const struct rmsgpack_dom_value *value, uint64_t type)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint8_t *current   = ((uint8_t *)buff + (mid * item_size));
-   int rv             = memcmp(current, item, field_size);
+   uint64_t num;
 
-   if (rv == 0)
+   switch (type)
    {
-      *offset         = *(uint64_t *)(current + field_size);
-      return 0;
+      case RDT_STRING:
+         if (value->type != RDT_STRING)
+            return false;
+         key->data = (const uint8_t*)value->val.string.buff;
+         key->len  = value->val.string.len;
+         return true;
+      case RDT_BINARY:
+         if (value->type != RDT_BINARY)
+            return false;
+         key->data = (const uint8_t*)value->val.binary.buff;
+         key->len  = value->val.binary.len;
+         return true;
+      case RDT_UINT:
+         /* Query integers are signed; convert them
+          * the same way func_equals does */
+         if (value->type != RDT_UINT && value->type != RDT_INT)
+            return false;
+         num = value->val.uint_;
+         break;
+      case RDT_INT:
+         if (value->type != RDT_INT)
+            return false;
+         num = value->val.uint_ ^ ((uint64_t)1 << 63);
+         break;
+      default:
+         return false;
+   }
+
+   num       = swap_if_little64(num);
+   memcpy(key->num, &num, sizeof(num));
+   key->data = key->num;
+   key->len  = sizeof(num);
+   return true;
+}
+
+static void libretrodb_index_key_value(struct rmsgpack_dom_value *value,
+      const libretrodb_index_reader_t *r, uint64_t type)
+{
+   uint64_t num;
+
+   value->type = (enum rmsgpack_dom_type)type;
+
+   switch (type)
+   {
+      case RDT_STRING:
+         value->val.string.buff = (char*)r->key;
+         value->val.string.len  = r->key_len;
+         break;
+      case RDT_BINARY:
+         value->val.binary.buff = (char*)r->key;
+         value->val.binary.len  = r->key_len;
+         break;
+      case RDT_UINT:
+      case RDT_INT:
+         memcpy(&num, r->key, sizeof(num));
+         value->val.uint_       = swap_if_little64(num);
+         if (type == RDT_INT)
+            value->val.uint_   ^= ((uint64_t)1 << 63);
+         break;
+      default:
+         value->type            = RDT_NULL;
+         break;
+   }
+}
+
+static int libretrodb_index_key_cmp(const uint8_t *a, uint32_t a_len,
+      const uint8_t *b, uint32_t b_len)
+{
+   int rv = memcmp(a, b, (a_len < b_len) ? a_len : b_len);
+   if (rv != 0)
+      return rv;
+   return (a_len > b_len) - (a_len < b_len);
+}
+
+/* Moves @fd to entry @i of the index body */
+static int libretrodb_index_seek_entry(intfstream_t *fd,
+      const libretrodb_index_t *idx, uint64_t i)
+{
+   uint32_t pos;
+
+   intfstream_seek(fd, (int64_t)(idx->offset + i * sizeof(uint32_t)),
+         RETRO_VFS_SEEK_POSITION_START);
+   if (intfstream_read(fd, &pos, sizeof(pos)) != sizeof(pos))
+      return -1;
+
+   intfstream_seek(fd, (int64_t)(idx->offset
+            + idx->count * sizeof(uint32_t) + swap_if_little32(pos)),
+         RETRO_VFS_SEEK_POSITION_START);
+   return 0;
+}
+
+/* Reads the key at the current position of @fd and the
+ * number of items sharing it */
+static int libretrodb_index_read_key(intfstream_t *fd,
+      libretrodb_index_reader_t *r)
+{
+   uint32_t len, count;
+
+   if (intfstream_read(fd, &len, sizeof(len)) != sizeof(len))
+      return -1;
+   len = swap_if_little32(len);
+
+   if (len >= r->key_cap)
+   {
+      uint8_t *key = (uint8_t*)realloc(r->key, len + 1);
+      if (!key)
+         return -1;
+      r->key     = key;
+      r->key_cap = len + 1;
    }
 
-   if (count == 0)
+   if (     (len && intfstream_read(fd, r->key, len) != len)
+         || intfstream_read(fd, &count, sizeof(count)) != sizeof(count))
       return -1;
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+   r->key[len] = '\0';
+   r->key_len  = len;
+   r->count    = swap_if_little32(count);
+   return 0;
+}
+
+/* Reads the item offsets following the key; keys are stored
+ * back to back, so read_key can be called again afterwards */
+static int libretrodb_index_read_items(intfstream_t *fd,
+      libretrodb_index_reader_t *r)
+{
+   uint32_t i;
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+   if (r->count > r->items_cap)
+   {
+      uint32_t *items = (uint32_t*)realloc(r->items,
+            r->count * sizeof(uint32_t));
+      if (!items)
+         return -1;
+      r->items     = items;
+      r->items_cap = r->count;
+   }
+
+   if (intfstream_read(fd, r->items, r->count * sizeof(uint32_t))
+         != (int64_t)(r->count * sizeof(uint32_t)))
+      return -1;
+
+   for (i = 0; i < r->count; i++)
+      r->items[i] = swap_if_little32(r->items[i]);
+   return 0;
 }
 
-int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
-      const void *key, struct rmsgpack_dom_value *out)
+/* Returns the first entry whose key is not less than @key */
+static int64_t libretrodb_index_lower_bound(intfstream_t *fd,
+      const libretrodb_index_t *idx, libretrodb_index_reader_t *r,
+      const libretrodb_index_key_t *key)
+{
+   uint64_t lo = 0;
+   uint64_t hi = idx->count;
+
+   while (lo < hi)
+   {
+      uint64_t mid = lo + (hi - lo) / 2;
+
+      if (     libretrodb_index_seek_entry(fd, idx, mid) < 0
+            || libretrodb_index_read_key(fd, r) < 0)
+         return -1;
+
+      if (libretrodb_index_key_cmp(r->key, r->key_len,
+               key->data, key->len) < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return (int64_t)lo;
+}
+
+int libretrodb_index_iterate(libretrodb_t *db, const char *field_name,
+      const struct rmsgpack_dom_value *min,
+      const struct rmsgpack_dom_value *max,
+      libretrodb_index_visitor visitor, void *ctx)
 {
    libretrodb_index_t idx;
-   int rv;
-   uint8_t *buff;
-   uint64_t offset;
-   ssize_t bufflen, nread = 0;
+   libretrodb_index_key_t min_key;
+   libretrodb_index_key_t max_key;
+   struct rmsgpack_dom_value value;
+   libretrodb_index_reader_t r = {0};
+   int64_t i                   = 0;
+   int rv                      = -1;
+
+   if (     !db
+         || !db->fd
+         || libretrodb_find_index(db, NULL, field_name, &idx) < 0)
+      return -1;
 
-   if (libretrodb_find_index(db, index_name, &idx) < 0)
+   if (min && !libretrodb_index_key_init(&min_key, min, idx.type))
+      return -1;
+   if (max && !libretrodb_index_key_init(&max_key, max, idx.type))
       return -1;
 
-   bufflen        = idx.next;
-   if (!(buff = (uint8_t*)malloc(bufflen)))
+   if (min && (i = libretrodb_index_lower_bound(
+               db->fd, &idx, &r, &min_key)) < 0)
+      goto end;
+
+   if (     (uint64_t)i < idx.count
+         && libretrodb_index_seek_entry(db->fd, &idx, (uint64_t)i) < 0)
+      goto end;
+
+   for (; (uint64_t)i < idx.count; i++)
+   {
+      uint32_t j;
+
+      if (libretrodb_index_read_key(db->fd, &r) < 0)
+         goto end;
+
+      if (max && libretrodb_index_key_cmp(r.key, r.key_len,
+               max_key.data, max_key.len) > 0)
+         break;
+
+      if (libretrodb_index_read_items(db->fd, &r) < 0)
+         goto end;
+
+      libretrodb_index_key_value(&value, &r, idx.type);
+      for (j = 0; j < r.count; j++)
+         if (visitor(ctx, &value, r.items[j]) != 0)
+            goto done;
+   }
+
+done:
+   rv = 0;
+end:
+   free(r.key);
+   free(r.items);
+   return rv;
+}
+
+/* Old-format index bodies are fixed-size binary keys, each
+ * followed by the item offset, sorted by key */
+static int libretrodb_find_legacy_entry(libretrodb_t *db,
+      const libretrodb_index_t *idx, const struct rmsgpack_dom_value *key,
+      struct rmsgpack_dom_value *out)
+{
+   uint8_t *entry;
+   size_t entry_len = (size_t)idx->key_size + sizeof(uint64_t);
+   uint64_t lo      = 0;
+   uint64_t hi      = idx->count;
+   int rv           = -1;
+
+   if (     key->type != RDT_BINARY
+         || idx->key_size == 0
+         || key->val.binary.len != idx->key_size)
+      return -1;
+
+   if (!(entry = (uint8_t*)malloc(entry_len)))
       return -1;
 
-   while (nread < bufflen)
+   while (lo < hi)
    {
-      void *buff_ = (buff + nread);
-      rv          = (int)intfstream_read(db->fd, buff_, bufflen - nread);
+      int cmp;
+      uint64_t mid = lo + (hi - lo) / 2;
 
-      if (rv <= 0)
+      intfstream_seek(db->fd, (int64_t)(idx->offset + mid * entry_len),
+            RETRO_VFS_SEEK_POSITION_START);
+      if (intfstream_read(db->fd, entry, entry_len) != (int64_t)entry_len)
+         break;
+
+      if ((cmp = memcmp(entry, key->val.binary.buff,
+                  (size_t)idx->key_size)) == 0)
       {
-         free(buff);
-         return -1;
+         uint64_t offset;
+         memcpy(&offset, entry + idx->key_size, sizeof(offset));
+         intfstream_seek(db->fd, (int64_t)offset,
+               RETRO_VFS_SEEK_POSITION_START);
+         if (rmsgpack_dom_read(db->fd, out) >= 0)
+            rv = 0;
+         break;
       }
-      nread += rv;
+
+      if (cmp < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
    }
 
-   rv = binsearch(buff, key, idx.count, (ssize_t)idx.key_size, &offset);
-   free(buff);
+   free(entry);
+   return rv;
+}
+
+int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
+      const struct rmsgpack_dom_value *key, struct rmsgpack_dom_value *out)
+{
+   libretrodb_index_t idx;
+   libretrodb_index_key_t ikey;
+   libretrodb_index_reader_t r = {0};
+   int64_t i;
+   int rv                      = -1;
+
+   if (libretrodb_find_index(db, index_name, NULL, &idx) < 0)
+      return -1;
+
+   if (idx.legacy)
+      return libretrodb_find_legacy_entry(db, &idx, key, out);
 
-   if (rv == 0)
+   if (!libretrodb_index_key_init(&ikey, key, idx.type))
+      return -1;
+
+   if ((i = libretrodb_index_lower_bound(db->fd, &idx, &r, &ikey)) < 0)
+      goto end;
+
+   if (     (uint64_t)i < idx.count
+         && libretrodb_index_seek_entry(db->fd, &idx, (uint64_t)i) == 0
+         && libretrodb_index_read_key(db->fd, &r) == 0
+         && libretrodb_index_key_cmp(r.key, r.key_len,
+               ikey.data, ikey.len) == 0
+         && libretrodb_index_read_items(db->fd, &r) == 0
+         && r.count > 0)
    {
-      intfstream_seek(db->fd, (ssize_t)offset, RETRO_VFS_SEEK_POSITION_START);
-      rmsgpack_dom_read(db->fd, out);
-      return 0;
+      intfstream_seek(db->fd, (int64_t)r.items[0],
+            RETRO_VFS_SEEK_POSITION_START);
+      if (rmsgpack_dom_read(db->fd, out) >= 0)
+         rv = 0;
    }
-   return -1;
+
+end:
+   free(r.key);
+   free(r.items);
+   return rv;
 }
 
 /**
@@ -328,40 +723,182 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
+   cursor->eof        = 0;
+   cursor->plan_pos   = 0;
+   cursor->buf_offset = cursor->db->root + sizeof(libretrodb_header_t);
+   cursor->buf_len    = 0;
+   cursor->buf_pos    = 0;
    return (int)intfstream_seek(cursor->fd,
-         (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
+         (int64_t)cursor->buf_offset,
          RETRO_VFS_SEEK_POSITION_START);
 }
 
-int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
-      struct rmsgpack_dom_value *out)
+/* Points @item at the next item in the window, reading
+ * more of the file when the item does not fit in it */
+static int libretrodb_cursor_next_span(libretrodb_cursor_t *cursor,
+      struct rmsgpack_reader *item)
 {
-   int rv;
+   if (cursor->plan_count >= 0)
+   {
+      uint64_t offset;
+
+      if (cursor->plan_pos >= cursor->plan_count)
+         return EOF;
+
+      /* Items close to each other are usually
+       * already in the window */
+      offset = cursor->plan[cursor->plan_pos++];
+      if (     offset >= cursor->buf_offset
+            && offset <= cursor->buf_offset + cursor->buf_len)
+         cursor->buf_pos    = (size_t)(offset - cursor->buf_offset);
+      else
+      {
+         intfstream_seek(cursor->fd, (int64_t)offset,
+               RETRO_VFS_SEEK_POSITION_START);
+         cursor->buf_offset = offset;
+         cursor->buf_len    = 0;
+         cursor->buf_pos    = 0;
+      }
+   }
+
+   for (;;)
+   {
+      int rv;
+      int64_t read;
+
+      rmsgpack_reader_init(item, cursor->buf + cursor->buf_pos,
+            cursor->buf_len - cursor->buf_pos);
 
+      if ((rv = rmsgpack_reader_skip(item)) == 0)
+      {
+         /* Limit the reader to the item */
+         item->len         = item->pos;
+         item->pos         = 0;
+         cursor->buf_pos  += item->len;
+         return 0;
+      }
+
+      if (rv < 0)
+         return -1;
+
+      /* Move the partial item to the front and fill the rest */
+      if (cursor->buf_pos)
+      {
+         memmove(cursor->buf, cursor->buf + cursor->buf_pos,
+               cursor->buf_len - cursor->buf_pos);
+         cursor->buf_offset += cursor->buf_pos;
+         cursor->buf_len    -= cursor->buf_pos;
+         cursor->buf_pos     = 0;
+      }
+
+      if (cursor->buf_len == cursor->buf_cap)
+      {
+         size_t cap   = cursor->buf_cap
+            ? cursor->buf_cap * 2
+            : LIBRETRODB_CURSOR_BUFFER_SIZE;
+         uint8_t *buf = (uint8_t*)realloc(cursor->buf, cap);
+         if (!buf)
+            return -1;
+         cursor->buf     = buf;
+         cursor->buf_cap = cap;
+      }
+
+      if ((read = intfstream_read(cursor->fd, cursor->buf + cursor->buf_len,
+                  cursor->buf_cap - cursor->buf_len)) <= 0)
+         return -1;
+      cursor->buf_len += (size_t)read;
+   }
+}
+
+/* Returns the next item that may match the query; the
+ * query's field values are checked without decoding it */
+static int libretrodb_cursor_read_span(libretrodb_cursor_t *cursor,
+      struct rmsgpack_reader *item)
+{
    if (cursor->eof)
       return EOF;
 
-retry:
-   if ((rv = rmsgpack_dom_read(cursor->fd, out)) < 0)
-      return rv;
+   for (;;)
+   {
+      struct rmsgpack_token token;
+      int rv;
+
+      if ((rv = libretrodb_cursor_next_span(cursor, item)) != 0)
+      {
+         if (rv == EOF)
+            cursor->eof = 1;
+         return rv;
+      }
 
-   if (out->type == RDT_NULL)
+      /* Items are followed by nil */
+      if (     rmsgpack_reader_next(item, &token) == 0
+            && token.type == RMSGPACK_TOKEN_NIL)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+      item->pos = 0;
+
+      if (     !cursor->query
+            || libretrodb_query_filter_buf(cursor->query, item))
+      {
+         item->pos = 0;
+         return 0;
+      }
+   }
+}
+
+int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   for (;;)
    {
-      cursor->eof = 1;
-      return EOF;
+      int rv;
+      struct rmsgpack_reader item;
+
+      if ((rv = libretrodb_cursor_read_span(cursor, &item)) != 0)
+         return rv;
+
+      if (rmsgpack_dom_read_buf(&item, out) < 0)
+         return -1;
+
+      if (     !cursor->query
+            || libretrodb_query_filter(cursor->query, out))
+         return 0;
+
+      rmsgpack_dom_value_free(out);
    }
+}
 
-   if (cursor->query)
+int libretrodb_cursor_read_item_buf(libretrodb_cursor_t *cursor,
+      const void **data, size_t *len)
+{
+   for (;;)
    {
-      if (!libretrodb_query_filter(cursor->query, out))
+      int rv;
+      struct rmsgpack_reader item;
+
+      if ((rv = libretrodb_cursor_read_span(cursor, &item)) != 0)
+         return rv;
+
+      /* Only items that passed the field checks are decoded */
+      if (cursor->query)
       {
-         rmsgpack_dom_value_free(out);
-         goto retry;
+         struct rmsgpack_dom_value value;
+         int match;
+
+         if (rmsgpack_dom_read_buf(&item, &value) < 0)
+            return -1;
+         match = libretrodb_query_filter(cursor->query, &value);
+         rmsgpack_dom_value_free(&value);
+         if (!match)
+            continue;
       }
-   }
 
-   return 0;
+      *data = item.data;
+      *len  = item.len;
+      return 0;
+   }
 }
 
 /**
@@ -381,11 +918,19 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+   cursor->is_valid   = 0;
+   cursor->eof        = 1;
+   cursor->fd         = NULL;
+   cursor->db         = NULL;
+   cursor->query      = NULL;
+   cursor->plan       = NULL;
+   cursor->plan_count = -1;
+
+   free(cursor->buf);
+   cursor->buf        = NULL;
+   cursor->buf_cap    = 0;
+   cursor->buf_len    = 0;
+   cursor->buf_pos    = 0;
 }
 
 /**
@@ -411,148 +956,229 @@ int libretrodb_cursor_open(libretrodb_t *db,
                                    RETRO_VFS_FILE_ACCESS_HINT_NONE)))
       return -1;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
-   libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->fd         = fd;
+   cursor->db         = db;
+   cursor->is_valid   = 1;
+   cursor->query      = q;
+   cursor->plan       = NULL;
+   cursor->plan_count = -1;
+   cursor->buf        = NULL;
+   cursor->buf_cap    = 0;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      cursor->plan_count = libretrodb_query_get_plan(q, &cursor->plan);
+   }
+
+   libretrodb_cursor_reset(cursor);
 
    return 0;
 }
 
-static int node_iter(void *value, void *ctx)
+static int libretrodb_index_entry_key_cmp(
+      const libretrodb_index_entry_t *a, const libretrodb_index_entry_t *b)
 {
-   struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
-
-   if (intfstream_write(nictx->db->fd, value,
-                        (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
-      return 0;
-
-   return -1;
+   return libretrodb_index_key_cmp(a->key, a->key_len, b->key, b->key_len);
 }
 
-static int node_compare(const void *a, const void *b, void *ctx)
+static int libretrodb_index_entry_cmp(const void *a, const void *b)
 {
-   return memcmp(a, b, *(uint8_t *)ctx);
+   const libretrodb_index_entry_t *ea = (const libretrodb_index_entry_t*)a;
+   const libretrodb_index_entry_t *eb = (const libretrodb_index_entry_t*)b;
+   int rv = libretrodb_index_entry_key_cmp(ea, eb);
+   if (rv != 0)
+      return rv;
+   /* Equal keys keep database order */
+   return (ea->item > eb->item) - (ea->item < eb->item);
 }
 
 int libretrodb_create_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
-   struct node_iter_ctx nictx;
-   struct rmsgpack_dom_value key;
+   size_t i, j, len;
    libretrodb_index_t idx;
+   libretrodb_index_key_t key;
    struct rmsgpack_dom_value item;
-   libretrodb_cursor_t cur          = {0};
-   struct rmsgpack_dom_value *field = NULL;
-   void *buff                       = NULL;
-   uint64_t *buff_u64               = NULL;
-   uint8_t field_size               = 0;
-   uint64_t item_loc                = intfstream_tell(db->fd);
-   bintree_t *tree;
-   uint64_t item_count              = 0;
-   int rval                         = -1;
-
-   if (libretrodb_find_index(db, name, &idx) >= 0)
+   libretrodb_cursor_t cur           = {0};
+   libretrodb_index_entry_t *entries = NULL;
+   struct rmsgpack_dom_value *field  = NULL;
+   uint64_t pos                      = 0;
+   int rval                          = -1;
+
+   /* Old-format indexes cannot be used by the query
+    * planner, so they are rebuilt rather than kept */
+   if (     libretrodb_find_index(db, name, NULL, &idx) >= 0
+         && !idx.legacy)
      return 1;
    if (!db->can_write)
      return -1;
 
-   tree = bintree_new(node_compare, &field_size);
+   item.type                         = RDT_NULL;
+   idx.type                          = RDT_NULL;
 
-   item.type                        = RDT_NULL;
-
-   if (!tree || (libretrodb_cursor_open(db, &cur, NULL) != 0))
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
       goto clean;
 
-   key.type                         = RDT_STRING;
-   key.val.string.len               = (uint32_t)strlen(field_name);
-   key.val.string.buff              = (char *)field_name;   /* We know we aren't going to change it */
-
-   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   for (;;)
    {
-      /* Only map keys are supported */
-      if (item.type != RDT_MAP)
-         goto clean;
-
-      /* Field not found in item? */
-      if (!(field = rmsgpack_dom_value_map_value(&item, &key)))
-        continue;
+      libretrodb_index_entry_t entry;
+      /* Without a query the next item starts where
+       * the last one ended */
+      uint64_t item_loc = cur.buf_offset + cur.buf_pos;
 
-      /* Field is not binary? */
-      if (field->type != RDT_BINARY)
-         goto clean;
+      if (libretrodb_cursor_read_item(&cur, &item) != 0)
+         break;
 
-      /* Field is empty? */
-      if (field->val.binary.len == 0)
+      /* Only map keys are supported */
+      if (item.type != RDT_MAP)
          goto clean;
 
-      if (field_size == 0)
-         field_size = field->val.binary.len;
-      /* Field is not of correct size */
-      else if (field->val.binary.len != field_size)
-         goto clean;
+      /* Items without the field can never match
+       * a query on it, so they are left out */
+      if ((field = libretrodb_map_get(&item, field_name)))
+      {
+         if (idx.type == RDT_NULL)
+            idx.type = field->type;
+
+         /* All values must be of one indexable type */
+         if (     field->type != idx.type
+               || !libretrodb_index_key_init(&key, field, idx.type))
+            goto clean;
+
+         /* Item offsets are stored as 32-bit */
+         if (item_loc > 0xFFFFFFFF)
+            goto clean;
+
+         if (!(entry.key = (uint8_t*)malloc(key.len + 1)))
+            goto clean;
+         memcpy(entry.key, key.data, key.len);
+         entry.key[key.len] = '\0';
+         entry.key_len      = key.len;
+         entry.item         = (uint32_t)item_loc;
+         RBUF_PUSH(entries, entry);
+      }
 
-      if (!(buff = malloc(field_size + sizeof(uint64_t))))
-         goto clean;
+      rmsgpack_dom_value_free(&item);
+      item.type = RDT_NULL;
+   }
 
-      memcpy(buff, field->val.binary.buff, field_size);
+   /* Stopped on a read error rather than the end marker */
+   if (!cur.eof)
+      goto clean;
 
-      buff_u64 = (uint64_t *)((uint8_t *)buff + field_size);
+   len = RBUF_LEN(entries);
+   qsort(entries, len, sizeof(*entries), libretrodb_index_entry_cmp);
 
-      memcpy(buff_u64, &item_loc, sizeof(uint64_t));
+   strlcpy(idx.name,  name,       sizeof(idx.name));
+   strlcpy(idx.field, field_name, sizeof(idx.field));
 
-      /* Value is not unique? */
-      if (bintree_insert(tree, tree->root, buff) != 0)
+   /* Equal keys are stored once, followed by the offsets
+    * of all the items sharing them */
+   idx.count = 0;
+   idx.next  = 0;
+   for (i = 0; i < len; i++)
+   {
+      if (i == 0 || libretrodb_index_entry_key_cmp(&entries[i - 1],
+               &entries[i]) != 0)
       {
-         rmsgpack_dom_value_print(field);
-         goto clean;
+         /* Position, key length and item count */
+         idx.next += 3 * sizeof(uint32_t) + entries[i].key_len;
+         idx.count++;
       }
-      item_count++;
-      buff     = NULL;
-      rmsgpack_dom_value_free(&item);
-      item_loc = intfstream_tell(cur.fd);
+      idx.next += sizeof(uint32_t);
    }
-   rval = 0;
 
-   intfstream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
+   /* Key positions are 32-bit */
+   if (idx.next > 0xFFFFFFFF)
+      goto clean;
 
-   strlcpy(idx.name, name, sizeof(idx.name));
+   intfstream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
 
-   idx.key_size = field_size;
-   idx.next     = item_count * (field_size + sizeof(uint64_t));
-   idx.count    = item_count;
    /* Write index header */
-   rmsgpack_write_map_header(db->fd, 4);
+   rmsgpack_write_map_header(db->fd, 5);
    rmsgpack_write_string(db->fd, "name", STRLEN_CONST("name"));
    rmsgpack_write_string(db->fd, idx.name, (uint32_t)strlen(idx.name));
-   rmsgpack_write_string(db->fd, "key_size", (uint32_t)STRLEN_CONST("key_size"));
-   rmsgpack_write_uint  (db->fd, idx.key_size);
-   rmsgpack_write_string(db->fd, "next", STRLEN_CONST("next"));
-   rmsgpack_write_uint  (db->fd, idx.next);
+   rmsgpack_write_string(db->fd, "field", STRLEN_CONST("field"));
+   rmsgpack_write_string(db->fd, idx.field, (uint32_t)strlen(idx.field));
+   rmsgpack_write_string(db->fd, "type", STRLEN_CONST("type"));
+   rmsgpack_write_uint  (db->fd, idx.type);
    rmsgpack_write_string(db->fd, "count", STRLEN_CONST("count"));
    rmsgpack_write_uint  (db->fd, idx.count);
+   rmsgpack_write_string(db->fd, "next", STRLEN_CONST("next"));
+   rmsgpack_write_uint  (db->fd, idx.next);
+
+   /* Body: the position of every key for the binary search,
+    * then the sorted keys with their item offsets */
+   for (i = 0; i < len; i = j)
+   {
+      uint32_t key_pos = swap_if_little32((uint32_t)pos);
+
+      for (j = i + 1; j < len && libretrodb_index_entry_key_cmp(
+               &entries[i], &entries[j]) == 0; j++);
+
+      if (intfstream_write(db->fd, &key_pos, sizeof(key_pos)) <= 0)
+         goto clean;
+      pos += 2 * sizeof(uint32_t) + entries[i].key_len
+         + (j - i) * sizeof(uint32_t);
+   }
+
+   for (i = 0; i < len; i = j)
+   {
+      size_t k;
+      uint32_t key_len, count;
+
+      for (j = i + 1; j < len && libretrodb_index_entry_key_cmp(
+               &entries[i], &entries[j]) == 0; j++);
+
+      key_len = swap_if_little32(entries[i].key_len);
+      count   = swap_if_little32((uint32_t)(j - i));
+
+      if (intfstream_write(db->fd, &key_len, sizeof(key_len)) <= 0)
+         goto clean;
+      if (     entries[i].key_len
+            && intfstream_write(db->fd, entries[i].key,
+               entries[i].key_len) <= 0)
+         goto clean;
+      if (intfstream_write(db->fd, &count, sizeof(count)) <= 0)
+         goto clean;
 
-   nictx.db     = db;
-   nictx.idx    = &idx;
-   bintree_iterate(tree->root, node_iter, &nictx);
+      for (k = i; k < j; k++)
+      {
+         uint32_t item_loc = swap_if_little32(entries[k].item);
+         if (intfstream_write(db->fd, &item_loc, sizeof(item_loc)) <= 0)
+            goto clean;
+      }
+   }
 
    intfstream_flush(db->fd);
+   rval = 0;
+
 clean:
    rmsgpack_dom_value_free(&item);
-   if (buff)
-      free(buff);
+   for (i = 0; i < RBUF_LEN(entries); i++)
+      free(entries[i].key);
+   RBUF_FREE(entries);
    if (cur.is_valid)
       libretrodb_cursor_close(&cur);
-   if (tree && tree->root)
-      bintree_free(tree->root);
-   free(tree);
    return rval;
 }
 
+int libretrodb_create_default_indexes(libretrodb_t *db)
+{
+   size_t i;
+   int rv = 0;
+
+   for (i = 0; i < ARRAY_SIZE(libretrodb_default_index_fields); i++)
+   {
+      const char *field = libretrodb_default_index_fields[i];
+      if (libretrodb_create_index(db, field, field) < 0)
+         rv = -1;
+   }
+
+   return rv;
+}
+
 libretrodb_cursor_t *libretrodb_cursor_new(void)
 {
    libretrodb_cursor_t *dbc = (libretrodb_cursor_t*)
@@ -566,6 +1192,14 @@ libretrodb_cursor_t *libretrodb_cursor_new(void)
    dbc->eof                 = 0;
    dbc->query               = NULL;
    dbc->db                  = NULL;
+   dbc->plan                = NULL;
+   dbc->buf                 = NULL;
+   dbc->buf_offset          = 0;
+   dbc->buf_len             = 0;
+   dbc->buf_pos             = 0;
+   dbc->buf_cap             = 0;
+   dbc->plan_count          = -1;
+   dbc->plan_pos            = 0;
 
    return dbc;
 }
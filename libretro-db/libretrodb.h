@@ -45,17 +45,64 @@ typedef struct libretrodb_index libretrodb_index_t;
 
 typedef int (*libretrodb_value_provider)(void *ctx, struct rmsgpack_dom_value *out);
 
+/* Return non-zero to stop the iteration */
+typedef int (*libretrodb_index_visitor)(void *ctx,
+      const struct rmsgpack_dom_value *key, uint64_t offset);
+
 int libretrodb_create(intfstream_t *fd, libretrodb_value_provider value_provider, void *ctx);
 
 void libretrodb_close(libretrodb_t *db);
 
 int libretrodb_open(const char *path, libretrodb_t *db, bool write);
 
+/**
+ * libretrodb_create_index:
+ * @db                  : Handle to database, opened for writing.
+ * @name                : Name of the new index.
+ * @field_name          : Field to index.
+ *
+ * Appends a sorted index of @field_name to the database. Values
+ * need not be unique, but must all be of the same scalar type.
+ *
+ * Returns: 0 if successful, 1 if the index already exists,
+ * otherwise negative.
+ **/
 int libretrodb_create_index(libretrodb_t *db, const char *name,
       const char *field_name);
 
+/**
+ * libretrodb_create_default_indexes:
+ * @db                  : Handle to database, opened for writing.
+ *
+ * Indexes the fields the frontend looks content up by
+ * (crc, serial, name, developer and releaseyear).
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_create_default_indexes(libretrodb_t *db);
+
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
-        const void *key, struct rmsgpack_dom_value *out);
+      const struct rmsgpack_dom_value *key, struct rmsgpack_dom_value *out);
+
+/**
+ * libretrodb_index_iterate:
+ * @db                  : Handle to database.
+ * @field_name          : Indexed field.
+ * @min                 : Lowest key to visit, or NULL.
+ * @max                 : Highest key to visit, or NULL.
+ * @visitor             : Called for every key in range, in key order.
+ * @ctx                 : Passed to @visitor.
+ *
+ * Walks the index of @field_name from @min to @max, handing
+ * each key and the offset of its item to @visitor.
+ *
+ * Returns: 0 if successful, negative if there is no index for
+ * @field_name or its values cannot be compared to @min/@max.
+ **/
+int libretrodb_index_iterate(libretrodb_t *db, const char *field_name,
+      const struct rmsgpack_dom_value *min,
+      const struct rmsgpack_dom_value *max,
+      libretrodb_index_visitor visitor, void *ctx);
 
 libretrodb_t *libretrodb_new(void);
 
@@ -105,6 +152,22 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_cursor_read_item_buf:
+ * @cursor              : Handle to database cursor.
+ * @data                : Set to the encoded item.
+ * @len                 : Set to the size of @data.
+ *
+ * Returns the same items as libretrodb_cursor_read_item,
+ * still encoded, for use with rmsgpack_reader. @data belongs
+ * to the cursor and stays valid until its next read.
+ *
+ * Returns: 0 if successful, EOF at the end of the
+ * results, otherwise negative.
+ **/
+int libretrodb_cursor_read_item_buf(libretrodb_cursor_t *cursor,
+      const void **data, size_t *len);
+
 RETRO_END_DECLS
 
 #endif
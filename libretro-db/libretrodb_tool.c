@@ -21,13 +21,62 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
 
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 
+#define BENCH_ITERATIONS 100
+
+/* Runs @query_exp @iterations times and returns the number of
+ * items found, or -1 on error. Compiling without a database
+ * leaves the query unplanned, which forces a full scan. */
+static int bench_query(libretrodb_t *db, bool use_index,
+      const char *query_exp, unsigned iterations, retro_time_t *elapsed)
+{
+   unsigned i;
+   int found          = -1;
+   retro_time_t start = cpu_features_get_time_usec();
+
+   for (i = 0; i < iterations; i++)
+   {
+      struct rmsgpack_dom_value item;
+      const char *err          = NULL;
+      libretrodb_cursor_t *cur = NULL;
+      libretrodb_query_t *q    = libretrodb_query_compile(
+            use_index ? db : NULL, query_exp, strlen(query_exp), &err);
+
+      if (err || !q)
+         return -1;
+
+      if (     !(cur = libretrodb_cursor_new())
+            || libretrodb_cursor_open(db, cur, q) != 0)
+      {
+         libretrodb_cursor_free(cur);
+         libretrodb_query_free(q);
+         return -1;
+      }
+
+      found = 0;
+      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      {
+         found++;
+         rmsgpack_dom_value_free(&item);
+      }
+
+      libretrodb_cursor_close(cur);
+      libretrodb_cursor_free(cur);
+      libretrodb_query_free(q);
+   }
+
+   *elapsed = cpu_features_get_time_usec() - start;
+   return found;
+}
+
 int main(int argc, char ** argv)
 {
    int rv;
@@ -46,6 +95,8 @@ int main(int argc, char ** argv)
       printf("Available Commands:\n");
       printf("\tlist\n");
       printf("\tcreate-index <index name> <field name>\n");
+      printf("\tcreate-indexes\n");
+      printf("\tbench <query expression> [iterations]\n");
       printf("\tfind <query expression>\n");
       printf("\tget-names <query expression>\n");
       return 1;
@@ -159,6 +210,69 @@ int main(int argc, char ** argv)
          rmsgpack_dom_value_free(&item);
       }
    }
+   else if (string_is_equal(command, "create-indexes"))
+   {
+      if (argc != 3)
+      {
+         printf("Usage: %s <db file> create-indexes\n", argv[0]);
+         goto error;
+      }
+
+      if (libretrodb_create_default_indexes(db) != 0)
+      {
+         printf("Could not create indexes\n");
+         goto error;
+      }
+   }
+   else if (string_is_equal(command, "bench"))
+   {
+      retro_time_t scan_time, index_time;
+      int scan_found, index_found;
+      const uint64_t *plan = NULL;
+      ssize_t planned      = -1;
+      unsigned iterations  = BENCH_ITERATIONS;
+
+      if (argc != 4 && argc != 5)
+      {
+         printf("Usage: %s <db file> bench <query expression> [iterations]\n", argv[0]);
+         goto error;
+      }
+
+      query_exp = argv[3];
+      if (argc == 5 && (iterations = (unsigned)strtoul(argv[4], NULL, 10)) == 0)
+         iterations = 1;
+
+      err = NULL;
+      if (!(q = libretrodb_query_compile(db, query_exp, strlen(query_exp), &err)))
+      {
+         printf("%s\n", err ? err : "Could not compile query");
+         goto error;
+      }
+      planned     = libretrodb_query_get_plan(q, &plan);
+
+      scan_found  = bench_query(db, false, query_exp, iterations, &scan_time);
+      index_found = bench_query(db, true,  query_exp, iterations, &index_time);
+
+      if (scan_found < 0 || index_found < 0)
+      {
+         printf("Could not run query\n");
+         goto error;
+      }
+
+      printf("scan:  %d items, %.3f ms/query\n", scan_found,
+            scan_time / 1000.0 / iterations);
+      if (planned < 0)
+         printf("index: no usable index\n");
+      else
+         printf("index: %d items, %.3f ms/query (%d candidates)\n", index_found,
+               index_time / 1000.0 / iterations, (int)planned);
+
+      if (scan_found != index_found)
+      {
+         printf("Result mismatch\n");
+         goto error;
+      }
+   }
    else if (memcmp(command, "create-index", 12) == 0)
    {
       const char * index_name, * field_name;
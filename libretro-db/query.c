@@ -34,6 +34,7 @@
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
+#include <array/rbuf.h>
 
 #include "libretrodb.h"
 #include "query.h"
@@ -78,10 +79,28 @@ struct argument
    enum argument_type type;
 };
 
+/* A field that must equal one of @values */
+struct query_check
+{
+   const struct rmsgpack_dom_value *field;
+   const struct argument *values;
+   unsigned count;
+};
+
 struct query
 {
    struct invocation root; /* ptr alignment */
+   uint64_t *plan;         /* Item offsets (RBUF), valid if planned */
+   struct query_check *checks; /* RBUF, see query_build_checks */
    unsigned ref_count;
+   bool planned;
+};
+
+struct query_plan_ctx
+{
+   uint64_t *offsets;      /* RBUF */
+   const char *pattern;
+   size_t prefix_len;
 };
 
 struct registered_func
@@ -953,6 +972,366 @@ clean:
    return buff;
 }
 
+static int query_plan_collect(void *ctx,
+      const struct rmsgpack_dom_value *key, uint64_t offset)
+{
+   struct query_plan_ctx *pctx = (struct query_plan_ctx*)ctx;
+   RBUF_PUSH(pctx->offsets, offset);
+   return 0;
+}
+
+static int query_plan_collect_glob(void *ctx,
+      const struct rmsgpack_dom_value *key, uint64_t offset)
+{
+   struct query_plan_ctx *pctx = (struct query_plan_ctx*)ctx;
+
+   /* Glob only matches strings, and all values of
+    * an index share one type */
+   if (key->type != RDT_STRING)
+      return 1;
+
+   /* Keys are sorted, so the ones starting with the
+    * literal part of the pattern are adjacent */
+   if (strncmp(key->val.string.buff, pctx->pattern, pctx->prefix_len) != 0)
+      return 1;
+
+   if (rl_fnmatch(pctx->pattern, key->val.string.buff, 0) == 0)
+      RBUF_PUSH(pctx->offsets, offset);
+   return 0;
+}
+
+static int query_plan_offset_cmp(const void *a, const void *b)
+{
+   uint64_t oa = *(const uint64_t*)a;
+   uint64_t ob = *(const uint64_t*)b;
+   return (oa > ob) - (oa < ob);
+}
+
+/* Puts @offsets in file order and drops duplicates */
+static void query_plan_sort(uint64_t *offsets)
+{
+   size_t i;
+   size_t j   = 0;
+   size_t len = RBUF_LEN(offsets);
+
+   if (len < 2)
+      return;
+
+   qsort(offsets, len, sizeof(*offsets), query_plan_offset_cmp);
+
+   for (i = 1; i < len; i++)
+      if (offsets[i] != offsets[j])
+         offsets[++j] = offsets[i];
+
+   RBUF_RESIZE(offsets, j + 1);
+}
+
+/* Keeps the offsets of @plan that are also in @offsets;
+ * both must be sorted */
+static void query_plan_intersect(uint64_t *plan, const uint64_t *offsets)
+{
+   size_t i     = 0;
+   size_t j     = 0;
+   size_t k     = 0;
+   size_t len_a = RBUF_LEN(plan);
+   size_t len_b = RBUF_LEN(offsets);
+
+   while (i < len_a && j < len_b)
+   {
+      if (plan[i] < offsets[j])
+         i++;
+      else if (plan[i] > offsets[j])
+         j++;
+      else
+      {
+         plan[k++] = plan[i++];
+         j++;
+      }
+   }
+
+   RBUF_CLEAR(plan);
+   if (k)
+      RBUF_RESIZE(plan, k);
+}
+
+/* Collects the items whose @field may satisfy @arg. Every
+ * item that can match has to be collected; extra ones are
+ * fine since the query is still run on each of them.
+ * Returns false if the index cannot narrow @arg down. */
+static bool query_plan_argument(libretrodb_t *db, const char *field,
+      const struct argument *arg, uint64_t **offsets)
+{
+   unsigned i;
+   struct query_plan_ctx ctx;
+   const struct invocation *inv = &arg->a.invocation;
+
+   ctx.offsets    = NULL;
+   ctx.pattern    = NULL;
+   ctx.prefix_len = 0;
+
+   if (arg->type == AT_VALUE)
+   {
+      if (libretrodb_index_iterate(db, field, &arg->a.value, &arg->a.value,
+               query_plan_collect, &ctx) < 0)
+         goto fail;
+   }
+   else if (inv->func == query_func_operator_or)
+   {
+      for (i = 0; i < inv->argc; i++)
+      {
+         const struct rmsgpack_dom_value *value = &inv->argv[i].a.value;
+         if (inv->argv[i].type != AT_VALUE)
+            goto fail;
+         if (libretrodb_index_iterate(db, field, value, value,
+                  query_plan_collect, &ctx) < 0)
+            goto fail;
+      }
+   }
+   else if (inv->func == query_func_between)
+   {
+      struct rmsgpack_dom_value min, max;
+
+      if (     inv->argc != 2
+            || inv->argv[0].type != AT_VALUE
+            || inv->argv[1].type != AT_VALUE
+            || inv->argv[0].a.value.type != RDT_INT
+            || inv->argv[1].a.value.type != RDT_INT)
+         goto fail;
+
+      min = inv->argv[0].a.value;
+      max = inv->argv[1].a.value;
+
+      if (libretrodb_index_iterate(db, field,
+               (min.val.int_ < 0) ? NULL : &min, &max,
+               query_plan_collect, &ctx) < 0)
+         goto fail;
+
+      /* query_func_between truncates unsigned values to
+       * 'unsigned', so larger ones may match any range */
+      if (max.val.int_ < ((int64_t)1 << 32))
+      {
+         min.val.int_ = (int64_t)1 << 32;
+         if (libretrodb_index_iterate(db, field, &min, NULL,
+                  query_plan_collect, &ctx) < 0)
+            goto fail;
+      }
+   }
+   else if (inv->func == query_func_glob)
+   {
+      struct rmsgpack_dom_value prefix;
+
+      if (     inv->argc != 1
+            || inv->argv[0].type != AT_VALUE
+            || inv->argv[0].a.value.type != RDT_STRING)
+         goto fail;
+
+      ctx.pattern             = inv->argv[0].a.value.val.string.buff;
+      ctx.prefix_len          = strcspn(ctx.pattern, "*?[\\");
+
+      /* Without a literal prefix this still only
+       * reads the index rather than every item */
+      prefix.type             = RDT_STRING;
+      prefix.val.string.buff  = (char*)ctx.pattern;
+      prefix.val.string.len   = (uint32_t)ctx.prefix_len;
+
+      if (libretrodb_index_iterate(db, field,
+               ctx.prefix_len ? &prefix : NULL, NULL,
+               query_plan_collect_glob, &ctx) < 0)
+         goto fail;
+   }
+   else
+      goto fail;
+
+   query_plan_sort(ctx.offsets);
+   *offsets = ctx.offsets;
+   return true;
+
+fail:
+   RBUF_FREE(ctx.offsets);
+   return false;
+}
+
+/* min and max carry state from one item to the next,
+ * so queries using them have to see every item */
+static bool query_plan_is_stateless(const struct invocation *inv)
+{
+   unsigned i;
+
+   if (inv->func == query_func_min || inv->func == query_func_max)
+      return false;
+
+   for (i = 0; i < inv->argc; i++)
+      if (     inv->argv[i].type == AT_FUNCTION
+            && !query_plan_is_stateless(&inv->argv[i].a.invocation))
+         return false;
+
+   return true;
+}
+
+/* Narrows a table query down to the items picked by the indexes
+ * of its fields. Queries that cannot use an index, or databases
+ * without one, are left to scan every item. */
+static void query_plan(libretrodb_t *db, struct query *q)
+{
+   unsigned i;
+
+   if (     !db
+         || q->root.func != query_func_all_map
+         || !query_plan_is_stateless(&q->root))
+      return;
+
+   for (i = 0; i + 1 < q->root.argc; i += 2)
+   {
+      uint64_t *offsets          = NULL;
+      const struct argument *key = &q->root.argv[i];
+
+      if (key->type != AT_VALUE || key->a.value.type != RDT_STRING)
+         continue;
+
+      if (!query_plan_argument(db, key->a.value.val.string.buff,
+               &q->root.argv[i + 1], &offsets))
+         continue;
+
+      if (!q->planned)
+      {
+         q->plan    = offsets;
+         q->planned = true;
+      }
+      else
+      {
+         query_plan_intersect(q->plan, offsets);
+         RBUF_FREE(offsets);
+      }
+
+      /* Nothing can match */
+      if (!RBUF_LEN(q->plan))
+         break;
+   }
+}
+
+/* Whether @arg is a value an item field can be compared
+ * to without decoding the item */
+static bool query_check_value(const struct argument *arg)
+{
+   if (arg->type != AT_VALUE)
+      return false;
+
+   switch (arg->a.value.type)
+   {
+      case RDT_BOOL:
+      case RDT_UINT:
+      case RDT_INT:
+      case RDT_STRING:
+      case RDT_BINARY:
+         return true;
+      default:
+         break;
+   }
+
+   /* A nil value matches missing fields */
+   return false;
+}
+
+/* Collects the fields of a table query that must equal a value
+ * or one of the values of or(), so items can be rejected before
+ * they are decoded. Other arguments are left to the full filter. */
+static void query_build_checks(struct query *q)
+{
+   unsigned i, j;
+
+   /* Items rejected early are never seen by min and max */
+   if (     q->root.func != query_func_all_map
+         || (q->root.argc % 2) != 0
+         || !query_plan_is_stateless(&q->root))
+      return;
+
+   for (i = 0; i < q->root.argc; i += 2)
+   {
+      struct query_check check;
+      const struct argument *key   = &q->root.argv[i];
+      const struct argument *value = &q->root.argv[i + 1];
+
+      if (key->type != AT_VALUE || key->a.value.type != RDT_STRING)
+         continue;
+
+      if (value->type == AT_VALUE)
+      {
+         if (!query_check_value(value))
+            continue;
+         check.values = value;
+         check.count  = 1;
+      }
+      else if (value->a.invocation.func == query_func_operator_or
+            && value->a.invocation.argc > 0)
+      {
+         for (j = 0; j < value->a.invocation.argc; j++)
+            if (!query_check_value(&value->a.invocation.argv[j]))
+               break;
+         if (j < value->a.invocation.argc)
+            continue;
+         check.values = value->a.invocation.argv;
+         check.count  = value->a.invocation.argc;
+      }
+      else
+         continue;
+
+      check.field = &key->a.value;
+      RBUF_PUSH(q->checks, check);
+   }
+}
+
+/* Compares the same way func_equals does */
+static bool query_check_token(const struct query_check *check,
+      const struct rmsgpack_token *token)
+{
+   unsigned i;
+
+   for (i = 0; i < check->count; i++)
+   {
+      const struct rmsgpack_dom_value *value = &check->values[i].a.value;
+
+      switch (value->type)
+      {
+         case RDT_BOOL:
+            if (     token->type == RMSGPACK_TOKEN_BOOL
+                  && token->val.bool_ == value->val.bool_)
+               return true;
+            break;
+         case RDT_UINT:
+            if (     token->type == RMSGPACK_TOKEN_UINT
+                  && token->val.uint_ == value->val.uint_)
+               return true;
+            break;
+         case RDT_INT:
+            if (     token->type == RMSGPACK_TOKEN_INT
+                  && token->val.int_ == value->val.int_)
+               return true;
+            if (     token->type == RMSGPACK_TOKEN_UINT
+                  && token->val.uint_ == (uint64_t)value->val.int_)
+               return true;
+            break;
+         case RDT_STRING:
+            if (     token->type == RMSGPACK_TOKEN_STRING
+                  && token->val.string.len == value->val.string.len
+                  && strncmp(token->val.string.buff,
+                     value->val.string.buff, value->val.string.len) == 0)
+               return true;
+            break;
+         case RDT_BINARY:
+            if (     token->type == RMSGPACK_TOKEN_BINARY
+                  && token->val.binary.len == value->val.binary.len
+                  && memcmp(token->val.binary.buff,
+                     value->val.binary.buff, value->val.binary.len) == 0)
+               return true;
+            break;
+         default:
+            break;
+      }
+   }
+
+   return false;
+}
+
 void libretrodb_query_free(void *q)
 {
    unsigned i;
@@ -966,6 +1345,8 @@ void libretrodb_query_free(void *q)
       query_argument_free(&real_q->root.argv[i]);
 
    free(real_q->root.argv);
+   RBUF_FREE(real_q->plan);
+   RBUF_FREE(real_q->checks);
    real_q->root.argv = NULL;
    real_q->root.argc = 0;
    free(real_q);
@@ -990,6 +1371,9 @@ void *libretrodb_query_compile(libretrodb_t *db,
    q->root.argc        = 0;
    q->root.func        = NULL;
    q->root.argv        = NULL;
+   q->plan             = NULL;
+   q->checks           = NULL;
+   q->planned          = false;
 
    buff.data           = query;
    buff.len            = len;
@@ -1027,6 +1411,9 @@ void *libretrodb_query_compile(libretrodb_t *db,
       goto error;
    }
 
+   query_build_checks(q);
+   query_plan(db, q);
+
    return q;
 
 error:
@@ -1049,3 +1436,76 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+int libretrodb_query_filter_buf(libretrodb_query_t *q,
+      struct rmsgpack_reader *item)
+{
+   struct rmsgpack_token token;
+   uint32_t i, pairs;
+   uint64_t seen    = 0;
+   struct query *rq = (struct query*)q;
+   size_t count     = RBUF_LEN(rq->checks);
+
+   /* Only the first 64 checks are used */
+   if (count > 64)
+      count = 64;
+
+   if (!count)
+      return 1;
+
+   /* Anything unusual is left to the full filter */
+   if (     rmsgpack_reader_next(item, &token) != 0
+         || token.type != RMSGPACK_TOKEN_MAP)
+      return 1;
+
+   pairs = token.val.len;
+
+   for (i = 0; i < pairs; i++)
+   {
+      size_t k;
+      struct rmsgpack_reader value;
+
+      if (rmsgpack_reader_next(item, &token) != 0)
+         return 1;
+
+      value = *item;
+      if (rmsgpack_reader_skip(item) != 0)
+         return 1;
+
+      if (token.type != RMSGPACK_TOKEN_STRING)
+         continue;
+
+      for (k = 0; k < count; k++)
+      {
+         const struct rmsgpack_dom_value *field = rq->checks[k].field;
+         struct rmsgpack_token field_value;
+
+         /* As with rmsgpack_dom_value_map_value, the
+          * first pair with the key is the one used */
+         if (     (seen & ((uint64_t)1 << k))
+               || field->val.string.len != token.val.string.len
+               || strncmp(field->val.string.buff, token.val.string.buff,
+                  token.val.string.len) != 0)
+            continue;
+
+         seen |= (uint64_t)1 << k;
+
+         if (     rmsgpack_reader_next(&value, &field_value) != 0
+               || !query_check_token(&rq->checks[k], &field_value))
+            return 0;
+      }
+   }
+
+   /* Missing fields are nil, which no check matches */
+   return seen == ((count == 64) ? ~(uint64_t)0 : (((uint64_t)1 << count) - 1));
+}
+
+ssize_t libretrodb_query_get_plan(libretrodb_query_t *q,
+      const uint64_t **offsets)
+{
+   struct query *rq = (struct query*)q;
+   if (!rq->planned)
+      return -1;
+   *offsets = rq->plan;
+   return (ssize_t)RBUF_LEN(rq->plan);
+}
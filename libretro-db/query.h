@@ -26,6 +26,7 @@
 #include <retro_common_api.h>
 
 #include "libretrodb.h"
+#include "rmsgpack.h"
 #include "rmsgpack_dom.h"
 
 RETRO_BEGIN_DECLS
@@ -38,6 +39,31 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_filter_buf:
+ * @q                   : Compiled query.
+ * @item                : Reader positioned at an encoded item.
+ *
+ * Checks the fields the query compares to plain values
+ * without decoding @item, and moves @item past what was read.
+ *
+ * Returns: 0 if @item cannot match, 1 if it has to be
+ * decoded and passed to libretrodb_query_filter.
+ **/
+int libretrodb_query_filter_buf(libretrodb_query_t *q,
+      struct rmsgpack_reader *item);
+
+/**
+ * libretrodb_query_get_plan:
+ * @q                   : Compiled query.
+ * @offsets             : Set to the item offsets to visit.
+ *
+ * Returns: number of items picked from the database indexes,
+ * in file order, or -1 if every item has to be scanned.
+ **/
+ssize_t libretrodb_query_get_plan(libretrodb_query_t *q,
+      const uint64_t **offsets);
+
 RETRO_END_DECLS
 
 #endif
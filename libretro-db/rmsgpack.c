@@ -590,3 +590,208 @@ int rmsgpack_read(intfstream_t *fd,
       free(buff);
    return 0;
 }
+
+void rmsgpack_reader_init(struct rmsgpack_reader *reader,
+      const void *data, size_t len)
+{
+   reader->data = (const uint8_t*)data;
+   reader->len  = len;
+   reader->pos  = 0;
+}
+
+static uint64_t rmsgpack_reader_uint(const uint8_t *p, size_t len)
+{
+   size_t i;
+   uint64_t value = 0;
+   for (i = 0; i < len; i++)
+      value = (value << 8) | p[i];
+   return value;
+}
+
+static int64_t rmsgpack_reader_int(const uint8_t *p, size_t len)
+{
+   uint64_t value = rmsgpack_reader_uint(p, len);
+
+   switch (len)
+   {
+      case 1:
+         return (int8_t)value;
+      case 2:
+         return (int16_t)value;
+      case 4:
+         return (int32_t)value;
+   }
+   return (int64_t)value;
+}
+
+int rmsgpack_reader_next(struct rmsgpack_reader *reader,
+      struct rmsgpack_token *token)
+{
+   uint8_t type;
+   size_t size;
+   uint64_t len;
+   const uint8_t *p = reader->data + reader->pos;
+   size_t avail     = reader->len  - reader->pos;
+
+   if (avail < 1)
+      return 1;
+
+   type = *p++;
+   avail--;
+
+   if (type < MPF_FIXMAP)
+   {
+      token->type      = RMSGPACK_TOKEN_INT;
+      token->val.int_  = type;
+      reader->pos     += 1;
+      return 0;
+   }
+   else if (type < MPF_FIXARRAY)
+   {
+      token->type      = RMSGPACK_TOKEN_MAP;
+      token->val.len   = type - MPF_FIXMAP;
+      reader->pos     += 1;
+      return 0;
+   }
+   else if (type < MPF_FIXSTR)
+   {
+      token->type      = RMSGPACK_TOKEN_ARRAY;
+      token->val.len   = type - MPF_FIXARRAY;
+      reader->pos     += 1;
+      return 0;
+   }
+   else if (type < MPF_NIL)
+   {
+      len = type - MPF_FIXSTR;
+      if (avail < len)
+         return 1;
+      token->type            = RMSGPACK_TOKEN_STRING;
+      token->val.string.buff = (const char*)p;
+      token->val.string.len  = (uint32_t)len;
+      reader->pos           += 1 + (size_t)len;
+      return 0;
+   }
+   else if (type > MPF_MAP32)
+   {
+      token->type      = RMSGPACK_TOKEN_INT;
+      token->val.int_  = type - 0xff - 1;
+      reader->pos     += 1;
+      return 0;
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         token->type          = RMSGPACK_TOKEN_NIL;
+         size                 = 0;
+         break;
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         token->type          = RMSGPACK_TOKEN_BOOL;
+         token->val.bool_     = (type == _MPF_TRUE);
+         size                 = 0;
+         break;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         if (type >= _MPF_STR8)
+         {
+            token->type       = RMSGPACK_TOKEN_STRING;
+            size              = (size_t)1 << (type - _MPF_STR8);
+         }
+         else
+         {
+            token->type       = RMSGPACK_TOKEN_BINARY;
+            size              = (size_t)1 << (type - _MPF_BIN8);
+         }
+         if (avail < size)
+            return 1;
+         len                  = rmsgpack_reader_uint(p, size);
+         if (avail - size < len)
+            return 1;
+         if (token->type == RMSGPACK_TOKEN_STRING)
+         {
+            token->val.string.buff = (const char*)p + size;
+            token->val.string.len  = (uint32_t)len;
+         }
+         else
+         {
+            token->val.binary.buff = p + size;
+            token->val.binary.len  = (uint32_t)len;
+         }
+         size                 += (size_t)len;
+         break;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         size                 = (size_t)1 << (type - _MPF_UINT8);
+         if (avail < size)
+            return 1;
+         token->type          = RMSGPACK_TOKEN_UINT;
+         token->val.uint_     = rmsgpack_reader_uint(p, size);
+         break;
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         size                 = (size_t)1 << (type - _MPF_INT8);
+         if (avail < size)
+            return 1;
+         token->type          = RMSGPACK_TOKEN_INT;
+         token->val.int_      = rmsgpack_reader_int(p, size);
+         break;
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         if (type >= _MPF_MAP16)
+         {
+            token->type       = RMSGPACK_TOKEN_MAP;
+            size              = (size_t)2 << (type - _MPF_MAP16);
+         }
+         else
+         {
+            token->type       = RMSGPACK_TOKEN_ARRAY;
+            size              = (size_t)2 << (type - _MPF_ARRAY16);
+         }
+         if (avail < size)
+            return 1;
+         token->val.len       = (uint32_t)rmsgpack_reader_uint(p, size);
+         break;
+      default:
+         return -1;
+   }
+
+   reader->pos += 1 + size;
+   return 0;
+}
+
+int rmsgpack_reader_skip(struct rmsgpack_reader *reader)
+{
+   struct rmsgpack_token token;
+   size_t start     = reader->pos;
+   uint64_t pending = 1;
+
+   while (pending)
+   {
+      int rv;
+
+      if ((rv = rmsgpack_reader_next(reader, &token)) != 0)
+      {
+         reader->pos = start;
+         return rv;
+      }
+
+      pending--;
+      if (token.type == RMSGPACK_TOKEN_MAP)
+         pending += (uint64_t)token.val.len * 2;
+      else if (token.type == RMSGPACK_TOKEN_ARRAY)
+         pending += token.val.len;
+   }
+
+   return 0;
+}
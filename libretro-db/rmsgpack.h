@@ -23,6 +23,7 @@
 #ifndef __LIBRETRODB_MSGPACK_H__
 #define __LIBRETRODB_MSGPACK_H__
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <streams/interface_stream.h>
@@ -39,6 +40,52 @@ struct rmsgpack_read_callbacks
    int (*read_array_start)(uint32_t, void *);
 };
 
+enum rmsgpack_token_type
+{
+   RMSGPACK_TOKEN_NIL = 0,
+   RMSGPACK_TOKEN_BOOL,
+   RMSGPACK_TOKEN_UINT,
+   RMSGPACK_TOKEN_INT,
+   RMSGPACK_TOKEN_STRING,
+   RMSGPACK_TOKEN_BINARY,
+   RMSGPACK_TOKEN_MAP,
+   RMSGPACK_TOKEN_ARRAY
+};
+
+/* A value read by rmsgpack_reader_next. Strings and binaries
+ * point into the reader's buffer and are not NUL terminated.
+ * Maps and arrays only carry their size; their contents are
+ * the tokens that follow (a key and a value for each pair). */
+struct rmsgpack_token
+{
+   union
+   {
+      uint64_t uint_;
+      int64_t int_;
+      int bool_;
+      struct
+      {
+         const char *buff;
+         uint32_t len;
+      } string;
+      struct
+      {
+         const uint8_t *buff;
+         uint32_t len;
+      } binary;
+      uint32_t len;
+   } val;
+   enum rmsgpack_token_type type;
+};
+
+/* Reads values straight from a buffer without copying them */
+struct rmsgpack_reader
+{
+   const uint8_t *data;
+   size_t len;
+   size_t pos;
+};
+
 int rmsgpack_write_array_header(intfstream_t *stream, uint32_t size);
 
 int rmsgpack_write_map_header(intfstream_t *stream, uint32_t size);
@@ -57,4 +104,33 @@ int rmsgpack_write_uint(intfstream_t *stream, uint64_t value);
 
 int rmsgpack_read(intfstream_t *stream, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+void rmsgpack_reader_init(struct rmsgpack_reader *reader,
+      const void *data, size_t len);
+
+/**
+ * rmsgpack_reader_next:
+ * @reader              : Reader to take the token from.
+ * @token               : Set to the next token.
+ *
+ * Reads one token and moves past it. Nothing is consumed
+ * unless the whole token is available.
+ *
+ * Returns: 0 if successful, 1 if the buffer ends before
+ * the token does, or -1 on invalid data.
+ **/
+int rmsgpack_reader_next(struct rmsgpack_reader *reader,
+      struct rmsgpack_token *token);
+
+/**
+ * rmsgpack_reader_skip:
+ * @reader              : Reader to skip a value of.
+ *
+ * Moves past the next value, including the contents
+ * of maps and arrays. Nothing is consumed unless the
+ * whole value is available.
+ *
+ * Returns: same as rmsgpack_reader_next.
+ **/
+int rmsgpack_reader_skip(struct rmsgpack_reader *reader);
+
 #endif
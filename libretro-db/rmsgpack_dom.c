@@ -452,6 +452,88 @@ int rmsgpack_dom_read(intfstream_t *fd, struct rmsgpack_dom_value *out)
    return rmsgpack_dom_read_with(fd, out, &s);
 }
 
+static char *rmsgpack_dom_strndup(const void *s, uint32_t len)
+{
+   char *buff = (char*)malloc((size_t)len + 1);
+   if (!buff)
+      return NULL;
+   memcpy(buff, s, len);
+   buff[len] = '\0';
+   return buff;
+}
+
+int rmsgpack_dom_read_buf(struct rmsgpack_reader *reader,
+      struct rmsgpack_dom_value *out)
+{
+   struct rmsgpack_dom_reader_state s;
+   struct rmsgpack_token token;
+   uint64_t pending = 1;
+   int rv           = 0;
+
+   s.i        = 0;
+   s.growable = false;
+   s.capacity = MAX_DEPTH;
+   s.stack    = alloca(MAX_DEPTH*sizeof(struct rmsgpack_dom_value *));
+   s.stack[0] = out;
+   out->type  = RDT_NULL;
+
+   /* Same state machine as rmsgpack_read, fed from the reader */
+   while (pending && rv >= 0)
+   {
+      char *buff;
+
+      if (rmsgpack_reader_next(reader, &token) != 0)
+      {
+         rv = -1;
+         break;
+      }
+
+      pending--;
+
+      switch (token.type)
+      {
+         case RMSGPACK_TOKEN_NIL:
+            rv = dom_read_nil(&s);
+            break;
+         case RMSGPACK_TOKEN_BOOL:
+            rv = dom_read_bool(token.val.bool_, &s);
+            break;
+         case RMSGPACK_TOKEN_UINT:
+            rv = dom_read_uint(token.val.uint_, &s);
+            break;
+         case RMSGPACK_TOKEN_INT:
+            rv = dom_read_int(token.val.int_, &s);
+            break;
+         case RMSGPACK_TOKEN_STRING:
+            if (!(buff = rmsgpack_dom_strndup(token.val.string.buff,
+                        token.val.string.len)))
+               rv = -1;
+            else
+               rv = dom_read_string(buff, token.val.string.len, &s);
+            break;
+         case RMSGPACK_TOKEN_BINARY:
+            if (!(buff = rmsgpack_dom_strndup(token.val.binary.buff,
+                        token.val.binary.len)))
+               rv = -1;
+            else
+               rv = dom_read_bin(buff, token.val.binary.len, &s);
+            break;
+         case RMSGPACK_TOKEN_MAP:
+            pending += (uint64_t)token.val.len * 2;
+            rv       = dom_read_map_start(token.val.len, &s);
+            break;
+         case RMSGPACK_TOKEN_ARRAY:
+            pending += token.val.len;
+            rv       = dom_read_array_start(token.val.len, &s);
+            break;
+      }
+   }
+
+   if (rv < 0)
+      rmsgpack_dom_value_free(out);
+   return rv;
+}
+
 int rmsgpack_dom_read_into(intfstream_t *fd, ...)
 {
    int rv;
@@ -28,6 +28,8 @@
 #include <retro_common_api.h>
 #include <streams/interface_stream.h>
 
+#include "rmsgpack.h"
+
 RETRO_BEGIN_DECLS
 
 enum rmsgpack_dom_type
@@ -93,6 +95,19 @@ struct rmsgpack_dom_value *rmsgpack_dom_value_map_value(
 
 int rmsgpack_dom_read(intfstream_t *stream, struct rmsgpack_dom_value *out);
 
+/**
+ * rmsgpack_dom_read_buf:
+ * @reader              : Reader positioned at the value.
+ * @out                 : Set to a copy of the value.
+ *
+ * Like rmsgpack_dom_read, but decodes the next value
+ * of @reader instead of reading a stream.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int rmsgpack_dom_read_buf(struct rmsgpack_reader *reader,
+      struct rmsgpack_dom_value *out);
+
 struct rmsgpack_dom_reader_state *rmsgpack_dom_reader_state_new(void);
 int rmsgpack_dom_read_with(intfstream_t *stream, struct rmsgpack_dom_value *out, struct rmsgpack_dom_reader_state *state);
 void rmsgpack_dom_reader_state_free(struct rmsgpack_dom_reader_state *state);
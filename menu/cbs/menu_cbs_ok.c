@@ -8732,6 +8732,7 @@ static int action_ok_core_delete(const char *path,
 static int action_ok_delete_playlist(const char *path,
       const char *label, unsigned type, size_t idx, size_t entry_idx)
 {
+   char cache_path[PATH_MAX_LENGTH];
    playlist_t       *playlist = playlist_get_cached();
    struct menu_state *menu_st = menu_state_get_ptr();
    menu_entry_t entry;
@@ -8742,6 +8743,8 @@ static int action_ok_delete_playlist(const char *path,
    path = playlist_get_conf_path(playlist);
 
    filestream_delete(path);
+   playlist_get_cache_path(path, cache_path, sizeof(cache_path));
+   filestream_delete(cache_path);
 
    if (menu_st->driver_ctx->environ_cb)
       menu_st->driver_ctx->environ_cb(MENU_ENVIRON_RESET_HORIZONTAL_LIST,
@@ -486,6 +486,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_runahead_toggle,       ME
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_preempt_toggle,        MENU_ENUM_SUBLABEL_INPUT_META_PREEMPT_TOGGLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_fps_toggle,            MENU_ENUM_SUBLABEL_INPUT_META_FPS_TOGGLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_statistics_toggle,     MENU_ENUM_SUBLABEL_INPUT_META_STATISTICS_TOGGLE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_perf_trace_dump,       MENU_ENUM_SUBLABEL_INPUT_META_PERF_TRACE_DUMP)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_ai_service,            MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE)
 
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_netplay_ping_toggle,   MENU_ENUM_SUBLABEL_INPUT_META_NETPLAY_PING_TOGGLE)
@@ -554,6 +555,9 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_respect_silent_mode,     MENU_
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_fastforward_mute,        MENU_ENUM_SUBLABEL_AUDIO_FASTFORWARD_MUTE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_rewind_mute,             MENU_ENUM_SUBLABEL_AUDIO_REWIND_MUTE)
+#ifdef HAVE_THREADS
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_processing_thread,       MENU_ENUM_SUBLABEL_AUDIO_PROCESSING_THREAD)
+#endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_fastforward_speedup,     MENU_ENUM_SUBLABEL_AUDIO_FASTFORWARD_SPEEDUP)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_camera_allow,                  MENU_ENUM_SUBLABEL_CAMERA_ALLOW)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_location_allow,                MENU_ENUM_SUBLABEL_LOCATION_ALLOW)
@@ -774,6 +778,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_runahead_mode,                 MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_runahead_mode,                 MENU_ENUM_SUBLABEL_RUNAHEAD_MODE_NO_SECOND_INSTANCE)
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_hide_warnings,       MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_secondary_thread,    MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREAD)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_frames,              MENU_ENUM_SUBLABEL_RUN_AHEAD_FRAMES)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_preempt_frames,                MENU_ENUM_SUBLABEL_PREEMPT_FRAMES)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_block_timeout,           MENU_ENUM_SUBLABEL_INPUT_BLOCK_TIMEOUT)
@@ -813,6 +818,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_settings,               MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_granularity,            MENU_ENUM_SUBLABEL_REWIND_GRANULARITY)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size,            MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size_step,       MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_deduplicate,            MENU_ENUM_SUBLABEL_REWIND_DEDUPLICATE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_libretro_log_level,            MENU_ENUM_SUBLABEL_LIBRETRO_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_frontend_log_level,            MENU_ENUM_SUBLABEL_FRONTEND_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_perfcnt_enable,                MENU_ENUM_SUBLABEL_PERFCNT_ENABLE)
@@ -826,6 +832,10 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_autosave_interval,             MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_max_keep,               MENU_ENUM_SUBLABEL_REPLAY_MAX_KEEP)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_checkpoint_interval,    MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_INTERVAL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_checkpoint_deserialize, MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_DESERIALIZE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_checkpoint_async,       MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_ASYNC)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_checkpoint_dictionary,  MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_DICTIONARY)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_checkpoint_calibrate,   MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_CALIBRATE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_checkpoint_memory_limit, MENU_ENUM_SUBLABEL_REPLAY_CHECKPOINT_MEMORY_LIMIT)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_remap_binds_enable,      MENU_ENUM_SUBLABEL_INPUT_REMAP_BINDS_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_remap_sort_by_controller_enable,      MENU_ENUM_SUBLABEL_INPUT_REMAP_SORT_BY_CONTROLLER_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_autodetect_enable,       MENU_ENUM_SUBLABEL_INPUT_AUTODETECT_ENABLE)
@@ -2458,6 +2468,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
             case RARCH_STATISTICS_TOGGLE:
                BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_meta_statistics_toggle);
                return 0;
+            case RARCH_PERF_TRACE_DUMP:
+               BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_meta_perf_trace_dump);
+               return 0;
             case RARCH_AI_SERVICE:
                BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_meta_ai_service);
                return 0;
@@ -4100,6 +4113,18 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REPLAY_CHECKPOINT_DESERIALIZE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_replay_checkpoint_deserialize);
             break;
+         case MENU_ENUM_LABEL_REPLAY_CHECKPOINT_ASYNC:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_replay_checkpoint_async);
+            break;
+         case MENU_ENUM_LABEL_REPLAY_CHECKPOINT_DICTIONARY:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_replay_checkpoint_dictionary);
+            break;
+         case MENU_ENUM_LABEL_REPLAY_CHECKPOINT_CALIBRATE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_replay_checkpoint_calibrate);
+            break;
+         case MENU_ENUM_LABEL_REPLAY_CHECKPOINT_MEMORY_LIMIT:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_replay_checkpoint_memory_limit);
+            break;
          case MENU_ENUM_LABEL_SAVESTATE_MAX_KEEP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_max_keep);
             break;
@@ -4145,6 +4170,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_buffer_size_step);
             break;
+         case MENU_ENUM_LABEL_REWIND_DEDUPLICATE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_deduplicate);
+            break;
          case MENU_ENUM_LABEL_CORE_CHEAT_OPTIONS:
 #ifdef HAVE_CHEATS
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_core_cheat_options);
@@ -4287,6 +4315,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_hide_warnings);
             break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_secondary_thread);
+            break;
          case MENU_ENUM_LABEL_RUN_AHEAD_FRAMES:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_frames);
             break;
@@ -4807,6 +4838,11 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_FASTFORWARD_SPEEDUP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_fastforward_speedup);
             break;
+#ifdef HAVE_THREADS
+         case MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_processing_thread);
+            break;
+#endif
          case MENU_ENUM_LABEL_AUDIO_LATENCY:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_latency);
             break;
@@ -8093,6 +8093,9 @@ unsigned menu_displaylist_build_list(
             {MENU_ENUM_LABEL_AUDIO_FASTFORWARD_SPEEDUP,       PARSE_ONLY_BOOL,  true },
 #if defined(HAVE_DSP_FILTER)
             {MENU_ENUM_LABEL_AUDIO_DSP_PLUGIN,                PARSE_ONLY_PATH,  true },
+#endif
+#if defined(HAVE_THREADS)
+            {MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD,         PARSE_ONLY_BOOL,  true },
 #endif
          };
 
@@ -10851,6 +10854,9 @@ unsigned menu_displaylist_build_list(
             bool runahead_supported       = true;
             bool runahead_enabled         = settings->bools.run_ahead_enabled;
             bool preempt_enabled          = settings->bools.preemptive_frames_enable;
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+            bool secondary_instance       = settings->bools.run_ahead_secondary_instance;
+#endif
 #endif
             menu_displaylist_build_info_selective_t build_list[] = {
                {MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,                PARSE_ONLY_BOOL, true },
@@ -10858,6 +10864,9 @@ unsigned menu_displaylist_build_list(
 #ifdef HAVE_RUNAHEAD
                {MENU_ENUM_LABEL_RUNAHEAD_MODE,                         PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,                      PARSE_ONLY_UINT, false },
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+               {MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD,            PARSE_ONLY_BOOL, false },
+#endif
                {MENU_ENUM_LABEL_PREEMPT_FRAMES,                        PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,               PARSE_ONLY_BOOL, false },
 #endif
@@ -10923,6 +10932,12 @@ unsigned menu_displaylist_build_list(
                         if (runahead_enabled)
                            build_list[i].checked = true;
                         break;
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+                     case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD:
+                        if (runahead_enabled && secondary_instance)
+                           build_list[i].checked = true;
+                        break;
+#endif
                      case MENU_ENUM_LABEL_PREEMPT_FRAMES:
                         if (preempt_enabled)
                            build_list[i].checked = true;
@@ -11273,6 +11288,16 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_REPLAY_MAX_KEEP,                    PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_REPLAY_CHECKPOINT_INTERVAL,         PARSE_ONLY_UINT, true},
                {MENU_ENUM_LABEL_REPLAY_CHECKPOINT_DESERIALIZE,      PARSE_ONLY_BOOL, true},
+#ifdef HAVE_THREADS
+               {MENU_ENUM_LABEL_REPLAY_CHECKPOINT_ASYNC,            PARSE_ONLY_BOOL, true},
+#endif
+#ifdef HAVE_ZSTD
+               {MENU_ENUM_LABEL_REPLAY_CHECKPOINT_DICTIONARY,       PARSE_ONLY_BOOL, true},
+#endif
+#ifdef HAVE_STATESTREAM
+               {MENU_ENUM_LABEL_REPLAY_CHECKPOINT_CALIBRATE,        PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_REPLAY_CHECKPOINT_MEMORY_LIMIT,     PARSE_ONLY_UINT, true},
+#endif
                {MENU_ENUM_LABEL_SORT_SCREENSHOTS_BY_CONTENT_ENABLE, PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SCREENSHOTS_IN_CONTENT_DIR_ENABLE,  PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,               PARSE_ONLY_BOOL, false},
@@ -11983,6 +12008,9 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_REWIND_GRANULARITY,      PARSE_ONLY_UINT, true },
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,      PARSE_ONLY_SIZE, true },
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP, PARSE_ONLY_UINT, true },
+#ifdef HAVE_STATESTREAM
+               {MENU_ENUM_LABEL_REWIND_DEDUPLICATE,      PARSE_ONLY_BOOL, true },
+#endif
                {MENU_ENUM_LABEL_AUDIO_REWIND_MUTE,       PARSE_ONLY_BOOL, true },
             };
 
@@ -22,7 +22,7 @@
 #include <array/rhmap.h>
 #include <formats/rjson.h>
 #include <formats/rjson_helpers.h>
-#include <retro_endianness.h>
+#include <encodings/crc32.h>
 #include <streams/file_stream.h>
 
 #include "menu_driver.h"
@@ -33,6 +33,7 @@
 #include "../playlist.h"
 #include "../verbosity.h"
 #include "../libretro-db/libretrodb.h"
+#include "../libretro-db/rmsgpack.h"
 #include "../tasks/tasks_internal.h"
 
 /* Explore */
@@ -448,25 +449,679 @@ static void explore_load_icons(explore_state_t *state)
    }
 }
 
+struct explore_source
+{
+   const struct playlist_entry *source;
+   uint32_t entry_index, meta_count;
+};
+
+struct explore_rdb
+{
+   libretrodb_t *handle;
+   struct explore_source *playlist_crcs;
+   struct explore_source *playlist_names;
+   size_t count;
+   uint32_t keys_hash[2];
+   char systemname[NAME_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+};
+
+/* Persisted explore index
+ *
+ * Building the explore view decodes every item of every
+ * database referenced by a playlist. The index file keeps,
+ * per database, the metadata of the items that matched
+ * playlist entries during the last build. A database section
+ * is reused as long as the database file and the set of
+ * playlist keys looked up in it are unchanged, so only
+ * databases touched by changed playlists are walked again. */
+#define EXPLORE_INDEX_MAGIC      0x58444958 /* "XIDX" */
+#define EXPLORE_INDEX_VERSION    2
+#define EXPLORE_INDEX_NULL       0xFFFFFFFF
+#define EXPLORE_INDEX_CHUNK_SIZE (64 * 1024)
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t num_rdbs;
+   uint32_t num_items;
+   uint32_t strings_size;
+} explore_index_header_t;
+
+typedef struct
+{
+   uint32_t path;
+   uint32_t rdb_size;
+   uint32_t rdb_crc;
+   uint32_t keys_hash[2];
+   uint32_t first_item;
+   uint32_t num_items;
+} explore_index_rdb_t;
+
+/* Boolean fields are stored as "0"/"1" so the index
+ * does not depend on the interface language */
+typedef struct
+{
+   uint32_t crc32;
+   uint32_t name;
+   uint32_t meta_count;
+   uint32_t original_title;
+   uint32_t fields[EXPLORE_CAT_COUNT];
+} explore_index_item_t;
+
+typedef struct
+{
+   /* Index loaded from disk */
+   char *data;
+   explore_index_header_t header;
+   const explore_index_rdb_t *rdbs;
+   const explore_index_item_t *items;
+   const char *strings;
+
+   /* Index assembled by the current build */
+   explore_index_rdb_t *out_rdbs;
+   explore_index_item_t *out_items;
+   char *out_strings;
+   uint32_t *out_string_map;
+   bool dirty;
+} explore_index_t;
+
+static void explore_index_hash_key(struct explore_rdb *rdb,
+      uint32_t key, bool is_name)
+{
+   /* Order independent, so the hash only depends on
+    * which keys the playlists look up */
+   uint32_t a = is_name ? ~key : key;
+   uint32_t b = a;
+
+   a ^= a >> 16; a *= 0x85ebca6b; a ^= a >> 13;
+   a *= 0xc2b2ae35; a ^= a >> 16;
+   b ^= b >> 16; b *= 0x7feb352d; b ^= b >> 15;
+   b *= 0x846ca68b; b ^= b >> 16;
+
+   rdb->keys_hash[0] += a;
+   rdb->keys_hash[1] += b;
+}
+
+/* Gets the size and the CRC32 of the whole database file,
+ * so any change to it invalidates its index section */
+static bool explore_index_rdb_fingerprint(const char *path,
+      uint32_t *size, uint32_t *crc)
+{
+   int64_t _len;
+   int64_t size_in;
+   uint8_t *buf = NULL;
+   RFILE *file  = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (     ((size_in = filestream_get_size(file)) < 0)
+         || (size_in > (int64_t)0xFFFFFFFF)
+         || !(buf = (uint8_t*)malloc(EXPLORE_INDEX_CHUNK_SIZE)))
+   {
+      filestream_close(file);
+      return false;
+   }
+
+   *size = 0;
+   *crc  = 0;
+   while ((_len = filestream_read(file, buf, EXPLORE_INDEX_CHUNK_SIZE)) > 0)
+   {
+      *crc   = encoding_crc32(*crc, buf, (size_t)_len);
+      *size += (uint32_t)_len;
+   }
+
+   free(buf);
+   filestream_close(file);
+   return (_len == 0) && ((int64_t)*size == size_in);
+}
+
+static void explore_index_load(explore_index_t *index, const char *path)
+{
+   size_t i, j;
+   uint64_t expected;
+   void *buf   = NULL;
+   int64_t len = 0;
+
+   if (!filestream_read_file(path, &buf, &len))
+      return;
+
+   if ((size_t)len < sizeof(index->header))
+      goto error;
+
+   memcpy(&index->header, buf, sizeof(index->header));
+
+   if (     (index->header.magic        != EXPLORE_INDEX_MAGIC)
+         || (index->header.version      != EXPLORE_INDEX_VERSION)
+         || (index->header.strings_size == 0))
+      goto error;
+
+   expected = sizeof(index->header)
+      + (uint64_t)index->header.num_rdbs  * sizeof(explore_index_rdb_t)
+      + (uint64_t)index->header.num_items * sizeof(explore_index_item_t)
+      + index->header.strings_size;
+   if (expected != (uint64_t)len)
+      goto error;
+
+   index->rdbs    = (const explore_index_rdb_t*)((const char*)buf
+         + sizeof(index->header));
+   index->items   = (const explore_index_item_t*)(index->rdbs
+         + index->header.num_rdbs);
+   index->strings = (const char*)(index->items + index->header.num_items);
+
+   if (index->strings[index->header.strings_size - 1] != '\0')
+      goto error;
+
+   for (i = 0; i < index->header.num_rdbs; i++)
+   {
+      const explore_index_rdb_t *rdb = &index->rdbs[i];
+      if (     (rdb->path       >= index->header.strings_size)
+            || (rdb->first_item >  index->header.num_items)
+            || (rdb->num_items  >  index->header.num_items - rdb->first_item))
+         goto error;
+   }
+
+   for (i = 0; i < index->header.num_items; i++)
+   {
+      const explore_index_item_t *item = &index->items[i];
+      uint32_t offsets[EXPLORE_CAT_COUNT + 2];
+
+      memcpy(offsets, item->fields, sizeof(item->fields));
+      offsets[EXPLORE_CAT_COUNT]     = item->name;
+      offsets[EXPLORE_CAT_COUNT + 1] = item->original_title;
+
+      for (j = 0; j < EXPLORE_CAT_COUNT + 2; j++)
+         if (     (offsets[j] != EXPLORE_INDEX_NULL)
+               && (offsets[j] >= index->header.strings_size))
+            goto error;
+   }
+
+   index->data = (char*)buf;
+   return;
+
+error:
+   RARCH_WARN("[Explore] Ignoring invalid index \"%s\".\n", path);
+   free(buf);
+   memset(&index->header, 0, sizeof(index->header));
+   index->rdbs    = NULL;
+   index->items   = NULL;
+   index->strings = NULL;
+}
+
+static const explore_index_rdb_t *explore_index_find(
+      const explore_index_t *index, const struct explore_rdb *rdb,
+      uint32_t rdb_size, uint32_t rdb_crc)
+{
+   size_t i;
+   for (i = 0; i < index->header.num_rdbs; i++)
+   {
+      const explore_index_rdb_t *sec = &index->rdbs[i];
+      if (     (sec->rdb_size     == rdb_size)
+            && (sec->rdb_crc      == rdb_crc)
+            && (sec->keys_hash[0] == rdb->keys_hash[0])
+            && (sec->keys_hash[1] == rdb->keys_hash[1])
+            && string_is_equal(index->strings + sec->path, rdb->path))
+         return sec;
+   }
+   return NULL;
+}
+
+static const char *explore_index_get_string(
+      const explore_index_t *index, uint32_t offset)
+{
+   if (offset == EXPLORE_INDEX_NULL)
+      return NULL;
+   return index->strings + offset;
+}
+
+static uint32_t explore_index_add_string(explore_index_t *index,
+      const char *s)
+{
+   size_t _len;
+   uint32_t offset;
+
+   if (!s)
+      return EXPLORE_INDEX_NULL;
+
+   /* Category values repeat a lot, store each one once */
+   if ((offset = RHMAP_GET_STR(index->out_string_map, s)))
+      return offset - 1;
+
+   _len   = strlen(s) + 1;
+   offset = (uint32_t)RBUF_LEN(index->out_strings);
+   RBUF_RESIZE(index->out_strings, offset + _len);
+   memcpy(index->out_strings + offset, s, _len);
+   RHMAP_SET_STR(index->out_string_map, s, offset + 1);
+   return offset;
+}
+
+static void explore_index_add_item(explore_index_t *index,
+      uint32_t crc32, const char *name, uint32_t meta_count,
+      const char *fields[EXPLORE_CAT_COUNT], const char *original_title)
+{
+   unsigned cat;
+   explore_index_item_t item;
+
+   item.crc32          = crc32;
+   item.name           = explore_index_add_string(index, name);
+   item.meta_count     = meta_count;
+   item.original_title = explore_index_add_string(index, original_title);
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      item.fields[cat] = explore_index_add_string(index, fields[cat]);
+
+   RBUF_PUSH(index->out_items, item);
+}
+
+static void explore_index_write(explore_index_t *index, const char *path)
+{
+   explore_index_header_t header;
+   RFILE *file = NULL;
+
+   /* The string table must end with a NUL even when empty */
+   explore_index_add_string(index, "");
+
+   header.magic        = EXPLORE_INDEX_MAGIC;
+   header.version      = EXPLORE_INDEX_VERSION;
+   header.num_rdbs     = (uint32_t)RBUF_LEN(index->out_rdbs);
+   header.num_items    = (uint32_t)RBUF_LEN(index->out_items);
+   header.strings_size = (uint32_t)RBUF_LEN(index->out_strings);
+
+   if (!(file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      RARCH_ERR("[Explore] Failed to write index \"%s\".\n", path);
+      return;
+   }
+
+   if (     (filestream_write(file, &header, sizeof(header))
+               != sizeof(header))
+         || (filestream_write(file, index->out_rdbs,
+               RBUF_SIZEOF(index->out_rdbs))
+               != (int64_t)RBUF_SIZEOF(index->out_rdbs))
+         || (filestream_write(file, index->out_items,
+               RBUF_SIZEOF(index->out_items))
+               != (int64_t)RBUF_SIZEOF(index->out_items))
+         || (filestream_write(file, index->out_strings,
+               RBUF_SIZEOF(index->out_strings))
+               != (int64_t)RBUF_SIZEOF(index->out_strings)))
+   {
+      RARCH_ERR("[Explore] Failed to write index \"%s\".\n", path);
+      filestream_close(file);
+      filestream_delete(path);
+      return;
+   }
+
+   filestream_close(file);
+}
+
+static void explore_index_free(explore_index_t *index)
+{
+   free(index->data);
+   RBUF_FREE(index->out_rdbs);
+   RBUF_FREE(index->out_items);
+   RBUF_FREE(index->out_strings);
+   RHMAP_FREE(index->out_string_map);
+}
+
+static struct explore_source *explore_find_source(
+      struct explore_rdb *rdb, uint32_t crc32, const char *name,
+      bool *by_name)
+{
+   *by_name = false;
+   if (crc32)
+   {
+      ptrdiff_t idx = RHMAP_IDX(rdb->playlist_crcs, crc32);
+      if (idx != -1)
+         return &rdb->playlist_crcs[idx];
+   }
+   if (name)
+   {
+      ptrdiff_t idx = RHMAP_IDX_STR(rdb->playlist_names, name);
+      if (idx != -1)
+      {
+         *by_name = true;
+         return &rdb->playlist_names[idx];
+      }
+   }
+   return NULL;
+}
+
+/* Fills in the explore entry of a playlist item from the
+ * metadata of its database item. Returns true once every
+ * playlist item looked up in the database has been found */
+static bool explore_add_rdb_item(explore_state_t *state,
+      struct explore_rdb *rdb, struct explore_source *src,
+      explore_string_t **cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf, uint32_t meta_count,
+      const char *const rdb_fields[EXPLORE_CAT_COUNT],
+      const char *original_title)
+{
+   unsigned l, cat;
+   explore_entry_t *e;
+   const char *fields[EXPLORE_CAT_COUNT];
+
+   if (src->entry_index != (uint32_t)-1 && src->meta_count >= meta_count)
+      return false;
+
+   if (src->entry_index == (uint32_t)-1)
+   {
+      src->entry_index = (uint32_t)RBUF_LEN(state->entries);
+      RBUF_RESIZE(state->entries, src->entry_index + 1);
+   }
+   e = &state->entries[src->entry_index];
+   src->meta_count = meta_count;
+   e->playlist_entry = src->source;
+   for (l = 0; l < EXPLORE_CAT_COUNT; l++)
+      e->by[l]       = NULL;
+   e->split          = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   e->original_title = NULL;
+#endif
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      fields[cat] = rdb_fields[cat];
+      if (explore_by_info[cat].is_boolean && fields[cat])
+         fields[cat] = msg_hash_to_str(fields[cat][0] == '1'
+               ? MENU_ENUM_LABEL_VALUE_YES : MENU_ENUM_LABEL_VALUE_NO);
+   }
+   fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      explore_add_unique_string(state,
+            cat_maps, e, cat,
+            fields[cat], split_buf);
+   }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   if (original_title && *original_title)
+   {
+      size_t _len       = strlen(original_title) + 1;
+      e->original_title = (char*)
+         ex_arena_alloc(&state->arena, _len);
+      memcpy(e->original_title, original_title, _len);
+   }
+#endif
+
+   if (RBUF_LEN(*split_buf))
+   {
+      size_t _len;
+
+      RBUF_PUSH(*split_buf, NULL); /* terminator */
+      _len       = RBUF_SIZEOF(*split_buf);
+      e->split   = (explore_string_t **)
+         ex_arena_alloc(&state->arena, _len);
+      memcpy(e->split, *split_buf, _len);
+      RBUF_CLEAR(*split_buf);
+   }
+
+   /* if all entries have found connections, we can leave early */
+   return (--rdb->count == 0);
+}
+
+static bool explore_token_is(const struct rmsgpack_token *key,
+      const char *s)
+{
+   size_t _len = strlen(s);
+   return key->val.string.len == _len
+      && memcmp(key->val.string.buff, s, _len) == 0;
+}
+
+/* Numbers and booleans of an item as an int */
+static int explore_token_int(const struct rmsgpack_token *val)
+{
+   switch (val->type)
+   {
+      case RMSGPACK_TOKEN_BOOL:
+         return val->val.bool_;
+      case RMSGPACK_TOKEN_UINT:
+      case RMSGPACK_TOKEN_INT:
+         return (int)val->val.int_;
+      default:
+         break;
+   }
+   return 0;
+}
+
+/* Appends a NUL terminated copy of a string value
+ * of the item to @scratch, returning its offset */
+static size_t explore_scratch_add(char **scratch,
+      const struct rmsgpack_token *val)
+{
+   size_t offset = RBUF_LEN(*scratch);
+   RBUF_RESIZE(*scratch, offset + val->val.string.len + 1);
+   memcpy(*scratch + offset, val->val.string.buff, val->val.string.len);
+   (*scratch)[offset + val->val.string.len] = '\0';
+   return offset;
+}
+
+/* Walks every item of the database, recording the ones
+ * matching a playlist entry into the new index. Items are
+ * read in place from the cursor's buffer, so the ones not
+ * in any playlist are skipped without allocating. */
+static void explore_walk_rdb(explore_state_t *state,
+      struct explore_rdb *rdb, explore_index_t *index,
+      explore_string_t **cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf)
+{
+   size_t _len;
+   const void *data;
+   char *scratch            = NULL; /* NUL terminated copies (RBUF) */
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+   bool more                =
+      (
+       libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
+       && libretrodb_cursor_read_item_buf(cur, &data, &_len) == 0);
+
+   for (; more; more = (libretrodb_cursor_read_item_buf(
+               cur, &data, &_len) == 0))
+   {
+      unsigned cat;
+      uint32_t k, pairs;
+      bool by_name;
+      struct rmsgpack_reader item;
+      struct rmsgpack_token token;
+      struct rmsgpack_token name_val;
+      struct rmsgpack_token title_val;
+      struct rmsgpack_token strings[EXPLORE_CAT_COUNT];
+      const char *fields[EXPLORE_CAT_COUNT];
+      size_t offsets[EXPLORE_CAT_COUNT];
+      char numeric_buf[EXPLORE_CAT_COUNT][16];
+      size_t title_offset                = 0;
+      uint32_t crc32                     = 0;
+      uint32_t meta_count                = 0;
+      char *name                         = NULL;
+      char *original_title               = NULL;
+      struct explore_source* src         = NULL;
+
+      rmsgpack_reader_init(&item, data, _len);
+      if (     rmsgpack_reader_next(&item, &token) != 0
+            || token.type != RMSGPACK_TOKEN_MAP)
+         continue;
+
+      name_val.type                      = RMSGPACK_TOKEN_NIL;
+      title_val.type                     = RMSGPACK_TOKEN_NIL;
+      for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+      {
+         fields[cat]                     = NULL;
+         strings[cat].type               = RMSGPACK_TOKEN_NIL;
+      }
+
+      pairs = token.val.len;
+      for (k = 0; k < pairs; k++)
+      {
+         struct rmsgpack_token key, val;
+         struct rmsgpack_reader value;
+
+         if (rmsgpack_reader_next(&item, &key) != 0)
+            break;
+         value = item;
+         if (     rmsgpack_reader_skip(&item) != 0
+               || rmsgpack_reader_next(&value, &val) != 0)
+            break;
+         if (key.type != RMSGPACK_TOKEN_STRING)
+            continue;
+
+         if (explore_token_is(&key, "crc"))
+         {
+            const uint8_t *crc;
+            crc32 = 0;
+            if (val.type != RMSGPACK_TOKEN_BINARY)
+               continue;
+            crc   = val.val.binary.buff;
+            /* Stored big endian, possibly unaligned */
+            switch (val.val.binary.len)
+            {
+               case 1:
+                  crc32 = crc[0];
+                  break;
+               case 2:
+                  crc32 = ((uint32_t)crc[0] << 8) | crc[1];
+                  break;
+               case 4:
+                  crc32 = ((uint32_t)crc[0] << 24) | ((uint32_t)crc[1] << 16)
+                        | ((uint32_t)crc[2] << 8)  |  (uint32_t)crc[3];
+                  break;
+               default:
+                  break;
+            }
+            continue;
+         }
+         else if (explore_token_is(&key, "name"))
+         {
+            if (val.type == RMSGPACK_TOKEN_STRING)
+               name_val = val;
+            continue;
+         }
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+         else if (explore_token_is(&key, "original_title"))
+         {
+            if (val.type == RMSGPACK_TOKEN_STRING)
+               title_val = val;
+            continue;
+         }
+#endif
+
+         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         {
+            if (!explore_token_is(&key, explore_by_info[cat].rdbkey))
+               continue;
+
+            meta_count++;
+            if (explore_by_info[cat].is_numeric)
+            {
+               if (val.type >= RMSGPACK_TOKEN_STRING)
+                  break;
+               snprintf(numeric_buf[cat],
+                     sizeof(numeric_buf[cat]),
+                     "%d", explore_token_int(&val));
+               fields[cat] = numeric_buf[cat];
+               break;
+            }
+            if (explore_by_info[cat].is_boolean)
+            {
+               if (val.type >= RMSGPACK_TOKEN_STRING)
+                  break;
+               fields[cat] = explore_token_int(&val) ? "1" : "0";
+               break;
+            }
+            if (val.type == RMSGPACK_TOKEN_STRING)
+               strings[cat] = val;
+            break;
+         }
+      }
+
+      /* The name is looked up by string */
+      RBUF_CLEAR(scratch);
+      if (name_val.type == RMSGPACK_TOKEN_STRING)
+         explore_scratch_add(&scratch, &name_val);
+
+      if (!(src = explore_find_source(rdb, crc32,
+                  RBUF_LEN(scratch) ? scratch : NULL, &by_name)))
+         continue;
+
+      /* Copy the strings of matching items only; the
+       * scratch buffer may move, so take pointers after */
+      if (title_val.type == RMSGPACK_TOKEN_STRING)
+         title_offset = explore_scratch_add(&scratch, &title_val);
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         if (strings[cat].type == RMSGPACK_TOKEN_STRING)
+            offsets[cat] = explore_scratch_add(&scratch, &strings[cat]);
+
+      if (name_val.type == RMSGPACK_TOKEN_STRING)
+         name           = scratch;
+      if (title_val.type == RMSGPACK_TOKEN_STRING)
+         original_title = scratch + title_offset;
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         if (strings[cat].type == RMSGPACK_TOKEN_STRING)
+            fields[cat] = scratch + offsets[cat];
+
+      /* The name is only needed to find the entry again
+       * when the CRC did not match */
+      explore_index_add_item(index, crc32, by_name ? name : NULL,
+            meta_count, fields, original_title);
+
+      if (explore_add_rdb_item(state, rdb, src, cat_maps, split_buf,
+               meta_count, fields, original_title))
+         break;
+   }
+
+   RBUF_FREE(scratch);
+   libretrodb_cursor_close(cur);
+   libretrodb_cursor_free(cur);
+}
+
+/* Replays the items recorded for an unchanged database,
+ * copying them into the new index as well */
+static void explore_replay_rdb(explore_state_t *state,
+      struct explore_rdb *rdb, explore_index_t *index,
+      const explore_index_rdb_t *sec,
+      explore_string_t **cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf)
+{
+   size_t k;
+   unsigned cat;
+
+   for (k = 0; k < sec->num_items; k++)
+   {
+      bool by_name;
+      const char *fields[EXPLORE_CAT_COUNT];
+      const explore_index_item_t *item = &index->items[sec->first_item + k];
+      const char *name                 = explore_index_get_string(
+            index, item->name);
+      const char *original_title       = explore_index_get_string(
+            index, item->original_title);
+      struct explore_source *src       = NULL;
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         fields[cat] = explore_index_get_string(index, item->fields[cat]);
+
+      explore_index_add_item(index, item->crc32, name,
+            item->meta_count, fields, original_title);
+
+      if (!(src = explore_find_source(rdb, item->crc32, name, &by_name)))
+         continue;
+
+      if (explore_add_rdb_item(state, rdb, src, cat_maps, split_buf,
+               item->meta_count, fields, original_title))
+         break;
+   }
+}
+
 explore_state_t *menu_explore_build_list(const char *directory_playlist,
       const char *directory_database)
 {
    unsigned i;
    char tmp[PATH_MAX_LENGTH];
-   struct explore_source
-   {
-      const struct playlist_entry *source;
-      uint32_t entry_index, meta_count;
-   };
-   struct explore_rdb
-   {
-      libretrodb_t *handle;
-      struct explore_source *playlist_crcs;
-      struct explore_source *playlist_names;
-      size_t count;
-      char systemname[NAME_MAX_LENGTH];
-   }
-   *rdbs                                          = NULL;
+   char index_path[PATH_MAX_LENGTH];
+   explore_index_t index;
+   struct explore_rdb *rdbs                       = NULL;
    int *rdb_indices                               = NULL;
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
@@ -480,6 +1135,11 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    state->label_explore_item_str    =
       msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
 
+   memset(&index, 0, sizeof(index));
+   fill_pathname_join_special(index_path, directory_playlist,
+         FILE_PATH_EXPLORE_INDEX, sizeof(index_path));
+   explore_index_load(&index, index_path);
+
    /* Index all playlists */
    for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
    {
@@ -559,6 +1219,8 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
             newrdb.count            = 0;
             newrdb.playlist_crcs    = NULL;
             newrdb.playlist_names   = NULL;
+            newrdb.keys_hash[0]     = 0;
+            newrdb.keys_hash[1]     = 0;
 
             _len                    = db_ext - db_name;
             if (_len >= sizeof(newrdb.systemname))
@@ -589,6 +1251,7 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
                continue;
             }
 
+            strlcpy(newrdb.path, tmp, sizeof(newrdb.path));
             RBUF_PUSH(rdbs, newrdb);
             rdb_num = (int)RBUF_LEN(rdbs);
             RHMAP_SET(rdb_indices, rdb_hash, rdb_num);
@@ -607,10 +1270,13 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
             if (entry_crc32)
             {
                RHMAP_SET(rdb->playlist_crcs, entry_crc32, src);
+               explore_index_hash_key(rdb, entry_crc32, false);
             }
             else
             {
                RHMAP_SET_STR(rdb->playlist_names, entry->label, src);
+               explore_index_hash_key(rdb,
+                     rhmap_hash_string(entry->label), true);
             }
          }
          used_entries++;
@@ -623,187 +1289,57 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    }
 
    /* Loop through all RDBs referenced in the playlists
-    * and load meta data strings */
+    * and load meta data strings, from the index where
+    * possible */
    for (i = 0; i != RBUF_LEN(rdbs); i++)
    {
-      struct rmsgpack_dom_value item;
-      struct explore_rdb* rdb  = &rdbs[i];
-      libretrodb_cursor_t *cur = libretrodb_cursor_new();
-      bool more                =
-         (
-          libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
-          && libretrodb_cursor_read_item(cur, &item) == 0);
-
-      for (; more; more = (rmsgpack_dom_value_free(&item),
-               libretrodb_cursor_read_item(cur, &item) == 0))
+      explore_index_rdb_t sec;
+      const explore_index_rdb_t *cached = NULL;
+      struct explore_rdb* rdb           = &rdbs[i];
+      bool has_fingerprint              =
+         explore_index_rdb_fingerprint(rdb->path,
+               &sec.rdb_size, &sec.rdb_crc);
+
+      if (has_fingerprint)
+         cached = explore_index_find(&index, rdb,
+               sec.rdb_size, sec.rdb_crc);
+
+      sec.first_item = (uint32_t)RBUF_LEN(index.out_items);
+
+      if (cached)
+         explore_replay_rdb(state, rdb, &index, cached,
+               cat_maps, &split_buf);
+      else
       {
-         unsigned k, l, cat;
-         explore_entry_t* e;
-         const char *fields[EXPLORE_CAT_COUNT];
-         char numeric_buf[EXPLORE_CAT_COUNT][16];
-         uint32_t crc32                     = 0;
-         uint32_t meta_count                = 0;
-         char *name                         = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         char *original_title               = NULL;
-#endif
-         struct explore_source* src         = NULL;
-
-         if (item.type != RDT_MAP)
-            continue;
-
-         for (k = 0; k < EXPLORE_CAT_COUNT; k++)
-            fields[k]                       = NULL;
-
-         for (k = 0; k < item.val.map.len; k++)
-         {
-            const char *key_str             = NULL;
-            struct rmsgpack_dom_value *key  = &item.val.map.items[k].key;
-            struct rmsgpack_dom_value *val  = &item.val.map.items[k].value;
-            if (!key || !val || key->type != RDT_STRING)
-               continue;
-
-            key_str                         = key->val.string.buff;
-            if (string_is_equal(key_str, "crc"))
-            {
-               switch (val->val.binary.len)
-               {
-                  case 1:
-                     crc32 = *(uint8_t*)val->val.binary.buff;
-                     break;
-                  case 2:
-                     crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
-                     break;
-                  case 4:
-                     crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
-                     break;
-                  default:
-                     crc32 = 0;
-                     break;
-               }
-
-               continue;
-            }
-            else if (string_is_equal(key_str, "name"))
-            {
-               name = val->val.string.buff;
-               continue;
-            }
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-            else if (string_is_equal(key_str, "original_title"))
-            {
-               original_title = val->val.string.buff;
-               continue;
-            }
-#endif
-
-            for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-            {
-               if (!string_is_equal(key_str, explore_by_info[cat].rdbkey))
-                  continue;
-
-               meta_count++;
-               if (explore_by_info[cat].is_numeric)
-               {
-                  if (val->type >= RDT_STRING)
-                     break;
-                  snprintf(numeric_buf[cat],
-                        sizeof(numeric_buf[cat]),
-                        "%d", (int)val->val.int_);
-                  fields[cat] = numeric_buf[cat];
-                  break;
-               }
-               if (explore_by_info[cat].is_boolean)
-               {
-                  if (val->type >= RDT_STRING)
-                     break;
-                  fields[cat] = msg_hash_to_str(val->val.int_ ?
-                        MENU_ENUM_LABEL_VALUE_YES : MENU_ENUM_LABEL_VALUE_NO);
-                  break;
-               }
-               if (val->type != RDT_STRING)
-                  break;
-               fields[cat] = val->val.string.buff;
-               break;
-            }
-         }
-
-         if (crc32)
-         {
-            ptrdiff_t idx = RHMAP_IDX(rdb->playlist_crcs, crc32);
-            src = (idx != -1 ? &rdb->playlist_crcs[idx] : NULL);
-         }
-         if (!src && name)
-         {
-            ptrdiff_t idx = RHMAP_IDX_STR(rdb->playlist_names, name);
-            src = (idx != -1 ? &rdb->playlist_names[idx] : NULL);
-         }
-         if (!src)
-            continue;
-         if (src->entry_index != (uint32_t)-1 && src->meta_count >= meta_count)
-            continue;
-
-         if (src->entry_index == (uint32_t)-1)
-         {
-            src->entry_index = (uint32_t)RBUF_LEN(state->entries);
-            RBUF_RESIZE(state->entries, src->entry_index + 1);
-         }
-         e = &state->entries[src->entry_index];
-         src->meta_count = meta_count;
-         e->playlist_entry = src->source;
-         for (l = 0; l < EXPLORE_CAT_COUNT; l++)
-            e->by[l]       = NULL;
-         e->split          = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         e->original_title = NULL;
-#endif
-
-         fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
-
-         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-         {
-            explore_add_unique_string(state,
-                  cat_maps, e, cat,
-                  fields[cat], &split_buf);
-         }
-
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         if (original_title && *original_title)
-         {
-            size_t _len       = strlen(original_title) + 1;
-            e->original_title = (char*)
-               ex_arena_alloc(&state->arena, _len);
-            memcpy(e->original_title, original_title, _len);
-         }
-#endif
-
-         if (RBUF_LEN(split_buf))
-         {
-            size_t _len;
-
-            RBUF_PUSH(split_buf, NULL); /* terminator */
-            _len       = RBUF_SIZEOF(split_buf);
-            e->split   = (explore_string_t **)
-               ex_arena_alloc(&state->arena, _len);
-            memcpy(e->split, split_buf, _len);
-            RBUF_CLEAR(split_buf);
-         }
+         explore_walk_rdb(state, rdb, &index, cat_maps, &split_buf);
+         index.dirty = true;
+      }
 
-         /* if all entries have found connections, we can leave early */
-         if (--rdb->count == 0)
-         {
-            rmsgpack_dom_value_free(&item);
-            break;
-         }
+      if (has_fingerprint)
+      {
+         sec.path         = explore_index_add_string(&index, rdb->path);
+         sec.keys_hash[0] = rdb->keys_hash[0];
+         sec.keys_hash[1] = rdb->keys_hash[1];
+         sec.num_items    = (uint32_t)RBUF_LEN(index.out_items)
+            - sec.first_item;
+         RBUF_PUSH(index.out_rdbs, sec);
       }
+      else
+         RBUF_RESIZE(index.out_items, sec.first_item);
 
-      libretrodb_cursor_close(cur);
-      libretrodb_cursor_free(cur);
       libretrodb_close(rdb->handle);
       libretrodb_free(rdb->handle);
       RHMAP_FREE(rdb->playlist_crcs);
       RHMAP_FREE(rdb->playlist_names);
    }
+
+   /* Databases that are no longer referenced drop out
+    * of the index as well */
+   if (     index.dirty
+         || (index.header.num_rdbs != RBUF_LEN(index.out_rdbs)))
+      explore_index_write(&index, index_path);
+   explore_index_free(&index);
+
    RBUF_FREE(split_buf);
    RHMAP_FREE(rdb_indices);
    RBUF_FREE(rdbs);
@@ -12005,6 +12005,69 @@ static bool setting_append_list(
                   general_write_handler,
                   general_read_handler,
                   SD_FLAG_NONE);
+
+#ifdef HAVE_THREADS
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.replay_checkpoint_async,
+                  MENU_ENUM_LABEL_REPLAY_CHECKPOINT_ASYNC,
+                  MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_ASYNC,
+                  DEFAULT_REPLAY_CHECKPOINT_ASYNC,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
+#ifdef HAVE_ZSTD
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.replay_checkpoint_dictionary,
+                  MENU_ENUM_LABEL_REPLAY_CHECKPOINT_DICTIONARY,
+                  MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_DICTIONARY,
+                  DEFAULT_REPLAY_CHECKPOINT_DICTIONARY,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
+#ifdef HAVE_STATESTREAM
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.replay_checkpoint_calibrate,
+                  MENU_ENUM_LABEL_REPLAY_CHECKPOINT_CALIBRATE,
+                  MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_CALIBRATE,
+                  DEFAULT_REPLAY_CHECKPOINT_CALIBRATE,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.replay_checkpoint_memory_limit,
+                  MENU_ENUM_LABEL_REPLAY_CHECKPOINT_MEMORY_LIMIT,
+                  MENU_ENUM_LABEL_VALUE_REPLAY_CHECKPOINT_MEMORY_LIMIT,
+                  DEFAULT_REPLAY_CHECKPOINT_MEMORY_LIMIT,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 4096, 16, true, true);
+#endif
 #endif
 
             CONFIG_BOOL(
@@ -12400,6 +12463,24 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+#ifdef HAVE_STATESTREAM
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_deduplicate,
+                  MENU_ENUM_LABEL_REWIND_DEDUPLICATE,
+                  MENU_ENUM_LABEL_VALUE_REWIND_DEDUPLICATE,
+                  DEFAULT_REWIND_DEDUPLICATE,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REWIND_REINIT);
+#endif
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -14979,6 +15060,24 @@ static bool setting_append_list(
                SD_FLAG_NONE
                );
 
+#ifdef HAVE_THREADS
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_processing_thread,
+               MENU_ENUM_LABEL_AUDIO_PROCESSING_THREAD,
+               MENU_ENUM_LABEL_VALUE_AUDIO_PROCESSING_THREAD,
+               DEFAULT_AUDIO_PROCESSING_THREAD,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+#endif
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.audio_volume,
@@ -16959,6 +17058,24 @@ static bool setting_append_list(
          (*list)[list_info->index - 1].change_handler = runahead_change_handler;
          menu_settings_list_current_add_range(list, list_info, 1, MAX_RUNAHEAD_FRAMES, 1, true, true);
 
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_secondary_thread,
+               MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREAD,
+               DEFAULT_RUN_AHEAD_SECONDARY_THREAD,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+#endif
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.run_ahead_hide_warnings,
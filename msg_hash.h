@@ -431,6 +431,8 @@ enum msg_hash_enums
    MSG_MOVIE_PLAYBACK_ENDED,
    MSG_TAKING_SCREENSHOT,
    MSG_SCREENSHOT_SAVED,
+   MSG_PERF_TRACE_SAVED,
+   MSG_PERF_TRACE_EMPTY,
    MSG_ACHIEVEMENT_UNLOCKED,
    MSG_RARE_ACHIEVEMENT_UNLOCKED,
    MSG_LEADERBOARD_STARTED,
@@ -1177,6 +1179,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_INPUT_META_PREEMPT_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_FPS_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_STATISTICS_TOGGLE,
+   MENU_ENUM_LABEL_VALUE_INPUT_META_PERF_TRACE_DUMP,
    MENU_ENUM_LABEL_VALUE_INPUT_META_AI_SERVICE,
 
    MENU_ENUM_LABEL_VALUE_INPUT_META_NETPLAY_PING_TOGGLE,
@@ -1280,6 +1283,7 @@ enum msg_hash_enums
    MENU_ENUM_SUBLABEL_INPUT_META_PREEMPT_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_FPS_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_STATISTICS_TOGGLE,
+   MENU_ENUM_SUBLABEL_INPUT_META_PERF_TRACE_DUMP,
    MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE,
 
    MENU_ENUM_SUBLABEL_INPUT_META_NETPLAY_PING_TOGGLE,
@@ -2277,6 +2281,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_FASTFORWARD_MUTE),
    MENU_LABEL(AUDIO_FASTFORWARD_SPEEDUP),
    MENU_LABEL(AUDIO_REWIND_MUTE),
+   MENU_LABEL(AUDIO_PROCESSING_THREAD),
    MENU_LABEL(AUDIO_SYNC),
    MENU_LBL_H(AUDIO_VOLUME),
    MENU_LABEL(AUDIO_MIXER_VOLUME),
@@ -2356,6 +2361,7 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_DEDUPLICATE),
 
    MENU_LABEL(CHEAT_APPLY_CHANGES),
    MENU_LABEL(CHEAT_IDX),
@@ -2538,6 +2544,10 @@ enum msg_hash_enums
    MENU_LBL_H(AUTOSAVE_INTERVAL),
    MENU_LBL_H(REPLAY_CHECKPOINT_INTERVAL),
    MENU_LBL_H(REPLAY_CHECKPOINT_DESERIALIZE),
+   MENU_LBL_H(REPLAY_CHECKPOINT_ASYNC),
+   MENU_LBL_H(REPLAY_CHECKPOINT_DICTIONARY),
+   MENU_LBL_H(REPLAY_CHECKPOINT_CALIBRATE),
+   MENU_LBL_H(REPLAY_CHECKPOINT_MEMORY_LIMIT),
    MENU_LBL_H(CONFIG_SAVE_ON_EXIT),
    MENU_LABEL(REMAP_SAVE_ON_EXIT),
    MENU_LABEL(CONFIGURATION_LIST),
@@ -2733,6 +2743,7 @@ enum msg_hash_enums
    MENU_LABEL(SLOWMOTION_RATIO),
    MENU_LABEL(RUN_AHEAD_UNSUPPORTED),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
+   MENU_LABEL(RUN_AHEAD_SECONDARY_THREAD),
    MENU_LABEL(RUN_AHEAD_FRAMES),
    MENU_LABEL(PREEMPT_FRAMES),
    MENU_LABEL(INPUT_BLOCK_TIMEOUT),
@@ -908,7 +908,15 @@ static int select_compression(netplay_t *netplay, uint32_t compression)
 
    compression &= NETPLAY_COMPRESSION_SUPPORTED;
 
-   if (compression & NETPLAY_COMPRESSION_ZLIB)
+   if (compression & NETPLAY_COMPRESSION_ZSTD)
+   {
+      ctrans = &netplay->compress_zstd;
+      if (!ctrans->compression_backend)
+         ctrans->compression_backend =
+            trans_stream_get_zstd_compress_backend();
+      ret = NETPLAY_COMPRESSION_ZSTD;
+   }
+   else if (compression & NETPLAY_COMPRESSION_ZLIB)
    {
       ctrans = &netplay->compress_zlib;
       if (!ctrans->compression_backend)
@@ -943,6 +951,114 @@ static int select_compression(netplay_t *netplay, uint32_t compression)
    return ret;
 }
 
+static bool netplay_delta_reserve(uint8_t **buf, size_t *cap, size_t len)
+{
+   uint8_t *tmp;
+   if (*cap >= len)
+      return true;
+   if (!(tmp = (uint8_t*)realloc(*buf, len)))
+      return false;
+   *buf = tmp;
+   *cap = len;
+   return true;
+}
+
+/* A delta is a list of (offset, size, bytes) runs, each run covering
+ * consecutive changed blocks. At worst every other block changed. */
+static size_t netplay_state_delta_bound(size_t len)
+{
+   size_t blocks = (len + NETPLAY_DELTA_BLOCK_SIZE - 1)
+      / NETPLAY_DELTA_BLOCK_SIZE;
+   return len + 2 * sizeof(uint32_t) * (blocks / 2 + 1);
+}
+
+/**
+ * netplay_build_state_delta
+ *
+ * Writes the blocks of state that differ from delta_base into
+ * delta_buffer, and the size of that into delta_len.
+ *
+ * Returns: false if there is no base of the same size to take
+ * the delta against.
+ */
+static bool netplay_build_state_delta(netplay_t *netplay,
+      const uint8_t *state, size_t len, size_t *delta_len)
+{
+   size_t i;
+   uint8_t *out;
+   const uint8_t *base = netplay->delta_base;
+
+   if (!len || netplay->delta_base_size != len)
+      return false;
+   if (!netplay_delta_reserve(&netplay->delta_buffer,
+         &netplay->delta_buffer_cap, netplay_state_delta_bound(len)))
+      return false;
+
+   out = netplay->delta_buffer;
+   for (i = 0; i < len; )
+   {
+      uint32_t run[2];
+      size_t start;
+      size_t _len = MIN(NETPLAY_DELTA_BLOCK_SIZE, len - i);
+      if (!memcmp(state + i, base + i, _len))
+      {
+         i += _len;
+         continue;
+      }
+      start = i;
+      do
+      {
+         i   += _len;
+         _len = MIN(NETPLAY_DELTA_BLOCK_SIZE, len - i);
+      } while (i < len && memcmp(state + i, base + i, _len));
+
+      run[0] = htonl((uint32_t)start);
+      run[1] = htonl((uint32_t)(i - start));
+      memcpy(out, run, sizeof(run));
+      memcpy(out + sizeof(run), state + start, i - start);
+      out += sizeof(run) + (i - start);
+   }
+
+   *delta_len = (size_t)(out - netplay->delta_buffer);
+   return true;
+}
+
+/**
+ * netplay_apply_state_delta
+ *
+ * Rebuilds a state from delta_base and a delta made by
+ * netplay_build_state_delta.
+ *
+ * Returns: false if the delta is malformed or doesn't fit the base.
+ */
+static bool netplay_apply_state_delta(netplay_t *netplay,
+      uint8_t *state, size_t len, const uint8_t *delta, size_t delta_len)
+{
+   if (netplay->delta_base_size != len)
+      return false;
+
+   memcpy(state, netplay->delta_base, len);
+   while (delta_len)
+   {
+      uint32_t run[2];
+      if (delta_len < sizeof(run))
+         return false;
+      memcpy(run, delta, sizeof(run));
+      run[0]     = ntohl(run[0]);
+      run[1]     = ntohl(run[1]);
+      delta     += sizeof(run);
+      delta_len -= sizeof(run);
+      if (     run[1] > delta_len
+            || run[0] > len
+            || run[1] > len - run[0])
+         return false;
+      memcpy(state + run[0], delta, run[1]);
+      delta     += run[1];
+      delta_len -= run[1];
+   }
+   return true;
+}
+
 /**
  * netplay_handshake_init
  *
@@ -1117,6 +1233,14 @@ bool netplay_handshake_init(netplay_t *netplay,
       return false;
    connection->compression_supported = (uint32_t)compression;
 
+   if (ntohl(header[2]) & NETPLAY_COMPRESSION_DELTA)
+   {
+      connection->flags |= NETPLAY_CONN_FLAG_DELTA_STATES;
+      /* Whatever we were sent before came from another session */
+      if (!netplay->is_server)
+         netplay->delta_base_size = 0;
+   }
+
    if (!netplay->is_server)
    {
       /* If a password is demanded, ask for it */
@@ -6005,6 +6129,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
          break;
 
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
          {
             uint32_t i;
             uint32_t frame;
@@ -6012,7 +6137,9 @@ static bool netplay_get_cmd(netplay_t *netplay,
             size_t   load_ptr;
             uint32_t load_frame_count;
             uint32_t rd, wn;
+            uint8_t *state;
             struct compression_transcoder *ctrans = NULL;
+            bool is_delta = (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
             NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
 
             if (netplay->is_server)
@@ -6021,6 +6148,12 @@ static bool netplay_get_cmd(netplay_t *netplay,
                return netplay_cmd_nak(netplay, connection);
             }
 
+            if (is_delta && !(connection->flags & NETPLAY_CONN_FLAG_DELTA_STATES))
+            {
+               RARCH_ERR("[Netplay] Unexpected NETPLAY_CMD_LOAD_SAVESTATE_DELTA.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
             if (cmd_size < sizeof(frame) + sizeof(state_size))
             {
                RARCH_ERR("[Netplay] Received invalid payload size for NETPLAY_CMD_LOAD_SAVESTATE.\n");
@@ -6096,6 +6229,9 @@ static bool netplay_get_cmd(netplay_t *netplay,
 
             switch (connection->compression_supported)
             {
+               case NETPLAY_COMPRESSION_ZSTD:
+                  ctrans = &netplay->compress_zstd;
+                  break;
                case NETPLAY_COMPRESSION_ZLIB:
                   ctrans = &netplay->compress_zlib;
                   break;
@@ -6116,16 +6252,51 @@ static bool netplay_get_cmd(netplay_t *netplay,
                }
             }
 
+            /* A delta is unpacked on its own, then laid over the base */
+            state = (uint8_t*)netplay->buffer[load_ptr].state;
+            if (is_delta)
+            {
+               if (!netplay_delta_reserve(&netplay->delta_buffer,
+                     &netplay->delta_buffer_cap,
+                     netplay_state_delta_bound(state_size)))
+                  return false;
+               state = netplay->delta_buffer;
+            }
+
             ctrans->decompression_backend->set_in(
                ctrans->decompression_stream,
                netplay->zbuffer, state_size_raw);
             ctrans->decompression_backend->set_out(
                ctrans->decompression_stream,
-               (uint8_t*)netplay->buffer[load_ptr].state, state_size);
+               state, is_delta
+               ? (uint32_t)netplay->delta_buffer_cap : state_size);
             ctrans->decompression_backend->trans(
                ctrans->decompression_stream,
                true, &rd, &wn, NULL);
 
+            if (is_delta)
+            {
+               if (!netplay_apply_state_delta(netplay,
+                     (uint8_t*)netplay->buffer[load_ptr].state, state_size,
+                     netplay->delta_buffer, wn))
+               {
+                  RARCH_ERR("[Netplay] Netplay state delta doesn't match the last state loaded.\n");
+                  return netplay_cmd_nak(netplay, connection);
+               }
+            }
+
+            /* Keep it for the next delta */
+            if (connection->flags & NETPLAY_CONN_FLAG_DELTA_STATES)
+            {
+               /* The server counts on us having it */
+               if (!netplay_delta_reserve(&netplay->delta_base,
+                     &netplay->delta_base_cap, state_size))
+                  return false;
+               memcpy(netplay->delta_base,
+                     netplay->buffer[load_ptr].state, state_size);
+               netplay->delta_base_size = state_size;
+            }
+
             if (memcmp(netplay->buffer[load_ptr].state, "NETPLAY", 7) != 0)
             {
                if (state_size != netplay->coremem_size)
@@ -7280,6 +7451,8 @@ static void netplay_free(netplay_t *netplay)
    }
 
    free(netplay->zbuffer);
+   free(netplay->delta_base);
+   free(netplay->delta_buffer);
 
    if (netplay->compress_nil.compression_stream)
       netplay->compress_nil.compression_backend->stream_free(
@@ -7293,6 +7466,12 @@ static void netplay_free(netplay_t *netplay)
    if (netplay->compress_zlib.decompression_stream)
       netplay->compress_zlib.decompression_backend->stream_free(
          netplay->compress_zlib.decompression_stream);
+   if (netplay->compress_zstd.compression_stream)
+      netplay->compress_zstd.compression_backend->stream_free(
+         netplay->compress_zstd.compression_stream);
+   if (netplay->compress_zstd.decompression_stream)
+      netplay->compress_zstd.decompression_backend->stream_free(
+         netplay->compress_zstd.decompression_stream);
 
    free(netplay);
 }
@@ -7439,67 +7618,101 @@ failure:
  * @serial_info          : the savestate being loaded
  * @cx                   : compression type
  * @z                    : compression backend to use
+ * @delta_len            : size of the delta in delta_buffer, if there is one
  *
  * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * scheme. Peers known to hold delta_base are sent the delta instead.
  */
 static void netplay_send_savestate(netplay_t *netplay,
    retro_ctx_serialize_info_t *serial_info, uint32_t cx,
-   struct compression_transcoder *z, bool is_legacy_data)
+   struct compression_transcoder *z, bool is_legacy_data,
+   const size_t *delta_len)
 {
    uint32_t header[4];
    uint32_t rd, wn;
    size_t i;
+   int pass;
    bool has_legacy_connection = false;
    NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
 
-   /* Compress it */
-   z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
-   z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
-   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
-         &wn, NULL))
+   if (is_legacy_data)
+      delta_len = NULL;
+
+   /* Full states first, then deltas; each is compressed only if
+    * some peer needs it */
+   for (pass = 0; pass < (delta_len ? 2 : 1); pass++)
    {
-      /* Catastrophe! */
-      for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
-   }
+      bool send_delta = (pass == 1);
+      bool compressed = false;
 
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
-   header[2] = htonl(netplay->run_frame_count);
-   header[3] = htonl(serial_info->size);
+      for (i = 0; i < netplay->connections_size; i++)
+      {
+         struct netplay_connection* connection = &netplay->connections[i];
+         bool can_send;
 
-   for (i = 0; i < netplay->connections_size; i++)
-   {
-      struct netplay_connection* connection = &netplay->connections[i];
-      bool can_send;
+         /* if is_legacy_data is false, only send to peers on protocol 7 or higher */
+         REQUIRE_PROTOCOL_VERSION(connection, 7)
+            can_send = !is_legacy_data;
+         else
+            can_send = is_legacy_data;
 
-      /* if is_legacy_data is false, only send to peers on protocol 7 or higher */
-      REQUIRE_PROTOCOL_VERSION(connection, 7)
-         can_send = !is_legacy_data;
-      else
-         can_send = is_legacy_data;
+         if (!can_send)
+         {
+            has_legacy_connection = true;
+            continue;
+         }
 
-      if (can_send)
-      {
          if ( (!(connection->flags & NETPLAY_CONN_FLAG_ACTIVE))
-            ||  (connection->mode < NETPLAY_CONNECTION_CONNECTED)
-            ||  (connection->compression_supported != cx))
+            ||  (connection->mode < NETPLAY_CONNECTION_CONNECTED))
+         {
+            /* It won't see this state, so delta_base will be news to it */
+            connection->flags &= ~NETPLAY_CONN_FLAG_DELTA_BASE;
+            continue;
+         }
+
+         if (     (connection->compression_supported != cx)
+               || (send_delta != (delta_len
+                  && (connection->flags & NETPLAY_CONN_FLAG_DELTA_BASE))))
             continue;
 
+         if (!compressed)
+         {
+            /* Compress it */
+            if (send_delta)
+               z->compression_backend->set_in(z->compression_stream,
+                  netplay->delta_buffer, (uint32_t)*delta_len);
+            else
+               z->compression_backend->set_in(z->compression_stream,
+                  (const uint8_t*)serial_info->data_const,
+                  (uint32_t)serial_info->size);
+            z->compression_backend->set_out(z->compression_stream,
+               netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+            if (!z->compression_backend->trans(z->compression_stream, true,
+                  &rd, &wn, NULL))
+            {
+               /* Catastrophe! */
+               for (i = 0; i < netplay->connections_size; i++)
+                  netplay_hangup(netplay, &netplay->connections[i]);
+               return;
+            }
+
+            header[0] = htonl(send_delta
+                  ? NETPLAY_CMD_LOAD_SAVESTATE_DELTA
+                  : NETPLAY_CMD_LOAD_SAVESTATE);
+            header[1] = htonl(wn + 2*sizeof(uint32_t));
+            header[2] = htonl(netplay->run_frame_count);
+            header[3] = htonl(serial_info->size);
+            compressed = true;
+         }
+
          if (  !netplay_send(&connection->send_packet_buffer,
                  connection->fd, header, sizeof(header))
             || !netplay_send(&connection->send_packet_buffer,
                  connection->fd, netplay->zbuffer, wn))
             netplay_hangup(netplay, connection);
-      }
-      else
-      {
-         has_legacy_connection = true;
+         else if (!is_legacy_data && netplay->is_server
+               && (connection->flags & NETPLAY_CONN_FLAG_DELTA_STATES))
+            connection->flags |= NETPLAY_CONN_FLAG_DELTA_BASE;
       }
    }
 
@@ -7515,7 +7728,7 @@ static void netplay_send_savestate(netplay_t *netplay,
          serial_info->data_const = input;
          serial_info->size = netplay->coremem_size;
 
-         netplay_send_savestate(netplay, serial_info, cx, z, true);
+         netplay_send_savestate(netplay, serial_info, cx, z, true, NULL);
       }
    }
 }
@@ -7830,13 +8043,72 @@ void netplay_load_savestate(netplay_t *netplay,
    /* Don't send it if we're expected to be desynced. */
    if (!netplay->desync)
    {
+      size_t i;
+      size_t delta_len             = 0;
+      bool has_delta               = false;
+      bool keep_base               = false;
+      /* Sending to legacy peers may point serial_info at a part of it */
+      retro_ctx_serialize_info_t full_info = *serial_info;
+
+      /* Only the server sends deltas, against the last state it sent */
+      if (netplay->is_server)
+      {
+         for (i = 0; i < netplay->connections_size; i++)
+         {
+            uint8_t flags = netplay->connections[i].flags;
+            if (flags & NETPLAY_CONN_FLAG_DELTA_STATES)
+               keep_base = true;
+            if (flags & NETPLAY_CONN_FLAG_DELTA_BASE)
+               has_delta = true;
+         }
+         if (has_delta)
+            has_delta = netplay_build_state_delta(netplay,
+                  (const uint8_t*)full_info.data_const, full_info.size,
+                  &delta_len);
+         if (!has_delta)
+         {
+            /* Nobody can take a delta against the old base now */
+            for (i = 0; i < netplay->connections_size; i++)
+               netplay->connections[i].flags &= ~NETPLAY_CONN_FLAG_DELTA_BASE;
+         }
+      }
+
       /* Send this to every peer. */
       if (netplay->compress_nil.compression_backend)
+      {
+         *serial_info = full_info;
          netplay_send_savestate(netplay, serial_info, 0,
-            &netplay->compress_nil, false);
+            &netplay->compress_nil, false, has_delta ? &delta_len : NULL);
+      }
       if (netplay->compress_zlib.compression_backend)
+      {
+         *serial_info = full_info;
          netplay_send_savestate(netplay, serial_info, NETPLAY_COMPRESSION_ZLIB,
-            &netplay->compress_zlib, false);
+            &netplay->compress_zlib, false, has_delta ? &delta_len : NULL);
+      }
+      if (netplay->compress_zstd.compression_backend)
+      {
+         *serial_info = full_info;
+         netplay_send_savestate(netplay, serial_info, NETPLAY_COMPRESSION_ZSTD,
+            &netplay->compress_zstd, false, has_delta ? &delta_len : NULL);
+      }
+
+      /* What was just sent is the base for the next delta */
+      if (keep_base)
+      {
+         if (netplay_delta_reserve(&netplay->delta_base,
+               &netplay->delta_base_cap, full_info.size))
+         {
+            memcpy(netplay->delta_base, full_info.data_const, full_info.size);
+            netplay->delta_base_size = full_info.size;
+         }
+         else
+         {
+            netplay->delta_base_size = 0;
+            for (i = 0; i < netplay->connections_size; i++)
+               netplay->connections[i].flags &= ~NETPLAY_CONN_FLAG_DELTA_BASE;
+         }
+      }
    }
 }
 
@@ -72,12 +72,26 @@
 #define NETPLAY_QUIRK_PLATFORM_DEPENDENT (1 << 2)
 
 /* Compression protocols supported */
-#define NETPLAY_COMPRESSION_ZLIB (1<<0)
+#define NETPLAY_COMPRESSION_ZLIB  (1<<0)
+#define NETPLAY_COMPRESSION_ZSTD  (1<<1)
+/* Not a compressor of its own: the peer can load savestates sent as
+ * the blocks that changed since the last savestate it was sent. */
+#define NETPLAY_COMPRESSION_DELTA (1<<2)
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED_ZLIB NETPLAY_COMPRESSION_ZLIB
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED_ZLIB 0
 #endif
+#ifdef HAVE_ZSTD
+#define NETPLAY_COMPRESSION_SUPPORTED_ZSTD NETPLAY_COMPRESSION_ZSTD
+#else
+#define NETPLAY_COMPRESSION_SUPPORTED_ZSTD 0
+#endif
+#define NETPLAY_COMPRESSION_SUPPORTED (NETPLAY_COMPRESSION_SUPPORTED_ZLIB \
+      | NETPLAY_COMPRESSION_SUPPORTED_ZSTD | NETPLAY_COMPRESSION_DELTA)
+
+/* Savestates sent as deltas are compared in blocks of this many bytes */
+#define NETPLAY_DELTA_BLOCK_SIZE 256
 
 /* The keys supported by netplay */
 enum netplay_keys
@@ -165,6 +179,10 @@ enum netplay_cmd
    /* Send a network packet from the raw packet core interface */
    NETPLAY_CMD_NETPACKET      = 0x0048,
 
+   /* Send a savestate for the client to load, as the changes from the
+    * last one it was sent */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0049,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -364,7 +382,11 @@ enum netplay_connection_flags
    /* Is this connection allowed to play (server only)? */
    NETPLAY_CONN_FLAG_CAN_PLAY       = (1 << 2),
    /* Did we request a ping response? */
-   NETPLAY_CONN_FLAG_PING_REQUESTED = (1 << 3)
+   NETPLAY_CONN_FLAG_PING_REQUESTED = (1 << 3),
+   /* Does this peer take savestates as deltas? */
+   NETPLAY_CONN_FLAG_DELTA_STATES   = (1 << 4),
+   /* Does this peer hold the savestate in delta_base (server only)? */
+   NETPLAY_CONN_FLAG_DELTA_BASE     = (1 << 5)
 };
 
 /* Each connection gets a connection struct */
@@ -501,6 +523,7 @@ struct netplay
    /* Compression transcoder */
    struct compression_transcoder compress_nil;
    struct compression_transcoder compress_zlib;
+   struct compression_transcoder compress_zstd;
 
    /* MITM session id */
    mitm_id_t mitm_session_id;
@@ -522,9 +545,19 @@ struct netplay
    /* A buffer into which to compress frames for transfer */
    uint8_t *zbuffer;
 
+   /* The last savestate sent (server) or received (client) in full,
+    * which savestate deltas are taken against */
+   uint8_t *delta_base;
+   /* Uncompressed savestate delta being built or applied */
+   uint8_t *delta_buffer;
+
    size_t connections_size;
    size_t buffer_size;
    size_t zbuffer_size;
+   /* 0 if there is no delta base */
+   size_t delta_base_size;
+   size_t delta_base_cap;
+   size_t delta_buffer_cap;
    /* The size of our packet buffers */
    size_t packet_buffer_size;
    /* Size of savestates (coremem_size + cheevos_size + headers) */
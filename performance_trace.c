@@ -0,0 +1,221 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <streams/file_stream.h>
+#include <formats/rjson.h>
+
+#include "performance_trace.h"
+#include "verbosity.h"
+
+/* The ring index wraps with a mask */
+#if (PERF_TRACE_MAX_EVENTS & (PERF_TRACE_MAX_EVENTS - 1)) != 0
+#error "PERF_TRACE_MAX_EVENTS must be a power of two"
+#endif
+
+typedef struct
+{
+   retro_time_t start;
+   uint32_t duration;
+   uint32_t frame;
+   uint8_t phase;
+} perf_trace_event_t;
+
+typedef struct
+{
+   perf_trace_event_t *events;
+   size_t head;
+   size_t count;
+   retro_time_t start[PERF_TRACE_PHASE_LAST];
+   retro_time_t frame_start;
+   uint32_t frame;
+   bool active;
+} perf_trace_state_t;
+
+static perf_trace_state_t perf_trace_st;
+
+static const char *perf_trace_phase_names[PERF_TRACE_PHASE_LAST] = {
+   "frame",
+   "core_run",
+   "video_driver_frame",
+   "audio_driver_flush",
+   "input_driver_poll",
+   "runahead",
+   "rewind_push",
+   "replay_checkpoint"
+};
+
+static void performance_trace_push(enum perf_trace_phase phase,
+      retro_time_t start, retro_time_t end)
+{
+   perf_trace_event_t *ev = &perf_trace_st.events[perf_trace_st.head];
+   retro_time_t duration  = end - start;
+
+   ev->start              = start;
+   ev->duration           = (duration > 0)
+      ? (duration < 0xFFFFFFFF ? (uint32_t)duration : 0xFFFFFFFF)
+      : 0;
+   ev->frame              = perf_trace_st.frame;
+   ev->phase              = (uint8_t)phase;
+
+   perf_trace_st.head     = (perf_trace_st.head + 1)
+      & (PERF_TRACE_MAX_EVENTS - 1);
+   if (perf_trace_st.count < PERF_TRACE_MAX_EVENTS)
+      perf_trace_st.count++;
+}
+
+void performance_trace_frame(bool enable)
+{
+   retro_time_t now;
+
+   if (!enable)
+   {
+      perf_trace_st.active      = false;
+      perf_trace_st.frame_start = 0;
+      return;
+   }
+
+   if (!perf_trace_st.events)
+   {
+      if (!(perf_trace_st.events = (perf_trace_event_t*)malloc(
+            PERF_TRACE_MAX_EVENTS * sizeof(perf_trace_event_t))))
+         return;
+      perf_trace_st.head  = 0;
+      perf_trace_st.count = 0;
+   }
+
+   now = cpu_features_get_time_usec();
+   if (perf_trace_st.frame_start)
+      performance_trace_push(PERF_TRACE_FRAME, perf_trace_st.frame_start, now);
+
+   memset(perf_trace_st.start, 0, sizeof(perf_trace_st.start));
+   perf_trace_st.frame_start = now;
+   perf_trace_st.frame++;
+   perf_trace_st.active      = true;
+}
+
+void performance_trace_begin(enum perf_trace_phase phase)
+{
+   if (perf_trace_st.active)
+      perf_trace_st.start[phase] = cpu_features_get_time_usec();
+}
+
+void performance_trace_end(enum perf_trace_phase phase)
+{
+   if (!perf_trace_st.active || !perf_trace_st.start[phase])
+      return;
+   performance_trace_push(phase, perf_trace_st.start[phase],
+         cpu_features_get_time_usec());
+   perf_trace_st.start[phase] = 0;
+}
+
+int performance_trace_dump(const char *path, unsigned seconds)
+{
+   size_t i;
+   rjsonwriter_t *writer;
+   RFILE *file            = NULL;
+   retro_time_t newest    = 0;
+   retro_time_t base      = 0;
+   retro_time_t cutoff;
+   int written            = 0;
+   size_t count           = perf_trace_st.count;
+   size_t oldest          = (perf_trace_st.head - count)
+      & (PERF_TRACE_MAX_EVENTS - 1);
+
+   if (!count)
+      return 0;
+
+   /* Spans are pushed when they end, so the last one
+    * pushed has the latest end time */
+   {
+      const perf_trace_event_t *ev = &perf_trace_st.events[
+         (perf_trace_st.head - 1) & (PERF_TRACE_MAX_EVENTS - 1)];
+      newest = ev->start + ev->duration;
+   }
+   cutoff = newest - (retro_time_t)seconds * 1000000;
+
+   /* Frame spans are pushed after the phases they
+    * contain, so find the earliest start in the window */
+   base = newest;
+   for (i = 0; i < count; i++)
+   {
+      const perf_trace_event_t *ev = &perf_trace_st.events[
+         (oldest + i) & (PERF_TRACE_MAX_EVENTS - 1)];
+      if (ev->start >= cutoff && ev->start < base)
+         base = ev->start;
+   }
+
+   if (!(file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      RARCH_ERR("[Trace] Failed to open \"%s\".\n", path);
+      return -1;
+   }
+
+   if (!(writer = rjsonwriter_open_rfile(file)))
+   {
+      RARCH_ERR("[Trace] Failed to create JSON writer.\n");
+      filestream_close(file);
+      return -1;
+   }
+
+   rjsonwriter_rawf(writer,
+         "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+         "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+         "\"args\":{\"name\":\"RetroArch\"}},\n"
+         "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+         "\"args\":{\"name\":\"runloop\"}}");
+
+   for (i = 0; i < count; i++)
+   {
+      const perf_trace_event_t *ev = &perf_trace_st.events[
+         (oldest + i) & (PERF_TRACE_MAX_EVENTS - 1)];
+      if (ev->start < cutoff)
+         continue;
+      rjsonwriter_rawf(writer,
+            ",\n{\"name\":\"%s\",\"cat\":\"runloop\",\"ph\":\"X\","
+            "\"ts\":%" PRId64 ",\"dur\":%u,\"pid\":1,\"tid\":1,"
+            "\"args\":{\"frame\":%u}}",
+            perf_trace_phase_names[ev->phase],
+            (int64_t)(ev->start - base),
+            (unsigned)ev->duration,
+            (unsigned)ev->frame);
+      written++;
+   }
+
+   rjsonwriter_raw(writer, "\n]}\n", 4);
+
+   if (!rjsonwriter_free(writer))
+   {
+      RARCH_ERR("[Trace] Error writing \"%s\".\n", path);
+      filestream_close(file);
+      return -1;
+   }
+   filestream_close(file);
+
+   RARCH_LOG("[Trace] Wrote %d spans to \"%s\".\n", written, path);
+   return written;
+}
+
+void performance_trace_deinit(void)
+{
+   free(perf_trace_st.events);
+   memset(&perf_trace_st, 0, sizeof(perf_trace_st));
+}
@@ -0,0 +1,104 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PERFORMANCE_TRACE_H
+#define _PERFORMANCE_TRACE_H
+
+#include <stdint.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+
+/* Number of spans kept in the ring buffer. At roughly
+ * ten spans per frame this covers close to a minute
+ * of 60 Hz content. */
+#ifndef PERF_TRACE_MAX_EVENTS
+#define PERF_TRACE_MAX_EVENTS (1 << 15)
+#endif
+
+/* How far back the dump hotkey/command reaches */
+#ifndef PERF_TRACE_DUMP_SECONDS
+#define PERF_TRACE_DUMP_SECONDS 10
+#endif
+
+RETRO_BEGIN_DECLS
+
+enum perf_trace_phase
+{
+   PERF_TRACE_FRAME = 0,
+   PERF_TRACE_CORE_RUN,
+   PERF_TRACE_VIDEO_FRAME,
+   PERF_TRACE_AUDIO_FLUSH,
+   PERF_TRACE_INPUT_POLL,
+   PERF_TRACE_RUNAHEAD,
+   PERF_TRACE_REWIND_PUSH,
+   PERF_TRACE_REPLAY_CHECKPOINT,
+
+   PERF_TRACE_PHASE_LAST
+};
+
+/**
+ * performance_trace_frame:
+ * @enable             : whether performance counters are enabled
+ *
+ * Marks the start of a runloop frame. Closes the span of the
+ * previous frame and latches @enable for the phases recorded
+ * until the next call. Only the main thread may record spans.
+ **/
+void performance_trace_frame(bool enable);
+
+/**
+ * performance_trace_begin:
+ * @phase              : runloop phase being entered
+ *
+ * Records the start time of @phase. Does nothing unless
+ * tracing was enabled by the last performance_trace_frame().
+ **/
+void performance_trace_begin(enum perf_trace_phase phase);
+
+/**
+ * performance_trace_end:
+ * @phase              : runloop phase being left
+ *
+ * Pushes the span started by the matching
+ * performance_trace_begin() into the ring buffer.
+ **/
+void performance_trace_end(enum perf_trace_phase phase);
+
+/**
+ * performance_trace_dump:
+ * @path               : output file
+ * @seconds            : how much recent history to write
+ *
+ * Writes the spans recorded over the last @seconds as a
+ * Chrome trace event file, loadable in chrome://tracing
+ * or the Perfetto UI.
+ *
+ * Returns: number of spans written, 0 if nothing has
+ * been recorded (no file is created), or -1 on error.
+ **/
+int performance_trace_dump(const char *path, unsigned seconds);
+
+/**
+ * performance_trace_deinit:
+ *
+ * Frees the ring buffer.
+ **/
+void performance_trace_deinit(void);
+
+RETRO_END_DECLS
+
+#endif
@@ -25,6 +25,8 @@
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <streams/interface_stream.h>
+#include <streams/file_stream.h>
+#include <encodings/crc32.h>
 #include <file/file_path.h>
 #include <file/archive_file.h>
 #include <lists/string_list.h>
@@ -44,6 +46,23 @@
 #define PLAYLIST_ENTRIES 6
 #endif
 
+/* JSON playlists smaller than this are always parsed
+ * directly, without a binary cache */
+#ifndef PLAYLIST_CACHE_MIN_SIZE
+#define PLAYLIST_CACHE_MIN_SIZE (32 * 1024)
+#endif
+
+/* Size of the reads used to hash the JSON file when
+ * checking whether its binary cache is still current */
+#define PLAYLIST_CACHE_CHUNK_SIZE    (64 * 1024)
+
+#define PLAYLIST_CACHE_MAGIC         0x43504C52 /* "RLPC" */
+#define PLAYLIST_CACHE_VERSION       3
+#define PLAYLIST_CACHE_NULL          0xFFFFFFFF
+#define PLAYLIST_CACHE_ENTRY_STRINGS 8
+#define PLAYLIST_CACHE_ENTRY_VALUES  10
+#define PLAYLIST_CACHE_META_STRINGS  6
+
 #define WINDOWS_PATH_DELIMITER '\\'
 #define POSIX_PATH_DELIMITER '/'
 
@@ -69,6 +88,55 @@ enum content_playlist_flags
    CNT_PLAYLIST_FLG_CACHED_EXT = (1 << 3)
 };
 
+enum playlist_cache_scan_flags
+{
+   PLAYLIST_CACHE_SCAN_RECURSIVE = (1 << 0),
+   PLAYLIST_CACHE_SCAN_ARCHIVES  = (1 << 1),
+   PLAYLIST_CACHE_SCAN_FILTER    = (1 << 2),
+   PLAYLIST_CACHE_SCAN_OVERWRITE = (1 << 3)
+};
+
+/* Binary cache file layout, in native byte order:
+ * header, entry records, subsystem rom string offsets,
+ * then a table of NUL terminated strings. All string
+ * references are offsets into the string table, or
+ * PLAYLIST_CACHE_NULL */
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   /* Size of the JSON file the cache was built from, and
+    * CRC32 of its first and last chunks */
+   uint32_t json_size;
+   uint32_t json_crc;
+   uint32_t capacity;
+   uint32_t num_entries;
+   uint32_t num_roms;
+   uint32_t strings_size;
+   uint32_t meta[PLAYLIST_CACHE_META_STRINGS];
+   uint32_t label_display_mode;
+   uint32_t right_thumbnail_mode;
+   uint32_t left_thumbnail_mode;
+   uint32_t thumbnail_match_mode;
+   uint32_t sort_mode;
+   uint32_t scan_flags;
+   uint32_t compressed;
+} playlist_cache_header_t;
+
+typedef struct
+{
+   uint32_t strings[PLAYLIST_CACHE_ENTRY_STRINGS];
+   uint32_t values[PLAYLIST_CACHE_ENTRY_VALUES];
+   uint32_t roms_first;
+   uint32_t roms_count;
+} playlist_cache_entry_t;
+
+typedef struct
+{
+   playlist_path_id_t *path_id;
+   uint32_t hash;
+} playlist_path_index_slot_t;
+
 struct content_playlist
 {
    char *default_core_path;
@@ -77,6 +145,21 @@ struct content_playlist
 
    struct playlist_entry *entries;
 
+   /* Open addressed table of entry path IDs, keyed on
+    * both the real path and parent archive path hashes.
+    * Only built on the first lookup, after which it
+    * tracks every entry in the playlist */
+   playlist_path_index_slot_t *path_index;
+   size_t path_index_cap;
+   size_t path_index_count;
+   size_t path_index_used;
+
+   /* Contents of the binary cache the playlist was
+    * loaded from. Entry strings point straight into
+    * its string table until they are replaced */
+   char *cache_data;
+   size_t cache_size;
+
    playlist_manual_scan_record_t scan_record; /* ptr alignment */
    playlist_config_t config;                  /* size_t alignment */
 
@@ -403,44 +486,31 @@ static bool playlist_path_equal(const char *real_path,
 }
 
 /**
- * playlist_path_matches_entry:
- * @path_id           : Path identity, containing 'real' path,
- *                      hash and archive status information
- * @entry             : Playlist entry to compare with path_id
+ * playlist_path_id_matches:
+ * @path_id           : Path identity to search for
+ * @entry_id          : Path identity of an existing entry
  *
- * Returns 'true' if 'path_id' matches path information
- * contained in specified 'entry'. Will update path_id
- * cache inside specified 'entry', if not already present.
+ * Returns 'true' if 'path_id' refers to the same
+ * content as 'entry_id'.
  **/
-static bool playlist_path_matches_entry(playlist_path_id_t *path_id,
-      struct playlist_entry *entry, const playlist_config_t *config)
+static bool playlist_path_id_matches(const playlist_path_id_t *path_id,
+      const playlist_path_id_t *entry_id, const playlist_config_t *config)
 {
-   /* Sanity check */
-   if (!path_id || !entry || !config)
-      return false;
-
-   /* Check whether entry contains a path ID cache */
-   if (!entry->path_id)
-   {
-      if (!(entry->path_id = playlist_path_id_init(entry->path)))
-         return false;
-   }
-
    /* Ensure we have valid real_path strings */
    if (   string_is_empty(path_id->real_path)
-       || string_is_empty(entry->path_id->real_path))
+       || string_is_empty(entry_id->real_path))
       return false;
 
    /* First pass comparison */
-   if (path_id->real_path_hash == entry->path_id->real_path_hash)
+   if (path_id->real_path_hash == entry_id->real_path_hash)
    {
 #ifdef _WIN32
       /* Handle case-insensitive operating systems*/
       if (string_is_equal_noncase(path_id->real_path,
-            entry->path_id->real_path))
+            entry_id->real_path))
          return true;
 #else
-      if (string_is_equal(path_id->real_path, entry->path_id->real_path))
+      if (string_is_equal(path_id->real_path, entry_id->real_path))
          return true;
 #endif
    }
@@ -465,25 +535,25 @@ static bool playlist_path_matches_entry(playlist_path_id_t *path_id,
     * loads an archive file via the command line or some
     * external launcher (where the [delimiter][rom_file]
     * part is almost always omitted) */
-   if (   ((path_id->is_archive        && !path_id->is_in_archive)        && entry->path_id->is_in_archive)
-       || ((entry->path_id->is_archive && !entry->path_id->is_in_archive) && path_id->is_in_archive))
+   if (   ((path_id->is_archive  && !path_id->is_in_archive)  && entry_id->is_in_archive)
+       || ((entry_id->is_archive && !entry_id->is_in_archive) && path_id->is_in_archive))
    {
       /* Ensure we have valid parent archive path
        * strings */
       if (   string_is_empty(path_id->archive_path)
-          || string_is_empty(entry->path_id->archive_path))
+          || string_is_empty(entry_id->archive_path))
          return false;
 
-      if (path_id->archive_path_hash == entry->path_id->archive_path_hash)
+      if (path_id->archive_path_hash == entry_id->archive_path_hash)
       {
 #ifdef _WIN32
          /* Handle case-insensitive operating systems*/
          if (string_is_equal_noncase(path_id->archive_path,
-               entry->path_id->archive_path))
+               entry_id->archive_path))
             return true;
 #else
          if (string_is_equal(path_id->archive_path,
-               entry->path_id->archive_path))
+               entry_id->archive_path))
             return true;
 #endif
       }
@@ -492,6 +562,231 @@ static bool playlist_path_matches_entry(playlist_path_id_t *path_id,
    return false;
 }
 
+/**
+ * playlist_path_matches_entry:
+ * @path_id           : Path identity, containing 'real' path,
+ *                      hash and archive status information
+ * @entry             : Playlist entry to compare with path_id
+ *
+ * Returns 'true' if 'path_id' matches path information
+ * contained in specified 'entry'. Will update path_id
+ * cache inside specified 'entry', if not already present.
+ **/
+static bool playlist_path_matches_entry(playlist_path_id_t *path_id,
+      struct playlist_entry *entry, const playlist_config_t *config)
+{
+   /* Sanity check */
+   if (!path_id || !entry || !config)
+      return false;
+
+   /* Check whether entry contains a path ID cache */
+   if (!entry->path_id)
+   {
+      if (!(entry->path_id = playlist_path_id_init(entry->path)))
+         return false;
+   }
+
+   return playlist_path_id_matches(path_id, entry->path_id, config);
+}
+
+/* Marks a removed slot, so that probing
+ * continues past it */
+static playlist_path_id_t playlist_path_index_tombstone;
+
+static void playlist_path_index_free(playlist_t *playlist)
+{
+   if (playlist->path_index)
+      free(playlist->path_index);
+   playlist->path_index       = NULL;
+   playlist->path_index_cap   = 0;
+   playlist->path_index_count = 0;
+   playlist->path_index_used  = 0;
+}
+
+static void playlist_path_index_insert_hash(playlist_t *playlist,
+      uint32_t hash, playlist_path_id_t *path_id)
+{
+   size_t mask = playlist->path_index_cap - 1;
+   size_t i    = hash & mask;
+
+   while (     playlist->path_index[i].path_id
+         &&    playlist->path_index[i].path_id != &playlist_path_index_tombstone)
+      i = (i + 1) & mask;
+
+   if (!playlist->path_index[i].path_id)
+      playlist->path_index_used++;
+   playlist->path_index[i].path_id = path_id;
+   playlist->path_index[i].hash    = hash;
+   playlist->path_index_count++;
+}
+
+/* Resizes the table so that live slots stay below
+ * a quarter of its capacity, dropping tombstones */
+static bool playlist_path_index_rehash(playlist_t *playlist, size_t count)
+{
+   size_t i;
+   size_t old_cap                    = playlist->path_index_cap;
+   size_t new_cap                    = 64;
+   playlist_path_index_slot_t *old   = playlist->path_index;
+   playlist_path_index_slot_t *table = NULL;
+
+   while (new_cap < count * 4)
+      new_cap <<= 1;
+
+   if (!(table = (playlist_path_index_slot_t*)calloc(new_cap,
+         sizeof(*table))))
+      return false;
+
+   playlist->path_index       = table;
+   playlist->path_index_cap   = new_cap;
+   playlist->path_index_count = 0;
+   playlist->path_index_used  = 0;
+
+   for (i = 0; i < old_cap; i++)
+      if (     old[i].path_id
+            && old[i].path_id != &playlist_path_index_tombstone)
+         playlist_path_index_insert_hash(playlist,
+               old[i].hash, old[i].path_id);
+
+   free(old);
+   return true;
+}
+
+static bool playlist_path_index_add(playlist_t *playlist,
+      playlist_path_id_t *path_id)
+{
+   /* Files inside an archive are also filed under
+    * the archive itself, for fuzzy matching */
+   bool by_archive = path_id->is_in_archive;
+   size_t needed   = playlist->path_index_used + (by_archive ? 2 : 1);
+
+   if (needed * 2 > playlist->path_index_cap)
+   {
+      if (!playlist_path_index_rehash(playlist,
+            playlist->path_index_count + (by_archive ? 2 : 1)))
+      {
+         playlist_path_index_free(playlist);
+         return false;
+      }
+   }
+
+   playlist_path_index_insert_hash(playlist,
+         path_id->real_path_hash, path_id);
+   if (by_archive)
+      playlist_path_index_insert_hash(playlist,
+            path_id->archive_path_hash, path_id);
+   return true;
+}
+
+static void playlist_path_index_remove_hash(playlist_t *playlist,
+      uint32_t hash, const playlist_path_id_t *path_id)
+{
+   size_t mask = playlist->path_index_cap - 1;
+   size_t i    = hash & mask;
+   playlist_path_index_slot_t *slot;
+
+   while ((slot = &playlist->path_index[i])->path_id)
+   {
+      if (slot->path_id == path_id && slot->hash == hash)
+      {
+         slot->path_id = &playlist_path_index_tombstone;
+         playlist->path_index_count--;
+         return;
+      }
+      i = (i + 1) & mask;
+   }
+}
+
+static void playlist_path_index_remove(playlist_t *playlist,
+      const playlist_path_id_t *path_id)
+{
+   if (!playlist->path_index || !path_id)
+      return;
+
+   playlist_path_index_remove_hash(playlist,
+         path_id->real_path_hash, path_id);
+   if (path_id->is_in_archive)
+      playlist_path_index_remove_hash(playlist,
+            path_id->archive_path_hash, path_id);
+}
+
+/**
+ * playlist_path_index_init:
+ * @playlist          : Playlist handle
+ *
+ * Builds the path index if it does not exist yet,
+ * caching the path ID of every entry on the way.
+ *
+ * Returns 'true' if the index is available.
+ **/
+static bool playlist_path_index_init(playlist_t *playlist)
+{
+   size_t i, _len;
+
+   if (playlist->path_index)
+      return true;
+
+   _len = RBUF_LEN(playlist->entries);
+   if (!playlist_path_index_rehash(playlist, _len * 2))
+      return false;
+
+   for (i = 0; i < _len; i++)
+   {
+      struct playlist_entry *entry = &playlist->entries[i];
+
+      if (     (!entry->path_id
+            && !(entry->path_id = playlist_path_id_init(entry->path)))
+            || !playlist_path_index_add(playlist, entry->path_id))
+      {
+         playlist_path_index_free(playlist);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static bool playlist_path_index_probe(const playlist_t *playlist,
+      uint32_t hash, const playlist_path_id_t *path_id)
+{
+   size_t mask = playlist->path_index_cap - 1;
+   size_t i    = hash & mask;
+   const playlist_path_index_slot_t *slot;
+
+   while ((slot = &playlist->path_index[i])->path_id)
+   {
+      if (     slot->hash    == hash
+            && slot->path_id != &playlist_path_index_tombstone
+            && playlist_path_id_matches(path_id, slot->path_id,
+               &playlist->config))
+         return true;
+      i = (i + 1) & mask;
+   }
+
+   return false;
+}
+
+/**
+ * playlist_path_index_find:
+ * @playlist          : Playlist handle, with an initialised index
+ * @path_id           : Path identity to search for
+ *
+ * Returns 'true' if any entry matches 'path_id', in
+ * the sense of playlist_path_matches_entry().
+ **/
+static bool playlist_path_index_find(const playlist_t *playlist,
+      const playlist_path_id_t *path_id)
+{
+   if (string_is_empty(path_id->real_path))
+      return false;
+   if (playlist_path_index_probe(playlist,
+         path_id->real_path_hash, path_id))
+      return true;
+   return   path_id->is_in_archive
+         && playlist_path_index_probe(playlist,
+               path_id->archive_path_hash, path_id);
+}
+
 /**
  * playlist_core_path_equal:
  * @real_core_path  : 'Real' search path, generated by path_resolve_realpath()
@@ -551,6 +846,11 @@ char *playlist_get_conf_path(playlist_t *playlist)
    return playlist->config.path;
 }
 
+size_t playlist_get_cache_path(const char *path, char *s, size_t len)
+{
+   return fill_pathname(s, path, FILE_PATH_LPL_CACHE_EXTENSION, len);
+}
+
 /**
  * playlist_get_index:
  * @playlist            : Playlist handle.
@@ -571,37 +871,42 @@ void playlist_get_index(playlist_t *playlist,
    *entry = &playlist->entries[idx];
 }
 
+/* Strings of entries loaded from the binary cache live
+ * in the cache buffer and are released along with it */
+static void playlist_free_string(const playlist_t *playlist, char *s)
+{
+   if (!s)
+      return;
+   if (     playlist->cache_data
+         && (s >= playlist->cache_data)
+         && (s <  playlist->cache_data + playlist->cache_size))
+      return;
+   free(s);
+}
+
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(const playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
-   if (entry->path)
-      free(entry->path);
-   if (entry->label)
-      free(entry->label);
-   if (entry->core_path)
-      free(entry->core_path);
-   if (entry->core_name)
-      free(entry->core_name);
-   if (entry->db_name)
-      free(entry->db_name);
-   if (entry->crc32)
-      free(entry->crc32);
-   if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
-   if (entry->subsystem_name)
-      free(entry->subsystem_name);
-   if (entry->runtime_str)
-      free(entry->runtime_str);
-   if (entry->last_played_str)
-      free(entry->last_played_str);
+   playlist_free_string(playlist, entry->path);
+   playlist_free_string(playlist, entry->label);
+   playlist_free_string(playlist, entry->core_path);
+   playlist_free_string(playlist, entry->core_name);
+   playlist_free_string(playlist, entry->db_name);
+   playlist_free_string(playlist, entry->crc32);
+   playlist_free_string(playlist, entry->subsystem_ident);
+   playlist_free_string(playlist, entry->subsystem_name);
+   playlist_free_string(playlist, entry->runtime_str);
+   playlist_free_string(playlist, entry->last_played_str);
    if (entry->subsystem_roms)
       string_list_free(entry->subsystem_roms);
    if (entry->path_id)
@@ -655,7 +960,10 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+   {
+      playlist_path_index_remove(playlist, entry_to_delete->path_id);
+      playlist_free_entry(playlist, entry_to_delete);
+   }
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -686,6 +994,13 @@ void playlist_delete_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
+   if (     playlist_path_index_init(playlist)
+         && !playlist_path_index_find(playlist, path_id))
+   {
+      playlist_path_id_free(path_id);
+      return;
+   }
+
    while (i < RBUF_LEN(playlist->entries))
    {
       if (!playlist_path_matches_entry(path_id,
@@ -718,6 +1033,13 @@ void playlist_get_index_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
+   if (     playlist_path_index_init(playlist)
+         && !playlist_path_index_find(playlist, path_id))
+   {
+      playlist_path_id_free(path_id);
+      return;
+   }
+
    for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
    {
       if (!playlist_path_matches_entry(path_id,
@@ -743,6 +1065,13 @@ bool playlist_entry_exists(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(path)))
       return false;
 
+   if (playlist_path_index_init(playlist))
+   {
+      bool found = playlist_path_index_find(playlist, path_id);
+      playlist_path_id_free(path_id);
+      return found;
+   }
+
    for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
    {
       if (playlist_path_matches_entry(path_id,
@@ -769,8 +1098,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -779,45 +1107,43 @@ void playlist_update(playlist_t *playlist, size_t idx,
          entry->path_id  = NULL;
       }
 
+      /* Rebuilt on the next lookup */
+      playlist_path_index_free(playlist);
+
       playlist->flags |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->label && (update_entry->label != entry->label))
    {
-      if (entry->label)
-         free(entry->label);
+      playlist_free_string(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
       entry->core_path   = strdup(update_entry->core_path);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
-      if (entry->core_name)
-         free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
       entry->core_name   = strdup(update_entry->core_name);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
-      if (entry->db_name)
-         free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
       entry->db_name     = strdup(update_entry->db_name);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
-      if (entry->crc32)
-         free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
@@ -836,8 +1162,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -846,14 +1171,16 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
          entry->path_id  = NULL;
       }
 
+      /* Rebuilt on the next lookup */
+      playlist_path_index_free(playlist);
+
       if (register_update)
          playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
       entry->core_path      = strdup(update_entry->core_path);
       if (register_update)
          playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
@@ -931,8 +1258,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->runtime_str && (update_entry->runtime_str != entry->runtime_str))
    {
-      if (entry->runtime_str)
-         free(entry->runtime_str);
+      playlist_free_string(playlist, entry->runtime_str);
       entry->runtime_str    = strdup(update_entry->runtime_str);
       if (register_update)
          playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
@@ -940,8 +1266,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->last_played_str && (update_entry->last_played_str != entry->last_played_str))
    {
-      if (entry->last_played_str)
-         free(entry->last_played_str);
+      playlist_free_string(playlist, entry->last_played_str);
       entry->last_played_str = NULL;
       entry->last_played_str = strdup(update_entry->last_played_str);
       if (register_update)
@@ -983,7 +1308,14 @@ bool playlist_push_runtime(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   /* The path index rules out new content without
+    * comparing it against every entry */
+   i   = 0;
+   if (     !string_is_empty(path_id->real_path)
+         && playlist_path_index_init(playlist)
+         && !playlist_path_index_find(playlist, path_id))
+      i = len;
+   for (; i < len; i++)
    {
       struct playlist_entry tmp;
       bool equal_path  = (string_is_empty(path_id->real_path)
@@ -1020,7 +1352,8 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_path_index_remove(playlist, last_entry->path_id);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1044,6 +1377,9 @@ bool playlist_push_runtime(playlist_t *playlist,
       playlist->entries[0].path_id            = path_id;
       path_id                                 = NULL;
 
+      if (playlist->path_index)
+         playlist_path_index_add(playlist, playlist->entries[0].path_id);
+
       if (!string_is_empty(real_core_path))
          playlist->entries[0].core_path       = strdup(real_core_path);
 
@@ -1328,7 +1664,14 @@ bool playlist_push(playlist_t *playlist,
    }
 
    _len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < _len; i++)
+   /* The path index rules out new content without
+    * comparing it against every entry */
+   i    = 0;
+   if (     !string_is_empty(path_id->real_path)
+         && playlist_path_index_init(playlist)
+         && !playlist_path_index_find(playlist, path_id))
+      i = _len;
+   for (; i < _len; i++)
    {
       struct playlist_entry tmp;
       bool equal_path  = (string_is_empty(path_id->real_path)
@@ -1460,7 +1803,8 @@ bool playlist_push(playlist_t *playlist,
    if (_len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[_len - 1];
-      playlist_free_entry(last_entry);
+      playlist_path_index_remove(playlist, last_entry->path_id);
+      playlist_free_entry(playlist, last_entry);
       _len--;
    }
    else
@@ -1504,6 +1848,9 @@ bool playlist_push(playlist_t *playlist,
       playlist->entries[0].path_id            = path_id;
       path_id                                 = NULL;
 
+      if (playlist->path_index)
+         playlist_path_index_add(playlist, playlist->entries[0].path_id);
+
       playlist->entries[0].entry_slot         = entry->entry_slot;
 
       if (!string_is_empty(entry->label))
@@ -1701,11 +2048,19 @@ end:
    free(file);
 }
 
+static bool playlist_cache_fingerprint(const char *path,
+      uint32_t *size, uint32_t *crc);
+static void playlist_cache_write(playlist_t *playlist,
+      uint32_t json_size, uint32_t json_crc);
+
 void playlist_write_file(playlist_t *playlist)
 {
    size_t i, _len;
+   uint32_t json_size;
+   uint32_t json_crc;
    intfstream_t *file = NULL;
    bool compressed    = false;
+   bool written       = false;
 
    /* Playlist will be written if any of the
     * following are true:
@@ -2096,6 +2451,8 @@ void playlist_write_file(playlist_t *playlist)
       {
          RARCH_ERR("[Playlist] Failed to write to file: \"%s\".\n", playlist->config.path);
       }
+      else
+         written        = true;
 
       playlist->flags  &= ~(CNT_PLAYLIST_FLG_OLD_FMT);
    }
@@ -2111,6 +2468,14 @@ void playlist_write_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
+
+   /* The entries are still in memory, so the cache of a
+    * JSON playlist can be brought up to date without
+    * parsing the file again */
+   if (     written
+         && playlist_cache_fingerprint(playlist->config.path,
+            &json_size, &json_crc))
+      playlist_cache_write(playlist, json_size, json_crc);
 }
 
 /**
@@ -2157,12 +2522,17 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   if (playlist->cache_data)
+      free(playlist->cache_data);
+   playlist->cache_data = NULL;
+
+   playlist_path_index_free(playlist);
    free(playlist);
 }
 
@@ -2183,9 +2553,15 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_path_index_free(playlist);
+
+   if (playlist->cache_data)
+      free(playlist->cache_data);
+   playlist->cache_data = NULL;
+   playlist->cache_size = 0;
 }
 
 /**
@@ -2576,19 +2952,455 @@ static size_t playlist_get_old_format_metadata_value(
    return strlcpy(s, start, len);
 }
 
+static void playlist_cache_entry_fields(struct playlist_entry *entry,
+      char **strings[PLAYLIST_CACHE_ENTRY_STRINGS],
+      unsigned *values[PLAYLIST_CACHE_ENTRY_VALUES])
+{
+   strings[0] = &entry->path;
+   strings[1] = &entry->label;
+   strings[2] = &entry->core_path;
+   strings[3] = &entry->core_name;
+   strings[4] = &entry->db_name;
+   strings[5] = &entry->crc32;
+   strings[6] = &entry->subsystem_ident;
+   strings[7] = &entry->subsystem_name;
+
+   values[0]  = &entry->entry_slot;
+   values[1]  = &entry->runtime_hours;
+   values[2]  = &entry->runtime_minutes;
+   values[3]  = &entry->runtime_seconds;
+   values[4]  = &entry->last_played_year;
+   values[5]  = &entry->last_played_month;
+   values[6]  = &entry->last_played_day;
+   values[7]  = &entry->last_played_hour;
+   values[8]  = &entry->last_played_minute;
+   values[9]  = &entry->last_played_second;
+}
+
+static void playlist_cache_meta_fields(playlist_t *playlist,
+      char **strings[PLAYLIST_CACHE_META_STRINGS])
+{
+   strings[0] = &playlist->default_core_path;
+   strings[1] = &playlist->default_core_name;
+   strings[2] = &playlist->base_content_directory;
+   strings[3] = &playlist->scan_record.content_dir;
+   strings[4] = &playlist->scan_record.file_exts;
+   strings[5] = &playlist->scan_record.dat_file_path;
+}
+
+/* Gets the size of the playlist file as stored on disk
+ * and the CRC32 of its whole content, so any edit made
+ * outside of RetroArch invalidates the binary cache */
+static bool playlist_cache_fingerprint(const char *path,
+      uint32_t *size, uint32_t *crc)
+{
+   int64_t _len;
+   int64_t size_in;
+   uint8_t *buf = NULL;
+   RFILE *file  = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (     ((size_in = filestream_get_size(file)) < PLAYLIST_CACHE_MIN_SIZE)
+         || (size_in > (int64_t)0xFFFFFFFF)
+         || !(buf = (uint8_t*)malloc(PLAYLIST_CACHE_CHUNK_SIZE)))
+   {
+      filestream_close(file);
+      return false;
+   }
+
+   *size = 0;
+   *crc  = 0;
+   while ((_len = filestream_read(file, buf, PLAYLIST_CACHE_CHUNK_SIZE)) > 0)
+   {
+      *crc   = encoding_crc32(*crc, buf, (size_t)_len);
+      *size += (uint32_t)_len;
+   }
+
+   free(buf);
+   filestream_close(file);
+   return (_len == 0) && ((int64_t)*size == size_in);
+}
+
+static bool playlist_cache_add_string(char **strings,
+      const char *s, uint32_t *offset)
+{
+   size_t _len;
+   size_t pos = RBUF_LEN(*strings);
+
+   if (!s)
+   {
+      *offset = PLAYLIST_CACHE_NULL;
+      return true;
+   }
+
+   _len = strlen(s) + 1;
+   if (!RBUF_TRYFIT(*strings, pos + _len))
+      return false;
+   RBUF_RESIZE(*strings, pos + _len);
+   memcpy(*strings + pos, s, _len);
+   *offset = (uint32_t)pos;
+   return true;
+}
+
+/**
+ * playlist_cache_write:
+ * @playlist            : Playlist handle.
+ * @json_size           : Size of the JSON file the entries match.
+ * @json_crc            : CRC32 of that file's first and last chunks.
+ *
+ * Saves the playlist, freshly parsed or just written, as a
+ * binary cache next to the JSON file, so the next
+ * playlist_init() of the same unchanged file can skip
+ * the parser.
+ **/
+static void playlist_cache_write(playlist_t *playlist,
+      uint32_t json_size, uint32_t json_crc)
+{
+   size_t i, j;
+   char cache_path[PATH_MAX_LENGTH];
+   playlist_cache_header_t header;
+   char **meta[PLAYLIST_CACHE_META_STRINGS];
+   playlist_cache_entry_t *records = NULL;
+   uint32_t *roms                  = NULL;
+   char *strings                   = NULL;
+   RFILE *file                     = NULL;
+   size_t _len                     = RBUF_LEN(playlist->entries);
+   bool success                    = false;
+
+   memset(&header, 0, sizeof(header));
+
+   if (_len && !(records = (playlist_cache_entry_t*)
+         malloc(_len * sizeof(*records))))
+      return;
+
+   /* Scanned playlists tend to repeat the same core and
+    * database names, so consecutive duplicates share a
+    * single copy in the string table */
+   for (i = 0; i < _len; i++)
+   {
+      char **fields[PLAYLIST_CACHE_ENTRY_STRINGS];
+      char **prev_fields[PLAYLIST_CACHE_ENTRY_STRINGS];
+      unsigned *values[PLAYLIST_CACHE_ENTRY_VALUES];
+      unsigned *prev_values[PLAYLIST_CACHE_ENTRY_VALUES];
+      struct playlist_entry *entry  = &playlist->entries[i];
+      struct string_list *sub_roms  = entry->subsystem_roms;
+      playlist_cache_entry_t *rec   = &records[i];
+
+      playlist_cache_entry_fields(entry, fields, values);
+      if (i > 0)
+         playlist_cache_entry_fields(&playlist->entries[i - 1],
+               prev_fields, prev_values);
+
+      for (j = 0; j < PLAYLIST_CACHE_ENTRY_STRINGS; j++)
+      {
+         if (     (i > 0)
+               && *fields[j]
+               && string_is_equal(*prev_fields[j], *fields[j]))
+         {
+            rec->strings[j] = records[i - 1].strings[j];
+            continue;
+         }
+
+         if (!playlist_cache_add_string(&strings, *fields[j],
+                  &rec->strings[j]))
+            goto end;
+      }
+
+      for (j = 0; j < PLAYLIST_CACHE_ENTRY_VALUES; j++)
+         rec->values[j] = *values[j];
+
+      rec->roms_first = (uint32_t)RBUF_LEN(roms);
+      rec->roms_count = 0;
+
+      if (sub_roms)
+      {
+         for (j = 0; j < sub_roms->size; j++)
+         {
+            uint32_t offset;
+            if (     !playlist_cache_add_string(&strings,
+                        sub_roms->elems[j].data, &offset)
+                  || !RBUF_TRYFIT(roms, RBUF_LEN(roms) + 1))
+               goto end;
+            RBUF_PUSH(roms, offset);
+            rec->roms_count++;
+         }
+      }
+   }
+
+   playlist_cache_meta_fields(playlist, meta);
+   for (i = 0; i < PLAYLIST_CACHE_META_STRINGS; i++)
+      if (!playlist_cache_add_string(&strings, *meta[i], &header.meta[i]))
+         goto end;
+
+   /* The string table must end with a NUL even when empty */
+   {
+      uint32_t offset;
+      if (!playlist_cache_add_string(&strings, "", &offset))
+         goto end;
+   }
+
+   header.magic                = PLAYLIST_CACHE_MAGIC;
+   header.version              = PLAYLIST_CACHE_VERSION;
+   header.json_size            = json_size;
+   header.json_crc             = json_crc;
+   header.capacity             = (uint32_t)playlist->config.capacity;
+   header.num_entries          = (uint32_t)_len;
+   header.num_roms             = (uint32_t)RBUF_LEN(roms);
+   header.strings_size         = (uint32_t)RBUF_LEN(strings);
+   header.label_display_mode   = (uint32_t)playlist->label_display_mode;
+   header.right_thumbnail_mode = (uint32_t)playlist->right_thumbnail_mode;
+   header.left_thumbnail_mode  = (uint32_t)playlist->left_thumbnail_mode;
+   header.thumbnail_match_mode = (uint32_t)playlist->thumbnail_match_mode;
+   header.sort_mode            = (uint32_t)playlist->sort_mode;
+   header.compressed           =
+      (playlist->flags & CNT_PLAYLIST_FLG_COMPRESSED) ? 1 : 0;
+   if (playlist->scan_record.search_recursively)
+      header.scan_flags       |= PLAYLIST_CACHE_SCAN_RECURSIVE;
+   if (playlist->scan_record.search_archives)
+      header.scan_flags       |= PLAYLIST_CACHE_SCAN_ARCHIVES;
+   if (playlist->scan_record.filter_dat_content)
+      header.scan_flags       |= PLAYLIST_CACHE_SCAN_FILTER;
+   if (playlist->scan_record.overwrite_playlist)
+      header.scan_flags       |= PLAYLIST_CACHE_SCAN_OVERWRITE;
+
+   playlist_get_cache_path(playlist->config.path,
+         cache_path, sizeof(cache_path));
+
+   if (!(file = filestream_open(cache_path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      goto end;
+
+   success =
+         (filestream_write(file, &header, sizeof(header))
+            == sizeof(header))
+      && (filestream_write(file, records, _len * sizeof(*records))
+            == (int64_t)(_len * sizeof(*records)))
+      && (filestream_write(file, roms, RBUF_SIZEOF(roms))
+            == (int64_t)RBUF_SIZEOF(roms))
+      && (filestream_write(file, strings, RBUF_SIZEOF(strings))
+            == (int64_t)RBUF_SIZEOF(strings));
+
+   filestream_close(file);
+
+   /* A truncated cache would fail validation anyway,
+    * but there is no point keeping it around */
+   if (!success)
+      filestream_delete(cache_path);
+
+end:
+   if (!success)
+      RARCH_WARN("[Playlist] Failed to write cache: \"%s\".\n",
+            playlist->config.path);
+   free(records);
+   RBUF_FREE(roms);
+   RBUF_FREE(strings);
+}
+
+/**
+ * playlist_cache_read:
+ * @playlist            : Playlist handle.
+ * @json_size           : Size of the JSON file on disk.
+ * @json_crc            : CRC32 of its first and last chunks.
+ *
+ * Loads the playlist from its binary cache, if one exists
+ * and was built from the current JSON file. The cache file
+ * is kept in memory and entry strings point into it, so
+ * only strings that are later modified get allocated.
+ *
+ * Returns: true if the playlist was loaded from the cache.
+ **/
+static bool playlist_cache_read(playlist_t *playlist,
+      uint32_t json_size, uint32_t json_crc)
+{
+   size_t i, j;
+   char cache_path[PATH_MAX_LENGTH];
+   char **meta[PLAYLIST_CACHE_META_STRINGS];
+   playlist_cache_header_t header;
+   const playlist_cache_entry_t *records;
+   const uint32_t *roms;
+   const char *strings;
+   uint64_t expected;
+   void *buf   = NULL;
+   int64_t len = 0;
+
+   playlist_get_cache_path(playlist->config.path,
+         cache_path, sizeof(cache_path));
+
+   if (!filestream_read_file(cache_path, &buf, &len))
+      return false;
+
+   if ((size_t)len < sizeof(header))
+      goto error;
+
+   memcpy(&header, buf, sizeof(header));
+
+   if (     (header.magic        != PLAYLIST_CACHE_MAGIC)
+         || (header.version      != PLAYLIST_CACHE_VERSION)
+         || (header.json_size    != json_size)
+         || (header.json_crc     != json_crc)
+         || (header.capacity     != (uint32_t)playlist->config.capacity)
+         || (header.num_entries   > playlist->config.capacity)
+         || (header.strings_size == 0))
+      goto error;
+
+   expected = sizeof(header)
+      + (uint64_t)header.num_entries * sizeof(playlist_cache_entry_t)
+      + (uint64_t)header.num_roms    * sizeof(uint32_t)
+      + header.strings_size;
+   if (expected != (uint64_t)len)
+      goto error;
+
+   records = (const playlist_cache_entry_t*)((const char*)buf
+         + sizeof(header));
+   roms    = (const uint32_t*)(records + header.num_entries);
+   strings = (const char*)(roms + header.num_roms);
+
+   if (strings[header.strings_size - 1] != '\0')
+      goto error;
+
+   /* Validate every reference before touching the playlist */
+   for (i = 0; i < PLAYLIST_CACHE_META_STRINGS; i++)
+      if (     (header.meta[i] != PLAYLIST_CACHE_NULL)
+            && (header.meta[i] >= header.strings_size))
+         goto error;
+
+   for (i = 0; i < header.num_roms; i++)
+      if (roms[i] >= header.strings_size)
+         goto error;
+
+   for (i = 0; i < header.num_entries; i++)
+   {
+      const playlist_cache_entry_t *rec = &records[i];
+
+      for (j = 0; j < PLAYLIST_CACHE_ENTRY_STRINGS; j++)
+         if (     (rec->strings[j] != PLAYLIST_CACHE_NULL)
+               && (rec->strings[j] >= header.strings_size))
+            goto error;
+
+      if (     (rec->roms_first > header.num_roms)
+            || (rec->roms_count > header.num_roms - rec->roms_first))
+         goto error;
+   }
+
+   if (!RBUF_TRYFIT(playlist->entries, header.num_entries))
+      goto error;
+   RBUF_RESIZE(playlist->entries, header.num_entries);
+
+   playlist->cache_data = (char*)buf;
+   playlist->cache_size = (size_t)len;
+
+   for (i = 0; i < header.num_entries; i++)
+   {
+      char **fields[PLAYLIST_CACHE_ENTRY_STRINGS];
+      unsigned *values[PLAYLIST_CACHE_ENTRY_VALUES];
+      const playlist_cache_entry_t *rec = &records[i];
+      struct playlist_entry *entry      = &playlist->entries[i];
+
+      memset(entry, 0, sizeof(*entry));
+      playlist_cache_entry_fields(entry, fields, values);
+
+      for (j = 0; j < PLAYLIST_CACHE_ENTRY_STRINGS; j++)
+         if (rec->strings[j] != PLAYLIST_CACHE_NULL)
+            *fields[j] = (char*)strings + rec->strings[j];
+
+      for (j = 0; j < PLAYLIST_CACHE_ENTRY_VALUES; j++)
+         *values[j] = rec->values[j];
+
+      /* Subsystem content is rare, so it is simply
+       * copied into a regular string list */
+      if (rec->roms_count)
+      {
+         union string_list_elem_attr attr = {0};
+
+         if (!(entry->subsystem_roms = string_list_new()))
+            goto error_entries;
+
+         for (j = 0; j < rec->roms_count; j++)
+            if (!string_list_append(entry->subsystem_roms,
+                     strings + roms[rec->roms_first + j], attr))
+               goto error_entries;
+      }
+   }
+
+   playlist_cache_meta_fields(playlist, meta);
+   for (i = 0; i < PLAYLIST_CACHE_META_STRINGS; i++)
+      if (header.meta[i] != PLAYLIST_CACHE_NULL)
+         *meta[i] = strdup(strings + header.meta[i]);
+
+   playlist->label_display_mode   =
+      (enum playlist_label_display_mode)header.label_display_mode;
+   playlist->right_thumbnail_mode =
+      (enum playlist_thumbnail_mode)header.right_thumbnail_mode;
+   playlist->left_thumbnail_mode  =
+      (enum playlist_thumbnail_mode)header.left_thumbnail_mode;
+   playlist->thumbnail_match_mode =
+      (enum playlist_thumbnail_match_mode)header.thumbnail_match_mode;
+   playlist->sort_mode            =
+      (enum playlist_sort_mode)header.sort_mode;
+
+   playlist->scan_record.search_recursively =
+      (header.scan_flags & PLAYLIST_CACHE_SCAN_RECURSIVE) ? true : false;
+   playlist->scan_record.search_archives    =
+      (header.scan_flags & PLAYLIST_CACHE_SCAN_ARCHIVES)  ? true : false;
+   playlist->scan_record.filter_dat_content =
+      (header.scan_flags & PLAYLIST_CACHE_SCAN_FILTER)    ? true : false;
+   playlist->scan_record.overwrite_playlist =
+      (header.scan_flags & PLAYLIST_CACHE_SCAN_OVERWRITE) ? true : false;
+
+   playlist->flags &= ~CNT_PLAYLIST_FLG_OLD_FMT;
+   if (header.compressed)
+      playlist->flags |=  CNT_PLAYLIST_FLG_COMPRESSED;
+   else
+      playlist->flags &= ~CNT_PLAYLIST_FLG_COMPRESSED;
+
+   return true;
+
+error_entries:
+   /* Entries own nothing but their subsystem lists at
+    * this point, so release those and start over */
+   for (j = 0; j <= i; j++)
+      if (playlist->entries[j].subsystem_roms)
+         string_list_free(playlist->entries[j].subsystem_roms);
+   RBUF_CLEAR(playlist->entries);
+   playlist->cache_data = NULL;
+   playlist->cache_size = 0;
+error:
+   free(buf);
+   return false;
+}
+
 static bool playlist_read_file(playlist_t *playlist)
 {
    int test_char;
+   uint32_t json_size   = 0;
+   uint32_t json_crc    = 0;
    bool res             = true;
+   bool use_cache       = false;
+   intfstream_t *file   = NULL;
+
+   /* Large playlists are loaded from their binary
+    * cache whenever it matches the file on disk */
+   if ((use_cache = playlist_cache_fingerprint(playlist->config.path,
+         &json_size, &json_crc)))
+   {
+      if (playlist_cache_read(playlist, json_size, json_crc))
+         return true;
+   }
+
 #if defined(HAVE_ZLIB)
       /* Always use RZIP interface when reading playlists
        * > this will automatically handle uncompressed
        *   data */
-   intfstream_t *file   = intfstream_open_rzip_file(
+   file                 = intfstream_open_rzip_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ);
 #else
-   intfstream_t *file   = intfstream_open_file(
+   file                 = intfstream_open_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -2650,7 +3462,14 @@ static bool playlist_read_file(playlist_t *playlist)
             JSONEndArrayHandler,
             JSONBoolHandler,
             NULL) /* Unused null handler */
-            != RJSON_DONE)
+            == RJSON_DONE)
+      {
+         /* Discarded entries leave the playlist modified,
+          * and a cache must match the file exactly */
+         if (use_cache && !(playlist->flags & CNT_PLAYLIST_FLG_MOD))
+            playlist_cache_write(playlist, json_size, json_crc);
+      }
+      else
       {
          if (context.flags & JSON_CTX_FLG_OOM)
          {
@@ -2924,6 +3743,12 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path              = NULL;
    playlist->base_content_directory         = NULL;
    playlist->entries                        = NULL;
+   playlist->path_index                     = NULL;
+   playlist->path_index_cap                 = 0;
+   playlist->path_index_count               = 0;
+   playlist->path_index_used                = 0;
+   playlist->cache_data                     = NULL;
+   playlist->cache_size                     = 0;
    playlist->label_display_mode             = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode           = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode            = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2971,7 +3796,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
                   playlist->config.base_content_directory,
                   sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_free_string(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
 
             /* Fix subsystem roms paths*/
@@ -319,6 +319,10 @@ bool playlist_entry_exists(playlist_t *playlist,
 
 char *playlist_get_conf_path(playlist_t *playlist);
 
+/* Fills @s with the path of the binary cache that
+ * accompanies the playlist file at @path */
+size_t playlist_get_cache_path(const char *path, char *s, size_t len);
+
 uint32_t playlist_get_size(playlist_t *playlist);
 
 void playlist_write_file(playlist_t *playlist);
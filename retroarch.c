@@ -191,6 +191,7 @@
 #include "file_path_special.h"
 #include "ui/ui_companion_driver.h"
 #include "verbosity.h"
+#include "performance_trace.h"
 
 #include "gfx/video_driver.h"
 #include "gfx/video_display_server.h"
@@ -295,6 +296,7 @@ enum
    RA_OPT_FEATURES,
    RA_OPT_VERSION,
    RA_OPT_EOF_EXIT,
+   RA_OPT_VERIFY_REPLAY,
    RA_OPT_LOG_FILE,
    RA_OPT_MAX_FRAMES,
    RA_OPT_MAX_FRAMES_SCREENSHOT,
@@ -1526,6 +1528,7 @@ void driver_set_nonblock_state(void)
       }
    }
 
+   audio_driver_processing_thread_drain();
    if (audio_driver_active && audio_st->context_audio_data)
       audio_st->current_audio->set_nonblock_state(
             audio_st->context_audio_data,
@@ -2013,6 +2016,7 @@ bool driver_ctl(enum driver_ctl_state state, void *data)
             video_monitor_set_refresh_rate(*hz);
 
             /* Sets audio monitor rate to new value. */
+            audio_driver_processing_thread_drain();
             audio_st->src_ratio_orig   =
             audio_st->src_ratio_curr   =
             (double)audio_output_sample_rate / audio_st->input;
@@ -3880,7 +3884,8 @@ bool command_event(enum event_command cmd, void *data)
 #endif
                {
                   state_manager_event_init(&runloop_st->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size,
+                        settings->bools.rewind_deduplicate);
                }
             }
          }
@@ -4026,6 +4031,38 @@ bool command_event(enum event_command cmd, void *data)
       case CMD_EVENT_STATISTICS_TOGGLE:
          settings->bools.video_statistics_show = !(settings->bools.video_statistics_show);
          break;
+      case CMD_EVENT_PERF_TRACE_DUMP:
+         {
+            int ret;
+            char trace_name[64];
+            char trace_path[PATH_MAX_LENGTH];
+            const char *log_dir = settings->paths.log_dir;
+
+            fill_str_dated_filename(trace_name, "retroarch-trace",
+                  "json", sizeof(trace_name));
+            if (string_is_empty(log_dir))
+               strlcpy(trace_path, trace_name, sizeof(trace_path));
+            else
+               fill_pathname_join_special(trace_path, log_dir,
+                     trace_name, sizeof(trace_path));
+
+            if ((ret = performance_trace_dump(trace_path,
+                        PERF_TRACE_DUMP_SECONDS)) > 0)
+            {
+               char msg[PATH_MAX_LENGTH + 64];
+               size_t _len = snprintf(msg, sizeof(msg), "%s: \"%s\"",
+                     msg_hash_to_str(MSG_PERF_TRACE_SAVED), trace_path);
+               runloop_msg_queue_push(msg, _len, 1, 180, true, NULL,
+                     MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_SUCCESS);
+            }
+            else if (ret == 0)
+            {
+               const char *_msg = msg_hash_to_str(MSG_PERF_TRACE_EMPTY);
+               runloop_msg_queue_push(_msg, strlen(_msg), 1, 180, true, NULL,
+                     MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_WARNING);
+            }
+         }
+         break;
       case CMD_EVENT_OVERLAY_NEXT:
          /* Switch to the next available overlay screen. */
 #ifdef HAVE_OVERLAY
@@ -5948,6 +5985,7 @@ void main_exit(void *args)
       RARCH_LOG("[PERF] Performance counters (RetroArch):\n");
       runloop_log_counters(p_rarch->perf_counters_rarch, p_rarch->perf_ptr_rarch);
    }
+   performance_trace_deinit();
 
 #if defined(HAVE_LOGGER) && !defined(ANDROID)
    logger_shutdown();
@@ -6218,6 +6256,11 @@ int rarch_main(int argc, char *argv[], void *data)
    main_exit(data);
 #endif
 
+#ifdef HAVE_BSV_MOVIE
+   /* Lets scripts running --verify-replay over many replays spot desyncs */
+   if (input_state_get_ptr()->bsv_movie_state.flags & BSV_FLAG_MOVIE_DESYNC)
+      return 1;
+#endif
    return 0;
 }
 
@@ -6821,6 +6864,12 @@ static void retroarch_print_help(const char *arg0)
          "Start recording a replay file from the beginning.\n"
          "      --eof-exit                 "
          "Exit upon reaching the end of the replay file.\n"
+         "      --verify-replay            "
+         "Play back the replay given with -P as fast as possible,\n"
+         "                                 "
+         "comparing the core against every checkpoint. Exits at the end\n"
+         "                                 "
+         "with a nonzero status if any desynced.\n"
          , sizeof(buf) - _len);
 #endif
 
@@ -7169,6 +7218,7 @@ static bool retroarch_parse_input_and_config(
       { "max-frames-ss",      0, NULL, RA_OPT_MAX_FRAMES_SCREENSHOT },
       { "max-frames-ss-path", 1, NULL, RA_OPT_MAX_FRAMES_SCREENSHOT_PATH },
       { "eof-exit",           0, NULL, RA_OPT_EOF_EXIT },
+      { "verify-replay",      0, NULL, RA_OPT_VERIFY_REPLAY },
       { "version",            0, NULL, 'V' /* RA_OPT_VERSION */ },
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
       { "accessibility",      0, NULL, RA_OPT_ACCESSIBILITY},
@@ -7734,6 +7784,16 @@ static bool retroarch_parse_input_and_config(
 #endif
                break;
 
+            case RA_OPT_VERIFY_REPLAY:
+#ifdef HAVE_BSV_MOVIE
+               {
+                  input_driver_state_t *input_st   = input_state_get_ptr();
+                  input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_VERIFY
+                                                   | BSV_FLAG_MOVIE_EOF_EXIT;
+               }
+#endif
+               break;
+
             case 'h':
             case 'V':
             case RA_OPT_VERSION:
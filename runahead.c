@@ -29,9 +29,13 @@
 #endif
 
 #include <encodings/utf.h>
+#include <lists/string_list.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 #include <time/rtime.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "configuration.h"
 #include "content.h"
@@ -44,19 +48,16 @@
 #include "runloop.h"
 #include "verbosity.h"
 
-static int16_t input_state_get_last(unsigned port,
-      unsigned device, unsigned index, unsigned id)
+static int16_t input_state_list_get(const my_list *list,
+      unsigned port, unsigned device, unsigned index, unsigned id)
 {
-   runloop_state_t      *runloop_st = runloop_state_get_ptr();
-
-   if (runloop_st->input_state_list)
+   if (list)
    {
       int i;
       /* find list item */
-      for (i = 0; i < runloop_st->input_state_list->size; i++)
+      for (i = 0; i < list->size; i++)
       {
-         input_list_element *element =
-            (input_list_element*)runloop_st->input_state_list->data[i];
+         input_list_element *element = (input_list_element*)list->data[i];
 
          if (     (element->port   == port)
                && (element->device == device)
@@ -72,6 +73,13 @@ static int16_t input_state_get_last(unsigned port,
    return 0;
 }
 
+static int16_t input_state_get_last(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   return input_state_list_get(runloop_state_get_ptr()->input_state_list,
+         port, device, index, id);
+}
+
 static void free_retro_ctx_load_content_info(struct
       retro_ctx_load_content_info *dest)
 {
@@ -146,6 +154,12 @@ void runahead_set_load_content_info(void *data,
 
 /* RUNAHEAD - SECONDARY CORE  */
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+#ifdef HAVE_THREADS
+static bool runahead_secondary_thread_environment(
+      struct runahead_secondary_thread *thread, unsigned cmd, void *data);
+static void runahead_secondary_thread_stop(runloop_state_t *runloop_st);
+#endif
+
 static void strcat_alloc(char **dst, const char *s)
 {
    size_t _len;
@@ -186,6 +200,10 @@ void runahead_secondary_core_destroy(void *data)
    if (!runloop_st->secondary_lib_handle)
       return;
 
+#ifdef HAVE_THREADS
+   runahead_secondary_thread_stop(runloop_st);
+#endif
+
    /* unload game from core */
    if (runloop_st->secondary_core.retro_unload_game)
       runloop_st->secondary_core.retro_unload_game();
@@ -389,7 +407,13 @@ static bool runloop_environment_secondary_core_hook(
       unsigned cmd, void *data)
 {
    runloop_state_t *runloop_st    = runloop_state_get_ptr();
-   bool result                    = runloop_environment_cb(cmd, data);
+   bool result;
+#ifdef HAVE_THREADS
+   if (runloop_st->secondary_thread)
+      return runahead_secondary_thread_environment(
+            runloop_st->secondary_thread, cmd, data);
+#endif
+   result                         = runloop_environment_cb(cmd, data);
 
    if (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE)
    {
@@ -602,11 +626,15 @@ void runahead_remember_controller_port_device(void *data,
       runloop_st->port_map[port] = (int)device;
    if (     runloop_st->secondary_lib_handle
          && runloop_st->secondary_core.retro_set_controller_port_device)
+   {
+      runahead_secondary_core_sync(runloop_st);
       runloop_st->secondary_core.retro_set_controller_port_device((unsigned)port, (unsigned)device);
+   }
 }
 
 #else
 void runahead_secondary_core_destroy(void *data) { }
+void runahead_secondary_core_sync(void *data) { }
 #endif
 
 static void mylist_resize(my_list *list,
@@ -961,6 +989,10 @@ static void runahead_remove_hooks(runloop_state_t *runloop_st)
 
 static void runahead_destroy(runloop_state_t *runloop_st)
 {
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+   /* The secondary thread may still be loading slot 0 */
+   runahead_secondary_thread_stop(runloop_st);
+#endif
    mylist_destroy(&runloop_st->runahead_save_state_list);
    runahead_remove_hooks(runloop_st);
    runahead_clear_variables(runloop_st);
@@ -1010,10 +1042,14 @@ static void runahead_add_hooks(runloop_state_t *runloop_st)
 
 static void runahead_err(runloop_state_t *runloop_st)
 {
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+   runahead_secondary_thread_stop(runloop_st);
+#endif
    runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_AVAILABLE;
    mylist_destroy(&runloop_st->runahead_save_state_list);
    runahead_remove_hooks(runloop_st);
    runloop_st->runahead_save_state_size       = 0;
+   runloop_st->runahead_ring_frames           = 0;
    runloop_st->flags                         |= RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN;
 }
 
@@ -1038,17 +1074,19 @@ static bool runahead_create(runloop_state_t *runloop_st)
 
    runahead_add_hooks(runloop_st);
    runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+   runloop_st->runahead_ring_base   = 0;
+   runloop_st->runahead_ring_frames = 0;
    if (runloop_st->runahead_save_state_list)
       mylist_resize(runloop_st->runahead_save_state_list, 1, true);
    return true;
 }
 
-static bool runahead_save_state(runloop_state_t *runloop_st)
+static bool runahead_save_state(runloop_state_t *runloop_st, size_t slot)
 {
    if (runloop_st->runahead_save_state_list)
    {
       retro_ctx_serialize_info_t *serialize_info =
-         (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
+         (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[slot];
       if (core_serialize_special(serialize_info))
          return true;
       runahead_err(runloop_st);
@@ -1056,11 +1094,11 @@ static bool runahead_save_state(runloop_state_t *runloop_st)
    return false;
 }
 
-static bool runahead_load_state(runloop_state_t *runloop_st)
+static bool runahead_load_state(runloop_state_t *runloop_st, size_t slot)
 {
    retro_ctx_serialize_info_t *serialize_info =
       (retro_ctx_serialize_info_t*)
-      runloop_st->runahead_save_state_list->data[0];
+      runloop_st->runahead_save_state_list->data[slot];
    bool last_dirty                            = (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY) ? true : false;
    bool ret                                   = core_unserialize_special(serialize_info);
    if (last_dirty)
@@ -1092,6 +1130,528 @@ static bool runahead_load_state_secondary(runloop_state_t *runloop_st, settings_
 }
 #endif
 
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+/* Secondary core on its own thread.
+ *
+ * The thread runs one frame behind the main instance: while the main
+ * instance runs a frame, the thread catches up from the state handed
+ * over after the previous one and renders the next frame to show.
+ * The main thread only touches the secondary core and the job fields
+ * below while the thread is idle. */
+typedef struct runahead_secondary_thread
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   /* Last input of the main instance when the job was posted */
+   my_list *input_state_list;
+   /* Slot 0 of runahead_save_state_list, if the job loads it */
+   const void *state;
+   size_t state_size;
+   /* Core option values as of the last job and the answers to the
+    * other lookups the thread serves, all taken on the main thread
+    * since runloop_environment_cb may only be called from there */
+   struct string_list *variable_keys;
+   struct string_list *variable_values;
+   struct retro_log_callback log_cb;
+   const char *system_dir;
+   const char *save_dir;
+   unsigned language;
+   unsigned options_version;
+   bool can_dupe;
+   bool has_log_cb;
+   bool has_system_dir;
+   bool has_save_dir;
+   bool has_language;
+   bool has_options_version;
+   bool has_can_dupe;
+   bool has_input_bitmasks;
+   /* Copy of the frame rendered by the job's last run */
+   uint8_t *frame;
+   size_t frame_cap;
+   size_t frame_pitch;
+   unsigned frame_width;
+   unsigned frame_height;
+   int frames;
+   bool load;
+   bool loading;
+   bool capture;
+   bool has_frame;
+   bool frame_dupe;
+   bool variable_update;
+   bool posted;
+   bool ok;
+   bool busy;
+   bool quit;
+} runahead_secondary_thread_t;
+
+static void input_state_list_copy(my_list *dst, const my_list *src)
+{
+   int i;
+
+   mylist_resize(dst, src ? src->size : 0, true);
+
+   for (i = 0; i < dst->size; i++)
+   {
+      input_list_element *from = (input_list_element*)src->data[i];
+      input_list_element *to   = (input_list_element*)dst->data[i];
+
+      to->port                 = from->port;
+      to->device               = from->device;
+      to->index                = from->index;
+      input_list_element_realloc(to, from->state_size);
+      memcpy(to->state, from->state, from->state_size * sizeof(int16_t));
+      if (to->state_size > from->state_size)
+         memset(&to->state[from->state_size], 0,
+               (to->state_size - from->state_size) * sizeof(int16_t));
+   }
+}
+
+static int16_t runahead_secondary_thread_input_state(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   runloop_state_t *runloop_st = runloop_state_get_ptr();
+   return input_state_list_get(
+         runloop_st->secondary_thread->input_state_list,
+         port, device, index, id);
+}
+
+static void runahead_secondary_thread_frame(const void *data,
+      unsigned width, unsigned height, size_t pitch)
+{
+   runahead_secondary_thread_t *thread =
+      runloop_state_get_ptr()->secondary_thread;
+   size_t _len                         = pitch * height;
+
+   if (!thread->capture)
+      return;
+
+   thread->has_frame    = true;
+   thread->frame_dupe   = !data;
+   thread->frame_width  = width;
+   thread->frame_height = height;
+   thread->frame_pitch  = pitch;
+
+   if (!data)
+      return;
+
+   if (thread->frame_cap < _len)
+   {
+      uint8_t *frame = (uint8_t*)realloc(thread->frame, _len);
+      if (!frame)
+      {
+         thread->has_frame = false;
+         return;
+      }
+      thread->frame     = frame;
+      thread->frame_cap = _len;
+   }
+   memcpy(thread->frame, data, _len);
+}
+
+static void runahead_secondary_thread_audio_sample(
+      int16_t left, int16_t right) { }
+
+static size_t runahead_secondary_thread_audio_sample_batch(
+      const int16_t *data, size_t frames)
+{
+   return frames;
+}
+
+static bool runahead_secondary_thread_environment(
+      runahead_secondary_thread_t *thread, unsigned cmd, void *data)
+{
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         if (data)
+            *(bool*)data         = thread->variable_update;
+         thread->variable_update = false;
+         return true;
+      case RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT:
+         if (data)
+            *(int*)data          = thread->loading
+               ? RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_BINARY
+               : RETRO_SAVESTATE_CONTEXT_NORMAL;
+         return true;
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         if (data)
+         {
+            int result = RETRO_AV_ENABLE_HARD_DISABLE_AUDIO;
+            if (thread->capture)
+               result |= RETRO_AV_ENABLE_VIDEO;
+            if (thread->loading)
+               result |= RETRO_AV_ENABLE_FAST_SAVESTATES;
+            *(enum retro_av_enable_flags*)data =
+               (enum retro_av_enable_flags)result;
+         }
+         return true;
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         {
+            size_t i;
+            struct retro_variable *var = (struct retro_variable*)data;
+            if (!var)
+               return true;
+            var->value = NULL;
+            if (!thread->variable_keys || string_is_empty(var->key))
+               return true;
+            for (i = 0; i < thread->variable_keys->size; i++)
+            {
+               if (string_is_equal(var->key,
+                        thread->variable_keys->elems[i].data))
+               {
+                  var->value = thread->variable_values->elems[i].data;
+                  break;
+               }
+            }
+         }
+         return true;
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+         if (thread->has_log_cb)
+            *(struct retro_log_callback*)data = thread->log_cb;
+         return thread->has_log_cb;
+      case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+         if (thread->has_system_dir)
+            *(const char**)data = thread->system_dir;
+         return thread->has_system_dir;
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+         if (thread->has_save_dir)
+            *(const char**)data = thread->save_dir;
+         return thread->has_save_dir;
+      case RETRO_ENVIRONMENT_GET_LANGUAGE:
+         if (thread->has_language)
+            *(unsigned*)data = thread->language;
+         return thread->has_language;
+      case RETRO_ENVIRONMENT_GET_CORE_OPTIONS_VERSION:
+         if (thread->has_options_version)
+            *(unsigned*)data = thread->options_version;
+         return thread->has_options_version;
+      case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+         if (thread->has_can_dupe)
+            *(bool*)data = thread->can_dupe;
+         return thread->has_can_dupe;
+      case RETRO_ENVIRONMENT_GET_INPUT_BITMASKS:
+         return thread->has_input_bitmasks;
+      default:
+         break;
+   }
+
+   /* Everything else is left to the main instance */
+   return false;
+}
+
+/* Copies the current value of every core option for GET_VARIABLE */
+static void runahead_secondary_thread_snapshot_variables(
+      runloop_state_t *runloop_st, runahead_secondary_thread_t *thread)
+{
+   size_t i;
+   union string_list_elem_attr attr;
+   core_option_manager_t *opts = runloop_st->core_options;
+
+   attr.i = 0;
+   if (thread->variable_keys)
+      string_list_free(thread->variable_keys);
+   if (thread->variable_values)
+      string_list_free(thread->variable_values);
+   thread->variable_keys   = NULL;
+   thread->variable_values = NULL;
+
+   if (     !opts
+         || !(thread->variable_keys   = string_list_new())
+         || !(thread->variable_values = string_list_new()))
+      return;
+
+   for (i = 0; i < opts->size; i++)
+   {
+      const char *val = core_option_manager_get_val(opts, i);
+      if (     string_is_empty(opts->opts[i].key)
+            || !val)
+         continue;
+      if (     !string_list_append(thread->variable_keys,
+                  opts->opts[i].key, attr)
+            || !string_list_append(thread->variable_values, val, attr))
+      {
+         string_list_free(thread->variable_keys);
+         string_list_free(thread->variable_values);
+         thread->variable_keys   = NULL;
+         thread->variable_values = NULL;
+         return;
+      }
+   }
+}
+
+/* Asks the main instance's environment once for everything else
+ * the thread answers itself */
+static void runahead_secondary_thread_snapshot_environment(
+      runahead_secondary_thread_t *thread)
+{
+   thread->has_log_cb          = runloop_environment_cb(
+         RETRO_ENVIRONMENT_GET_LOG_INTERFACE, &thread->log_cb);
+   thread->has_system_dir      = runloop_environment_cb(
+         RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &thread->system_dir);
+   thread->has_save_dir        = runloop_environment_cb(
+         RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY, &thread->save_dir);
+   thread->has_language        = runloop_environment_cb(
+         RETRO_ENVIRONMENT_GET_LANGUAGE, &thread->language);
+   thread->has_options_version = runloop_environment_cb(
+         RETRO_ENVIRONMENT_GET_CORE_OPTIONS_VERSION,
+         &thread->options_version);
+   thread->has_can_dupe        = runloop_environment_cb(
+         RETRO_ENVIRONMENT_GET_CAN_DUPE, &thread->can_dupe);
+   thread->has_input_bitmasks  = runloop_environment_cb(
+         RETRO_ENVIRONMENT_GET_INPUT_BITMASKS, NULL);
+}
+
+static void runahead_secondary_thread_loop(void *data)
+{
+   runahead_secondary_thread_t *thread = (runahead_secondary_thread_t*)data;
+   struct retro_core_t *secondary_core = &runloop_state_get_ptr()->secondary_core;
+
+   for (;;)
+   {
+      int i;
+
+      slock_lock(thread->lock);
+      while (!thread->busy && !thread->quit)
+         scond_wait(thread->cond, thread->lock);
+      if (thread->quit)
+      {
+         slock_unlock(thread->lock);
+         break;
+      }
+      slock_unlock(thread->lock);
+
+      thread->ok = true;
+      if (thread->load)
+      {
+         thread->loading = true;
+         thread->ok      = secondary_core->retro_unserialize(
+               thread->state, thread->state_size);
+         thread->loading = false;
+      }
+
+      for (i = 0; thread->ok && i < thread->frames; i++)
+      {
+         thread->capture = (i == thread->frames - 1);
+         secondary_core->retro_run();
+      }
+      thread->capture = false;
+
+      slock_lock(thread->lock);
+      thread->busy = false;
+      scond_signal(thread->cond);
+      slock_unlock(thread->lock);
+   }
+}
+
+static bool runahead_secondary_thread_wait(runahead_secondary_thread_t *thread)
+{
+   slock_lock(thread->lock);
+   while (thread->busy)
+      scond_wait(thread->cond, thread->lock);
+   slock_unlock(thread->lock);
+   return thread->ok;
+}
+
+static void runahead_secondary_thread_stop(runloop_state_t *runloop_st)
+{
+   runahead_secondary_thread_t *thread = runloop_st->secondary_thread;
+   struct retro_core_t *secondary_core = &runloop_st->secondary_core;
+
+   if (!thread)
+      return;
+
+   if (thread->thread)
+   {
+      runahead_secondary_thread_wait(thread);
+      slock_lock(thread->lock);
+      thread->quit = true;
+      scond_signal(thread->cond);
+      slock_unlock(thread->lock);
+      sthread_join(thread->thread);
+   }
+
+   if (secondary_core->retro_set_video_refresh)
+   {
+      secondary_core->retro_set_video_refresh(
+            runloop_st->secondary_callbacks.frame_cb);
+      secondary_core->retro_set_audio_sample(
+            runloop_st->secondary_callbacks.sample_cb);
+      secondary_core->retro_set_audio_sample_batch(
+            runloop_st->secondary_callbacks.sample_batch_cb);
+      secondary_core->retro_set_input_state(
+            runloop_st->secondary_callbacks.state_cb);
+      secondary_core->retro_set_input_poll(
+            runloop_st->secondary_callbacks.poll_cb);
+   }
+
+   mylist_destroy(&thread->input_state_list);
+   if (thread->variable_keys)
+      string_list_free(thread->variable_keys);
+   if (thread->variable_values)
+      string_list_free(thread->variable_values);
+   if (thread->cond)
+      scond_free(thread->cond);
+   if (thread->lock)
+      slock_free(thread->lock);
+   free(thread->frame);
+   free(thread);
+   runloop_st->secondary_thread = NULL;
+}
+
+static runahead_secondary_thread_t *runahead_secondary_thread_start(
+      runloop_state_t *runloop_st)
+{
+   struct retro_core_t *secondary_core = &runloop_st->secondary_core;
+   runahead_secondary_thread_t *thread = (runahead_secondary_thread_t*)
+      calloc(1, sizeof(*thread));
+
+   if (!thread)
+      return NULL;
+
+   /* The callbacks below find the thread through the runloop */
+   runloop_st->secondary_thread = thread;
+   thread->ok                   = true;
+
+   if (     !(thread->lock = slock_new())
+         || !(thread->cond = scond_new()))
+      goto error;
+
+   mylist_create(&thread->input_state_list, 16,
+         input_list_element_constructor,
+         input_list_element_destructor);
+   runahead_secondary_thread_snapshot_environment(thread);
+
+   secondary_core->retro_set_video_refresh(
+         runahead_secondary_thread_frame);
+   secondary_core->retro_set_audio_sample(
+         runahead_secondary_thread_audio_sample);
+   secondary_core->retro_set_audio_sample_batch(
+         runahead_secondary_thread_audio_sample_batch);
+   secondary_core->retro_set_input_state(
+         runahead_secondary_thread_input_state);
+   secondary_core->retro_set_input_poll(
+         secondary_core_input_poll_null);
+
+   if (!(thread->thread = sthread_create(
+               runahead_secondary_thread_loop, thread)))
+      goto error;
+
+   return thread;
+
+error:
+   runahead_secondary_thread_stop(runloop_st);
+   return NULL;
+}
+
+/**
+ * runahead_secondary_thread_run:
+ *
+ * Runs the main instance for this frame, shows the frame rendered
+ * by the thread meanwhile and hands it the next job.
+ *
+ * @return false if the thread couldn't be started, in which case
+ * nothing has been run.
+ **/
+static bool runahead_secondary_thread_run(runloop_state_t *runloop_st,
+      int runahead_count)
+{
+   const char *_msg                    = NULL;
+   video_driver_state_t *video_st      = video_state_get_ptr();
+   runahead_secondary_thread_t *thread = runloop_st->secondary_thread;
+   bool show_main;
+
+   if (!thread && !(thread = runahead_secondary_thread_start(runloop_st)))
+      return false;
+
+   /* Until the thread has caught up with the current state,
+    * show the main instance's frame instead */
+   show_main = !thread->posted
+      || (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY);
+
+   if (!show_main)
+      video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+   core_run();
+   if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
+      video_st->flags |=  VIDEO_FLAG_ACTIVE;
+   else
+      video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+
+   if (!runahead_secondary_thread_wait(thread))
+   {
+      _msg = msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE);
+      runahead_secondary_core_destroy(runloop_st);
+      runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
+      runahead_err(runloop_st);
+      goto error;
+   }
+
+   if (!show_main && thread->has_frame)
+      video_driver_frame(thread->frame_dupe ? NULL : thread->frame,
+            thread->frame_width, thread->frame_height, thread->frame_pitch);
+   thread->has_frame = false;
+
+   if (     (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY)
+         || (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY))
+   {
+      retro_ctx_serialize_info_t *serialize_info;
+
+      runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+
+      if (!runahead_save_state(runloop_st, 0))
+      {
+         _msg = msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
+         goto error;
+      }
+
+      serialize_info     = (retro_ctx_serialize_info_t*)
+         runloop_st->runahead_save_state_list->data[0];
+      thread->state      = serialize_info->data_const;
+      thread->state_size = serialize_info->size;
+      thread->load       = true;
+      thread->frames     = runahead_count;
+   }
+   else
+   {
+      thread->load       = false;
+      thread->frames     = 1;
+   }
+
+   input_state_list_copy(thread->input_state_list,
+         runloop_st->input_state_list);
+   if (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE)
+   {
+      runahead_secondary_thread_snapshot_variables(runloop_st, thread);
+      thread->variable_update = true;
+      runloop_st->flags      &= ~RUNLOOP_FLAG_HAS_VARIABLE_UPDATE;
+   }
+   else if (!thread->variable_keys)
+      runahead_secondary_thread_snapshot_variables(runloop_st, thread);
+
+   slock_lock(thread->lock);
+   thread->busy   = true;
+   thread->posted = true;
+   scond_signal(thread->cond);
+   slock_unlock(thread->lock);
+   return true;
+
+error:
+   runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
+         MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+   RARCH_WARN("[Run-Ahead] %s\n", _msg);
+   return true;
+}
+
+void runahead_secondary_core_sync(void *data)
+{
+   runloop_state_t *runloop_st = (runloop_state_t*)data;
+   if (runloop_st->secondary_thread)
+      runahead_secondary_thread_wait(runloop_st->secondary_thread);
+}
+#elif defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+void runahead_secondary_core_sync(void *data) { }
+#endif
+
 static void runahead_core_run_use_last_input(runloop_state_t *runloop_st)
 {
    struct retro_callbacks *cbs            = &runloop_st->retro_ctx;
@@ -1183,8 +1743,32 @@ void runahead_run(void *data,
          || !have_dynamic
          || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE))
    {
-      /* TODO: multiple savestates for higher performance
-       * when not using secondary core */
+      /* The states after the last real frame and after each
+       * run-ahead frame are kept in a ring of savestates.
+       * While input doesn't change, the real frame repeats the
+       * first run-ahead frame of the previous chain, so the chain
+       * carries on from its newest state and only the last
+       * run-ahead frame has to be run. */
+      size_t slots     = (size_t)runahead_count + 1;
+      bool reuse_chain;
+
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+      /* The secondary thread may still be loading slot 0, which
+       * is about to be overwritten */
+      if (runloop_st->secondary_thread)
+      {
+         runahead_secondary_thread_stop(runloop_st);
+         runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+      }
+#endif
+
+      reuse_chain      = runahead_count > 1
+         && runloop_st->runahead_ring_frames == runahead_count;
+
+      if ((size_t)runloop_st->runahead_save_state_list->size < slots)
+         mylist_resize(runloop_st->runahead_save_state_list,
+               (int)slots, true);
+
       for (frame_number = 0; frame_number <= runahead_count; frame_number++)
       {
          last_frame      = frame_number == runahead_count;
@@ -1213,20 +1797,50 @@ void runahead_run(void *data,
 
          if (frame_number == 0)
          {
-            if (!runahead_save_state(runloop_st))
+            if (     reuse_chain
+                  && !(runloop_st->flags & (RUNLOOP_FLAG_INPUT_IS_DIRTY
+                        | RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY)))
             {
-               const char *_msg =
-                  msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
-               runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
-                     MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-               RARCH_WARN("[Run-Ahead] %s\n", _msg);
-               return;
+               /* This frame's state is the next slot; resume from
+                * the newest one and run only the last frame */
+               size_t head = (runloop_st->runahead_ring_base
+                     + runahead_count) % slots;
+               runloop_st->runahead_ring_base =
+                  (runloop_st->runahead_ring_base + 1) % slots;
+               if (!runahead_load_state(runloop_st, head))
+               {
+                  const char *_msg = msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE);
+                  runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
+                        MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+                  RARCH_WARN("[Run-Ahead] %s\n", _msg);
+                  return;
+               }
+               frame_number = runahead_count - 1;
+               continue;
             }
+
+            runloop_st->flags               &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+            runloop_st->runahead_ring_base   = 0;
+            runloop_st->runahead_ring_frames = 0;
+         }
+
+         if (     (frame_number == 0 || runahead_count > 1)
+               && !runahead_save_state(runloop_st,
+                  (runloop_st->runahead_ring_base + frame_number) % slots))
+         {
+            const char *_msg =
+               msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
+            runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
+                  MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            RARCH_WARN("[Run-Ahead] %s\n", _msg);
+            return;
          }
 
          if (last_frame)
          {
-            if (!runahead_load_state(runloop_st))
+            runloop_st->runahead_ring_frames = runahead_count;
+            if (!runahead_load_state(runloop_st,
+                     runloop_st->runahead_ring_base))
             {
                const char *_msg = msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE);
                runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
@@ -1252,6 +1866,27 @@ void runahead_run(void *data,
          goto force_input_dirty;
       }
 
+      /* The secondary core reuses slot 0 */
+      runloop_st->runahead_ring_frames = 0;
+
+#ifdef HAVE_THREADS
+      if (     settings->bools.run_ahead_secondary_thread
+            && video_driver_get_hw_context()->context_type
+               == RETRO_HW_CONTEXT_NONE
+            && runahead_secondary_thread_run(runloop_st, runahead_count))
+      {
+         runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+         return;
+      }
+
+      if (runloop_st->secondary_thread)
+      {
+         /* Back to running it on this thread */
+         runahead_secondary_thread_stop(runloop_st);
+         runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+      }
+#endif
+
       /* run main core with video suspended */
       video_st->flags &= ~VIDEO_FLAG_ACTIVE;
       core_run();
@@ -1265,7 +1900,7 @@ void runahead_run(void *data,
       {
          runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
 
-         if (!runahead_save_state(runloop_st))
+         if (!runahead_save_state(runloop_st, 0))
          {
             const char *_msg = msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
             runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
@@ -1692,4 +2327,6 @@ void runahead_clear_variables(void *data)
                                           | RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE
                                           | RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
    runloop_st->runahead_last_frame_count  = 0;
+   runloop_st->runahead_ring_base         = 0;
+   runloop_st->runahead_ring_frames       = 0;
 }
@@ -88,6 +88,10 @@ void runahead_set_load_content_info(
 
 void runahead_secondary_core_destroy(void *data);
 
+/* Waits for a secondary core running on its own thread to go idle,
+ * so it can be called from the main thread. */
+void runahead_secondary_core_sync(void *data);
+
 bool preempt_init(void *data);
 void preempt_deinit(void *data);
 
@@ -219,6 +219,7 @@
 #include "tasks/task_powerstate.h"
 #include "tasks/tasks_internal.h"
 #include "performance_counters.h"
+#include "performance_trace.h"
 
 #include "version.h"
 #include "version_git.h"
@@ -6380,6 +6381,9 @@ static enum runloop_state_enum runloop_check_state(
    /* Check statistics hotkey */
    HOTKEY_CHECK(RARCH_STATISTICS_TOGGLE, CMD_EVENT_STATISTICS_TOGGLE, true, NULL);
 
+   /* Check frame trace dump hotkey */
+   HOTKEY_CHECK(RARCH_PERF_TRACE_DUMP, CMD_EVENT_PERF_TRACE_DUMP, true, NULL);
+
    /* Check netplay host hotkey */
    HOTKEY_CHECK(RARCH_NETPLAY_HOST_TOGGLE, CMD_EVENT_NETPLAY_HOST_TOGGLE, true, NULL);
 
@@ -7425,6 +7429,8 @@ int runloop_iterate(void)
    /* Measure the time between core_run() and video_driver_frame() */
    runloop_st->core_run_time = cpu_features_get_time_usec();
 
+   performance_trace_frame(runloop_st->perfcnt_enable);
+
    {
 #ifdef HAVE_RUNAHEAD
       bool run_ahead_enabled            = settings->bools.run_ahead_enabled;
@@ -7440,13 +7446,21 @@ int runloop_iterate(void)
 #endif
 
       if (want_runahead)
+      {
+         performance_trace_begin(PERF_TRACE_RUNAHEAD);
          runahead_run(
                runloop_st,
                run_ahead_num_frames,
                run_ahead_hide_warnings,
                run_ahead_secondary_instance);
+         performance_trace_end(PERF_TRACE_RUNAHEAD);
+      }
       else if (runloop_st->preempt_data)
+      {
+         performance_trace_begin(PERF_TRACE_RUNAHEAD);
          preempt_run(runloop_st->preempt_data, runloop_st);
+         performance_trace_end(PERF_TRACE_RUNAHEAD);
+      }
       else
 #endif
          core_run();
@@ -7472,7 +7486,11 @@ int runloop_iterate(void)
    if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_END)
    {
       movie_stop_playback(input_st);
-      command_event(CMD_EVENT_PAUSE, NULL);
+      /* Keep the end flag so the next iteration quits */
+      if (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_EOF_EXIT)
+         input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
+      else
+         command_event(CMD_EVENT_PAUSE, NULL);
    }
 #endif
 
@@ -7490,6 +7508,7 @@ end:
          if (runloop_st->fastforward_after_frames == 1)
          {
             /* Nonblocking audio */
+            audio_driver_processing_thread_drain();
             if (    (audio_st->flags & AUDIO_FLAG_ACTIVE)
                  && (audio_st->context_audio_data))
                audio_st->current_audio->set_nonblock_state(
@@ -7503,6 +7522,7 @@ end:
          if (runloop_st->fastforward_after_frames == 6)
          {
             /* Blocking audio */
+            audio_driver_processing_thread_drain();
             if (     (audio_st->flags & AUDIO_FLAG_ACTIVE)
                   && (audio_st->context_audio_data))
                audio_st->current_audio->set_nonblock_state(
@@ -7846,8 +7866,11 @@ bool core_set_cheat(retro_ctx_cheat_info_t *info)
          && (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE)
          && (secondary_core_ensure_exists(runloop_st, settings))
          && (runloop_st->secondary_core.retro_cheat_set))
+   {
+      runahead_secondary_core_sync(runloop_st);
       runloop_st->secondary_core.retro_cheat_set(
             info->index, info->enabled, info->code);
+   }
 #endif
 
    return true;
@@ -7886,7 +7909,10 @@ bool core_reset_cheat(void)
        && (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE)
        && (secondary_core_ensure_exists(runloop_st, settings))
        && (runloop_st->secondary_core.retro_cheat_reset))
+   {
+      runahead_secondary_core_sync(runloop_st);
       runloop_st->secondary_core.retro_cheat_reset();
+   }
 #endif
 
    return true;
@@ -8108,6 +8134,8 @@ void core_run(void)
    }
 #endif
 
+   performance_trace_begin(PERF_TRACE_CORE_RUN);
+
    if (early_polling)
       input_driver_poll();
    else if (late_polling)
@@ -8135,6 +8163,8 @@ void core_run(void)
          && (!(current_core->flags & RETRO_CORE_FLAG_INPUT_POLLED)))
       input_driver_poll();
 
+   performance_trace_end(PERF_TRACE_CORE_RUN);
+
 #ifdef HAVE_NETWORKING
    netplay_driver_ctl(RARCH_NETPLAY_CTL_POST_FRAME, NULL);
 #endif
@@ -207,6 +207,9 @@ struct runloop
       retro_unserialize_callback_original;               /* ptr alignment */
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    struct retro_callbacks secondary_callbacks;           /* ptr alignment */
+#ifdef HAVE_THREADS
+   struct runahead_secondary_thread *secondary_thread;   /* ptr alignment */
+#endif
 #endif
 #endif
 #ifdef HAVE_THREADS
@@ -234,6 +237,8 @@ struct runloop
    dylib_t secondary_lib_handle;                         /* ptr alignment */
 #endif
    size_t runahead_save_state_size;
+   /* Slot of runahead_save_state_list holding the last real frame */
+   size_t runahead_ring_base;
 #endif
    size_t msg_queue_size;
 
@@ -241,6 +246,8 @@ struct runloop
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    int port_map[MAX_USERS];
 #endif
+   /* Run-ahead frames saved after the base slot, 0 if none are valid */
+   int runahead_ring_frames;
 #endif
 
    runloop_core_status_msg_t core_status_msg;
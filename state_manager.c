@@ -24,6 +24,7 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
 
@@ -33,6 +34,7 @@
 #include "core_info.h"
 #include "retroarch.h"
 #include "verbosity.h"
+#include "performance_trace.h"
 #include "content.h"
 #include "audio/audio_driver.h"
 
@@ -40,6 +42,10 @@
 #include "network/netplay/netplay.h"
 #endif
 
+#ifdef HAVE_STATESTREAM
+#include "input/bsv/uint32s_index.h"
+#endif
+
 /* This makes Valgrind throw errors if a core overflows its savestate size. */
 /* Keep it off unless you're chasing a core bug, it slows things down. */
 #define STRICT_BUF_SIZE 0
@@ -369,6 +375,16 @@ static void state_manager_free(state_manager_t *state)
    if (state->debugblock)
       free(state->debugblock);
    state->debugblock = NULL;
+#endif
+#ifdef HAVE_STATESTREAM
+   uint32s_index_free(state->blocks);
+   uint32s_index_free(state->superblocks);
+   free(state->seqs);
+   free(state->scratch);
+   state->blocks      = NULL;
+   state->superblocks = NULL;
+   state->seqs        = NULL;
+   state->scratch     = NULL;
 #endif
    state->data       = NULL;
    state->thisblock  = NULL;
@@ -427,6 +443,261 @@ error:
    return NULL;
 }
 
+#ifdef HAVE_STATESTREAM
+/* Deduplicating backend.
+ *
+ * Every pushed state is cut into blocks, which are interned in a
+ * uint32s_index; runs of blocks (superblocks) are interned the same way,
+ * so an entry is just its sequence of superblock indices.  An entry holds
+ * one reference on each of its superblocks and a superblock one on each
+ * of its blocks, so dropping the oldest entry frees exactly the data no
+ * newer entry shares.  States that keep returning to the same contents
+ * (menus, idle loops, level restarts) then cost almost nothing, and any
+ * entry can be restored without replaying a chain of patches. */
+#define STATE_MGR_DEDUP_SUPERBLOCK_SIZE  16      /* blocks per superblock */
+#define STATE_MGR_DEDUP_BLOCK_SIZE       1024    /* bytes */
+#define STATE_MGR_DEDUP_SMALL_BLOCK_SIZE 128     /* bytes, for small states */
+#define STATE_MGR_DEDUP_SMALL_STATE      (8 << 20)
+/* Rough bookkeeping cost of one interned object on top of its data:
+ * object pointer, count, hash and bucket slot. */
+#define STATE_MGR_DEDUP_OBJECT_OVERHEAD  32
+#define STATE_MGR_DEDUP_MIN_ENTRIES      64
+
+#define STATE_MGR_DEDUP_BLOCK_COST(state) \
+   ((state)->blocks->object_size * sizeof(uint32_t) \
+    + STATE_MGR_DEDUP_OBJECT_OVERHEAD)
+#define STATE_MGR_DEDUP_SUPERBLOCK_COST \
+   (STATE_MGR_DEDUP_SUPERBLOCK_SIZE * sizeof(uint32_t) \
+    + STATE_MGR_DEDUP_OBJECT_OVERHEAD)
+
+static uint32_t *state_manager_dedup_entry(state_manager_t *state,
+      size_t i)
+{
+   return state->seqs + ((state->seq_tail + i) % state->seq_cap)
+      * state->superblock_count;
+}
+
+static bool state_manager_dedup_grow(state_manager_t *state)
+{
+   size_t i;
+   size_t new_cap    = state->seq_cap * 2;
+   size_t entry_size = state->superblock_count * sizeof(uint32_t);
+   uint32_t *seqs    = (uint32_t*)malloc(new_cap * entry_size);
+   if (!seqs)
+      return false;
+   for (i = 0; i < state->entries; i++)
+      memcpy(seqs + i * state->superblock_count,
+            state_manager_dedup_entry(state, i), entry_size);
+   free(state->seqs);
+   state->seqs     = seqs;
+   state->seq_cap  = new_cap;
+   state->seq_tail = 0;
+   return true;
+}
+
+static void state_manager_dedup_decode(state_manager_t *state,
+      const uint32_t *seq, uint8_t *out)
+{
+   size_t i, j;
+   size_t block_size = state->blocks->object_size * sizeof(uint32_t);
+   size_t offset     = 0;
+   for (i = 0; i < state->superblock_count; i++)
+   {
+      const uint32_t *superblock = uint32s_index_get(
+            state->superblocks, seq[i]);
+      for (j = 0; j < STATE_MGR_DEDUP_SUPERBLOCK_SIZE
+            && offset < state->state_size; j++, offset += block_size)
+      {
+         const uint32_t *block = uint32s_index_get(
+               state->blocks, superblock[j]);
+         memcpy(out + offset, block,
+               MIN(block_size, state->state_size - offset));
+      }
+   }
+}
+
+static void state_manager_dedup_release(state_manager_t *state,
+      const uint32_t *seq)
+{
+   size_t i, j;
+   uint32_t superblock[STATE_MGR_DEDUP_SUPERBLOCK_SIZE];
+   for (i = 0; i < state->superblock_count; i++)
+   {
+      /* Copy it out first, releasing the last use frees it */
+      memcpy(superblock, uint32s_index_get(state->superblocks, seq[i]),
+            sizeof(superblock));
+      if (!uint32s_index_release(state->superblocks, seq[i]))
+         continue;
+      state->used -= STATE_MGR_DEDUP_SUPERBLOCK_COST;
+      for (j = 0; j < STATE_MGR_DEDUP_SUPERBLOCK_SIZE; j++)
+         if (uint32s_index_release(state->blocks, superblock[j]))
+            state->used -= STATE_MGR_DEDUP_BLOCK_COST(state);
+   }
+}
+
+static void state_manager_dedup_push_do(state_manager_t *state)
+{
+   size_t i, j;
+   uint32_t *seq;
+   const uint32_t *prev_seq = NULL;
+   size_t block_size        = state->blocks->object_size * sizeof(uint32_t);
+   size_t entry_size        = state->superblock_count * sizeof(uint32_t);
+
+   if (state->entries == state->seq_cap && !state_manager_dedup_grow(state))
+   {
+      state_manager_dedup_release(state, state_manager_dedup_entry(state, 0));
+      state->used    -= entry_size;
+      state->seq_tail = (state->seq_tail + 1) % state->seq_cap;
+      state->entries--;
+   }
+
+   if (state->thisblock_valid && state->entries)
+      prev_seq = state_manager_dedup_entry(state, state->entries - 1);
+   seq = state_manager_dedup_entry(state, state->entries);
+
+   for (i = 0; i < state->superblock_count; i++)
+   {
+      uint32_t superblock[STATE_MGR_DEDUP_SUPERBLOCK_SIZE];
+      uint32_t hashes[STATE_MGR_DEDUP_SUPERBLOCK_SIZE];
+      bool same[STATE_MGR_DEDUP_SUPERBLOCK_SIZE];
+      const uint32_t *prev_superblock = prev_seq
+         ? uint32s_index_get(state->superblocks, prev_seq[i]) : NULL;
+      size_t base                     = i * STATE_MGR_DEDUP_SUPERBLOCK_SIZE
+         * block_size;
+      bool all_same                   = prev_superblock != NULL;
+      uint32s_insert_result_t result;
+
+      for (j = 0; j < STATE_MGR_DEDUP_SUPERBLOCK_SIZE; j++)
+      {
+         size_t offset = base + j * block_size;
+         size_t len;
+         if (offset >= state->state_size)
+         {
+            same[j] = true;
+            continue;
+         }
+         len = MIN(block_size, state->state_size - offset);
+         if (len == block_size)
+            same[j] = uint32s_hash_compare(
+                  (const uint32_t*)(state->nextblock + offset),
+                  prev_superblock
+                  ? (const uint32_t*)(state->thisblock + offset) : NULL,
+                  block_size, &hashes[j]);
+         else
+         {
+            /* The last block is zero-padded so it hashes like any other */
+            memset(state->scratch, 0, block_size);
+            memcpy(state->scratch, state->nextblock + offset, len);
+            uint32s_hash_compare(state->scratch, NULL, block_size, &hashes[j]);
+            same[j] = prev_superblock && memcmp(state->nextblock + offset,
+                  state->thisblock + offset, len) == 0;
+         }
+         all_same = all_same && same[j];
+      }
+
+      if (all_same)
+      {
+         seq[i] = prev_seq[i];
+         uint32s_index_bump_count(state->superblocks, seq[i]);
+         continue;
+      }
+
+      for (j = 0; j < STATE_MGR_DEDUP_SUPERBLOCK_SIZE; j++)
+      {
+         size_t offset = base + j * block_size;
+         uint32_t *block;
+         if (offset >= state->state_size)
+         {
+            superblock[j] = 0;
+            continue;
+         }
+         if (prev_superblock && same[j])
+         {
+            superblock[j] = prev_superblock[j];
+            uint32s_index_bump_count(state->blocks, superblock[j]);
+            continue;
+         }
+         block = (uint32_t*)(state->nextblock + offset);
+         if (state->state_size - offset < block_size)
+         {
+            memset(state->scratch, 0, block_size);
+            memcpy(state->scratch, block, state->state_size - offset);
+            block = state->scratch;
+         }
+         result        = uint32s_index_insert_hashed(state->blocks,
+               block, hashes[j], 0);
+         superblock[j] = result.index;
+         if (result.is_new)
+            state->used += STATE_MGR_DEDUP_BLOCK_COST(state);
+      }
+
+      result = uint32s_index_insert(state->superblocks, superblock, 0);
+      seq[i] = result.index;
+      if (result.is_new)
+         state->used += STATE_MGR_DEDUP_SUPERBLOCK_COST;
+      else /* the superblock we matched already holds its blocks */
+         for (j = 0; j < STATE_MGR_DEDUP_SUPERBLOCK_SIZE; j++)
+            uint32s_index_release(state->blocks, superblock[j]);
+   }
+
+   state->used += entry_size;
+   state->entries++;
+
+   /* Always keep the newest entry, even if it alone is over budget */
+   while (state->used > state->capacity && state->entries > 1)
+   {
+      state_manager_dedup_release(state, state_manager_dedup_entry(state, 0));
+      state->used    -= entry_size;
+      state->seq_tail = (state->seq_tail + 1) % state->seq_cap;
+      state->entries--;
+   }
+}
+
+static state_manager_t *state_manager_dedup_new(
+      size_t state_size, size_t buffer_size)
+{
+   size_t block_size, block_count;
+   state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
+
+   if (!state)
+      return NULL;
+
+   block_size              = state_size < STATE_MGR_DEDUP_SMALL_STATE
+      ? STATE_MGR_DEDUP_SMALL_BLOCK_SIZE : STATE_MGR_DEDUP_BLOCK_SIZE;
+   block_count             = (state_size + block_size - 1) / block_size;
+
+   state->state_size       = state_size;
+   state->superblock_count = (block_count
+         + STATE_MGR_DEDUP_SUPERBLOCK_SIZE - 1)
+      / STATE_MGR_DEDUP_SUPERBLOCK_SIZE;
+   state->capacity         = buffer_size;
+   state->seq_cap          = STATE_MGR_DEDUP_MIN_ENTRIES;
+   state->blocks           = uint32s_index_new(
+         block_size / sizeof(uint32_t), 0, 0);
+   state->superblocks      = uint32s_index_new(
+         STATE_MGR_DEDUP_SUPERBLOCK_SIZE, 0, 0);
+   state->seqs             = (uint32_t*)malloc(state->seq_cap
+         * state->superblock_count * sizeof(uint32_t));
+   state->scratch          = (uint32_t*)malloc(block_size);
+   /* Whole blocks are hashed, so round up to one */
+   state->thisblock        = (uint8_t*)calloc(block_count, block_size);
+   state->nextblock        = (uint8_t*)calloc(block_count, block_size);
+
+   if (     !state->blocks || !state->superblocks || !state->seqs
+         || !state->scratch || !state->thisblock || !state->nextblock)
+   {
+      state_manager_free(state);
+      free(state);
+      return NULL;
+   }
+
+   RARCH_LOG("[Rewind] Deduplicating states in %u byte blocks.\n",
+         (unsigned)block_size);
+
+   return state;
+}
+#endif
+
 static bool state_manager_pop(state_manager_t *state, const void **data)
 {
    size_t start;
@@ -435,6 +706,25 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = NULL;
 
+#ifdef HAVE_STATESTREAM
+   if (state->blocks)
+   {
+      uint32_t *seq;
+      *data                     = state->thisblock;
+      if (!state->entries)
+         return false;
+      seq                       = state_manager_dedup_entry(state,
+            state->entries - 1);
+      if (!state->thisblock_valid)
+         state_manager_dedup_decode(state, seq, state->thisblock);
+      state_manager_dedup_release(state, seq);
+      state->used              -= state->superblock_count * sizeof(uint32_t);
+      state->thisblock_valid    = false;
+      state->entries--;
+      return true;
+   }
+#endif
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid    = false;
@@ -464,6 +754,21 @@ static void state_manager_push_where(state_manager_t *state, void **data)
     * pushed state, or we could end up applying a 'patch' to wrong
     * savestate, and that'd blow up rather quickly. */
 
+#ifdef HAVE_STATESTREAM
+   if (state->blocks)
+   {
+      /* Unchanged blocks are detected against the newest entry */
+      if (!state->thisblock_valid && state->entries)
+      {
+         state_manager_dedup_decode(state, state_manager_dedup_entry(
+                  state, state->entries - 1), state->thisblock);
+         state->thisblock_valid = true;
+      }
+      *data = state->nextblock;
+      return;
+   }
+#endif
+
    if (!state->thisblock_valid)
    {
       const void *ignored;
@@ -488,6 +793,18 @@ static void state_manager_push_do(state_manager_t *state)
    memcpy(state->nextblock, state->debugblock, state->debugsize);
 #endif
 
+#ifdef HAVE_STATESTREAM
+   if (state->blocks)
+   {
+      state_manager_dedup_push_do(state);
+      swap                   = state->thisblock;
+      state->thisblock       = state->nextblock;
+      state->nextblock       = swap;
+      state->thisblock_valid = true;
+      return;
+   }
+#endif
+
    if (state->thisblock_valid)
    {
       uint8_t *compressed;
@@ -543,7 +860,7 @@ recheckcapacity:;
 
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, bool rewind_deduplicate)
 {
    core_info_t *core_info = NULL;
    void *state            = NULL;
@@ -597,8 +914,14 @@ void state_manager_event_init(
          msg_hash_to_str(MSG_REWIND_INIT),
          (unsigned)(rewind_buffer_size / 1000000));
 
-   rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+#ifdef HAVE_STATESTREAM
+   if (rewind_deduplicate)
+      rewind_st->state = state_manager_dedup_new(rewind_st->size,
+            rewind_buffer_size);
+   else
+#endif
+      rewind_st->state = state_manager_new(rewind_st->size,
+            rewind_buffer_size);
 
    if (!rewind_st->state)
       RARCH_WARN("[Rewind] %s.\n",
@@ -781,11 +1104,13 @@ bool state_manager_check_rewind(
             && ((cnt == 0) || retroarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL)))
       {
          void *state = NULL;
+         performance_trace_begin(PERF_TRACE_REWIND_PUSH);
          state_manager_push_where(rewind_st->state, &state);
 
          content_serialize_state_rewind(state, rewind_st->size);
 
          state_manager_push_do(rewind_st->state);
+         performance_trace_end(PERF_TRACE_REWIND_PUSH);
       }
    }
 
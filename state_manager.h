@@ -61,6 +61,23 @@ struct state_manager
 
    unsigned entries;
    bool thisblock_valid;
+
+#ifdef HAVE_STATESTREAM
+   /* Set when states are deduplicated instead of delta-compressed;
+    * data, head, tail and maxcompsize are then unused. */
+   struct uint32s_index *blocks;
+   struct uint32s_index *superblocks;
+   /* Ring of entries, superblock_count superblock indices each,
+    * oldest first starting at seq_tail */
+   uint32_t *seqs;
+   uint32_t *scratch;
+   size_t seq_cap;
+   size_t seq_tail;
+   size_t state_size;
+   size_t superblock_count;
+   /* Estimated bytes held by the index, compared against capacity */
+   size_t used;
+#endif
 };
 
 typedef struct state_manager state_manager_t;
@@ -80,7 +97,7 @@ void state_manager_event_deinit(
       struct retro_core_t *current_core);
 
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, bool rewind_deduplicate);
 
 /**
  * check_rewind:
@@ -22,6 +22,7 @@
 #include <time.h>
 #include <time/rtime.h>
 #include <compat/strl.h>
+#include <string/stdstring.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
@@ -44,11 +45,18 @@
 #include "tasks_internal.h"
 #include "../input/input_driver.h"
 #include "../input/bsv/bsvmovie.h"
+#include "../input/bsv/bsvindex.h"
+#ifdef HAVE_STATESTREAM
+#include "../input/bsv/bsvcalibrate.h"
+#endif
 
 #ifdef HAVE_STATESTREAM
 #if DEBUG
 #include "input/bsv/uint32s_index.h"
 #endif
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
 
 #define REPLAY_DEFAULT_COMMIT_INTERVAL 4
 #define REPLAY_DEFAULT_COMMIT_THRESHOLD 2
@@ -75,9 +83,10 @@ static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
    uint32_t header[REPLAY_HEADER_LEN] = {0};
    uint64_t header_size = REPLAY_HEADER_LEN_BYTES;
    uint32_t vsn                = 0;
+   /* Seeking jumps around the whole file, so have it mapped */
    intfstream_t *file          = intfstream_open_file(path,
          RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS);
 
    if (!file)
    {
@@ -109,6 +118,11 @@ static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
    handle->identifier = swap_if_big64(*identifier_loc);
 
    handle->min_file_pos = header_size + state_size;
+   /* Without a usable sidecar the index is built on the first seek */
+   if (vsn > 0)
+      handle->index     = bsv_index_load(handle->index_path,
+            intfstream_get_size(handle->file), handle->min_file_pos,
+            handle->identifier);
    return bsv_movie_reset_playback(handle);
 }
 
@@ -139,9 +153,12 @@ static bool bsv_movie_init_record(
 
    handle->file             = file;
    handle->version          = REPLAY_FORMAT_VERSION;
+   handle->index            = bsv_index_new();
 #ifdef HAVE_STATESTREAM
    handle->commit_interval  = REPLAY_DEFAULT_COMMIT_INTERVAL;
    handle->commit_threshold = REPLAY_DEFAULT_COMMIT_THRESHOLD;
+   handle->index_budget     = (size_t)settings->uints.replay_checkpoint_memory_limit
+      * 1024 * 1024;
 #endif
    handle->checkpoint_compression = REPLAY_CHECKPOINT2_COMPRESSION_NONE;
    if (settings->bools.savestate_file_compression)
@@ -152,6 +169,11 @@ static bool bsv_movie_init_record(
 #else
       {}
 #endif
+#ifdef HAVE_ZSTD
+   handle->checkpoint_dictionary  =
+            handle->checkpoint_compression == REPLAY_CHECKPOINT2_COMPRESSION_ZSTD
+         && settings->bools.replay_checkpoint_dictionary;
+#endif
 
    content_crc              = content_get_crc();
 
@@ -165,6 +187,20 @@ static bool bsv_movie_init_record(
    is_small                 = info_size < SMALL_STATE_THRESHOLD;
    superblock_size          = is_small ? SMALL_SUPERBLOCK_SIZE : DEFAULT_SUPERBLOCK_SIZE;
    block_size               = is_small ? SMALL_BLOCK_SIZE : DEFAULT_BLOCK_SIZE;
+   if (settings->bools.replay_checkpoint_calibrate)
+   {
+      char calibration_path[PATH_MAX_LENGTH];
+      if (bsv_calibration_path(calibration_path, sizeof(calibration_path),
+               runloop_state_get_ptr()->system.info.library_name))
+      {
+         if (bsv_calibration_load(calibration_path, info_size,
+                  &block_size, &superblock_size))
+            RARCH_LOG("[STATESTREAM] Using calibrated block size %u, "
+                  "superblock size %u.\n", block_size, superblock_size);
+         else
+            handle->calibration = bsv_calibration_new(calibration_path);
+      }
+   }
 #endif
    header[REPLAY_HEADER_STATE_SIZE_INDEX]      = 0; /* Will fill this in later */
    header[REPLAY_HEADER_FRAME_COUNT_INDEX]     = 0;
@@ -197,16 +233,30 @@ static bool bsv_movie_init_record(
 
 void bsv_movie_free(bsv_movie_t *handle)
 {
+#ifdef HAVE_THREADS
+   /* Lets the checkpoint worker finish writing before the file goes */
+   bsv_movie_async_free(handle);
+#endif
+   if (handle->file)
+      bsv_movie_save_index(handle);
    intfstream_close(handle->file);
    free(handle->file);
 
    free(handle->frame_pos);
+   bsv_index_free(handle->index);
+   free(handle->index_path);
 
 #ifdef HAVE_STATESTREAM
    uint32s_index_free(handle->superblocks);
    uint32s_index_free(handle->blocks);
    free(handle->superblock_seq);
+   bsv_calibration_free(handle->calibration);
+#ifdef HAVE_THREADS
+   if (handle->encode_pool)
+      tpool_destroy(handle->encode_pool);
 #endif
+#endif
+   bsv_movie_codec_free(handle);
    if (handle->last_save)
       free(handle->last_save);
    if (handle->cur_save)
@@ -217,6 +267,7 @@ void bsv_movie_free(bsv_movie_t *handle)
 
 static bsv_movie_t *bsv_movie_init_internal(const char *path, enum rarch_movie_type type)
 {
+   size_t index_path_len;
    size_t *frame_pos   = NULL;
    bsv_movie_t *handle = (bsv_movie_t*)calloc(1, sizeof(*handle));
 
@@ -231,6 +282,13 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path, enum rarch_movie_t
    handle->frame_pos       = frame_pos;
    handle->frame_mask      = (1 << 20) - 1;
 
+   index_path_len          = strlen(path) + STRLEN_CONST(BSV_INDEX_EXTENSION) + 1;
+   if ((handle->index_path = (char*)malloc(index_path_len)))
+   {
+      strlcpy(handle->index_path, path, index_path_len);
+      strlcat(handle->index_path, BSV_INDEX_EXTENSION, index_path_len);
+   }
+
    if (type == RARCH_MOVIE_PLAYBACK)
    {
       if (!bsv_movie_init_playback(handle, path))
@@ -241,6 +299,15 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path, enum rarch_movie_t
 
    handle->frame_pos[0]    = handle->min_file_pos;
 
+#ifdef HAVE_THREADS
+   /* Only recording benefits from moving checkpoint encoding
+    * off the main thread. */
+   if (     type == RARCH_MOVIE_RECORD
+         && config_get_ptr()->bools.replay_checkpoint_async
+         && !bsv_movie_async_init(handle))
+      RARCH_WARN("[Replay] Could not start checkpoint encoder thread, encoding on main thread.\n");
+#endif
+
    return handle;
 
 error:
@@ -389,6 +456,24 @@ bool movie_stop_playback(input_driver_state_t *input_st)
          MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
    RARCH_LOG("[Replay] %s\n", _msg);
 
+   if (     (input_st->bsv_movie_state.flags & BSV_FLAG_MOVIE_VERIFY)
+         && input_st->bsv_movie_state_handle)
+   {
+      bsv_movie_t *movie = input_st->bsv_movie_state_handle;
+      double secs        = (cpu_features_get_time_usec()
+            - movie->verify_start_usec) / 1000000.0;
+      RARCH_LOG("[Replay] Verified %u checkpoints over %llu frames "
+            "in %.2f s (%.1f fps).\n",
+            movie->verified_checkpoints,
+            (unsigned long long)movie->frame_counter, secs,
+            secs > 0 ? movie->frame_counter / secs : 0.0);
+      if (movie->desyncs)
+         RARCH_ERR("[Replay] %u desyncs, first at frame %lld.\n",
+               movie->desyncs, (long long)movie->first_desync_frame);
+      else
+         RARCH_LOG("[Replay] No desyncs.\n");
+   }
+
    bsv_movie_deinit_full(input_st);
 
    input_st->bsv_movie_state.flags &= ~(
@@ -407,6 +492,8 @@ bool movie_stop_record(input_driver_state_t *input_st)
    runloop_msg_queue_push(_msg, strlen(_msg), 2, 180, true, NULL,
          MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
    RARCH_LOG("[Replay] %s\n", _msg);
+   /* Let the checkpoint worker finish with the index first */
+   bsv_movie_async_flush(movie);
 #ifdef HAVE_STATESTREAM
 #if DEBUG
    RARCH_DBG("[Replay] superblock histogram\n");
@@ -414,6 +501,16 @@ bool movie_stop_record(input_driver_state_t *input_st)
    RARCH_DBG("[Replay] block histogram\n");
    uint32s_index_print_count_data(movie->blocks);
 #endif
+#endif
+#ifdef HAVE_STATESTREAM
+   if (movie->blocks && movie->superblocks)
+      RARCH_LOG("[STATESTREAM] Checkpoint index: %u blocks live, %u collected, "
+            "%u evicted; %u superblocks live, %u evicted; %u KB.\n",
+            movie->blocks->live, movie->blocks->collected,
+            movie->blocks->evicted, movie->superblocks->live,
+            movie->superblocks->evicted,
+            (unsigned)((uint32s_index_bytes(movie->blocks)
+                  + uint32s_index_bytes(movie->superblocks)) / 1024));
 #endif
    frame_count = swap_if_big32(movie->frame_counter);
    intfstream_seek(movie->file, REPLAY_HEADER_FRAME_COUNT_INDEX*sizeof(uint32_t), SEEK_SET);
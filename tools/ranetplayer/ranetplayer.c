@@ -119,6 +119,7 @@ uint32_t frame_offset_cmd(bool ntoh)
       case NETPLAY_CMD_MODE:
       case NETPLAY_CMD_CRC:
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
       case NETPLAY_CMD_RESET:
          frame = ntohl(payload[0]);
          if (ntoh)